@@ -28,6 +28,7 @@
 	/**@{*/
 	EXTERN void uart8250_init(void);
 	EXTERN void uart8250_write(char);
+	EXTERN void uart8250_flush(void);
 	/**@}*/
 
 #endif /* UART_8250_H */
@@ -17,15 +17,80 @@
  * You should have received a copy of the GNU General Public License
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
- 
+
 #ifndef KLOG_H_
 #define KLOG_H_
 
+	#include <stdint.h>
+
+	/**
+	 * @brief klog_ioctl() commands.
+	 */
+	/**@{*/
+	#define KLOG_CLEAR 0x4b100000 /**< Discard all records. */
+	/**@}*/
+
+	/**
+	 * @brief Kernel log parameters.
+	 */
+	/**@{*/
+	#define KLOG_RECORDS 128 /**< Number of record slots (should be 2^x). */
+	#define KLOG_SLOT    128 /**< Size of a record slot (in bytes).       */
+	/**@}*/
+
+	/**
+	 * @brief Record flags.
+	 */
+	/**@{*/
+	#define KLOG_CONT 0x1 /**< Continues the previous record. */
+	/**@}*/
+
+	/**
+	 * @brief Level of records that carry no log level.
+	 */
+	#define KLOG_NOLEVEL 0xff
+
+	/**
+	 * @brief Kernel log record header.
+	 *
+	 * @details Messages that do not fit in a single slot are split into
+	 *          several records, all but the first flagged KLOG_CONT.
+	 */
+	struct klog_record
+	{
+		uint32_t seq;    /**< Sequence number.               */
+		uint32_t ticks;  /**< Clock ticks at logging time.   */
+		uint8_t level;   /**< Log level (0-7).               */
+		uint8_t flags;   /**< Record flags.                  */
+		uint16_t length; /**< Length of the text (in bytes). */
+	};
+
+	/**
+	 * @brief Maximum length of the text in a record.
+	 */
+	#define KLOG_TEXT_MAX (KLOG_SLOT - sizeof(struct klog_record))
+
+	/**
+	 * @brief Gets the text of a record.
+	 */
+	#define KLOG_TEXT(r) \
+		((char *)(r) + sizeof(struct klog_record))
+
+	/**
+	 * @brief Gets the record that follows @p r in a buffer filled by read().
+	 */
+	#define KLOG_NEXT(r)                                                  \
+		((struct klog_record *)(KLOG_TEXT(r) + (((r)->length + 3) & ~3)))
+
+#ifdef BUILDING_KERNEL
+
 	#include <nanvix/const.h>
 
 	/* Forward definitions. */
 	EXTERN void klog_init(void);
+	EXTERN void klog_flush(void);
 	EXTERN void test_klog(void);
 
-#endif /* KLOG_H_ */
+#endif /* BUILDING_KERNEL */
 
+#endif /* KLOG_H_ */
@@ -0,0 +1,80 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROF_H_
+#define PROF_H_
+
+	#include <stdint.h>
+
+	/**
+	 * @brief prof_ioctl() commands.
+	 */
+	/**@{*/
+	#define PROF_START 0x50100000 /**< Start sampling.       */
+	#define PROF_STOP  0x50200000 /**< Stop sampling.        */
+	#define PROF_RESET 0x50300000 /**< Discard all samples.  */
+	#define PROF_LOST  0x50400000 /**< Get dropped samples.  */
+	/**@}*/
+
+	/**
+	 * @brief Profiler parameters.
+	 */
+	/**@{*/
+	#define PROF_FREQ     1000 /**< Sampling frequency (in Hz).        */
+	#define PROF_SAMPLES   512 /**< Ring buffer size (should be 2^x).  */
+	#define PROF_DEPTH       8 /**< Maximum depth of a call chain.     */
+	#define PROF_NAME_MAX   16 /**< Maximum length of a process name.  */
+	/**@}*/
+
+	/**
+	 * @brief Sample flags.
+	 */
+	/**@{*/
+	#define PROF_KERNEL 0x1 /**< Sampled in kernel mode. */
+	/**@}*/
+
+	/**
+	 * @brief Profiling sample.
+	 *
+	 * @details pc[0] is the interrupted program counter, and the remaining
+	 *          entries are return addresses recovered from the frame
+	 *          pointer chain, innermost first.
+	 */
+	struct prof_sample
+	{
+		int32_t pid;               /**< Process ID.               */
+		uint16_t flags;            /**< Sample flags.             */
+		uint16_t depth;            /**< Valid entries in pc[].    */
+		char name[PROF_NAME_MAX];  /**< Process name.             */
+		uint32_t pc[PROF_DEPTH];   /**< Call chain.               */
+	};
+
+#ifdef BUILDING_KERNEL
+
+	#include <nanvix/const.h>
+	#include <nanvix/hal.h>
+
+	/* Forward definitions. */
+	EXTERN void prof_init(void);
+	EXTERN void prof_tick(addr_t, addr_t);
+	EXTERN uint64_t prof_next(uint64_t);
+
+#endif /* BUILDING_KERNEL */
+
+#endif /* PROF_H_ */
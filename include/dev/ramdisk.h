@@ -21,10 +21,42 @@
 #ifndef RAMDISK_H_
 #define RAMDISK_H_
 
+	#include <stdint.h>
+
+	/**
+	 * @brief Compressed RAM disk images.
+	 *
+	 * @details A compressed image starts with a header, followed by an
+	 *          index of nchunks + 1 offsets and then by the chunks
+	 *          themselves. Chunk i spans bytes [index[i], index[i + 1]) of
+	 *          the data that follows the index. A chunk of zero length is
+	 *          all zeros, a chunk of RAMDISK_CHUNK_SIZE bytes is stored as
+	 *          is, and any other chunk is an LZ4 block.
+	 */
+	/**@{*/
+	#define RAMDISK_MAGIC      0x315a564e /**< "NVZ1".                  */
+	#define RAMDISK_CHUNK_SIZE       4096 /**< Uncompressed chunk size. */
+	/**@}*/
+
+	/**
+	 * @brief Compressed RAM disk image header.
+	 */
+	struct ramdisk_header
+	{
+		uint32_t magic;      /**< RAMDISK_MAGIC.                 */
+		uint32_t chunk_size; /**< Uncompressed chunk size.       */
+		uint32_t nchunks;    /**< Number of chunks.              */
+		uint32_t size;       /**< Uncompressed size (in bytes).  */
+	};
+
+#ifdef BUILDING_KERNEL
+
 	#include <nanvix/const.h>
 
 	/* Forward definitions. */
 	EXTERN void ramdisk_init(void);
 	EXTERN void test_rmd(void);
 
+#endif /* BUILDING_KERNEL */
+
 #endif /* RAMDISK_H_ */
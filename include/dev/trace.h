@@ -0,0 +1,108 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+	#include <stdint.h>
+
+	/**
+	 * @brief trace_ioctl() commands.
+	 */
+	/**@{*/
+	#define TRACE_START 0x54500000 /**< Start tracing.        */
+	#define TRACE_STOP  0x54600000 /**< Stop tracing.         */
+	#define TRACE_RESET 0x54700000 /**< Discard all events.   */
+	#define TRACE_LOST  0x54800000 /**< Get dropped events.   */
+	/**@}*/
+
+	/**
+	 * @brief Trace buffer size (in events, should be 2^x).
+	 */
+	#define TRACE_EVENTS 2048
+
+	/**
+	 * @brief Event types.
+	 */
+	/**@{*/
+	#define TRACE_SYSENTER  1 /**< System call entry: number.             */
+	#define TRACE_SYSEXIT   2 /**< System call exit: return value.        */
+	#define TRACE_SLEEP     3 /**< Sleep: chain, priority, exclusive.     */
+	#define TRACE_WAKEUP    4 /**< Wakeup: chain, first pid awaken.       */
+	#define TRACE_BIO_ISSUE 5 /**< Block I/O issue: see below.            */
+	#define TRACE_BIO_DONE  6 /**< Block I/O completion: dev, block, depth. */
+	#define TRACE_VFAULT    7 /**< Validity page fault: address.          */
+	#define TRACE_PFAULT    8 /**< Protection page fault: address.        */
+	#define TRACE_SWITCH    9 /**< Context switch: next pid, prev state.  */
+	/**@}*/
+
+	/**
+	 * @brief Gets the queue depth of a TRACE_BIO_ISSUE event.
+	 *
+	 * @details Block I/O issue events carry the device, the block number
+	 *          and the queue depth and request flags packed together.
+	 */
+	/**@{*/
+	#define TRACE_BIO_DEPTH(e) ((e)->arg[2] >> 16)
+	#define TRACE_BIO_FLAGS(e) ((e)->arg[2] & 0xffff)
+	/**@}*/
+
+	/**
+	 * @brief Trace event.
+	 */
+	struct trace_event
+	{
+		uint64_t ts;     /**< Timestamp (in nanoseconds). */
+		uint32_t seq;    /**< Sequence number.            */
+		uint16_t type;   /**< Event type.                 */
+		int16_t pid;     /**< Current process.            */
+		uint32_t arg[3]; /**< Arguments.                  */
+	};
+
+#ifdef BUILDING_KERNEL
+
+	#include <nanvix/const.h>
+
+	/**
+	 * @brief Records a trace event.
+	 *
+	 * @details Tracepoints compile to nothing unless the kernel is built
+	 *          with TRACE_ENABLE, and cost a single test while tracing is
+	 *          stopped.
+	 */
+#ifdef TRACE_ENABLE
+	#define TRACE(type, a0, a1, a2)                                    \
+	do {                                                               \
+		if (trace_enabled)                                             \
+			trace(type, (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2)); \
+	} while (0)
+#else
+	#define TRACE(type, a0, a1, a2) ((void)0)
+#endif
+
+	/* Forward definitions. */
+	EXTERN void trace_init(void);
+	EXTERN void trace(unsigned, uint32_t, uint32_t, uint32_t);
+	EXTERN void trace_sysenter(unsigned);
+	EXTERN void trace_sysexit(int);
+	EXTERN volatile int trace_enabled;
+
+#endif /* BUILDING_KERNEL */
+
+#endif /* TRACE_H_ */
@@ -64,6 +64,7 @@
 #define DIRENT_H_
 
 	#include <sys/types.h>
+	#include <sys/stat.h>
 	#include <limits.h>
 	
  	#ifndef MAXNAMLEN
@@ -79,12 +80,28 @@
 		char d_name[NAME_MAX]; /* Name of entry.      */
 	};
 	
+	/*
+	 * Directory entry along with the status of the file.
+	 *
+	 * The leading fields match struct dirent.
+	 */
+	struct dirplus
+	{
+		ino_t d_ino;           /* File serial number. */
+		char d_name[NAME_MAX]; /* Name of entry.      */
+		struct stat d_stat;    /* File status.        */
+	};
+	
 	/* Directory stream buffer size. */
 	#define _DIR_BUFSIZ ((1024/sizeof(struct dirent))*sizeof(struct dirent))
+	
+	/* Directory stream buffer size, when reading with readdirplus(). */
+	#define _DIR_PLUSSIZ (32*sizeof(struct dirplus))
 
 	/* Directory stream flags. */
-	#define _DIR_VALID 001 /* Valid directory?  */
-	#define _DIR_EOD   002 /* End of directory? */
+	#define _DIR_VALID 001 /* Valid directory?                    */
+	#define _DIR_EOD   002 /* End of directory?                   */
+	#define _DIR_PLUS  004 /* Buffer holds struct dirplus entries? */
 
 	/*
 	 * Directory stream.
@@ -94,8 +111,8 @@
 		int fd;             /* Underlying file descriptor.       */
 		int flags;          /* Flags (see above).                */
 		int count;          /* Valid entries left in the buffer. */
-		struct dirent *ptr; /* Next valid entry in the buffer.   */
-		struct dirent *buf; /* Buffer of directory entries.      */
+		char *ptr;          /* Next valid entry in the buffer.   */
+		char *buf;          /* Buffer of directory entries.      */
 	} DIR;
 	
 	/*
@@ -113,6 +130,16 @@
 	 */
 	extern struct dirent *readdir(DIR *dirp);
 	
+	/*
+	 * Reads a directory, along with the status of each entry.
+	 */
+	extern struct dirplus *readdirplus(DIR *dirp);
+	
+	/*
+	 * Reads directory entries along with their status.
+	 */
+	extern int getdentsplus(int fd, struct dirplus *buf, size_t nbytes);
+	
 	/*
 	 * Rewinds a directory stream.
 	 */
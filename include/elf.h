@@ -94,6 +94,19 @@
 	#define SHT_SHLIB    10 /* Reserved.                         */
 	#define SHT_DYNSYM   11 /* Dynamic linker symbol table.      */
 
+	/* Symbol types. */
+	#define STT_NOTYPE  0 /* Unspecified type. */
+	#define STT_OBJECT  1 /* Data object.      */
+	#define STT_FUNC    2 /* Code object.      */
+	#define STT_SECTION 3 /* Section.          */
+	#define STT_FILE    4 /* Source file.      */
+
+	/* Special section indexes. */
+	#define SHN_UNDEF 0 /* Undefined section. */
+
+	/* Extracts the type of a symbol. */
+	#define ELF32_ST_TYPE(info) ((info) & 0xf)
+
 	/* Section flags. */
 	#define SHF_WRITE     (1 << 0) /* Writable.                         */
 	#define SHF_ALLOC     (1 << 1) /* Occupies memory during execution. */
@@ -161,4 +174,17 @@
 		uint32_t sh_entsize;   /* Entry size if section holds table. */
 	};
 
+	/*
+	 * ELF 32 symbol table entry.
+	 */
+	struct elf32_sym
+	{
+		uint32_t st_name;  /* Symbol name (string tbl index). */
+		uint32_t st_value; /* Symbol value.                   */
+		uint32_t st_size;  /* Symbol size.                    */
+		uint8_t st_info;   /* Symbol type and binding.        */
+		uint8_t st_other;  /* Symbol visibility.              */
+		uint16_t st_shndx; /* Section index.                  */
+	};
+
 #endif /* ELF_H_ */
@@ -46,7 +46,12 @@
 	/**
 	 * @brief User for block number.
 	 */
-	typedef uint16_t block_t;
+	typedef uint32_t block_t;
+	
+	/**
+	 * @brief On-disk zone number.
+	 */
+	typedef uint16_t zone_t;
 #endif
 	
 	/**
@@ -128,10 +133,10 @@
 	#define NR_DIRECT 1
 
 	/** Number of zones in a single indirect zone. */
-	#define NR_SINGLE (BLOCK_SIZE/sizeof(block_t))
+	#define NR_SINGLE (BLOCK_SIZE/sizeof(zone_t))
 	
 	/** Number of zones in a double indirect zone. */
-	#define NR_DOUBLE ((BLOCK_SIZE/sizeof(block_t))*NR_SINGLE)
+	#define NR_DOUBLE ((BLOCK_SIZE/sizeof(zone_t))*NR_SINGLE)
 
 	/** Offset remaining to use in double indirect zone. */
 	#define REMAINING_OFFSET ((NR_ZONES_DIRECT+NR_SINGLE)*BLOCK_SIZE)
@@ -174,4 +179,101 @@
 	} __attribute__((packed));
 #endif
 
+/*============================================================================*
+ *                              Minix V3 Format                               *
+ *============================================================================*/
+
+	/**
+	 * @brief Minix V3 superblock magic number.
+	 */
+	#define SUPER_MAGIC_V3 0x4d5a
+	
+	/**
+	 * @brief Log 2 of Minix V3 block size.
+	 */
+	#define MINIX3_BLOCK_SIZE_LOG2 12
+	
+	/**
+	 * @brief Minix V3 block size (in bytes).
+	 */
+	#define MINIX3_BLOCK_SIZE (1 << MINIX3_BLOCK_SIZE_LOG2)
+	
+	/**
+	 * @brief Maximum name on a Minix V3 file system.
+	 */
+	#define MINIX3_NAME_MAX 60
+	
+	/**
+	 * @name Minix V3 Zones
+	 */
+	/**@{*/
+	#define MINIX3_NR_ZONES_DIRECT                        7 /**< Direct zones.    */
+	#define MINIX3_NR_ZONES                              10 /**< Total of zones.  */
+	#define MINIX3_ZONE_SINGLE     (MINIX3_NR_ZONES_DIRECT) /**< Single indirect. */
+	#define MINIX3_ZONE_DOUBLE     (MINIX3_ZONE_SINGLE + 1) /**< Double indirect. */
+	#define MINIX3_ZONE_TRIPLE     (MINIX3_ZONE_DOUBLE + 1) /**< Triple indirect. */
+	/**@}*/
+	
+	/** Number of zones in a Minix V3 single indirect zone. */
+	#define MINIX3_NR_SINGLE (MINIX3_BLOCK_SIZE/sizeof(uint32_t))
+	
+	/** Number of zones in a Minix V3 double indirect zone. */
+	#define MINIX3_NR_DOUBLE (MINIX3_NR_SINGLE*MINIX3_NR_SINGLE)
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief Minix V3 on-disk zone number.
+	 */
+	typedef uint32_t zone3_t;
+	
+	/**
+	 * @brief Minix V3 in-disk superblock.
+	 * 
+	 * @details Lives at byte 1024 of the device, whatever the block size.
+	 *          The inode map starts at block 2. Bit zero of both the
+	 *          inode and zone maps is reserved.
+	 */
+	struct d_superblock3
+	{
+		uint32_t s_ninodes;          /**< Number of inodes.           */
+		uint16_t s_pad0;             /**< Unused.                     */
+		uint16_t s_imap_nblocks;     /**< Number of inode map blocks. */
+		uint16_t s_bmap_nblocks;     /**< Number of zone map blocks.  */
+		uint16_t s_first_data_block; /**< First data zone.            */
+		uint16_t s_log_zone_size;    /**< Log 2 of blocks per zone.   */
+		uint16_t s_pad1;             /**< Unused.                     */
+		uint32_t s_max_size;         /**< Maximum file size.          */
+		uint32_t s_nblocks;          /**< Number of zones.            */
+		uint16_t s_magic;            /**< Magic number.               */
+		uint16_t s_pad2;             /**< Unused.                     */
+		uint16_t s_block_size;       /**< Block size (in bytes).      */
+		uint8_t s_disk_version;      /**< File system sub-version.    */
+	} __attribute__((packed));
+	
+	/**
+	 * @brief Minix V3 disk inode.
+	 */
+	struct d_inode3
+	{
+		uint16_t i_mode;                 /**< Access permissions.          */
+		uint16_t i_nlinks;               /**< Number of links to the file. */
+		uint16_t i_uid;                  /**< User id of the file's owner. */
+		uint16_t i_gid;                  /**< Group number of owner user.  */
+		uint32_t i_size;                 /**< File size (in bytes).        */
+		uint32_t i_atime;                /**< Last access time.            */
+		uint32_t i_mtime;                /**< Last modification time.      */
+		uint32_t i_ctime;                /**< Last status change time.     */
+		zone3_t i_zones[MINIX3_NR_ZONES]; /**< Zone numbers.              */
+	} __attribute__((packed));
+	
+	/**
+	 * @brief Minix V3 directory entry.
+	 */
+	struct d_dirent3
+	{
+		uint32_t d_ino;               /**< File serial number. */
+		char d_name[MINIX3_NAME_MAX]; /**< Name of entry.      */
+	} __attribute__((packed));
+#endif
+
 #endif /* MINIX_H_ */
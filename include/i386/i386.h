@@ -86,6 +86,11 @@
 	 */
 	EXTERN void idt_flush(struct idtptr *idtptr);
 	
+	/*
+	 * Reads the time stamp counter.
+	 */
+	EXTERN uint64_t read_tsc(void);
+	
 
 #endif /* _ASM_FILE_ */
 
@@ -23,8 +23,23 @@
 	/* Oscillator frequency. */
 	#define PIT_FREQUENCY 1193180
 	
+	/* Maximum value of the 16-bit counter. */
+	#define PIT_MAX_COUNT 0xffff
+	
 	/* Registers. */
-	#define PIT_CTRL 0x43 /* Control. */
-	#define PIT_DATA 0x40 /* Data.    */
+	#define PIT_CTRL  0x43 /* Control.                        */
+	#define PIT_DATA  0x40 /* Data.                           */
+	#define PIT_DATA2 0x42 /* Channel 2 data.                 */
+	#define PIT_GATE  0x61 /* Channel 2 gate and output line. */
+	
+	/* Control words. */
+	#define PIT_RATEGEN 0x36 /* Channel 0, rate generator.           */
+	#define PIT_ONESHOT 0x30 /* Channel 0, interrupt on terminal.    */
+	#define PIT_CAL     0xb0 /* Channel 2, interrupt on terminal.    */
+	
+	/* Channel 2 gate bits. */
+	#define PIT_GATE_ON  0x01 /* Gate input.             */
+	#define PIT_GATE_SPK 0x02 /* Speaker data.           */
+	#define PIT_GATE_OUT 0x20 /* Channel 2 output state. */
 
 #endif /* I386_PIT_H_ */
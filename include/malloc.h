@@ -94,6 +94,22 @@ struct mallinfo {
   size_t keepcost; /* top-most, releasable (via malloc_trim) space */
 };	
 
+/* Allocation statistics, as reported by mallstat(). */
+struct mallstat {
+  size_t heap;            /* bytes currently obtained with brk */
+  size_t heap_max;        /* peak of heap */
+  size_t trim_threshold;  /* top-most free bytes that trigger a trim */
+  size_t small_bytes;     /* bytes in small objects handed out */
+  size_t slab_bytes;      /* bytes carved into small-object slabs */
+  unsigned long nmalloc;  /* allocations, other than aligned ones */
+  unsigned long nfree;    /* deallocations */
+  unsigned long nsmall;   /* allocations served by the small-object front end */
+  unsigned long nreuse;   /* small allocations served from a free list */
+  unsigned long nslabs;   /* small-object slabs carved */
+  unsigned long brk_grows; /* times the break moved up */
+  unsigned long brk_trims; /* times the break moved down */
+};
+
 /* The routines.  */
 
 #ifdef __CYGWIN__
@@ -187,6 +203,8 @@ extern int malloc_trim _PARAMS ((size_t));
 extern int _malloc_trim_r _PARAMS ((struct _reent *, size_t));
 #endif
 
+extern void mallstat _PARAMS ((struct mallstat *));
+
 /* A compatibility routine for an earlier version of the allocator.  */
 
 extern _VOID mstats _PARAMS ((char *));
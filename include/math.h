@@ -566,6 +566,12 @@ extern float exp10f _PARAMS((float));
 extern float pow10f _PARAMS((float));
 # endif
 
+/* Nanvix extensions: y[i] = f(x[i]), for i < n */
+extern void vexp _PARAMS((double *, const double *, int));
+extern void vlog _PARAMS((double *, const double *, int));
+extern void vsin _PARAMS((double *, const double *, int));
+extern void vcos _PARAMS((double *, const double *, int));
+
 #endif /* !defined (__STRICT_ANSI__) || defined(__cplusplus) */
 
 #ifndef __STRICT_ANSI__
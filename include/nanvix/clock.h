@@ -22,9 +22,14 @@
 #define TIMER_H_
 
 	#include <nanvix/const.h>
+	#include <stdint.h>
 
 	/**
 	 * @brief Clock interrupt frequency (in Hz)
+	 *
+	 * @details When the clock runs in one-shot mode this is the rate of the
+	 *          virtual tick, which is still used for scheduling quanta,
+	 *          alarms and legacy time accounting.
 	 */
 	#define CLOCK_FREQ 100
 
@@ -33,6 +38,15 @@
 	 */
 	#define CLOCK_INTERVAL_PER_MS 10
 
+	/**
+	 * @name Time conversion constants
+	 */
+	/**@{*/
+	#define NSEC_PER_SEC  1000000000                 /**< Nanoseconds per second.      */
+	#define NSEC_PER_USEC 1000                       /**< Nanoseconds per microsecond. */
+	#define NSEC_PER_TICK (NSEC_PER_SEC/CLOCK_FREQ)  /**< Nanoseconds per clock tick.  */
+	/**@}*/
+
 #ifdef BUILDING_KERNEL
 	/**
 	 * @brief Current time.
@@ -42,10 +56,12 @@
 
  	/* Forward declarations. */
 	EXTERN void clock_init(unsigned);
+	EXTERN uint64_t clock_ns(void);
+	EXTERN void clock_event(uint64_t);
 
 	/* Forward definitions. */
 	EXTERN unsigned ticks;
-	EXTERN signed startup_time;
+	EXTERN unsigned startup_time;
 #endif
 
 #endif /* TIMER_H_ */
@@ -42,13 +42,16 @@
 	#define PROC_MAX                    64 /**< Maximum number of process.         */
 	#define PROC_SIZE_MAX  (MEMORY_SIZE/8) /**< Maximum process size.              */
 	#define RAMDISK_SIZE         0x4000000 /**< RAM disks size.                    */
-	#define INITRD_SIZE          0x4000000 /**< Init RAM disk size.                */
+	#define INITRD_SIZE          0x1000000 /**< Init RAM disk size.                */
 	#define NR_INODES                 1024 /**< Number of in-core inodes.          */
+	#define NR_BMAP_EXTENTS              4 /**< Cached block map extents/inode.   */
 	#define NR_SUPERBLOCKS               4 /**< Number of in-core super blocks.    */
 	#define ROOT_DEV                0x0001 /**< Root device number.                */
 	#define NR_FILES                   256 /**< Number of opened files.            */
 	#define NR_REGIONS                 128 /**< Number of memory regions.          */
 	#define NR_BUFFERS                 256 /**< Number of block buffers.           */
+	#define NR_DAX_BUFFERS             256 /**< Number of direct-access buffers.   */
+	#define NR_PAGE_BUFFERS             64 /**< Number of page-sized buffers.      */
 	#define NR_MOUNTING_POINT           64 /**< Maximum nunber of mounting points. */
 	#define DEBUG_MAX                   64 /**< Maximum number of debug functions. */
 	/**@}*/
@@ -62,9 +62,13 @@
 	 * @brief Major numbers for character devices.
 	 */
 	/**@{*/
-	#define NULL_MAJOR 0x0 /**< Null device.       */
-	#define TTY_MAJOR  0x1 /**< TTY device.        */
-	#define KLOG_MAJOR 0x2 /**< kernel log device. */
+	#define NULL_MAJOR  0x0 /**< Null device.       */
+	#define TTY_MAJOR   0x1 /**< TTY device.        */
+	#define KLOG_MAJOR  0x2 /**< kernel log device. */
+	#define PROF_MAJOR  0x3 /**< Profiler device.   */
+	#define TRACE_MAJOR 0x4 /**< Tracer device.     */
+	#define PROC_MAJOR  0x5 /**< Process file system (mount only). */
+	#define TMP_MAJOR   0x6 /**< Temporary file system (mount only). */
 	/**@}*/
 	
 	/**
@@ -114,6 +118,7 @@
 		ssize_t (*write)(dev_t, const char *, size_t, off_t); /**< Write.       */
 		int (*readblk)(unsigned, struct buffer *);            /**< Read block.  */
 		int (*writeblk)(unsigned, struct buffer *);           /**< Write block. */
+		void *(*direct)(unsigned, block_t, size_t);           /**< Map block.   */
 	};
 	
 	/* Forward definitions. */
@@ -122,5 +127,6 @@
 	EXTERN ssize_t bdev_read(dev_t, char *, size_t, off_t);
 	EXTERN void bdev_writeblk(struct buffer *);
 	EXTERN void bdev_readblk(struct buffer *);
+	EXTERN void *bdev_direct(dev_t, block_t, size_t);
 	EXTERN void bdev_test(void);
 #endif /* DEV_H_ */
@@ -32,8 +32,10 @@
 	#include <nanvix/config.h>
 	#include <nanvix/const.h>
 	#include <nanvix/pm.h>
+	#include <nanvix/waitq.h>
 	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <dirent.h>
 	#include <stdint.h>
 	#include <ustat.h>
 	#include <sys/sem.h>
@@ -69,6 +71,8 @@
 	EXTERN dev_t buffer_dev(const_buffer_t);
 	EXTERN block_t buffer_num(const_buffer_t);
 	EXTERN int buffer_is_sync(const_buffer_t);
+	EXTERN size_t buffer_size(const_buffer_t);
+	EXTERN int bsetsize(dev_t, size_t);
 	
 	/**@}*/
 	
@@ -91,6 +95,7 @@
 		ssize_t (*file_read)(struct inode *, void *, size_t , off_t );
 		ssize_t (*file_write)(struct inode *, const void *, size_t , off_t);
 		struct d_dirent *(*dirent_search) (struct inode *, const char *, struct buffer **, int);
+		block_t (*block_map)(struct inode *, off_t, int);
 	};
 
 	/**
@@ -105,6 +110,19 @@
 		INODE_PIPE   = (1 << 4)  /**< Pipe inode?  */
 	};
 
+	/**
+	 * @brief Cached block map extent.
+	 *
+	 * @details Maps @p count logical blocks starting at @p logic to
+	 *          consecutive disk blocks starting at @p phys.
+	 */
+	struct bmap_extent
+	{
+		unsigned logic; /**< First logical block. */
+		block_t phys;   /**< First disk block.    */
+		unsigned count; /**< Number of blocks.    */
+	};
+
 	/** 
  	 * @brief In-core inode. 
 	 */ 
@@ -117,6 +135,8 @@
 		off_t size;               /**< File size (in bytes).                 */ 
 		time_t time;              /**< Time when the file was last accessed. */ 
 		block_t blocks[NR_ZONES]; /**< Zone numbers.                         */ 
+		struct bmap_extent bmap[NR_BMAP_EXTENTS]; /**< Block map cache.  */
+		unsigned bmap_hand;       /**< Next block map cache slot to reuse.   */
 		dev_t dev;                /**< Underlying device.                    */ 
 		ino_t num;                /**< Inode number.                         */ 
 		struct superblock *sb;    /**< Superblock.                           */ 
@@ -128,10 +148,11 @@
 		struct inode *free_next;  /**< Next inode in the free list.          */ 
 		struct inode *hash_next;  /**< Next inode in the hash table.         */ 
 		struct inode *hash_prev;  /**< Previous inode in the hash table.     */ 
-		struct process *chain;    /**< Sleeping chain.                       */ 
+		struct waitq chain;       /**< Wait queue.                           */ 
 		struct inode_operations * i_op;
 		union {
 			struct d_inode minix;
+			pid_t procfs_pid;
 		} u;
 	}; 
 
@@ -149,9 +170,10 @@
   EXTERN struct inode *inode_dname(const char *, const char **); 
   EXTERN struct inode *inode_name(const char *); 
   EXTERN struct inode *inode_pipe(void); 
+  EXTERN void inode_stat(const struct inode *, struct stat *);
   EXTERN int mount (char*, char*); 
   EXTERN int unmount (char*);
-  EXTERN int mkfs (const char *, uint16_t, uint16_t, uint16_t, uint16_t);
+  EXTERN int mkfs (const char *, const char *, uint16_t, uint16_t, uint16_t, uint16_t);
   EXTERN struct inode * cross_mount_point_up (struct inode *);
   EXTERN struct inode * cross_mount_point_down (struct inode *);
   EXTERN int root_fs (struct inode *);
@@ -182,7 +204,10 @@
   EXTERN superblock_t superblock_read(dev_t); 
   EXTERN void superblock_stat(superblock_t, struct ustat *); 
   EXTERN void superblock_sync(void); 
-  EXTERN block_t block_map(struct inode *, off_t, int); 
+  EXTERN block_t block_map(struct inode *, off_t, int);
+  EXTERN void bmap_invalidate(struct inode *); 
+  EXTERN block_t bmap_lookup(struct inode *, unsigned);
+  EXTERN void bmap_insert(struct inode *, unsigned, block_t);
   EXTERN void block_free(struct superblock *, block_t, int); 
    
 /*============================================================================* 
@@ -208,15 +233,18 @@
   EXTERN int getfildes(void); 
   EXTERN struct file *getfile(void); 
   EXTERN void do_close(int); 
+  EXTERN void putfile(struct file *);
   EXTERN int dir_add(struct inode *, struct inode *, const char *); 
   EXTERN ino_t dir_search(struct inode *, const char *); 
   EXTERN int dir_remove(struct inode *, const char *); 
   EXTERN ssize_t file_read(struct inode *, void *, size_t, off_t); 
   EXTERN ssize_t dir_read(struct inode *, void *, size_t, off_t); 
+  EXTERN ssize_t dir_readplus(struct inode *, struct dirplus *, size_t, off_t *);
   EXTERN ssize_t file_write(struct inode *, const void *, size_t, off_t); 
   EXTERN ssize_t pipe_read(struct inode *, char *, size_t); 
   EXTERN ssize_t pipe_write(struct inode *, const char *, size_t); 
   EXTERN struct inode *do_creat(struct inode *, const char *wame, mode_t, int);
+  EXTERN struct inode *do_open(const char *, int, mode_t);
   EXTERN const char *break_path(const char *, char *);
    
   /* Forward definitions. */ 
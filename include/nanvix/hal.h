@@ -56,6 +56,11 @@
 	#define INT_LVL_5 5 /**< Level 5: all hardware interrupts enabled.  */
 	/**@}*/
 	
+	/**
+	 * @brief Number of hardware interrupt lines.
+	 */
+	#define NR_HWINT 16
+
 	/**
 	 * @name Processor Control Functions
 	 */
@@ -71,7 +76,11 @@
 	EXTERN void user_mode(addr_t, addr_t);
 	EXTERN void switch_to(struct process *);
 	EXTERN unsigned irq_lvl(unsigned);
-	/**@}*/	
+	EXTERN unsigned fetch_and_add(volatile unsigned *, unsigned);
+	/**@}*/
+
+	/* Forward definitions. */
+	EXTERN unsigned hwint_counts[NR_HWINT];	
 	
 	/**
 	 * @name I/O Functions
@@ -197,6 +197,13 @@
 	EXTERN void *kmemset(void *, int, size_t);
 	/**@}*/
 
+	/**
+	 * @name Compression Functions
+	 */
+	/**@{*/
+	EXTERN ssize_t lz4_decompress(const void *, size_t, void *, size_t);
+	/**@}*/
+
 	/**
 	 * @brief Aligns a value on a boundary.
 	 *
@@ -275,13 +282,6 @@
 	#define KERN_INFO    KERN_SOH "6" /* Informational.                    */
 	#define KERN_DEBUG   KERN_SOH "7" /* Debug-level messages.             */
 
-	/**
-	 * @brief Kernel log size (in characters).
-	 *
-	 * @note This should be 2^x.
-	 */
-	#define KLOG_SIZE 1024
-
 	/**
 	 * @name Logging and Debugging Functions
 	 */
@@ -43,7 +43,7 @@
 	 * - KPOOL_VIRT _should_ be placed after INITRD_VIRT _and_
 	 *   after CMD_LINE, which occupies 4MiB. (CMD_LINE will be
 	 *   mapped right after INITRD. (see boot.S for details).
-	 *   Thus, 0xc0... + 0x050... + 0x004...
+	 *   Thus, 0xc0... + 0x020... + 0x004...
 	 *
 	 * - SERIAL_VIRT should be placed KPOOL_SIZE MiB after KPOOL_VIRT.
 	 *   KPOOL_SIZE occupies 16MiB.
@@ -63,13 +63,13 @@
 	#define UBASE_VIRT   0x02000000 /* User base.        */
 	#define KBASE_VIRT   0xc0000000 /* Kernel base.      */
 	#define INITRD_VIRT  0xc1000000 /* Initial RAM disk. */
-	#define KPOOL_VIRT   0xc5400000 /* Kernel page pool. */
-	#define SERIAL_VIRT  0xc6400000 /* Serial port.      */
+	#define KPOOL_VIRT   0xc2400000 /* Kernel page pool. */
+	#define SERIAL_VIRT  0xc3400000 /* Serial port.      */
 	
 	/* Physical memory layout. */
 	#define KBASE_PHYS   0x00000000 /* Kernel base.      */
-	#define KPOOL_PHYS   0x05400000 /* Kernel page pool. */
-	#define UBASE_PHYS   0x06400000 /* User base.        */
+	#define KPOOL_PHYS   0x02400000 /* Kernel page pool. */
+	#define UBASE_PHYS   0x03400000 /* User base.        */
 	
 	/* User memory layout. */
 	#define USTACK_ADDR 0xc0000000 /* User stack. */
@@ -109,6 +109,18 @@
 	/* Buffers virt. */
 	EXTERN unsigned const BUFFERS_VIRT;
 
+	/**
+	 * @brief Memory usage statistics.
+	 */
+	struct mm_stats
+	{
+		unsigned frames;        /**< User page frames.          */
+		unsigned frames_used;   /**< User page frames in use.   */
+		unsigned frames_shared; /**< Shared user page frames.   */
+		unsigned kpages;        /**< Kernel pages.              */
+		unsigned kpages_used;   /**< Kernel pages in use.       */
+	};
+
 	/* Forward definitions. */
 	EXTERN int chkmem(const void *, size_t, mode_t);
 	EXTERN int fubyte(const void *);
@@ -116,10 +128,15 @@
 	EXTERN int crtpgdir(struct process *);
 	EXTERN int pfault(addr_t);
 	EXTERN int vfault(addr_t);
+	EXTERN int upgpresent(struct process *, addr_t);
+	EXTERN int upgvalid(struct process *, addr_t);
+	EXTERN int upgfill(struct process *, addr_t, void *);
 	EXTERN void dstrypgdir(struct process *);
 	EXTERN void putkpg(void *);
 	EXTERN void mm_init(void);
 	EXTERN void *getkpg(int);
+	EXTERN void frame_stats(struct mm_stats *);
+	EXTERN void kpool_stats(struct mm_stats *);
 
 #endif /* _ASM_FILE_ */
 	
@@ -29,6 +29,7 @@
 
 	#include <nanvix/config.h>
 	#include <nanvix/const.h>
+	#include <nanvix/waitq.h>
 	#include <nanvix/fs.h>
 	#include <nanvix/hal.h>
 	#include <nanvix/region.h>
@@ -36,6 +37,7 @@
 	#include <i386/pmc.h>
 	#include <sys/types.h>
 	#include <limits.h>
+	#include <stdint.h>
 	#include <signal.h>
 
 	/**
@@ -66,8 +68,9 @@
 	 * @name Process flags
 	 */
 	/**@{*/
-	#define PROC_NEW 0 /**< Is the process new?     */
-	#define PROC_SYS 1 /**< Handling a system call? */
+	#define PROC_NEW  0 /**< Is the process new?     */
+	#define PROC_SYS  1 /**< Handling a system call? */
+	#define PROC_EXCL 2 /**< Exclusive wait?         */
 	/**@}*/
 
 	/**
@@ -125,6 +128,8 @@
 
 #ifndef _ASM_FILE_
 
+	#include <sys/pstat.h>
+
 	/**
 	 * @brief Process.
 	 */
@@ -192,10 +197,19 @@
     	 * @name Timing information
     	 */
 		/**@{*/
-    	unsigned utime;  /**< User CPU time.                          */
-    	unsigned ktime;  /**< Kernel CPU time.                        */
-		unsigned cutime; /**< User CPU time of terminated children.   */
-		unsigned cktime; /**< Kernel CPU time of terminated children. */
+    	uint64_t utime;  /**< User CPU time (in ns).                          */
+    	uint64_t ktime;  /**< Kernel CPU time (in ns).                        */
+		uint64_t cutime; /**< User CPU time of terminated children (in ns).   */
+		uint64_t cktime; /**< Kernel CPU time of terminated children (in ns). */
+		uint64_t tstamp; /**< Time of last CPU time accounting (in ns).       */
+		/**@}*/
+
+    	/**
+    	 * @name Resource usage
+    	 */
+		/**@{*/
+		struct pcounters ru;  /**< Resource usage.                        */
+		struct pcounters cru; /**< Resource usage of terminated children. */
 		/**@}*/
 
     	/**
@@ -207,26 +221,51 @@
     	int priority;             /**< Process priorities.       */
     	int nice;                 /**< Nice for scheduling.      */
     	unsigned alarm;           /**< Alarm.                    */
-    	unsigned ns_ticks;        /**< Nanosleep ticks.          */
+    	uint64_t ns_deadline;     /**< Nanosleep deadline.       */
     	struct process *ns_chain; /**< Nanosleep sleeping chain. */
 		struct process *next;     /**< Next process in a list.   */
 		struct process **chain;   /**< Sleeping chain.           */
+		struct waitq *wq;         /**< Wait queue.               */
+		struct process *wq_next;  /**< Next in wait queue.       */
+		struct process *wq_prev;  /**< Previous in wait queue.   */
 		/**@}*/
 	};
 
 	/* Forward definitions. */
+	EXTERN void account(struct process *, int);
+	EXTERN void account_child(struct process *, struct process *);
 	EXTERN void bury(struct process *);
 	EXTERN void die(int);
 	EXTERN int issig(void);
+	EXTERN struct process *proc_alloc(void);
+	EXTERN void proc_inherit(struct process *);
 	EXTERN void pm_init(void);
 	EXTERN void sched(struct process *);
 #ifdef BUILDING_KERNEL
 	EXTERN void sleep(struct process **, int);
 #endif
 	EXTERN void sndsig(struct process *, int);
+	EXTERN void timer_arm(struct process *);
+	EXTERN int timer_expire(void);
 	EXTERN void wakeup(struct process **);
 	EXTERN void yield(void);
 
+	/**
+	 * @name Wait queues
+	 */
+	/**@{*/
+	#define WQ_SHARED    0 /**< Shared wait.    */
+	#define WQ_EXCLUSIVE 1 /**< Exclusive wait. */
+	/**@}*/
+
+	/* Forward definitions. */
+	EXTERN void waitq_init(struct waitq *);
+	EXTERN void wq_sleep(struct waitq *, int, int);
+	EXTERN void wq_wakeup(struct waitq *);
+	EXTERN void wq_wakeup_all(struct waitq *);
+	EXTERN void wq_handoff(struct waitq *, struct waitq *);
+	EXTERN void wq_remove(struct process *);
+
 	/**
 	 * @name Process memory regions
 	 */
@@ -235,6 +274,7 @@
 	#define HEAP(p)  (&p->pregs[1]) /**< Heap region.  */
 	#define STACK(p) (&p->pregs[2]) /**< Stack region. */
 	#define DATA(p)  (&p->pregs[3]) /**< Data region.  */
+	#define SEMS(p)  (&p->pregs[NR_PREGIONS - 1]) /**< Semaphore page. */
 	/**@}*/
 
 	/**
@@ -288,6 +328,7 @@
 	EXTERN struct process *last_proc;
 	EXTERN pid_t next_pid;
 	EXTERN unsigned nprocs;
+	EXTERN unsigned nswitches;
 
 #endif /* _ASM_FILE */
 
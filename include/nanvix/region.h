@@ -50,8 +50,8 @@
 	/* Mini region flags. */
 	#define MREGION_FREE 0x01 /* Mini region is free. */
 
-	/* 'Extra' regions. */
-	#define NR_DATA_REGIONS (NR_PREGIONS-3)
+	/* 'Extra' regions (the last one holds the semaphore page). */
+	#define NR_DATA_REGIONS (NR_PREGIONS-4)
 
 	/*
 	 * Mini region.
@@ -172,7 +172,9 @@
 	EXTERN int editreg(struct region *, uid_t, gid_t, mode_t);
 	EXTERN int growreg(struct process *, struct pregion *, ssize_t);
 	EXTERN int loadreg(struct inode *, struct region *, off_t, size_t);
+	EXTERN int sharepg(struct region *, struct region *, addr_t);
 	EXTERN void detachreg(struct process *, struct pregion *);
+	EXTERN void droppg(struct region *, addr_t);
 	EXTERN void freereg(struct region *);
 	EXTERN void initreg(void);
 	EXTERN void lockreg(struct region *);
@@ -28,14 +28,16 @@
 	#include <sys/times.h>
 	#include <sys/types.h>
 	#include <sys/utsname.h>
+	#include <time.h>
 	#include <i386/pmc.h>
 	#include <signal.h>
 	#include <ustat.h>
 	#include <utime.h>
 	#include <semaphore.h>
+	#include <sys/spawn.h>
 
 	/* Number of system calls. */
-	#define NR_SYSCALLS 60
+	#define NR_SYSCALLS 66
 
 	/* System call numbers. */
 	#define NR_alarm     0
@@ -98,12 +100,19 @@
 	#define NR_acct     57
 	#define NR_rmdir    58
 	#define NR_nanosleep 59
- 	#define NR_semget   60
- 	#define NR_semctl   61
- 	#define NR_semop    62
+	#define NR_clock_gettime 60
+	#define NR_futex    61
+	#define NR_spawn    62
+	#define NR_getrusage 63
+	#define NR_pstat    64
+	#define NR_getdentsplus 65
 
 #ifndef _ASM_FILE_
 
+	#include <sys/pstat.h>
+	#include <sys/resource.h>
+	#include <dirent.h>
+
 	/* System calls prototypes. */
 	EXTERN unsigned sys_alarm(unsigned seconds);
 	EXTERN int sys_brk(void *ptr);
@@ -312,7 +321,26 @@
 	EXTERN int sys_rmdir(const char *path);
 
 	/* Sleeps for a given amount of secs and nanosecs. */
-	EXTERN int sys_nanosleep(int tv_sec, int tv_nsec);
+	EXTERN int sys_nanosleep(int tv_sec, int tv_nsec, struct timespec *rmtp);
+
+	/* Gets the time of a clock. */
+	EXTERN int sys_clock_gettime(clockid_t clk_id, struct timespec *tp);
+
+	/* Waits on or wakes up processes waiting on a user address. */
+	EXTERN int sys_futex(int *uaddr, int op, int val);
+
+	/* Creates a process that executes a program. */
+	EXTERN pid_t sys_spawn(const char *filename, const char **argv,
+		const char **envp, const struct spawn *sp);
+
+	/* Gets resource usage. */
+	EXTERN int sys_getrusage(int who, struct rusage *usage);
+
+	/* Takes a snapshot of the process table. */
+	EXTERN int sys_pstat(struct pstat *buf, int n);
+
+	/* Reads directory entries along with their status. */
+	EXTERN ssize_t sys_getdentsplus(int fd, struct dirplus *buf, size_t n);
 
 #endif /* _ASM_FILE_ */
 
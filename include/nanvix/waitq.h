@@ -0,0 +1,49 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file nanvix/waitq.h
+ *
+ * @brief Wait queues.
+ */
+
+#ifndef NANVIX_WAITQ_H_
+#define NANVIX_WAITQ_H_
+
+#ifndef _ASM_FILE_
+
+	/* Forward definitions. */
+	struct process;
+
+	/**
+	 * @brief Wait queue.
+	 *
+	 * @details Doubly linked list of sleeping processes. Shared waiters are
+	 *          kept at the front and exclusive waiters at the back, so that
+	 *          a wakeup can stop at the first exclusive waiter.
+	 */
+	struct waitq
+	{
+		struct process *head; /**< First waiting process. */
+		struct process *tail; /**< Last waiting process.  */
+	};
+
+#endif /* _ASM_FILE_ */
+
+#endif /* NANVIX_WAITQ_H_ */
@@ -24,16 +24,50 @@
 
 #ifndef _ASM_FILE_
 
+	/**
+	 * @brief Semaphore pages address.
+	 *
+	 * @details Each named semaphore has its counter in a page of its own.
+	 *          The kernel maps the page of a semaphore at this address plus
+	 *          the semaphore ID times the page size, only in processes that
+	 *          open it, so that uncontended operations can be carried out
+	 *          without entering the kernel.
+	 */
+	#define SEM_PAGE_ADDR 0x9fc00000
+
+	/**
+	 * @brief Log2 of the size of a semaphore page.
+	 */
+	#define SEM_PAGE_SHIFT 12
+
+	/**
+	 * @brief Semaphore counter.
+	 */
+	struct semcount
+	{
+		volatile int value;   /**< Semaphore value.            */
+		volatile int waiters; /**< Processes in the slow path. */
+	};
+
+	/**
+	 * @brief Gets the counter of a semaphore.
+	 *
+	 * @param idx Semaphore ID.
+	 */
+	#define SEMCOUNT(idx) \
+		((struct semcount *)(SEM_PAGE_ADDR + ((idx) << SEM_PAGE_SHIFT)))
+
 	/**
 	 * @brief User-land semaphore
 	 *
 	 */
 	typedef struct sem_t
 	{
-		int semid; 	/**< Semaphore ID.  */
+		int semid; 	            /**< Semaphore ID.       */
+		struct semcount *count; /**< Semaphore counter.  */
 	} sem_t;
 
-	extern sem_t *usem[OPEN_MAX];
+	extern sem_t *usem[SEM_OPEN_MAX];
 
 	/* Forward definitions. */
 	extern sem_t *sem_open(const char *, int, ...);
@@ -103,6 +103,10 @@ extern "C" {
 #endif
 
 
+/* Nanvix provides monotonic and process CPU-time clocks. */
+#define _POSIX_MONOTONIC_CLOCK		200112L
+#define _POSIX_CPUTIME			200112L
+
 #ifdef __svr4__
 # define _POSIX_JOB_CONTROL     1
 # define _POSIX_SAVED_IDS       1
@@ -0,0 +1,89 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYS_PSTAT_H_
+#define SYS_PSTAT_H_
+
+	#include <sys/types.h>
+	#include <stdint.h>
+
+	/**
+	 * @brief Maximum length of a process name in a snapshot.
+	 */
+	#define PSTAT_NAME_MAX 16
+
+	/**
+	 * @name Process states
+	 */
+	/**@{*/
+	#define PSTAT_DEAD     0 /**< Dead.                      */
+	#define PSTAT_ZOMBIE   1 /**< Zombie.                    */
+	#define PSTAT_RUNNING  2 /**< Running.                   */
+	#define PSTAT_READY    3 /**< Ready to execute.          */
+	#define PSTAT_WAITING  4 /**< Waiting (interruptible).   */
+	#define PSTAT_SLEEPING 5 /**< Waiting (uninterruptible). */
+	#define PSTAT_STOPPED  6 /**< Stopped.                   */
+	/**@}*/
+
+	/**
+	 * @brief Resource usage counters.
+	 */
+	struct pcounters
+	{
+		uint32_t minflt;    /**< Page faults served without I/O.   */
+		uint32_t majflt;    /**< Page faults that read a page.     */
+		uint32_t cowflt;    /**< Copy-on-write breaks.             */
+		uint32_t inblock;   /**< Blocks read from devices.         */
+		uint32_t oublock;   /**< Blocks written to devices.        */
+		uint32_t nvcsw;     /**< Voluntary context switches.       */
+		uint32_t nivcsw;    /**< Involuntary context switches.     */
+		uint32_t nsyscalls; /**< System calls.                     */
+		uint64_t pipein;    /**< Bytes read from pipes.            */
+		uint64_t pipeout;   /**< Bytes written to pipes.           */
+		uint64_t ttyin;     /**< Bytes read from terminals.        */
+		uint64_t ttyout;    /**< Bytes written to terminals.       */
+	};
+
+	/**
+	 * @brief Process snapshot.
+	 */
+	struct pstat
+	{
+		pid_t pid;                  /**< Process ID.                   */
+		pid_t ppid;                 /**< Parent process ID.            */
+		pid_t pgrp;                 /**< Process group ID.             */
+		uid_t uid;                  /**< User ID.                      */
+		int state;                  /**< State (PSTAT_*).              */
+		int priority;               /**< Priority.                     */
+		int nice;                   /**< Nice value.                   */
+		size_t size;                /**< Process size (in bytes).      */
+		uint64_t utime;             /**< User CPU time (in ns).        */
+		uint64_t ktime;             /**< Kernel CPU time (in ns).      */
+		struct pcounters ru;        /**< Resource usage.               */
+		char name[PSTAT_NAME_MAX];  /**< Process name.                 */
+	};
+
+#ifndef BUILDING_KERNEL
+
+	/* Forward definitions. */
+	extern int pstat(struct pstat *, int);
+
+#endif /* BUILDING_KERNEL */
+
+#endif /* SYS_PSTAT_H_ */
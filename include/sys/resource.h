@@ -71,6 +71,12 @@
 struct rusage {
   	struct timeval ru_utime;	/* user time used */
 	struct timeval ru_stime;	/* system time used */
+	long ru_minflt;			/* page reclaims */
+	long ru_majflt;			/* page faults */
+	long ru_inblock;		/* block input operations */
+	long ru_oublock;		/* block output operations */
+	long ru_nvcsw;			/* voluntary context switches */
+	long ru_nivcsw;			/* involuntary context switches */
 };
 
 int	_EXFUN(getrusage, (int, struct rusage*));
@@ -23,9 +23,7 @@
 	/* Kernel semaphores */
 	struct ksem {
 		char name[MAX_SEM_NAME];				/* Semaphore name 										*/
-		short value;              				/* Value of the semaphore                    			*/
 		pid_t currprocs[PROC_MAX];				/* Processes using the semaphores						*/
-		struct process* semwaiters[PROC_MAX];	/* The size should be higher if threads are implemented */
 		dev_t dev;								/* Semaphore descriptor device							*/
 		ino_t num;								/* Semaphore descriptor inode number					*/
 	};
@@ -39,6 +37,21 @@
 	/* Frees a semaphore */
 	void freesem(struct ksem *sem);
 
+	/* Attaches a view of the semaphore pages to the calling process */
+	int semmap(void);
+
+	/* Maps the counter of a semaphore in the calling process */
+	int semattach(int idx);
+
+	/* Unmaps the counter of a semaphore from the calling process */
+	void semdetach(int idx);
+
+	/* Shares the semaphore counters with a child process */
+	int semdup(struct process *proc);
+
+	/* Returns the counter of a semaphore if it is mapped */
+	struct semcount *semcount(int idx);
+
 	/* Verify if a semaphore name is valid */
 	int namevalid(const char* name);
 
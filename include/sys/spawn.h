@@ -0,0 +1,89 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYS_SPAWN_H_
+#define SYS_SPAWN_H_
+
+	/**
+	 * @brief spawn() file actions.
+	 */
+	/**@{*/
+	#define SPAWN_OPEN  0 /**< Open a file on a descriptor.       */
+	#define SPAWN_CLOSE 1 /**< Close a descriptor.                */
+	#define SPAWN_DUP2  2 /**< Duplicate a descriptor on another. */
+	/**@}*/
+
+	/**
+	 * @brief Maximum number of file actions per spawn() call.
+	 */
+	#define SPAWN_ACTIONS_MAX 16
+
+	/**
+	 * @brief spawn() flags.
+	 *
+	 * @details These match the POSIX_SPAWN_* flags of <spawn.h>.
+	 */
+	/**@{*/
+	#define SPAWN_RESETIDS      0x01 /**< Reset effective IDs.          */
+	#define SPAWN_SETPGROUP     0x02 /**< Set process group.            */
+	#define SPAWN_SETSCHEDPARAM 0x04 /**< Set scheduling parameters.    */
+	#define SPAWN_SETSCHEDULER  0x08 /**< Set scheduling policy.        */
+	#define SPAWN_SETSIGDEF     0x10 /**< Reset signals to default.     */
+	#define SPAWN_SETSIGMASK    0x20 /**< Set signal mask.              */
+	/**@}*/
+
+#ifndef _ASM_FILE_
+
+	#include <sys/types.h>
+
+	/**
+	 * @brief File action.
+	 */
+	struct spawn_action
+	{
+		int type;         /**< Action type (SPAWN_*).        */
+		int fd;           /**< Target file descriptor.       */
+		int newfd;        /**< Source descriptor for dup2(). */
+		int oflag;        /**< Open flags.                   */
+		mode_t mode;      /**< Creation mode.                */
+		const char *path; /**< Path name for open().         */
+	};
+
+	/**
+	 * @brief spawn() attributes.
+	 */
+	struct spawn
+	{
+		int flags;                          /**< SPAWN_* flags.          */
+		pid_t pgroup;                       /**< Process group.          */
+		unsigned sigdefault;                /**< Signals to reset.       */
+		int nactions;                       /**< Number of file actions. */
+		const struct spawn_action *actions; /**< File actions.           */
+	};
+
+#ifndef BUILDING_KERNEL
+
+	/* Forward definitions. */
+	extern pid_t spawn(const char *, char *const [], char *const [], const struct spawn *);
+
+#endif /* BUILDING_KERNEL */
+
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_SPAWN_H_ */
@@ -248,6 +248,20 @@ int _EXFUN(timer_getoverrun, (timer_t timerid));
 #endif
 #endif /* _POSIX_TIMERS */
 
+#if !defined(_POSIX_TIMERS) && defined(_POSIX_MONOTONIC_CLOCK)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int _EXFUN(clock_gettime, (clockid_t clock_id, struct timespec *tp));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !_POSIX_TIMERS && _POSIX_MONOTONIC_CLOCK */
+
 /* High Resolution Sleep, P1003.1b-1993, p. 269 */
 int _EXFUN(nanosleep, (const struct timespec  *rqtp, struct timespec *rmtp));
 
@@ -17,10 +17,42 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/prof.h>
+#include <i386/int.h>
+#include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
 #include <nanvix/pm.h>
+#include <stdint.h>
+
+/* Forward definitions. */
+extern void cpuid(unsigned *, unsigned *,
+	unsigned *, unsigned *);
+
+/**
+ * @brief Time stamp counter feature flag (CPUID.01H:EDX).
+ */
+#define CPUID_TSC (1 << 4)
+
+/**
+ * @brief TSC calibration interval (in miliseconds).
+ */
+#define CLOCK_CAL_MS 10
+
+/**
+ * @brief Scale shift for cycles to nanoseconds conversion.
+ */
+#define CLOCK_SHIFT 22
+
+/**
+ * @name One-shot timer bounds (in nanoseconds)
+ */
+/**@{*/
+#define CLOCK_EVENT_MIN 20000 /**< Shortest programmable event. */
+#define CLOCK_EVENT_MAX \
+	((uint64_t)PIT_MAX_COUNT*NSEC_PER_SEC/PIT_FREQUENCY)
+/**@}*/
 
 /**
  * @brief Clock interrupts since system initialization.
@@ -32,25 +64,226 @@ PUBLIC unsigned ticks = 0;
  */
 PUBLIC unsigned startup_time = 0;
 
+/**
+ * @brief Clocksource state.
+ *
+ * @details The clocksource state is only written by the clock interrupt
+ *          handler. Readers use the sequence number to detect and retry
+ *          torn reads.
+ */
+PRIVATE struct
+{
+	int oneshot;       /**< TSC-based one-shot mode?          */
+	uint32_t tsc_khz;  /**< TSC frequency (in kHz).           */
+	uint32_t mult;     /**< Cycles to nanoseconds multiplier. */
+	volatile unsigned seq;       /**< Update sequence number.  */
+	volatile uint64_t base_tsc;  /**< TSC at last update.      */
+	volatile uint64_t base_ns;   /**< Nanoseconds at last update. */
+	uint32_t tick_ns;  /**< Nanoseconds into current tick.    */
+	uint64_t armed;    /**< Deadline of the pending event.    */
+} clksrc;
+
+/**
+ * @brief Converts a TSC delta to nanoseconds.
+ *
+ * @param cycles Number of elapsed TSC cycles.
+ *
+ * @returns The number of nanoseconds in @p cycles.
+ */
+#define CYCLES_TO_NS(cycles) \
+	(((cycles)*clksrc.mult) >> CLOCK_SHIFT)
+
+/**
+ * @brief Returns the monotonic time since system initialization.
+ *
+ * @returns The number of nanoseconds elapsed since the clock was initialized.
+ */
+PUBLIC uint64_t clock_ns(void)
+{
+	unsigned seq;
+	uint64_t ns;
+
+	/* Tick-based clocksource. */
+	if (!clksrc.oneshot)
+		return ((uint64_t)ticks*NSEC_PER_TICK);
+
+	do
+	{
+		seq = clksrc.seq;
+		ns = clksrc.base_ns + CYCLES_TO_NS(read_tsc() - clksrc.base_tsc);
+	} while ((seq & 1) || (seq != clksrc.seq));
+
+	return (ns);
+}
+
+/**
+ * @brief Advances the clocksource.
+ *
+ * @details Folds elapsed cycles into the clocksource base, so that cycle
+ *          deltas stay small enough to be scaled without overflow, and
+ *          advances the virtual tick counter accordingly.
+ *
+ * @returns The number of clock ticks that have elapsed since the last update.
+ */
+PRIVATE unsigned clock_update(void)
+{
+	unsigned elapsed;
+	uint64_t now;
+	uint64_t delta;
+
+	/* Tick-based clocksource. */
+	if (!clksrc.oneshot)
+	{
+		ticks++;
+		return (1);
+	}
+
+	now = read_tsc();
+	delta = CYCLES_TO_NS(now - clksrc.base_tsc);
+
+	clksrc.seq++;
+	clksrc.base_tsc = now;
+	clksrc.base_ns += delta;
+	clksrc.seq++;
+
+	/* Advance virtual ticks. */
+	elapsed = 0;
+	clksrc.tick_ns += (uint32_t)delta;
+	while (clksrc.tick_ns >= NSEC_PER_TICK)
+	{
+		clksrc.tick_ns -= NSEC_PER_TICK;
+		elapsed++;
+	}
+	ticks += elapsed;
+
+	return (elapsed);
+}
+
+/**
+ * @brief Programs the next clock event.
+ *
+ * @details Programs the PIT in one-shot mode to raise an interrupt at
+ *          @p deadline. The deadline is clamped to the range that the 16-bit
+ *          counter can express, so long idle periods are covered by a chain
+ *          of events. In periodic mode this function does nothing.
+ *
+ * @param deadline Absolute time of the event (in nanoseconds).
+ */
+PUBLIC void clock_event(uint64_t deadline)
+{
+	uint64_t now;
+	uint64_t delta;
+	unsigned count;
+	unsigned flags;
+
+	/* Periodic mode. */
+	if (!clksrc.oneshot)
+		return;
+
+	/*
+	 * We may be called either from the clock interrupt
+	 * handler or with interrupts enabled, so keep the
+	 * clock interrupt out while the PIT is programmed.
+	 */
+	__asm__ __volatile__ ("pushfl; popl %0; cli" : "=r" (flags) : : "memory");
+
+	/* An earlier event is already pending. */
+	if ((clksrc.armed != 0) && (deadline >= clksrc.armed))
+		goto out;
+
+	now = clock_ns();
+	delta = (deadline > now) ? deadline - now : 0;
+
+	if (delta < CLOCK_EVENT_MIN)
+		delta = CLOCK_EVENT_MIN;
+	else if (delta > CLOCK_EVENT_MAX)
+		delta = CLOCK_EVENT_MAX;
+
+	count = (unsigned)((delta*PIT_FREQUENCY)/NSEC_PER_SEC);
+	if (count == 0)
+		count = 1;
+	else if (count > PIT_MAX_COUNT)
+		count = PIT_MAX_COUNT;
+
+	clksrc.armed = now + delta;
+
+	/* Send control byte: interrupt on terminal count. */
+	outputb(PIT_CTRL, PIT_ONESHOT);
+
+	/* Send data byte: count_low and count_high. */
+	outputb(PIT_DATA, (byte_t)(count & 0xff));
+	outputb(PIT_DATA, (byte_t)((count >> 8)));
+
+out:
+	__asm__ __volatile__ ("pushl %0; popfl" : : "r" (flags) : "memory", "cc");
+}
+
 /*
  * Handles a timer interrupt.
  */
 PRIVATE void do_clock()
 {
-	ticks++;
-	curr_proc->counter--;
-	
+	unsigned elapsed;
+	struct intstack *ctx;
+
+	clksrc.armed = 0;
+
+	ctx = (struct intstack *)curr_proc->kesp;
+	prof_tick(ctx->eip, ctx->ebp);
+
+	elapsed = clock_update();
+	account(curr_proc, KERNEL_WAS_RUNNING(curr_proc));
+	curr_proc->counter -= (int)elapsed;
+
 	if (KERNEL_WAS_RUNNING(curr_proc))
 	{
-		curr_proc->ktime++;
+		timer_arm(curr_proc);
 		return;
 	}
-	
-	curr_proc->utime++;
-		
-	/* Give up processor time. */
-	if (curr_proc->counter <= 0)
+
+	/*
+	 * Give up processor time if the quantum is over or if some
+	 * sleeping process should be awaken right now.
+	 */
+	if ((curr_proc->counter <= 0) || (timer_expire()))
 		yield();
+	else
+		timer_arm(curr_proc);
+}
+
+/**
+ * @brief Calibrates the time stamp counter.
+ *
+ * @details Measures how many TSC cycles elapse while PIT channel 2 counts
+ *          down a known interval.
+ *
+ * @returns The TSC frequency (in kHz).
+ */
+PRIVATE uint32_t tsc_calibrate(void)
+{
+	byte_t gate;
+	uint64_t t0, t1;
+	unsigned latch;
+
+	latch = (PIT_FREQUENCY*CLOCK_CAL_MS)/1000;
+
+	/* Enable channel 2 gate and silence the speaker. */
+	gate = inputb(PIT_GATE);
+	outputb(PIT_GATE, (gate & ~PIT_GATE_SPK) | PIT_GATE_ON);
+
+	/* Count down the calibration interval. */
+	outputb(PIT_CTRL, PIT_CAL);
+	outputb(PIT_DATA2, (byte_t)(latch & 0xff));
+	outputb(PIT_DATA2, (byte_t)(latch >> 8));
+
+	t0 = read_tsc();
+	while (!(inputb(PIT_GATE) & PIT_GATE_OUT))
+		noop();
+	t1 = read_tsc();
+
+	outputb(PIT_GATE, gate);
+
+	return ((uint32_t)((t1 - t0)/CLOCK_CAL_MS));
 }
 
 /*
@@ -59,15 +292,39 @@ PRIVATE void do_clock()
 PUBLIC void clock_init(unsigned freq)
 {
 	uint16_t freq_divisor;
+	unsigned eax, ebx, ecx, edx;
 	
 	kprintf("dev: initializing clock device driver");
 	
 	set_hwint(INT_CLOCK, &do_clock);
-	
+
+	/* Use TSC-based clocksource, if available. */
+	eax = 1; ecx = 0;
+	cpuid(&eax, &ebx, &ecx, &edx);
+	if (edx & CPUID_TSC)
+	{
+		clksrc.tsc_khz = tsc_calibrate();
+
+		if (clksrc.tsc_khz != 0)
+		{
+			clksrc.mult = (uint32_t)
+				(((uint64_t)1000000 << CLOCK_SHIFT)/clksrc.tsc_khz);
+			clksrc.base_tsc = read_tsc();
+			clksrc.base_ns = 0;
+			clksrc.oneshot = 1;
+
+			kprintf("dev: tsc running at %d kHz", clksrc.tsc_khz);
+
+			clock_event(NSEC_PER_TICK);
+
+			return;
+		}
+	}
+
 	freq_divisor = PIT_FREQUENCY/freq;
 	
 	/* Send control byte: adjust frequency divisor. */
-	outputb(PIT_CTRL, 0x36);
+	outputb(PIT_CTRL, PIT_RATEGEN);
 	
 	/* Send data byte: divisor_low and divisor_high. */
 	outputb(PIT_DATA, (byte_t)(freq_divisor & 0xff));
@@ -106,3 +106,30 @@ PUBLIC void processor_reload(void)
 {
 	pic_mask(int_masks[curr_proc->irqlvl]);
 }
+
+/*============================================================================*
+ *                              fetch_and_add()                               *
+ *============================================================================*/
+
+/**
+ * @brief Atomically adds to a variable.
+ *
+ * @param p Target variable.
+ * @param n Value to add.
+ *
+ * @returns The value of @p p before the addition.
+ *
+ * @note A single instruction cannot be interrupted halfway, so this is safe
+ *       against interrupt handlers without disabling interrupts.
+ */
+PUBLIC unsigned fetch_and_add(volatile unsigned *p, unsigned n)
+{
+	__asm__ __volatile__ (
+		"xaddl %0, %1"
+		: "+r" (n), "+m" (*p)
+		:
+		: "memory"
+	);
+
+	return (n);
+}
@@ -35,6 +35,11 @@ PUBLIC void (*hwint_handlers[])(void) = {
 	&default_hwint, &default_hwint,	&default_hwint, &default_hwint
 };
 
+/**
+ * @brief Number of interrupts received on each line.
+ */
+PUBLIC unsigned hwint_counts[NR_HWINT] = { 0, };
+
 /**
  * @brief Default hardware interrupt handler.
  */
@@ -82,6 +87,7 @@ PUBLIC void do_hwint(unsigned irq)
 {
 	unsigned old_irqlvl;
 	
+	hwint_counts[irq]++;
 	old_irqlvl = processor_raise(irq);
 
 	enable_interrupts();
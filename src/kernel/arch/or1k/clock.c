@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
@@ -41,7 +42,7 @@ PRIVATE unsigned rate = 0;
 /*
  * @brief Setup the clock next event.
  */
-PRIVATE void clock_event()
+PRIVATE void tick_event()
 {
 	unsigned new_clock;
 	new_clock = rate;
@@ -51,6 +52,31 @@ PRIVATE void clock_event()
 	mtspr(SPR_TTMR, SPR_TTMR_RT | SPR_TTMR_IE | new_clock);
 }
 
+/**
+ * @brief Returns the monotonic time since system initialization.
+ *
+ * @returns The number of nanoseconds elapsed since the clock was initialized.
+ *
+ * @note The tick timer runs in periodic mode, so the resolution of this
+ *       clocksource is one clock tick.
+ */
+PUBLIC uint64_t clock_ns(void)
+{
+	return ((uint64_t)ticks*NSEC_PER_TICK);
+}
+
+/**
+ * @brief Programs the next clock event.
+ *
+ * @param deadline Absolute time of the event (in nanoseconds).
+ *
+ * @note The tick timer runs in periodic mode, so this function does nothing.
+ */
+PUBLIC void clock_event(uint64_t deadline)
+{
+	((void) deadline);
+}
+
 /*
  * Handles a timer interrupt.
  */
@@ -58,18 +84,18 @@ PRIVATE void do_clock()
 {
 	ticks++;
 	
+	account(curr_proc, KERNEL_WAS_RUNNING(curr_proc));
+
 	if (KERNEL_WAS_RUNNING(curr_proc))
 	{
-		curr_proc->ktime++;
-		clock_event();
+		tick_event();
 		return;
 	}
 	
-	curr_proc->utime++;
-	clock_event();
+	tick_event();
 		
 	/* Give up processor time. */
-	if (--curr_proc->counter == 0)
+	if ((--curr_proc->counter <= 0) || (timer_expire()))
 		yield();
 }
 
@@ -95,7 +121,7 @@ PUBLIC void clock_init(unsigned freq)
 	mtspr(SPR_TTCR, 0);
 
 	/* Setup the clock event. */
-	clock_event();
+	tick_event();
 
 	/* Unmask Timer Interrupt. */
 	mtspr(SPR_SR, mfspr(SPR_SR) | SPR_SR_TEE);
@@ -134,3 +134,32 @@ PUBLIC void processor_reload(void)
 	/* Previous state. */
 	pic_mask(int_masks[curr_proc->irqlvl]);
 }
+
+/*============================================================================*
+ *                              fetch_and_add()                               *
+ *============================================================================*/
+
+/**
+ * @brief Atomically adds to a variable.
+ *
+ * @param p Target variable.
+ * @param n Value to add.
+ *
+ * @returns The value of @p p before the addition.
+ */
+PUBLIC unsigned fetch_and_add(volatile unsigned *p, unsigned n)
+{
+	unsigned sr;
+	unsigned old;
+
+	/* Keep interrupts away, then restore the previous state. */
+	sr = mfspr(SPR_SR);
+	mtspr(SPR_SR, sr & ~(SPR_SR_IEE | SPR_SR_TEE));
+
+	old = *p;
+	*p = old + n;
+
+	mtspr(SPR_SR, sr);
+
+	return (old);
+}
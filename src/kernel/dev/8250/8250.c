@@ -103,14 +103,59 @@
 #define IIR_TO   0xCC /**< Timeout.                            */
 #define IIR_THRE 0xC2 /**< Transmitter Holding Register Empty. */
 #define IIT_MS   0xC0 /**< Modem Status.                       */
+#define IIR_NINT 0x01 /**< No interrupt pending.               */
+#define IIR_FIFO 0xC0 /**< FIFOs enabled.                      */
 /**@}*/
 
+/**
+ * @brief Transmitter parameters.
+ */
+/**@{*/
+#define UART_FIFO_SIZE 16  /**< Transmitter FIFO size.            */
+#define UART_TX_SIZE   512 /**< Transmit ring size (should be 2^x). */
+/**@}*/
+
+/* Error checking. */
+#if (UART_TX_SIZE & (UART_TX_SIZE - 1))
+	#error "UART_TX_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Transmitter.
+ *
+ * @details Characters are queued by uart8250_write() and drained by the
+ *          Transmitter Holding Register Empty interrupt, which refills the
+ *          whole FIFO at once. The tail is only written by writers and the
+ *          head only by the drainer. Writers run either with interrupts
+ *          disabled or from an interrupt handler that masks the UART, so
+ *          they are never interleaved with the interrupt handler.
+ */
+PRIVATE struct
+{
+	int ready;                   /**< Interrupts set up?        */
+	volatile int busy;           /**< Transmitter interrupt on? */
+	volatile unsigned head;      /**< First queued character.   */
+	volatile unsigned tail;      /**< Next free slot.           */
+	char buffer[UART_TX_SIZE];   /**< Ring buffer.              */
+} tx = { 0, 0, 0, 0, {0, } };
+
+/**
+ * @brief Asserts if the transmit ring is empty.
+ */
+#define TX_EMPTY() (tx.head == tx.tail)
+
+/**
+ * @brief Asserts if the transmit ring is full.
+ */
+#define TX_FULL() (((tx.tail + 1) & (UART_TX_SIZE - 1)) == tx.head)
+
 /**
  * FIFO Control Register bits.
  */
 /**@{*/
-#define FCR_CLRRECV 0x1  /**< Clear receiver FIFO.    */
-#define FCR_CLRTMIT 0x2  /**< Clear transmitter FIFO. */
+#define FCR_ENABLE  0x1  /**< Enable FIFOs.           */
+#define FCR_CLRRECV 0x2  /**< Clear receiver FIFO.    */
+#define FCR_CLRTMIT 0x4  /**< Clear transmitter FIFO. */
 /**@}*/
 
 /**
@@ -140,11 +185,20 @@
 #define LCR_DLA   0x80 /**< Divisor Latch Access.                            */
 /**@}*/
 
+/**
+ * Modem Control Register bits.
+ */
+/**@{*/
+#define MCR_DTR  0x1 /**< Data Terminal Ready.           */
+#define MCR_RTS  0x2 /**< Request To Send.               */
+#define MCR_OUT2 0x8 /**< Auxiliary output 2 (IRQ gate). */
+/**@}*/
+
 /**
  * Line Status Register.
  */
 /**@{*/
-#define LSR_DR  0x0  /**< Data Ready.                  */
+#define LSR_DR  0x1  /**< Data Ready.                  */
 #define LSR_OE  0x2  /**< Overrun Error.               */
 #define LSR_PE  0x4  /**< Parity Error.                */
 #define LSR_FE  0x8  /**< Framing Error.               */
@@ -163,23 +217,92 @@ PUBLIC char uart8250_read(void)
 	return INPUTB(RB);
 }
 
+/**
+ * @brief Moves queued characters into the transmitter FIFO.
+ *
+ * @details The transmitter FIFO must be empty.
+ */
+PRIVATE void uart8250_fill(void)
+{
+	int n;
+
+	for (n = 0; (n < UART_FIFO_SIZE) && (!TX_EMPTY()); n++)
+	{
+		OUTPUTB(THR, tx.buffer[tx.head]);
+		tx.head = (tx.head + 1) & (UART_TX_SIZE - 1);
+	}
+}
+
+/**
+ * @brief Drains the transmit ring by polling.
+ *
+ * @details This is used when the ring is full and cannot wait for the
+ *          transmitter interrupt, and when interrupts are about to be
+ *          disabled for good, e.g. on kernel panic.
+ */
+PUBLIC void uart8250_flush(void)
+{
+	while (!TX_EMPTY())
+	{
+		/* Wait until FIFO is empty. */
+		while (!(INPUTB(LSR) & LSR_TFE))
+			/* noop */;
+
+		uart8250_fill();
+	}
+}
+
 /**
  * Writes into serial port.
  * @param c Data to be written.
+ *
+ * @details The character is queued and sent by the transmitter interrupt
+ *          handler. The caller spins only if the ring is full.
  */
 PUBLIC void uart8250_write(char c)
 {
-	/* Wait until FIFO is empty. */
-	while ( !(INPUTB(LSR) & LSR_TFE) );
+	/* Interrupts not set up yet. */
+	if (!tx.ready)
+	{
+		/* Wait until FIFO is empty. */
+		while ( !(INPUTB(LSR) & LSR_TFE) );
+
+		/* Write character to device. */
+		OUTPUTB(THR, c);
+
+		return;
+	}
 
-	/* Write character to device. */
-	OUTPUTB(THR, c);
+	/*
+	 * Ring is full. Writers run with the
+	 * transmitter interrupt masked, so drain
+	 * some characters by hand.
+	 */
+	while (TX_FULL())
+	{
+		while (!(INPUTB(LSR) & LSR_TFE))
+			/* noop */;
+
+		uart8250_fill();
+	}
+
+	tx.buffer[tx.tail] = c;
+	tx.tail = (tx.tail + 1) & (UART_TX_SIZE - 1);
+
+	/* Kick transmitter. */
+	if (!tx.busy)
+	{
+		tx.busy = 1;
+		if (INPUTB(LSR) & LSR_TFE)
+			uart8250_fill();
+		OUTPUTB(IER, (1 << IER_RDAI) | (1 << IER_TEI));
+	}
 }
 
 /**
- * Serial interrupt handler.
+ * @brief Handles a received character.
  */
-PUBLIC void uart8250_handler(void)
+PRIVATE void uart8250_receive(void)
 {
 	char ascii_code = uart8250_read();
 
@@ -197,6 +320,45 @@ PUBLIC void uart8250_handler(void)
 	tty_int(ascii_code);
 }
 
+/**
+ * Serial interrupt handler.
+ */
+PUBLIC void uart8250_handler(void)
+{
+	unsigned char iir;
+
+	while (!((iir = INPUTB(IIR)) & IIR_NINT))
+	{
+		switch (iir | IIR_FIFO)
+		{
+			/* Transmitter FIFO is empty. */
+			case IIR_THRE:
+				uart8250_fill();
+
+				/* Nothing else to send. */
+				if (TX_EMPTY())
+				{
+					OUTPUTB(IER, (1 << IER_RDAI));
+					tx.busy = 0;
+				}
+				break;
+
+			/* Data received. */
+			case IIR_RDA:
+			case IIR_TO:
+				while (INPUTB(LSR) & LSR_DR)
+					uart8250_receive();
+				break;
+
+			/* Line or modem status change. */
+			default:
+				INPUTB(LSR);
+				INPUTB(MSR);
+				break;
+		}
+	}
+}
+
 /**
  * Initializes the serial device.
  */
@@ -220,11 +382,16 @@ PUBLIC void uart8250_init(void)
 	 */
 	OUTPUTB(LCR, LCR_BPC_8);
 
-	/* Reset FIFOs and set trigger level to 1 byte. */
-	OUTPUTB(FCR, FCR_CLRRECV | FCR_CLRTMIT | FCR_TRIG_1);
+	/* Enable and reset FIFOs and set trigger level to 1 byte. */
+	OUTPUTB(FCR, FCR_ENABLE | FCR_CLRRECV | FCR_CLRTMIT | FCR_TRIG_1);
+
+	/* Route interrupts to the interrupt controller. */
+	OUTPUTB(MCR, MCR_DTR | MCR_RTS | MCR_OUT2);
 
 	/* Enable 'Data Available Interrupt'. */
-	OUTPUTB(IER, 1);
+	OUTPUTB(IER, (1 << IER_RDAI));
 
 	set_hwint(INT_COM1, &uart8250_handler);
+
+	tx.ready = 1;
 }
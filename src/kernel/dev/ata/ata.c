@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/fs.h>
@@ -179,12 +180,17 @@ struct ata_info
 #define REQ_BUF   (1 << 1) /* Buffered request?      */
 #define REQ_SYNC  (1 << 2) /* Synchronous operation? */
 
+/* Gets the block number of a request. */
+#define REQ_NUM(req)                                                        \
+	(((req)->flags & REQ_BUF) ? buffer_num((req)->u.buffered.buf) : (req)->u.raw.num)
+
 /*
  * I/O operation request.
  */
 struct request
 {
-	unsigned flags; /* Flags (see above). */
+	unsigned flags;      /* Flags (see above).                      */
+	struct waitq waiter; /* Process waiting for request to complete. */
 	
 	union
 	{
@@ -212,7 +218,6 @@ PRIVATE struct atadev
 	/* General information. */
 	int flags;             /* Flags (see above).                         */
 	struct ata_info info;  /* Device information.                        */
-	struct process *chain; /* Process waiting for operation to complete. */
 	
 	/* Block operation queue. */
 	struct
@@ -221,7 +226,7 @@ PRIVATE struct atadev
 		int head;                                   /* Head.                 */
 		int tail;                                   /* Tail.                 */
 		struct request requests[ATADEV_QUEUE_SIZE]; /* Blocks.               */
-		struct process *chain;                      /* Processes wanting for *
+		struct waitq chain;                         /* Processes wanting for *
 		                                             * a slot in the queue.  */
 	} queue;
 } ata_devices[4];
@@ -352,11 +357,12 @@ PRIVATE int pata_setup(int atadevid)
 		devinfo->flags |= ATADEV_DMA;
 	
 	dev->flags = ATADEV_VALID | ATADEV_DISCARD;
-	dev->queue.chain = NULL;
 	dev->queue.size = 0;
 	dev->queue.head = 0;
 	dev->queue.tail = 0;
-	dev->queue.chain = NULL;
+	waitq_init(&dev->queue.chain);
+	for (int i = 0; i < ATADEV_QUEUE_SIZE; i++)
+		waitq_init(&dev->queue.requests[i].waiter);
 	
 	return (0);
 }
@@ -432,9 +438,9 @@ PRIVATE void ata_read_op(unsigned atadevid, struct request *req)
 	/* Buffered read. */
 	if (req->flags & REQ_BUF)
 	{
-		size = BLOCK_SIZE;
-		addr = buffer_num(req->u.buffered.buf) << 
-			(BLOCK_SIZE_LOG2 - ATA_SECTOR_SIZE_LOG2);
+		size = buffer_size(req->u.buffered.buf);
+		addr = (uint64_t)buffer_num(req->u.buffered.buf)*
+			(size >> ATA_SECTOR_SIZE_LOG2);
 	}
 	
 	/* Raw read. */
@@ -491,9 +497,9 @@ PRIVATE void ata_write_op(unsigned atadevid, struct request *req)
 	if (req->flags & REQ_BUF)
 	{
 		buf = buffer_data(req->u.buffered.buf);
-		size = BLOCK_SIZE;
-		addr = buffer_num(req->u.buffered.buf) << 
-			(BLOCK_SIZE_LOG2 - ATA_SECTOR_SIZE_LOG2);
+		size = buffer_size(req->u.buffered.buf);
+		addr = (uint64_t)buffer_num(req->u.buffered.buf)*
+			(size >> ATA_SECTOR_SIZE_LOG2);
 	}
 	
 	/* Raw I/O write. */
@@ -568,7 +574,7 @@ PRIVATE void ata_sched(unsigned atadevid, unsigned flags, ...)
 	
 		/* Wait for a slot in the block operation queue. */
 		while (dev->queue.size == ATADEV_QUEUE_SIZE)
-			sleep(&dev->queue.chain, PRIO_IO);
+			wq_sleep(&dev->queue.chain, PRIO_IO, WQ_EXCLUSIVE);
 		
 		req = &dev->queue.requests[dev->queue.tail];
 		
@@ -600,6 +606,9 @@ PRIVATE void ata_sched(unsigned atadevid, unsigned flags, ...)
 		dev->queue.tail = (dev->queue.tail + 1)%ATADEV_QUEUE_SIZE;
 		dev->queue.size++;
 		
+		TRACE(TRACE_BIO_ISSUE, atadevid, REQ_NUM(req),
+			(dev->queue.size << 16) | flags);
+		
 		/*
 		 * The queue was empty, therefore,
 		 * we can process this block right now.
@@ -614,7 +623,7 @@ PRIVATE void ata_sched(unsigned atadevid, unsigned flags, ...)
 		
 		/* Wait operation to complete. */
 		if (req->flags & REQ_SYNC)
-			sleep(&dev->chain, PRIO_IO);
+			wq_sleep(&req->waiter, PRIO_IO, WQ_EXCLUSIVE);
 	
 	enable_interrupts();
 }
@@ -846,7 +855,8 @@ PRIVATE const struct bdev ata_ops = {
 	&ata_read,    /* read()     */
 	&ata_write,   /* write()    */
 	&ata_readblk, /* readblk()  */
-	&ata_writeblk /* writeblk() */
+	&ata_writeblk, /* writeblk() */
+	NULL          /* direct()   */
 };
 
 /*
@@ -898,7 +908,7 @@ PRIVATE void ata_handler(int atadevid)
 	if (req->flags & REQ_BUF)
 	{
 		buf = buffer_data(req->u.buffered.buf);
-		size = BLOCK_SIZE;
+		size = buffer_size(req->u.buffered.buf);
 	}
 	
 	/* Raw I/O operation. */
@@ -939,6 +949,11 @@ PRIVATE void ata_handler(int atadevid)
 		}
 	}
 	
+	TRACE(TRACE_BIO_DONE, atadevid, REQ_NUM(req), dev->queue.size);
+	
+	/* Wakeup the process that was waiting for this operation. */
+	wq_wakeup(&req->waiter);
+	
 	/* Process next operation. */
 	if (dev->queue.size > 0)
 	{
@@ -953,12 +968,11 @@ PRIVATE void ata_handler(int atadevid)
 out:
 
 	/*
-	 * Wakeup the process that was waiting for this
-	 * operation and the processes that were waiting
-	 * for an empty slot in the block operation queue.
+	 * A slot in the block operation queue was
+	 * released, so wakeup one process that was
+	 * waiting for it.
 	 */
-	wakeup(&dev->queue.chain);
-	wakeup(&dev->chain);
+	wq_wakeup(&dev->queue.chain);
 }
 
 /*
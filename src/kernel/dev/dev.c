@@ -21,6 +21,8 @@
 
 #include <dev/ata.h>
 #include <dev/klog.h>
+#include <dev/prof.h>
+#include <dev/trace.h>
 #include <dev/tty.h>
 #include <dev/cmos.h>
 #include <dev/ramdisk.h>
@@ -38,7 +40,7 @@
  *============================================================================*/
 
 /* Number of character devices. */
-#define NR_CHRDEV 3
+#define NR_CHRDEV 7
 
 /*
  * Character devices table.
@@ -46,7 +48,11 @@
 PRIVATE const struct cdev *cdevsw[NR_CHRDEV] = {
 	NULL, /* /dev/null */
 	NULL, /* /dev/tty  */
-	NULL  /* /dev/klog */
+	NULL, /* /dev/klog */
+	NULL, /* /dev/prof */
+	NULL, /* /dev/trace */
+	NULL, /* /dev/proc  */
+	NULL  /* /dev/tmp   */
 };
 
 /**
@@ -358,8 +364,9 @@ PUBLIC ssize_t bdev_read(dev_t dev, char *buf, size_t n, off_t off)
  */
 PUBLIC void bdev_writeblk(buffer_t buf)
 {
-	int err;   /* Error ?        */
-	dev_t dev; /* Device number. */
+	int err;     /* Error ?        */
+	dev_t dev;   /* Device number. */
+	block_t num; /* Block number.  */
 	
 	dev = buffer_dev(buf);
 	
@@ -371,9 +378,15 @@ PUBLIC void bdev_writeblk(buffer_t buf)
 	if (bdevsw[MAJOR(dev)]->writeblk == NULL)
 		kpanic("block device cannot write blocks");
 		
+	num = buffer_num(buf);
+	
 	/* Write block. */
 	err = bdevsw[MAJOR(dev)]->writeblk(MINOR(dev), buf);
-	if (err)
+	
+	/* I/O error, the driver has dropped the buffer. */
+	if (err == -EIO)
+		kprintf("dev: I/O error writing block %d", num);
+	else if (err)
 		kpanic("failed to write block to device");
 }
 
@@ -401,6 +414,32 @@ PUBLIC void bdev_readblk(buffer_t buf)
 		kpanic("failed to read block from device");
 }
 
+/**
+ * @brief Maps a block of a block device.
+ *
+ * @details Block devices that live in memory may hand out the address of a
+ *          block, so that the block buffer cache uses it in place instead of
+ *          copying it into a buffer of its own.
+ *
+ * @param dev  Device number.
+ * @param num  Block number, in units of @p size.
+ * @param size Block size (in bytes).
+ *
+ * @returns The address of the block, or NULL if the device cannot map it.
+ */
+PUBLIC void *bdev_direct(dev_t dev, block_t num, size_t size)
+{
+	/* Invalid device. */
+	if (bdevsw[MAJOR(dev)] == NULL)
+		return (NULL);
+
+	/* Operation not supported. */
+	if (bdevsw[MAJOR(dev)]->direct == NULL)
+		return (NULL);
+
+	return (bdevsw[MAJOR(dev)]->direct(MINOR(dev), num, size));
+}
+
 /**
  * @brief Tests if all block devices are correctly registered.
  * 
@@ -495,6 +534,8 @@ PUBLIC void dev_init(void)
 {
 	uart8250_init();
 	klog_init();
+	prof_init();
+	trace_init();
 	cmos_init();
 	clock_init(CLOCK_FREQ);
 	tty_init();
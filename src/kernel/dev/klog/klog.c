@@ -18,190 +18,339 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/klog.h>
+#include <nanvix/clock.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/debug.h>
 #include <nanvix/dev.h>
+#include <nanvix/hal.h>
 #include <nanvix/klib.h>
-#include <nanvix/syscall.h> 
-#include <sys/types.h>  
+#include <stropts.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdint.h>
 
 /* Error checking. */
-#if KLOG_SIZE > KBUFFER_SIZE
-	#error "KLOG_SIZE must be smaller than or equal to KBUFFER_SIZE"
+#if (KLOG_RECORDS & (KLOG_RECORDS - 1))
+	#error "KLOG_RECORDS must be a power of two"
 #endif
+#if (KLOG_SLOT & 3)
+	#error "KLOG_SLOT must be a multiple of four"
+#endif
+
+/**
+ * @brief Compiler barrier.
+ */
+#define barrier() __asm__ __volatile__ ("" ::: "memory")
+
+/**
+ * @brief Return values of klog_get().
+ */
+/**@{*/
+#define KLOG_OK   0 /**< Record copied.               */
+#define KLOG_BUSY 1 /**< Record not yet committed.    */
+#define KLOG_LOST 2 /**< Record has been overwritten. */
+/**@}*/
 
-#define TL_CONST 3 
+/**
+ * @brief Record slot.
+ */
+struct klog_slot
+{
+	struct klog_record hdr;    /**< Header. */
+	char text[KLOG_TEXT_MAX];  /**< Text.   */
+};
 
 /**
  * @brief Kernel log.
+ *
+ * @details Writers reserve slots with fetch_and_add() on the next sequence
+ *          number, so they never wait for each other, not even when called
+ *          from interrupt handlers. A slot is committed by storing its
+ *          sequence number after the text has been written, and readers
+ *          check it again after copying the slot out. Sequence numbers start
+ *          at one, so that zeroed slots are never taken as committed.
  */
 PRIVATE struct
 {
-	int head;               /**< First element in the buffer.  */
-	int tail;               /**< Next free slot in the buffer. */
-	char buffer[KLOG_SIZE]; /**< Ring buffer.                  */
-} klog = { 0, 0, {0, }};
+	volatile unsigned next;                 /**< Next sequence number.      */
+	volatile uint32_t first;                /**< First readable record.     */
+	volatile uint32_t flushed;              /**< First record not flushed.  */
+	volatile unsigned flushoff;             /**< Bytes of it already out.   */
+	volatile int flushing;                  /**< Flush in progress?         */
+	struct klog_slot slots[KLOG_RECORDS];   /**< Ring buffer.               */
+} klog = { 1, 1, 1, 0, 0, {{{0, 0, 0, 0, 0}, {0, }}, }};
 
 /**
- * @brief Add log level code (if present) to buffer and skip it
- * 
- * @param buffer        Buffer to be written in the kernel log.
- * @param n             Pointer on the number of characters to be written in the kernel log. (for updating)
- * @param head, tail    Pointers on buffer head and tail
- * @param char_printed  Number of chaf added to buffer for log_level (0 or 3)
-
- * @returns Buffer with no code, hidden returns with pointers
+ * @brief Gets the oldest sequence number that is still in the ring.
+ *
+ * @param seq Sequence number to start from.
+ *
+ * @returns @p seq, or the oldest record that has not been overwritten, if
+ *          @p seq is no longer in the ring.
  */
-PRIVATE const char *print_code(const char *buffer, int *n, int *head, int *tail, int *char_printed)
+PRIVATE uint32_t klog_oldest(uint32_t seq)
 {
-	int i;
-	char p[3];
-	p[0] = get_code(buffer);
-	p[1] = ':';
-	p[2] = ' ';
-
-	/* log level is default one? */
-	if (p[0] == 0)
-		return buffer;
-
-	/* Copy data to ring buffer */
-	for (i=0;i<3;i++)
-	{
-		klog.buffer[*tail] = p[i];
-		*tail = (*tail + 1)&(KLOG_SIZE - 1);
-		
-		if (*tail == *head)
-			*head = *head + 1;
-	}
+	uint32_t next;
 
-	/* Three characters had been added to buffer for log_level printing. */
-	*char_printed =+ 3;
+	next = klog.next;
 
-	return (skip_code(buffer,n));
+	if ((next - seq) > KLOG_RECORDS)
+		seq = next - KLOG_RECORDS;
+
+	return (seq);
 }
 
-/** 
- * @brief Add clock ticks to klog.buffer 
- *  
- * @param head, tail    Pointers on buffer head and tail 
- * @param char_printed  Number of chaf added to buffer for log_level (0 or (TL_CONST + size of int returned by sys_gticks())) 
- */ 
-PRIVATE void print_ticks(int *head, int *tail, int *char_printed) 
-{ 
-	/* loop variables */ 
-	int i,j; 
-
-	/* temporary buffers */ 
-	char string_ticks[sizeof(int)*8 + 1] = ""; 
-	char string_ticks_const[TL_CONST + 1] = " - "; 
-	char buffer[sizeof(int)*8 + TL_CONST + 1]; 
-
-	/* compute clock ticks */ 
-	int ticks_lenght = itoa(string_ticks,(unsigned)sys_gticks(),'d'); 
-
-	/* put ticks in temporary buffer */ 
-	for(j=0;j<ticks_lenght;j++) 
-		buffer[j] = string_ticks[j]; 
-
-	/* put esthetic in temporary buffer */ 
-	for(i=0;i<TL_CONST;i++) 
-		buffer[i + ticks_lenght] = string_ticks_const[i]; 
-
-	/* Copy data to ring buffer */ 
-	for (i=0;i<(ticks_lenght + TL_CONST);i++) 
-	{ 
-		klog.buffer[*tail] = buffer[i]; 
-		*tail = (*tail + 1)&(KLOG_SIZE - 1); 
-		 
-		if (*tail == *head) 
-			*head = *head + 1; 
-	} 
-
-	/* number of characters added to buffer for ticks printing */ 
-	*char_printed =+ (ticks_lenght + TL_CONST); 
-} 
+/**
+ * @brief Copies a record out of the ring.
+ *
+ * @param seq  Sequence number of the target record.
+ * @param slot Where the record should be copied to.
+ *
+ * @returns KLOG_OK if the record was copied, KLOG_BUSY if it was not
+ *          committed yet and KLOG_LOST if it was overwritten meanwhile.
+ */
+PRIVATE int klog_get(uint32_t seq, struct klog_slot *slot)
+{
+	struct klog_slot *s;
+
+	s = &klog.slots[seq & (KLOG_RECORDS - 1)];
+
+	if (s->hdr.seq != seq)
+		return (((klog.next - seq) > KLOG_RECORDS) ? KLOG_LOST : KLOG_BUSY);
 
+	barrier();
+	kmemcpy(slot, s, sizeof(struct klog_slot));
+	barrier();
+
+	/* Overwritten while copying. */
+	if (s->hdr.seq != seq)
+		return (KLOG_LOST);
+
+	return (KLOG_OK);
+}
 
 /**
  * @brief Writes to kernel log.
- * 
+ *
+ * @param minor  Minor device number.
  * @param buffer Buffer to be written in the kernel log.
  * @param n      Number of characters to be written in the kernel log.
- * 
- * @returns The number of characters actually written to the kernel log.
+ *
+ * @returns The number of characters written to the kernel log.
+ *
+ * @details The message is stamped with the current clock ticks and its log
+ *          level, if any. Nothing is written to the kernel's output device
+ *          here; see klog_flush().
  */
 PUBLIC ssize_t klog_write(unsigned minor, const char *buffer, size_t n)
 {
-	int head;      /* Log head.        */
-	int tail;      /* Log tail.        */
-	const char *p; /* Writing pointer. */
-
-	int lenght = (int) n;
-	int char_printed = 0; /* Useful for returning size */
+	int len;              /* Remaining text.    */
+	char code;            /* Log level code.    */
+	uint32_t seq;         /* Sequence number.   */
+	uint32_t nslots;      /* Slots to fill.     */
+	uint32_t i;           /* Loop index.        */
+	unsigned now;         /* Clock ticks.       */
+	const char *p;        /* Writing pointer.   */
+	struct klog_slot *s;  /* Working slot.      */
 
-	
 	UNUSED(minor);
-	
-	/* Read pointers. */
-	head = klog.head;
-	tail = klog.tail;
 
-	/* If there is a log_level code, add it in buffer and skip it */
-	p = print_code(buffer,&lenght,&head,&tail,&char_printed);
+	len = (int)n;
+	code = get_code(buffer);
+	p = skip_code(buffer, &len);
 
-	  /* if a code had been printed, then clock ticks since initialization are printed too */ 
-     if (char_printed) 
-		print_ticks(&head,&tail,&char_printed); 
-	
-	/* Copy data to ring buffer. */
-	while (lenght-- > 0)
+	nslots = (len > 0) ? (len + KLOG_TEXT_MAX - 1)/KLOG_TEXT_MAX : 1;
+	seq = fetch_and_add(&klog.next, nslots);
+	now = ticks;
+
+	for (i = 0; i < nslots; i++)
 	{
-		klog.buffer[tail] = *p++;
-		
-		tail = (tail + 1)&(KLOG_SIZE - 1);
-		
-		if (tail == head)
-			head++;
+		size_t chunk;
+
+		chunk = ((size_t)len > KLOG_TEXT_MAX) ? KLOG_TEXT_MAX : (size_t)len;
+
+		s = &klog.slots[(seq + i) & (KLOG_RECORDS - 1)];
+
+		/* Invalidate slot. */
+		s->hdr.seq = 0;
+		barrier();
+
+		kmemcpy(s->text, p, chunk);
+		s->hdr.ticks = now;
+		s->hdr.level = (code) ? code - '0' : KLOG_NOLEVEL;
+		s->hdr.flags = (i > 0) ? KLOG_CONT : 0;
+		s->hdr.length = chunk;
+
+		/* Commit slot. */
+		barrier();
+		s->hdr.seq = seq + i;
+
+		p += chunk;
+		len -= chunk;
 	}
-	
-	/* Write back pointers. */
-	klog.head = head;
-	klog.tail = tail;
-	
-	return ((ssize_t)(char_printed + p - buffer));
+
+	return ((ssize_t)n);
+}
+
+/**
+ * @brief Flushes the kernel log to the kernel's output device.
+ *
+ * @details Writes the text of all committed records that have not been
+ *          flushed yet. This should be called where blocking on the output
+ *          device is fine, that is, never from interrupt handlers or with
+ *          interrupts disabled. The idle process may call it too, since the
+ *          output device does not block it, but writes less instead; the
+ *          flush then stops, and the remaining records are left for later,
+ *          starting with the rest of the one that was cut short.
+ *          Records are held back while the kernel's output device is not
+ *          set, so that early messages are not lost.
+ */
+PUBLIC void klog_flush(void)
+{
+	ssize_t ret;            /* Bytes written.   */
+	uint32_t seq;           /* Sequence number. */
+	unsigned off;           /* Bytes flushed.   */
+	struct klog_slot slot;  /* Working slot.    */
+
+	if (MAJOR(kout) == NULL_MAJOR)
+		return;
+
+	/* Someone else is flushing. */
+	if (klog.flushing)
+		return;
+
+	klog.flushing = 1;
+
+	off = klog.flushoff;
+
+	for (seq = klog.flushed; seq != klog.next; seq++, off = 0)
+	{
+		/* Overwritten, along with what was left of it. */
+		if (klog_oldest(seq) != seq)
+		{
+			seq = klog_oldest(seq);
+			off = 0;
+		}
+
+		switch (klog_get(seq, &slot))
+		{
+			case KLOG_OK:
+				ret = cdev_write(kout, slot.text + off, slot.hdr.length - off);
+
+				/* Output device would block. */
+				if (ret < (ssize_t)(slot.hdr.length - off))
+				{
+					if (ret > 0)
+						off += ret;
+					goto out;
+				}
+				break;
+
+			case KLOG_LOST:
+				break;
+
+			case KLOG_BUSY:
+				goto out;
+		}
+	}
+
+out:
+	klog.flushed = seq;
+	klog.flushoff = off;
+	klog.flushing = 0;
 }
 
 /**
  * @brief Reads from kernel log.
- * 
+ *
+ * @param minor  Minor device number.
  * @param buffer Buffer where the kernel log should be read to.
- * @param n      Number of characters to read.
- * 
- * @returns The number of characters actually read from the kernel log. 
+ * @param n      Number of bytes to read.
+ *
+ * @returns The number of bytes actually read from the kernel log.
+ *
+ * @details Records are read from the oldest one in the ring, each one as a
+ *          klog_record header followed by its text, padded to four bytes.
+ *          Only whole records are read.
  */
 PUBLIC ssize_t klog_read(unsigned minor, char *buffer, size_t n)
 {
-	int i;   /* Loop index.      */
-	char *p; /* Reading pointer. */
-	
+	char *p;                /* Reading pointer. */
+	size_t size;            /* Record size.     */
+	uint32_t seq;           /* Sequence number. */
+	struct klog_slot slot;  /* Working slot.    */
+
 	UNUSED(minor);
-	
+
 	p = buffer;
-	
-	i = klog.head;
-	
-	/* Copy data to ring buffer. */
-	while ((n-- > 0) && (i != klog.tail))
+
+	for (seq = klog_oldest(klog.first); seq != klog.next; seq++)
 	{
-		*p++ = klog.buffer[i];
-		
-		i = (i + 1)&(KLOG_SIZE - 1);
+		seq = klog_oldest(seq);
+
+		switch (klog_get(seq, &slot))
+		{
+			case KLOG_OK:
+				size = sizeof(struct klog_record) + ((slot.hdr.length + 3) & ~3);
+
+				if (size > n)
+					goto out;
+
+				kmemcpy(p, &slot, size);
+				p += size;
+				n -= size;
+				break;
+
+			case KLOG_LOST:
+				break;
+
+			case KLOG_BUSY:
+				goto out;
+		}
 	}
-	
+
+out:
 	return ((ssize_t)(p - buffer));
 }
 
+/**
+ * @brief Performs control operation on the kernel log.
+ *
+ * @param minor Minor device number.
+ * @param cmd   Command.
+ * @param arg   Command argument.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure, a
+ *          negative error code is returned instead.
+ */
+PRIVATE int klog_ioctl(unsigned minor, unsigned cmd, unsigned arg)
+{
+	int ret;
+
+	UNUSED(minor);
+	UNUSED(arg);
+
+	ret = 0;
+
+	/* Parse command. */
+	switch (IOCTL_MAJOR(cmd))
+	{
+		/* Discard records. */
+		case IOCTL_MAJOR(KLOG_CLEAR):
+			klog.first = klog.next;
+			break;
+
+		/* Invalid operation. */
+		default:
+			ret = -EINVAL;
+			break;
+	}
+
+	return (ret);
+}
+
 /**
  * @brief Dummy open() operation.
  */
@@ -229,43 +378,53 @@ PRIVATE struct cdev klog_driver = {
 	&klog_open,  /* open()  */
 	&klog_read,  /* read()  */
 	NULL,        /* write() */
-	NULL,        /* ioctl() */
+	&klog_ioctl, /* ioctl() */
 	&klog_close  /* close() */
 };
 
+/**
+ * @brief Buffer for klogtst_wr(), too large for the kernel stack.
+ */
+PRIVATE char klogtst_buffer[KLOG_RECORDS*KLOG_SLOT];
+
 /**
  * @brief Used for debugging
  * @details Tests if klog_write and klog_read works correctly
  * 
- * @param buffer Buffer to be written in the log device.
- * @param tstlog_lenght Number of characters to be written in the log device.
+ * @param msg Message to be written in the log device.
+ * @param len Number of characters to be written in the log device.
  * 
  * @returns Upon successful completion one is returned. Upon failure, a 
  *          zero is returned instead.
  */
-PRIVATE int klogtst_wr(char *buffer, int tstlog_lenght)
+PRIVATE int klogtst_wr(const char *msg, int len)
 {
-	char buffer2[KBUFFER_SIZE];
-	int char_count, char_count2;
+	ssize_t n;
+	char *buffer = klogtst_buffer;
+	struct klog_record *r, *last;
 
-	if ((char_count = klog_write(0, buffer, tstlog_lenght)) != tstlog_lenght)
+	if (klog_write(0, msg, len) != len)
 	{
-		if (char_count <= 0)
-			kprintf(KERN_DEBUG "klog test: klog_write failed: nothing has been written");
-		else
-			kprintf(KERN_DEBUG "klog test: klog_write failed: what has been written is not what it has to be write");
-
+		kprintf(KERN_DEBUG "klog test: klog_write failed");
 		return 0;
 	}
 
-	if ((char_count2 = klog_read(0,buffer2,tstlog_lenght)) != char_count)
+	if ((n = klog_read(0, buffer, sizeof(klogtst_buffer))) <= 0)
 	{
-		if (char_count2 <= 0)
-			kprintf(KERN_DEBUG "klog test: klog_read failed: nothing has been read");
-		else
-			kprintf(KERN_DEBUG "klog test: klog_read failed: what has been read is not what it has to be read");
+		kprintf(KERN_DEBUG "klog test: klog_read failed: nothing has been read");
+		return 0;
+	}
 
-		tst_failed();
+	/* Find last record. */
+	last = NULL;
+	for (r = (struct klog_record *)buffer; (char *)r < buffer + n; r = KLOG_NEXT(r))
+		last = r;
+
+	if ((last->level != 7) || (last->length != len - 2) ||
+		(kstrncmp(KLOG_TEXT(last), msg + 2, len - 2)))
+	{
+		kprintf(KERN_DEBUG "klog test: klog_read failed: what has been read is not what it has to be read");
+		return 0;
 	}
 
 	return 1;
@@ -276,11 +435,9 @@ PRIVATE int klogtst_wr(char *buffer, int tstlog_lenght)
  */
 PUBLIC void test_klog(void)
 {
-	char buffer[KBUFFER_SIZE]; /* Temporary buffer.        */
-	int tstlog_lenght = 35; /* Size of message to write in the log */
-	kstrncpy(buffer, "klog test: test data input in klog\n", tstlog_lenght);
+	const char *msg = KERN_DEBUG "klog test: test data input in klog\n";
 
-	if(!klogtst_wr(buffer, tstlog_lenght))
+	if(!klogtst_wr(msg, kstrlen(msg)))
 	{
 		tst_failed();
 		return;
@@ -0,0 +1,304 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dev/prof.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <stropts.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdint.h>
+
+/* Error checking. */
+#if (PROF_SAMPLES & (PROF_SAMPLES - 1))
+	#error "PROF_SAMPLES must be a power of two"
+#endif
+
+/**
+ * @brief Sampling period (in nanoseconds).
+ */
+#define PROF_PERIOD (NSEC_PER_SEC/PROF_FREQ)
+
+/**
+ * @brief Profiler.
+ *
+ * @details Samples are produced by the clock interrupt handler and consumed
+ *          by prof_read(), so the head is only written by the reader and the
+ *          tail is only written by the interrupt handler. When the ring is
+ *          full, new samples are dropped rather than overwriting old ones.
+ */
+PRIVATE struct
+{
+	volatile int enabled;                   /**< Sampling?                  */
+	volatile unsigned head;                 /**< First sample in the ring.  */
+	volatile unsigned tail;                 /**< Next free slot in the ring. */
+	volatile unsigned lost;                 /**< Dropped samples.           */
+	struct prof_sample buffer[PROF_SAMPLES]; /**< Ring buffer.               */
+} prof = { 0, 0, 0, 0, {{0, 0, 0, {0, }, {0, }}, }};
+
+/**
+ * @brief Walks a kernel call chain.
+ *
+ * @param s     Sample to fill.
+ * @param frame Frame pointer of the interrupted kernel code.
+ */
+PRIVATE void prof_kwalk(struct prof_sample *s, addr_t frame)
+{
+	addr_t lo, hi; /* Kernel stack bounds. */
+
+	lo = (addr_t)curr_proc->kstack;
+	hi = lo + KSTACK_SIZE;
+
+	while (s->depth < PROF_DEPTH)
+	{
+		/* Frame lies outside the kernel stack. */
+		if ((frame < lo) || (frame + 2*sizeof(dword_t) > hi) || (frame & 3))
+			break;
+
+		s->pc[s->depth++] = ((dword_t *)frame)[1];
+
+		/* Frames must grow towards the bottom of the stack. */
+		if (((dword_t *)frame)[0] <= frame)
+			break;
+
+		frame = ((dword_t *)frame)[0];
+	}
+}
+
+/**
+ * @brief Walks a user call chain.
+ *
+ * @param s     Sample to fill.
+ * @param frame Frame pointer of the interrupted user code.
+ *
+ * @details Only frames that are resident in memory are followed, so that
+ *          sampling never faults. Binaries built without frame pointers
+ *          yield truncated chains.
+ */
+PRIVATE void prof_uwalk(struct prof_sample *s, addr_t frame)
+{
+	while (s->depth < PROF_DEPTH)
+	{
+		if (frame & 3)
+			break;
+
+		if (!upgpresent(curr_proc, frame))
+			break;
+
+		if (!upgpresent(curr_proc, frame + sizeof(dword_t)))
+			break;
+
+		s->pc[s->depth++] = ((dword_t *)frame)[1];
+
+		/* Frames must grow towards the bottom of the stack. */
+		if (((dword_t *)frame)[0] <= frame)
+			break;
+
+		frame = ((dword_t *)frame)[0];
+	}
+}
+
+/**
+ * @brief Takes a profiling sample.
+ *
+ * @param pc    Interrupted program counter.
+ * @param frame Interrupted frame pointer.
+ *
+ * @details Records the program counter and the call chain that were
+ *          interrupted by the clock. This function should be called from
+ *          the clock interrupt handler only.
+ */
+PUBLIC void prof_tick(addr_t pc, addr_t frame)
+{
+	unsigned tail;
+	struct prof_sample *s;
+
+	if (!prof.enabled)
+		return;
+
+	tail = prof.tail;
+
+	/* Ring buffer is full. */
+	if (((tail + 1) & (PROF_SAMPLES - 1)) == prof.head)
+	{
+		prof.lost++;
+		return;
+	}
+
+	s = &prof.buffer[tail];
+
+	s->pid = curr_proc->pid;
+	s->flags = 0;
+	s->depth = 0;
+	kstrncpy(s->name, curr_proc->name, PROF_NAME_MAX - 1);
+	s->name[PROF_NAME_MAX - 1] = '\0';
+
+	s->pc[s->depth++] = pc;
+
+	if (KERNEL_WAS_RUNNING(curr_proc))
+	{
+		s->flags |= PROF_KERNEL;
+		prof_kwalk(s, frame);
+	}
+	else
+		prof_uwalk(s, frame);
+
+	prof.tail = (tail + 1) & (PROF_SAMPLES - 1);
+}
+
+/**
+ * @brief Gets the next sampling deadline.
+ *
+ * @param now Current time (in nanoseconds).
+ *
+ * @returns If sampling is enabled, the time at which the next sample should
+ *          be taken is returned. Otherwise, UINT64_MAX is returned.
+ */
+PUBLIC uint64_t prof_next(uint64_t now)
+{
+	return ((prof.enabled) ? now + PROF_PERIOD : UINT64_MAX);
+}
+
+/**
+ * @brief Reads profiling samples.
+ *
+ * @param minor  Minor device number.
+ * @param buffer Buffer where the samples should be read to.
+ * @param n      Number of bytes to read.
+ *
+ * @returns The number of bytes actually read. Only whole samples are read.
+ */
+PRIVATE ssize_t prof_read(unsigned minor, char *buffer, size_t n)
+{
+	unsigned head;
+	struct prof_sample *p;
+
+	UNUSED(minor);
+
+	p = (struct prof_sample *)buffer;
+	head = prof.head;
+
+	while ((n >= sizeof(struct prof_sample)) && (head != prof.tail))
+	{
+		kmemcpy(p++, &prof.buffer[head], sizeof(struct prof_sample));
+		head = (head + 1) & (PROF_SAMPLES - 1);
+		n -= sizeof(struct prof_sample);
+	}
+
+	prof.head = head;
+
+	return ((ssize_t)((char *)p - buffer));
+}
+
+/**
+ * @brief Performs control operation on the profiler.
+ *
+ * @param minor Minor device number.
+ * @param cmd   Command.
+ * @param arg   Command argument.
+ *
+ * @returns Upon successful completion, zero is returned, or the number of
+ *          dropped samples for PROF_LOST. Upon failure, a negative error
+ *          code is returned instead.
+ */
+PRIVATE int prof_ioctl(unsigned minor, unsigned cmd, unsigned arg)
+{
+	int ret;
+
+	UNUSED(minor);
+	UNUSED(arg);
+
+	ret = 0;
+
+	/* Parse command. */
+	switch (IOCTL_MAJOR(cmd))
+	{
+		/* Start sampling. */
+		case IOCTL_MAJOR(PROF_START):
+			prof.enabled = 1;
+			timer_arm(curr_proc);
+			break;
+
+		/* Stop sampling. */
+		case IOCTL_MAJOR(PROF_STOP):
+			prof.enabled = 0;
+			break;
+
+		/* Discard samples. */
+		case IOCTL_MAJOR(PROF_RESET):
+			prof.head = prof.tail;
+			prof.lost = 0;
+			break;
+
+		/* Get number of dropped samples. */
+		case IOCTL_MAJOR(PROF_LOST):
+			ret = (int)prof.lost;
+			break;
+
+		/* Invalid operation. */
+		default:
+			ret = -EINVAL;
+			break;
+	}
+
+	return (ret);
+}
+
+/**
+ * @brief Dummy open() operation.
+ */
+PRIVATE int prof_open(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Dummy close() operation.
+ */
+PRIVATE int prof_close(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Profiler driver.
+ */
+PRIVATE struct cdev prof_driver = {
+	&prof_open,  /* open()  */
+	&prof_read,  /* read()  */
+	NULL,        /* write() */
+	&prof_ioctl, /* ioctl() */
+	&prof_close  /* close() */
+};
+
+/**
+ * @brief Initializes the profiler driver.
+ */
+PUBLIC void prof_init(void)
+{
+	cdev_register(PROF_MAJOR, &prof_driver);
+}
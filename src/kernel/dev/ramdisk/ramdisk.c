@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/ramdisk.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
@@ -28,6 +29,7 @@
 #include <nanvix/mm.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <stdint.h>
 
 /* Maximum RAM disk size. */
 #if INITRD_SIZE > RAMDISK_SIZE
@@ -40,6 +42,40 @@
 
 char ramdisk1 [RAMDISK1_SIZE];
 
+/**
+ * @brief Bytes copied between yields on raw reads and writes.
+ */
+#define RAMDISK_BURST (64*1024)
+
+/**
+ * @brief Number of decompressed chunks kept in the cache.
+ */
+#define RAMDISK_CACHE_SIZE 64
+
+/**
+ * @brief Maximum number of chunks that may be written to.
+ *
+ * @details Written chunks live in pages of the kernel page pool, which is
+ *          far smaller than the disk. Writes that would pin more chunks
+ *          fail with an I/O error.
+ */
+#define RAMDISK_PINNED_MAX 1024
+
+/**
+ * @brief Number of chunks in the largest compressed RAM disk.
+ */
+#define RAMDISK_NR_CHUNKS (RAMDISK_SIZE/RAMDISK_CHUNK_SIZE)
+
+/**
+ * @brief Empty cache slot.
+ */
+#define RAMDISK_NOCHUNK 0xffffffff
+
+/* Chunks should fit in a kernel page. */
+#if (RAMDISK_CHUNK_SIZE != PAGE_SIZE)
+	#error "RAMDISK_CHUNK_SIZE should match PAGE_SIZE"
+#endif
+
 /*
  * RAM disks.
  */
@@ -48,43 +84,209 @@ PRIVATE struct
 	addr_t start; /* Start address.   */
 	addr_t end;   /* End address.     */
 	size_t size;  /* Size (in bytes). */
+	const struct ramdisk_header *z; /* Compressed image. */
 } ramdisks[NR_RAMDISKS];
 
+/**
+ * @brief Decompressed chunks of the compressed RAM disk.
+ *
+ * @details Clean chunks are decompressed into a small FIFO cache when they
+ *          are touched, and dropped when they fall off it. Cache pages are
+ *          reserved at startup, so reads never run out of memory. Chunks
+ *          that were written to cannot be rebuilt from the image, so they
+ *          are pinned in pages of their own instead, up to
+ *          RAMDISK_PINNED_MAX of them.
+ */
+PRIVATE struct
+{
+	char *pages[RAMDISK_NR_CHUNKS];    /**< Decompressed chunks.    */
+	uint8_t pinned[RAMDISK_NR_CHUNKS]; /**< Written to?             */
+	unsigned npinned;                  /**< Number of pinned chunks. */
+	struct
+	{
+		unsigned idx;                  /**< Chunk number.           */
+		char *pg;                      /**< Reserved page.          */
+	} cache[RAMDISK_CACHE_SIZE];       /**< Clean chunks.           */
+	unsigned hand;                     /**< Next slot to reuse.     */
+} chunks;
+
+/**
+ * @brief Decompresses a chunk of the compressed RAM disk.
+ *
+ * @param z   Compressed image.
+ * @param idx Chunk number.
+ * @param pg  Where the chunk should be decompressed to.
+ */
+PRIVATE void ramdisk_inflate(const struct ramdisk_header *z, unsigned idx, char *pg)
+{
+	size_t len;            /* Compressed size.  */
+	const uint32_t *index; /* Chunk index.      */
+	const char *data;      /* Compressed data.  */
+
+	index = (const uint32_t *)(z + 1);
+	data = (const char *)&index[z->nchunks + 1];
+	len = index[idx + 1] - index[idx];
+
+	/* Zero chunk. */
+	if (len == 0)
+		kmemset(pg, 0, RAMDISK_CHUNK_SIZE);
+
+	/* Stored chunk. */
+	else if (len == RAMDISK_CHUNK_SIZE)
+		kmemcpy(pg, &data[index[idx]], RAMDISK_CHUNK_SIZE);
+
+	else if (lz4_decompress(&data[index[idx]], len, pg, RAMDISK_CHUNK_SIZE) != RAMDISK_CHUNK_SIZE)
+		kpanic("ramdisk: corrupted chunk %d", idx);
+}
+
+/**
+ * @brief Gets a chunk of the compressed RAM disk.
+ *
+ * @param z     Compressed image.
+ * @param idx   Chunk number.
+ * @param write Will the chunk be written to?
+ *
+ * @returns A pointer to the decompressed chunk, or NULL if the chunk should
+ *          be pinned but there is no room left for it.
+ */
+PRIVATE char *ramdisk_chunk(const struct ramdisk_header *z, unsigned idx, int write)
+{
+	char *pg; /* Decompressed chunk. */
+
+	/* Written chunks stay resident. */
+	if (chunks.pinned[idx])
+		return (chunks.pages[idx]);
+
+	/* Pin chunk. */
+	if (write)
+	{
+		if (chunks.npinned >= RAMDISK_PINNED_MAX)
+			return (NULL);
+		if ((pg = getkpg(0)) == NULL)
+			return (NULL);
+
+		/* Take chunk out of the cache. */
+		if (chunks.pages[idx] != NULL)
+		{
+			kmemcpy(pg, chunks.pages[idx], RAMDISK_CHUNK_SIZE);
+			for (unsigned i = 0; i < RAMDISK_CACHE_SIZE; i++)
+			{
+				if (chunks.cache[i].idx == idx)
+					chunks.cache[i].idx = RAMDISK_NOCHUNK;
+			}
+		}
+		else
+			ramdisk_inflate(z, idx, pg);
+
+		chunks.pages[idx] = pg;
+		chunks.pinned[idx] = 1;
+		chunks.npinned++;
+
+		return (pg);
+	}
+
+	/* Not decompressed yet. */
+	if ((pg = chunks.pages[idx]) == NULL)
+	{
+		unsigned i = chunks.hand;
+
+		chunks.hand = (chunks.hand + 1)%RAMDISK_CACHE_SIZE;
+
+		/* Drop the oldest clean chunk. */
+		if (chunks.cache[i].idx != RAMDISK_NOCHUNK)
+			chunks.pages[chunks.cache[i].idx] = NULL;
+
+		pg = chunks.cache[i].pg;
+		ramdisk_inflate(z, idx, pg);
+		chunks.pages[idx] = pg;
+		chunks.cache[i].idx = idx;
+	}
+
+	return (pg);
+}
+
+/**
+ * @brief Copies data to or from a RAM disk.
+ *
+ * @param minor Minor device number.
+ * @param buf   Buffer.
+ * @param n     Number of bytes to copy.
+ * @param off   Offset in the RAM disk.
+ * @param write Copy to the RAM disk?
+ *
+ * @returns Zero upon success, and -EIO if a chunk could not be pinned.
+ */
+PRIVATE int ramdisk_copy(unsigned minor, char *buf, size_t n, off_t off, int write)
+{
+	char *pg;      /* Decompressed chunk. */
+	size_t chunk;  /* Bytes in the chunk. */
+	size_t pgoff;  /* Offset in the chunk. */
+
+	/* Plain RAM disk. */
+	if (ramdisks[minor].z == NULL)
+	{
+		if (write)
+			kmemcpy((void *)(ramdisks[minor].start + off), buf, n);
+		else
+			kmemcpy(buf, (void *)(ramdisks[minor].start + off), n);
+
+		return (0);
+	}
+
+	while (n > 0)
+	{
+		pg = ramdisk_chunk(ramdisks[minor].z, off/RAMDISK_CHUNK_SIZE, write);
+		if (pg == NULL)
+			return (-EIO);
+
+		pgoff = off%RAMDISK_CHUNK_SIZE;
+		chunk = KMIN(n, RAMDISK_CHUNK_SIZE - pgoff);
+
+		if (write)
+			kmemcpy(&pg[pgoff], buf, chunk);
+		else
+			kmemcpy(buf, &pg[pgoff], chunk);
+
+		buf += chunk;
+		off += chunk;
+		n -= chunk;
+	}
+
+	return (0);
+}
+
 /*
  * Writes to a RAM disk device.
  */
 PRIVATE ssize_t ramdisk_write(unsigned minor, const char *buf, size_t n, off_t off)
 {
 	size_t i;     /* Loop index.       */
-	addr_t ptr;   /* Write pointer.    */
 	size_t count; /* # bytes to write. */
 	
 	/* Invalid device. */
 	if (minor >= NR_RAMDISKS)
 		return (-EINVAL);
 	
-	ptr = ramdisks[minor].start + off;
-	
 	/* Invalid offset. */
-	if (ptr >= ramdisks[minor].end)
+	if ((off < 0) || ((size_t)off >= ramdisks[minor].size))
 		return (-EINVAL);
 	
-	/* Read as much as possible. */
-	if (ptr + n >= ramdisks[minor].end)
-		n = ramdisks[minor].end - ptr;
+	/* Write as much as possible. */
+	if (n > ramdisks[minor].size - off)
+		n = ramdisks[minor].size - off;
 	
 	/* Write in bursts. */
 	for (i = 0; i < n; /* noop */)
 	{
-		count = ((n - i) > BLOCK_SIZE) ? BLOCK_SIZE : (n - i);
+		count = ((n - i) > RAMDISK_BURST) ? RAMDISK_BURST : (n - i);
 		
-		kmemcpy((void *)ptr, buf, count);
+		if (ramdisk_copy(minor, (char *)&buf[i], count, off + i, 1))
+			return ((i > 0) ? (ssize_t)i : -EIO);
 		
 		i += count;
-		ptr += count;
 		
 		/* Avoid starvation. */
-		if (n > 0)
+		if (i < n)
 			yield();
 	}
 	
@@ -97,35 +299,32 @@ PRIVATE ssize_t ramdisk_write(unsigned minor, const char *buf, size_t n, off_t o
 PRIVATE ssize_t ramdisk_read(unsigned minor, char *buf, size_t n, off_t off)
 {
 	size_t i;     /* Loop index.      */
-	addr_t ptr;   /* Write pointer.   */
 	size_t count; /* # bytes to read. */
 	
 	/* Invalid device. */
 	if (minor >= NR_RAMDISKS)
 		return (-EINVAL);
 	
-	ptr = ramdisks[minor].start + off;
-	
 	/* Invalid offset. */
-	if (ptr >= ramdisks[minor].end)
+	if ((off < 0) || ((size_t)off >= ramdisks[minor].size))
 		return (-EINVAL);
 	
 	/* Read as much as possible. */
-	if (ptr + n >= ramdisks[minor].end)
-		n = ramdisks[minor].end - ptr;
+	if (n > ramdisks[minor].size - off)
+		n = ramdisks[minor].size - off;
 	
 	/* Read in bursts. */
 	for (i = 0; i < n; /* noop */)
 	{
-		count = ((n - i) > BLOCK_SIZE) ? BLOCK_SIZE : (n - i);
+		count = ((n - i) > RAMDISK_BURST) ? RAMDISK_BURST : (n - i);
 		
-		kmemcpy(buf, (void *)ptr, count);
+		if (ramdisk_copy(minor, &buf[i], count, off + i, 0))
+			return ((i > 0) ? (ssize_t)i : -EIO);
 		
 		i += count;
-		ptr += count;
 		
 		/* Avoid starvation. */
-		if (n > 0)
+		if (i < n)
 			yield();
 	}
 	
@@ -137,13 +336,11 @@ PRIVATE ssize_t ramdisk_read(unsigned minor, char *buf, size_t n, off_t off)
  */
 PRIVATE int ramdisk_readblk(unsigned minor, buffer_t buf)
 {	
-	addr_t ptr;
-	
-	ptr = ramdisks[minor].start + (buffer_num(buf) << BLOCK_SIZE_LOG2);
+	off_t off;
 	
-	kmemcpy(buffer_data(buf), (void *)ptr, BLOCK_SIZE);
+	off = buffer_num(buf)*buffer_size(buf);
 	
-	return (0);
+	return (ramdisk_copy(minor, buffer_data(buf), buffer_size(buf), off, 0));
 }
 
 /*
@@ -151,16 +348,46 @@ PRIVATE int ramdisk_readblk(unsigned minor, buffer_t buf)
  */
 PRIVATE int ramdisk_writeblk(unsigned minor, buffer_t buf)
 {	
-	addr_t ptr;
+	int err;
+	off_t off;
 	
-	ptr = ramdisks[minor].start + (buffer_num(buf) << BLOCK_SIZE_LOG2);
+	off = buffer_num(buf)*buffer_size(buf);
 	
-	kmemcpy((void *)ptr, buffer_data(buf), BLOCK_SIZE);
+	err = ramdisk_copy(minor, buffer_data(buf), buffer_size(buf), off, 1);
 	
+	/* The block is lost if it could not be written. */
 	buffer_dirty(buf, 0);
 	brelse(buf);
 	
-	return (0);
+	return (err);
+}
+
+/*
+ * Maps a block of a RAM disk device.
+ */
+PRIVATE void *ramdisk_direct(unsigned minor, block_t num, size_t size)
+{
+	addr_t ptr;
+
+	/* Invalid device. */
+	if (minor >= NR_RAMDISKS)
+		return (NULL);
+
+	/*
+	 * Chunks of a compressed RAM disk may be
+	 * dropped, so they cannot be mapped. Direct
+	 * access is therefore off for such a disk.
+	 */
+	if (ramdisks[minor].z != NULL)
+		return (NULL);
+
+	ptr = ramdisks[minor].start + num*size;
+
+	/* Invalid block. */
+	if (ptr + size > ramdisks[minor].end)
+		return (NULL);
+
+	return ((void *)ptr);
 }
 
 /*
@@ -170,7 +397,8 @@ PRIVATE const struct bdev ramdisk_driver = {
 	&ramdisk_read,     /* read()     */
 	&ramdisk_write,    /* write()    */
 	&ramdisk_readblk,  /* readblk()  */
-	&ramdisk_writeblk  /* writeblk() */
+	&ramdisk_writeblk, /* writeblk() */
+	&ramdisk_direct    /* direct()   */
 };
 
 /**
@@ -259,14 +487,40 @@ PUBLIC void ramdisk_init(void)
 	
 	kprintf("dev: initializing ramdisk device driver");
 
-	/* ramdisk[0] = INITRD. */
+	/* ramdisk[0] = INITRD, plain images up to INITRD_SIZE. */
 	ramdisks[0].start = INITRD_VIRT;
 	ramdisks[0].end = INITRD_VIRT + INITRD_SIZE;
 	ramdisks[0].size = INITRD_SIZE;
+	ramdisks[0].z = NULL;
 
 	ramdisks[1].start = (addr_t) ramdisk1;
 	ramdisks[1].end = ((addr_t) ramdisk1)+RAMDISK1_SIZE;
 	ramdisks[1].size = RAMDISK1_SIZE;
+	ramdisks[1].z = NULL;
+
+	/* Compressed INITRD. */
+	if (((struct ramdisk_header *)INITRD_VIRT)->magic == RAMDISK_MAGIC)
+	{
+		const struct ramdisk_header *z = (struct ramdisk_header *)INITRD_VIRT;
+
+		if ((z->chunk_size != RAMDISK_CHUNK_SIZE) ||
+			(z->nchunks > RAMDISK_NR_CHUNKS) ||
+			(z->size != z->nchunks*RAMDISK_CHUNK_SIZE))
+			kpanic("ramdisk: bad compressed image");
+
+		ramdisks[0].z = z;
+		ramdisks[0].size = z->size;
+
+		/* Reserve cache pages. */
+		for (unsigned i = 0; i < RAMDISK_CACHE_SIZE; i++)
+		{
+			chunks.cache[i].idx = RAMDISK_NOCHUNK;
+			if ((chunks.cache[i].pg = getkpg(0)) == NULL)
+				kpanic("ramdisk: cannot reserve chunk cache");
+		}
+
+		kprintf("dev: compressed initrd, %d chunks", z->nchunks);
+	}
 
 	
 	err = bdev_register(RAMDISK_MAJOR, &ramdisk_driver);
@@ -0,0 +1,279 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dev/trace.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <stropts.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef TRACE_ENABLE
+
+/* Error checking. */
+#if (TRACE_EVENTS & (TRACE_EVENTS - 1))
+	#error "TRACE_EVENTS must be a power of two"
+#endif
+
+/**
+ * @brief Compiler barrier.
+ */
+#define barrier() __asm__ __volatile__ ("" ::: "memory")
+
+/**
+ * @brief Tracing enabled?
+ */
+PUBLIC volatile int trace_enabled = 0;
+
+/**
+ * @brief Trace buffer.
+ *
+ * @details Events are produced anywhere in the kernel, interrupt handlers
+ *          included, so writers reserve slots with fetch_and_add() and
+ *          commit them by storing the sequence number last. When the ring
+ *          is full, the oldest events are overwritten, so that the buffer
+ *          always holds the most recent history. Sequence numbers start at
+ *          one, so that zeroed slots are never taken as committed.
+ */
+PRIVATE struct
+{
+	volatile unsigned next;                   /**< Next sequence number. */
+	volatile unsigned head;                   /**< Next event to read.   */
+	volatile unsigned lost;                   /**< Overwritten events.   */
+	struct trace_event buffer[TRACE_EVENTS];  /**< Ring buffer.          */
+} tracebuf = { 1, 1, 0, {{0, 0, 0, 0, {0, }}, }};
+
+/**
+ * @brief Records a trace event.
+ *
+ * @param type Event type.
+ * @param a0   First argument.
+ * @param a1   Second argument.
+ * @param a2   Third argument.
+ *
+ * @details Use the TRACE() macro instead, which skips the call while
+ *          tracing is stopped.
+ */
+PUBLIC void trace(unsigned type, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+	unsigned seq;
+	struct trace_event *e;
+
+	seq = fetch_and_add(&tracebuf.next, 1);
+	e = &tracebuf.buffer[seq & (TRACE_EVENTS - 1)];
+
+	/* Invalidate slot. */
+	e->seq = 0;
+	barrier();
+
+	e->ts = clock_ns();
+	e->type = type;
+	e->pid = (curr_proc != NULL) ? curr_proc->pid : -1;
+	e->arg[0] = a0;
+	e->arg[1] = a1;
+	e->arg[2] = a2;
+
+	/* Commit slot. */
+	barrier();
+	e->seq = seq;
+}
+
+/**
+ * @brief Traces a system call entry.
+ *
+ * @param nr System call number.
+ */
+PUBLIC void trace_sysenter(unsigned nr)
+{
+	TRACE(TRACE_SYSENTER, nr, 0, 0);
+}
+
+/**
+ * @brief Traces a system call exit.
+ *
+ * @param ret Return value of the system call.
+ */
+PUBLIC void trace_sysexit(int ret)
+{
+	TRACE(TRACE_SYSEXIT, ret, 0, 0);
+}
+
+/**
+ * @brief Reads trace events.
+ *
+ * @param minor  Minor device number.
+ * @param buffer Buffer where the events should be read to.
+ * @param n      Number of bytes to read.
+ *
+ * @returns The number of bytes actually read. Only whole events are read.
+ */
+PRIVATE ssize_t trace_read(unsigned minor, char *buffer, size_t n)
+{
+	unsigned seq;          /* Sequence number.  */
+	unsigned next;         /* Next event.       */
+	struct trace_event *e; /* Working event.    */
+	struct trace_event *p; /* Writing pointer.  */
+
+	UNUSED(minor);
+
+	p = (struct trace_event *)buffer;
+
+	for (seq = tracebuf.head; n >= sizeof(struct trace_event); seq++)
+	{
+		next = tracebuf.next;
+
+		/* Skip overwritten events. */
+		if ((next - seq) > TRACE_EVENTS)
+		{
+			tracebuf.lost += (next - TRACE_EVENTS) - seq;
+			seq = next - TRACE_EVENTS;
+		}
+
+		if (seq == next)
+			break;
+
+		e = &tracebuf.buffer[seq & (TRACE_EVENTS - 1)];
+
+		/* Not committed yet. */
+		if (e->seq != seq)
+			break;
+
+		barrier();
+		kmemcpy(p, e, sizeof(struct trace_event));
+		barrier();
+
+		/* Overwritten while copying. */
+		if (e->seq != seq)
+		{
+			tracebuf.lost++;
+			continue;
+		}
+
+		p++;
+		n -= sizeof(struct trace_event);
+	}
+
+	tracebuf.head = seq;
+
+	return ((ssize_t)((char *)p - buffer));
+}
+
+/**
+ * @brief Performs control operation on the tracer.
+ *
+ * @param minor Minor device number.
+ * @param cmd   Command.
+ * @param arg   Command argument.
+ *
+ * @returns Upon successful completion, zero is returned, or the number of
+ *          dropped events for TRACE_LOST. Upon failure, a negative error
+ *          code is returned instead.
+ */
+PRIVATE int trace_ioctl(unsigned minor, unsigned cmd, unsigned arg)
+{
+	int ret;
+
+	UNUSED(minor);
+	UNUSED(arg);
+
+	ret = 0;
+
+	/* Parse command. */
+	switch (IOCTL_MAJOR(cmd))
+	{
+		/* Start tracing. */
+		case IOCTL_MAJOR(TRACE_START):
+			trace_enabled = 1;
+			break;
+
+		/* Stop tracing. */
+		case IOCTL_MAJOR(TRACE_STOP):
+			trace_enabled = 0;
+			break;
+
+		/* Discard events. */
+		case IOCTL_MAJOR(TRACE_RESET):
+			tracebuf.head = tracebuf.next;
+			tracebuf.lost = 0;
+			break;
+
+		/* Get number of dropped events. */
+		case IOCTL_MAJOR(TRACE_LOST):
+			ret = (int)tracebuf.lost;
+			break;
+
+		/* Invalid operation. */
+		default:
+			ret = -EINVAL;
+			break;
+	}
+
+	return (ret);
+}
+
+/**
+ * @brief Dummy open() operation.
+ */
+PRIVATE int trace_open(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Dummy close() operation.
+ */
+PRIVATE int trace_close(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Tracer driver.
+ */
+PRIVATE struct cdev trace_driver = {
+	&trace_open,  /* open()  */
+	&trace_read,  /* read()  */
+	NULL,         /* write() */
+	&trace_ioctl, /* ioctl() */
+	&trace_close  /* close() */
+};
+
+#endif /* TRACE_ENABLE */
+
+/**
+ * @brief Initializes the tracer driver.
+ *
+ * @details The tracer device is only available in kernels built with
+ *          TRACE_ENABLE.
+ */
+PUBLIC void trace_init(void)
+{
+#ifdef TRACE_ENABLE
+	cdev_register(TRACE_MAJOR, &trace_driver);
+#endif
+}
@@ -20,6 +20,7 @@
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/hal.h>
+#include <nanvix/klib.h>
 #include <dev/8250.h>
 #include <sys/types.h>
 #include <stdint.h>
@@ -27,7 +28,9 @@
 
 /* Forward definitions. */
 static void console_set_color(uint16_t color);
-static void cursor_move(void);
+static void console_putc(uint8_t ch);
+static void console_erase(int mode);
+static void console_update(void);
 static void cursor_disable(void);
 static void cursor_enable(void);
 static void ansi_reset_buffer(void);
@@ -36,6 +39,7 @@ static void ansi_reset_buffer(void);
 #define VIDEO_ADDR  0xb8000 /* Video memory address. */
 #define VIDEO_WIDTH      80 /* Video width.          */
 #define VIDEO_HIGH       25 /* Video high.           */
+#define VIDEO_LINES     200 /* Lines in video memory. */
 
 /* Video registers. */
 #define VIDEO_CRTL_REG 0x3d4 /* Video control register. */
@@ -201,6 +205,62 @@ PRIVATE struct
 /* Video memory.*/
 PRIVATE uint16_t *video = (uint16_t*)VIDEO_ADDR;
 
+/*
+ * Video window.
+ *
+ * The screen is a view of VIDEO_HIGH lines over a window of VIDEO_LINES
+ * lines of video memory, starting at line origin. Scrolling moves the CRTC
+ * start address down the window, and lines are only copied when the
+ * screen wraps around the bottom of the window. CRTC registers are only
+ * written when a batch of output is done.
+ */
+PRIVATE struct
+{
+	int origin;       /* First line on screen.       */
+	word_t start;     /* Start address in the CRTC.  */
+	word_t location;  /* Cursor location in the CRTC. */
+} window = { 0, 0, 0 };
+
+/* Screen cell. */
+#define CELL(x, y) (&video[(window.origin + (y))*VIDEO_WIDTH + (x)])
+
+/* Blank cell. */
+#define BLANK ((cstate.bg_color << 8) | (' '))
+
+/*============================================================================*
+ *							     Video Functions                              *
+ *============================================================================*/
+
+/**
+ * @brief Fills video cells.
+ *
+ * @param p   First cell.
+ * @param val Cell value.
+ * @param n   Number of cells.
+ */
+PRIVATE void video_fill(uint16_t *p, uint16_t val, size_t n)
+{
+	uint32_t *q;
+	uint32_t val2;
+
+	/* Align to 4 bytes. */
+	if ((n > 0) && (!ALIGNED(p, sizeof(uint32_t))))
+	{
+		*p++ = val;
+		n--;
+	}
+
+	/* Fill two cells at a time. */
+	q = (uint32_t *)p;
+	val2 = ((uint32_t)val << 16) | val;
+	for (/* noop */; n >= 2; n -= 2)
+		*q++ = val2;
+
+	/* Fill last cell. */
+	if (n > 0)
+		*((uint16_t *)q) = val;
+}
+
 /*============================================================================*
  *							   ANSI Family Functions                          *
  *============================================================================*/
@@ -224,7 +284,6 @@ PRIVATE void ansi_cuu(void)
 	else
 		cursor.y = 0;
 
-	cursor_move();
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
 }
@@ -243,12 +302,11 @@ PRIVATE void ansi_cud(void)
 		times = 1;
 
 	/* Tries to move downward. */
-	if (cursor.y + times >= VIDEO_HIGH-1)
+	if (cursor.y + times < VIDEO_HIGH-1)
 		cursor.y += times;
 	else
 		cursor.y = VIDEO_HIGH-1;
 
-	cursor_move();
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
 }
@@ -267,12 +325,11 @@ PRIVATE void ansi_cuf(void)
 		times = 1;
 
 	/* Tries to move forward. */
-	if (cursor.x + times >= VIDEO_WIDTH-1)
+	if (cursor.x + times < VIDEO_WIDTH-1)
 		cursor.x += times;
 	else
 		cursor.x = VIDEO_WIDTH-1;
 
-	cursor_move();
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
 }
@@ -296,7 +353,6 @@ PRIVATE void ansi_cub(void)
 	else
 		cursor.x = 0;
 
-	cursor_move();
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
 }
@@ -323,7 +379,6 @@ PRIVATE void ansi_cup(void)
 
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
-	cursor_move();
 }
 
 /**
@@ -331,7 +386,7 @@ PRIVATE void ansi_cup(void)
  */
 PRIVATE inline void ansi_ed(void)
 {
-	console_clear(ansi_buff.nparam[0]);
+	console_erase(ansi_buff.nparam[0]);
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
 }
@@ -341,8 +396,6 @@ PRIVATE inline void ansi_ed(void)
  */
 PRIVATE void ansi_el(void)
 {
-	uint16_t *pstart;  /* Start pointer.        */
-	uint16_t *pend;    /* End pointer.          */
 	int xstart, xend;  /* Start and end x-axis. */
 	int op;            /* Operation.            */
 
@@ -369,14 +422,8 @@ PRIVATE void ansi_el(void)
 		xend = VIDEO_WIDTH;
 	}
 
-	pstart = &video[cursor.y*VIDEO_WIDTH+xstart];
-	pend   = &video[cursor.y*VIDEO_WIDTH+xend];
-
-	while (pstart < pend)
-	{
-		*pstart = (cstate.bg_color << 8) | (' ');
-		pstart++;
-	}
+	if (xend > xstart)
+		video_fill(CELL(xstart, cursor.y), BLANK, xend - xstart);
 
 	cstate.state = STATE_NONE;
 	ansi_reset_buffer();
@@ -459,7 +506,7 @@ PRIVATE void ansi_parse(uint8_t ch)
 			if (ch == ANSI_ESCAPE)
 				cstate.state = STATE_ESCAPE;
 			else
-				console_put(ch, WHITE);
+				console_putc(ch);
 
 			break;
 		}
@@ -474,8 +521,8 @@ PRIVATE void ansi_parse(uint8_t ch)
 			else
 			{
 				ansi_reset_state();
-				console_put(ANSI_ESCAPE, WHITE);
-				console_put(ch, WHITE);
+				console_putc(ANSI_ESCAPE);
+				console_putc(ch);
 			}
 			break;
 		}
@@ -653,16 +700,37 @@ PRIVATE void ansi_parse(uint8_t ch)
  *============================================================================*/
 
 /**
- * Moves the hardware console cursor.
+ * Moves the hardware console cursor and screen start address.
+ *
+ * Registers are only written if they have changed since the last update.
  */
-PRIVATE void cursor_move(void)
+PRIVATE void console_update(void)
 {
-	word_t cursor_location = cursor.y*VIDEO_WIDTH + cursor.x;
+	word_t start;
+	word_t location;
+
+	start = window.origin*VIDEO_WIDTH;
+	location = start + cursor.y*VIDEO_WIDTH + cursor.x;
+
+	/* Scroll screen. */
+	if (start != window.start)
+	{
+		outputb(VIDEO_CRTL_REG, VIDEO_SAH);
+		outputb(VIDEO_DATA_REG, (byte_t) ((start >> 8) & 0xFF));
+		outputb(VIDEO_CRTL_REG, VIDEO_SAL);
+		outputb(VIDEO_DATA_REG, (byte_t) (start & 0xFF));
+		window.start = start;
+	}
 
-	outputb(VIDEO_CRTL_REG, VIDEO_CLH);
-	outputb(VIDEO_DATA_REG, (byte_t) ((cursor_location >> 8) & 0xFF));
-	outputb(VIDEO_CRTL_REG, VIDEO_CLL);
-	outputb(VIDEO_DATA_REG, (byte_t) (cursor_location & 0xFF));
+	/* Move cursor. */
+	if (location != window.location)
+	{
+		outputb(VIDEO_CRTL_REG, VIDEO_CLH);
+		outputb(VIDEO_DATA_REG, (byte_t) ((location >> 8) & 0xFF));
+		outputb(VIDEO_CRTL_REG, VIDEO_CLL);
+		outputb(VIDEO_DATA_REG, (byte_t) (location & 0xFF));
+		window.location = location;
+	}
 }
 
 /**
@@ -762,26 +830,29 @@ PRIVATE void console_set_color(uint16_t color)
  */
 PRIVATE void console_scrolldown(void)
 {
-	uint16_t *p;
+	/* Move down the window. */
+	if (window.origin + VIDEO_HIGH < VIDEO_LINES)
+		window.origin++;
 
-	/* Pull lines up. */
-	for (p = video; p < (video + (VIDEO_HIGH-1)*(VIDEO_WIDTH)); p++)
-		*p = *(p + VIDEO_WIDTH);
+	/* Wrap around, pulling lines up to the top of the window. */
+	else
+	{
+		kmemcpy(video, CELL(0, 1), (VIDEO_HIGH - 1)*VIDEO_WIDTH*sizeof(uint16_t));
+		window.origin = 0;
+	}
 
 	/* Blank last line. */
-	for (; p < video + VIDEO_HIGH*VIDEO_WIDTH; p++)
-		*p = (BLACK << 8) | (' ');
+	video_fill(CELL(0, VIDEO_HIGH - 1), (BLACK << 8) | (' '), VIDEO_WIDTH);
 
 	/* Set cursor position. */
 	cursor.x = 0; cursor.y = VIDEO_HIGH - 1;
 }
 
 /*
- * Outputs a colored ASCII character on the console device.
+ * Renders an ASCII character on the console device.
  */
-PUBLIC void console_put(uint8_t ch, uint8_t color)
+PRIVATE void console_putc(uint8_t ch)
 {
-	((void)color);
 	((void)console_scrolldown);
 
 #ifdef VGA_ENABLE
@@ -814,12 +885,12 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
 				cursor.x = VIDEO_WIDTH - 1;
 				cursor.y--;
 			}
-			video[cursor.y*VIDEO_WIDTH +cursor.x] = cstate.color | (' ');
+			*CELL(cursor.x, cursor.y) = cstate.color | (' ');
 			break;
 
 		/* Any other. */
 		default:
-			video[cursor.y*VIDEO_WIDTH +cursor.x] = cstate.color | (ch);
+			*CELL(cursor.x, cursor.y) = cstate.color | (ch);
 			cursor.x++;
 			break;
 	}
@@ -832,7 +903,6 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
 	}
 	if (cursor.y >= VIDEO_HIGH)
 		console_scrolldown();
-	cursor_move();
 #endif
 
 #ifdef SERIAL_ENABLE
@@ -842,55 +912,67 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
 }
 
 /*
- * Clears the console accordingly with the mode @p mode.
+ * Outputs a colored ASCII character on the console device.
+ */
+PUBLIC void console_put(uint8_t ch, uint8_t color)
+{
+	((void)color);
+
+	console_putc(ch);
+	console_update();
+}
+
+/*
+ * Erases the console accordingly with the mode @p mode.
  *
- * @mode Clear mode: 0: above cursor, 1: below cursor, 2: all.
+ * @mode Clear mode: 0: below cursor, 1: above cursor, 2: all, 3: all and
+ *       reset cursor.
  */
-PUBLIC void console_clear(int mode)
+PRIVATE void console_erase(int mode)
 {
-	uint16_t *pstart;
-	uint16_t *pend;
+	int ystart, yend; /* Start and end y-axis. */
 
 	/* Lines below cursor. */
 	if (mode == 0)
 	{
-		pstart = &video[(cursor.y+1)*VIDEO_WIDTH+0];
-		pend   = &video[VIDEO_HIGH*VIDEO_WIDTH+VIDEO_WIDTH];
+		ystart = cursor.y + 1;
+		yend = VIDEO_HIGH;
 	}
 
 	/* Lines above cursor. */
 	else if (mode == 1)
 	{
-		pstart = &video[0];
-		pend   = &video[(cursor.y-1)*VIDEO_WIDTH+VIDEO_WIDTH];
-	}
-
-	/* Blank all lines. */
-	else if (mode == 2)
-	{
-		pstart = &video[0];
-		pend   = &video[VIDEO_HIGH*VIDEO_WIDTH+VIDEO_WIDTH];
+		ystart = 0;
+		yend = cursor.y;
 	}
 
 	/*
-	 * Especial mode: Blank all lines but also resetting the cursor.
-	 * This is not ANSI and only used inside the Nanvix internals.
+	 * Blank all lines. Mode 3 is not ANSI and only
+	 * used inside the Nanvix internals: it also
+	 * resets the cursor.
 	 */
-	else if (mode == 3)
+	else
 	{
-		pstart = &video[0];
-		pend   = &video[VIDEO_HIGH*VIDEO_WIDTH+VIDEO_WIDTH];
+		ystart = 0;
+		yend = VIDEO_HIGH;
 
-		/* Set console cursor position. */
-		cursor.x = cursor.y = 0;
-		cursor_move();
+		if (mode == 3)
+			cursor.x = cursor.y = 0;
 	}
 
-	while (pstart < pend)
-	{
-		*pstart = (cstate.bg_color << 8) | (' ');
-		pstart++;
-	}
+	if (yend > ystart)
+		video_fill(CELL(0, ystart), BLANK, (yend - ystart)*VIDEO_WIDTH);
+}
+
+/*
+ * Clears the console accordingly with the mode @p mode.
+ *
+ * @mode Clear mode: 0: below cursor, 1: above cursor, 2: all.
+ */
+PUBLIC void console_clear(int mode)
+{
+	console_erase(mode);
+	console_update();
 }
 
 /*
@@ -907,6 +989,9 @@ PUBLIC void console_write(struct kbuffer *buffer)
 
 		ansi_parse(ch);
 	}
+
+	/* Move cursor once per batch. */
+	console_update();
 }
 
 /*
@@ -920,6 +1005,10 @@ PUBLIC void console_init(void)
 	outputb(VIDEO_CRTL_REG, VIDEO_CE);
 	outputb(VIDEO_DATA_REG, 0x1f);
 
+	/* Registers are unknown, force an update. */
+	window.origin = 0;
+	window.start = window.location = 0xffff;
+
 	/* Clear the console. */
 	console_clear(3);
 
@@ -308,6 +308,13 @@ PRIVATE ssize_t tty_write(unsigned minor, const char *buf, size_t n)
 	/* Write n characters. */
 	while (n > 0)
 	{
+		/*
+		 * The idle process must never sleep,
+		 * so it gives up on a full buffer.
+		 */
+		if ((curr_proc == IDLE) && (KBUFFER_FULL(tty.output)))
+			break;
+
 		/*
 		 * Wait for free slots
 		 * in the output buffer.
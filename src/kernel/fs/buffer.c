@@ -24,6 +24,7 @@
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <errno.h>
 #include "fs.h"
 
 /*
@@ -47,6 +48,15 @@
 	#error "hard disk too small"
 #endif
 
+/*
+ * Same for page-sized buffers, which may hold the
+ * inode and zone maps of a file system that has
+ * page-sized blocks.
+ */
+#if (IMAP_SIZE + ZMAP_SIZE > NR_PAGE_BUFFERS/4)
+	#error "too few page-sized buffers"
+#endif
+
 /**
  * @brief Hash table size of the block buffer cache.
  */
@@ -65,7 +75,9 @@ enum buffer_flags
 	BUFFER_DIRTY  = (1 << 0), /**< Dirty?             */
 	BUFFER_VALID  = (1 << 1), /**< Valid?             */
 	BUFFER_LOCKED = (1 << 2), /**< Locked?            */
-	BUFFER_SYNC   = (1 << 3)  /**< Synchronous write? */
+	BUFFER_SYNC   = (1 << 3), /**< Synchronous write? */
+	BUFFER_DAX    = (1 << 4), /**< Direct access?     */
+	BUFFER_PAGE   = (1 << 5)  /**< Page-sized?        */
 };
 
 /**
@@ -80,6 +92,7 @@ struct buffer
 	dev_t dev;      /**< Device.          */
 	block_t num;    /**< Block number.    */
 	void *data;     /**< Underlying data. */
+	size_t size;    /**< Block size.      */
 	unsigned count; /**< Reference count. */
 	/**@}*/
 	
@@ -88,7 +101,7 @@ struct buffer
 	 */
 	/**@{*/
 	enum buffer_flags flags; /**< Flags.          */
-	struct process *chain;   /**< Sleeping chain. */
+	struct waitq chain;      /**< Wait queue.     */
 	/**@}*/
 	
 	/**
@@ -109,24 +122,85 @@ struct buffer
  */
 PRIVATE struct buffer buffers[NR_BUFFERS];
 
+/**
+ * @brief Direct-access block buffers.
+ *
+ * @details Direct-access buffers have no data of their own. They are used
+ *          for blocks of devices that live in memory, and point straight at
+ *          the block in the device, so reading such a block copies nothing
+ *          and writes land in the device right away.
+ */
+PRIVATE struct buffer dax_buffers[NR_DAX_BUFFERS];
+
+/**
+ * @brief Page-sized block buffers.
+ *
+ * @details Page-sized buffers hold blocks of devices that have been set to
+ *          blocks larger than #BLOCK_SIZE with bsetsize(), so that such a
+ *          block is looked up, read and written in one go.
+ */
+PRIVATE struct buffer page_buffers[NR_PAGE_BUFFERS];
+
 /**
  * @brief List of free block buffers.
  */
 PRIVATE struct buffer free_buffers;
 
+/**
+ * @brief List of free page-sized block buffers.
+ */
+PRIVATE struct buffer free_page_buffers;
+
+/**
+ * @brief List of free direct-access block buffers.
+ */
+PRIVATE struct buffer free_dax_buffers;
+
 /**
  * @brief Processes waiting for any block.
  * 
- * @details Chain of processes that are sleeping, waiting for any block to
- *          become free.
+ * @details Queue of processes that are sleeping, waiting for any block to
+ *          become free. Each released block wakes up a single waiter.
+ */
+PRIVATE struct waitq chain = { NULL, NULL };
+
+/**
+ * @brief Processes waiting for any direct-access block.
  */
-PRIVATE struct process *chain = NULL;
+PRIVATE struct waitq dax_chain = { NULL, NULL };
+
+/**
+ * @brief Processes waiting for any page-sized block.
+ */
+PRIVATE struct waitq page_chain = { NULL, NULL };
+
+/**
+ * @brief Block sizes of devices.
+ *
+ * @details Devices that are not listed here have blocks of #BLOCK_SIZE bytes.
+ */
+PRIVATE struct
+{
+	dev_t dev;   /**< Device.                     */
+	size_t size; /**< Block size (zero if free).  */
+} bsizes[NR_SUPERBLOCKS];
 
 /**
  * @brief block buffer hash table.
  */
 PRIVATE struct buffer hashtab[BUFFERS_HASHTAB_SIZE];
 
+/**
+ * @brief Block buffer cache counters.
+ */
+PRIVATE struct
+{
+	unsigned hits;   /**< Blocks found in the cache.     */
+	unsigned misses; /**< Blocks read from the disk.     */
+	unsigned writes; /**< Blocks written back.           */
+	unsigned direct; /**< Blocks mapped in place.        */
+} bcounters = { 0, 0, 0, 0 };
+
 /**
  * @brief Sets/clears buffer's dirty flag.
  * 
@@ -210,6 +284,20 @@ PUBLIC inline int buffer_is_sync(const struct buffer *buf)
 	return (buf->flags & BUFFER_SYNC);
 }
 
+/**
+ * @brief Returns the size of the block in a buffer.
+ * 
+ * @param buf Buffer to be considered.
+ * 
+ * @returns The size of the block in the buffer (in bytes).
+ * 
+ * @note The buffer must be locked.
+ */
+PUBLIC inline size_t buffer_size(const struct buffer *buf)
+{
+	return (buf->size);
+}
+
 /**
  * @brief Increments reference counter of a block buffer. 
  *
@@ -232,11 +320,56 @@ PUBLIC void buffer_share(struct buffer *buf)
 #define HASH(dev, block) \
 	(((dev)^(block))%BUFFERS_HASHTAB_SIZE)
 
+/**
+ * @brief Gets the block size of a device.
+ * 
+ * @param dev Device number.
+ * 
+ * @returns The block size of the device (in bytes).
+ */
+PRIVATE size_t bsize(dev_t dev)
+{
+	for (unsigned i = 0; i < NR_SUPERBLOCKS; i++)
+	{
+		if ((bsizes[i].size != 0) && (bsizes[i].dev == dev))
+			return (bsizes[i].size);
+	}
+
+	return (BLOCK_SIZE);
+}
+
+/**
+ * @brief Gets the free list and the waiters of a kind of block buffer.
+ * 
+ * @param flags Flags of the block buffer.
+ * @param waitq Where the queue of free list waiters should be stored.
+ * 
+ * @returns The free list of the block buffer.
+ */
+PRIVATE struct buffer *bpool(enum buffer_flags flags, struct waitq **waitq)
+{
+	if (flags & BUFFER_DAX)
+	{
+		*waitq = &dax_chain;
+		return (&free_dax_buffers);
+	}
+
+	if (flags & BUFFER_PAGE)
+	{
+		*waitq = &page_chain;
+		return (&free_page_buffers);
+	}
+
+	*waitq = &chain;
+	return (&free_buffers);
+}
+
 /**
  * @brief Gets a block buffer from the block buffer cache.
  * 
  * @details Searches the block buffer cache for a block buffer that matches
- *          a device number and block number.
+ *          a device number and block number. Blocks are numbered in units
+ *          of the block size of the device.
  * 
  * @param dev Device number.
  * @param num Block number.
@@ -248,16 +381,24 @@ PUBLIC void buffer_share(struct buffer *buf)
  */
 PRIVATE struct buffer *getblk(dev_t dev, block_t num)
 {
-	unsigned i;         /* Hash table index. */
-	struct buffer *buf; /* Buffer.           */
+	unsigned i;           /* Hash table index.   */
+	size_t size;          /* Block size.         */
+	void *data;           /* Block mapped in place. */
+	struct buffer *buf;   /* Buffer.             */
+	struct buffer *free;  /* Free list.          */
+	struct waitq *waitq;  /* Free list waiters.  */
+	struct waitq *woken;  /* Woken up on.        */
 	
 	/* Should not happen. */
 	if ((dev == 0) && (num == 0))
 		kpanic("getblk(0, 0)");
 
+	woken = NULL;
+
 repeat:
 
 	i = HASH(dev, num);
+	size = bsize(dev);
 
 	disable_interrupts();
 
@@ -265,7 +406,7 @@ repeat:
 	for (buf = hashtab[i].hash_next; buf != &hashtab[i]; buf = buf->hash_next)
 	{		
 		/* Not found. */
-		if ((buf->dev != dev) || (buf->num != num))
+		if ((buf->dev != dev) || (buf->num != num) || (buf->size != size))
 			continue;
 		
 		/*
@@ -274,10 +415,13 @@ repeat:
 		 */
 		if (buf->flags & BUFFER_LOCKED)
 		{
-			sleep(&buf->chain, PRIO_BUFFER);
+			wq_handoff(woken, &buf->chain);
+			wq_sleep(woken = &buf->chain, PRIO_BUFFER, WQ_EXCLUSIVE);
 			goto repeat;
 		}
 		
+		wq_handoff(woken, &buf->chain);
+		
 		/* Remove buffer from the free list. */
 		if (buf->count++ == 0)
 		{
@@ -291,28 +435,43 @@ repeat:
 		return (buf);
 	}
 
+	/*
+	 * Blocks that can be mapped in place take a direct-access
+	 * buffer, and large blocks a page-sized one.
+	 */
+	data = bdev_direct(dev, num, size);
+	if (data != NULL)
+		free = bpool(BUFFER_DAX, &waitq);
+	else
+		free = bpool((size > BLOCK_SIZE) ? BUFFER_PAGE : 0, &waitq);
+
 	/*
 	 * There are no free buffers so we need to
 	 * wait for one to become free.
 	 */
-	if (&free_buffers == free_buffers.free_next)
+	if (free == free->free_next)
 	{
 		kprintf("fs: no free buffers");
-		sleep(&chain, PRIO_BUFFER);
+		wq_handoff(woken, waitq);
+		wq_sleep(woken = waitq, PRIO_BUFFER, WQ_EXCLUSIVE);
 		goto repeat;
 	}
 	
+	wq_handoff(woken, waitq);
+	woken = NULL;
+	
 	/* Remove buffer from the free list. */
-	buf = free_buffers.free_next;
+	buf = free->free_next;
 	buf->free_prev->free_next = buf->free_next;
 	buf->free_next->free_prev = buf->free_prev;
 	buf->count++;
 	
 	/* 
 	 * Buffer is dirty, so write it asynchronously 
-	 * to the disk and go find another buffer.
+	 * to the disk and go find another buffer. Direct-access
+	 * buffers are never behind the device.
 	 */
-	if (buf->flags & BUFFER_DIRTY)
+	if ((buf->flags & BUFFER_DIRTY) && !(buf->flags & BUFFER_DAX))
 	{
 		blklock(buf);
 		enable_interrupts();
@@ -327,7 +486,17 @@ repeat:
 	/* Reassign device and block number. */
 	buf->dev = dev;
 	buf->num = num;
+	buf->size = size;
 	buf->flags &= ~BUFFER_VALID;
+
+	/* Map block in place. */
+	if (data != NULL)
+	{
+		buf->data = data;
+		buf->flags &= ~BUFFER_DIRTY;
+		buf->flags |= BUFFER_VALID;
+		bcounters.direct++;
+	}
 	
 	/* Place buffer in a new hash queue. */
 	hashtab[i].hash_next->hash_prev = buf;
@@ -356,7 +525,7 @@ PUBLIC void blklock(struct buffer *buf)
 	
 	/* Wait for block buffer to become unlocked. */
 	while (buf->flags & BUFFER_LOCKED)
-		sleep(&buf->chain, PRIO_BUFFER);
+		wq_sleep(&buf->chain, PRIO_BUFFER, WQ_EXCLUSIVE);
 		
 	buf->flags |= BUFFER_LOCKED;
 
@@ -367,7 +536,7 @@ PUBLIC void blklock(struct buffer *buf)
  * @brief Unlocks a block buffer.
  * 
  * @details Unlocks the block buffer pointed to by buf by marking it as not
- *          locked and waking up all processes that were waiting for it.
+ *          locked and waking up the next process that was waiting for it.
  *
  * @param buf Block buffer to be unlocked.
  * 
@@ -378,7 +547,7 @@ PUBLIC void blkunlock(struct buffer *buf)
 	disable_interrupts();
 
 	buf->flags &= ~BUFFER_LOCKED;
-	wakeup(&buf->chain);
+	wq_wakeup(&buf->chain);
 
 	enable_interrupts();
 }
@@ -404,28 +573,33 @@ PUBLIC void brelse(struct buffer *buf)
 	/* No more references. */
 	if (--buf->count == 0)
 	{
+		struct buffer *free; /* Free list.         */
+		struct waitq *waitq; /* Free list waiters. */
+
+		free = bpool(buf->flags, &waitq);
+
 		/*
-		 * Wakeup processes that were waiting
+		 * Wakeup one process that was waiting
 		 * for any block to become free.
 		 */
-		wakeup(&chain);
+		wq_wakeup(waitq);
 					
 		/* Frequently used buffer (insert in the end). */
 		if ((buf->flags & BUFFER_VALID) && (buf->flags & BUFFER_DIRTY))
 		{	
-			free_buffers.free_prev->free_next = buf;
-			buf->free_prev = free_buffers.free_prev;
-			free_buffers.free_prev = buf;
-			buf->free_next = &free_buffers;
+			free->free_prev->free_next = buf;
+			buf->free_prev = free->free_prev;
+			free->free_prev = buf;
+			buf->free_next = free;
 		}
 			
 		/* Not frequently used buffer (insert in the begin). */
 		else
 		{	
-			free_buffers.free_next->free_prev = buf;
-			buf->free_prev = &free_buffers;
-			buf->free_next = free_buffers.free_next;
-			free_buffers.free_next = buf;
+			free->free_next->free_prev = buf;
+			buf->free_prev = free;
+			buf->free_next = free->free_next;
+			free->free_next = buf;
 		}
 	}
 
@@ -458,8 +632,13 @@ PUBLIC struct buffer *bread(dev_t dev, block_t num)
 	
 	/* Valid buffer? */
 	if (buf->flags & BUFFER_VALID)
+	{
+		bcounters.hits++;
 		return (buf);
+	}
 
+	bcounters.misses++;
+	curr_proc->ru.inblock++;
 	bdev_readblk(buf);
 	
 	/* Update buffer flags. */
@@ -485,13 +664,18 @@ PUBLIC void bwrite(struct buffer *buf)
 	/*
 	 * We don't have to write back the buffer
 	 * to disk, so we just release it and we are done.
+	 * Direct-access buffers already live in the device.
 	 */
-	if (!(buf->flags & BUFFER_DIRTY))
+	if (!(buf->flags & BUFFER_DIRTY) || (buf->flags & BUFFER_DAX))
 	{
+		buf->flags &= ~BUFFER_DIRTY;
 		brelse(buf);
 		return;
 	}
 	
+	bcounters.writes++;
+	curr_proc->ru.oublock++;
+
 	/*
 	 * The low-level I/O function shall clean
 	 * the BUFFER_DIRTY flag and release the buffer.
@@ -499,6 +683,41 @@ PUBLIC void bwrite(struct buffer *buf)
 	bdev_writeblk(buf);
 }
 
+/**
+ * @brief Flushes a block buffer onto the underlying device.
+ * 
+ * @param buf Block buffer to be flushed.
+ */
+PRIVATE void bflush(struct buffer *buf)
+{
+	blklock(buf);
+		
+	/* Skip invalid buffers. */
+	if (!(buf->flags & BUFFER_VALID))
+	{
+		blkunlock(buf);
+		return;
+	}
+	
+	/*
+	 * Prevent double free, since a call
+	 * to brelse() will follow.
+	 */
+	disable_interrupts();
+	if (buf->count++ == 0)
+	{
+		buf->free_prev->free_next = buf->free_next;
+		buf->free_next->free_prev = buf->free_prev;
+	}
+	enable_interrupts();
+	
+	/*
+	 * This will cause the buffer to be
+	 * written back to disk and then released.
+	 */
+	bwrite(buf);
+}
+
 /**
  * @brief Synchronizes the block buffer cache.
  * 
@@ -508,34 +727,135 @@ PUBLIC void bsync(void)
 {
 	/* Synchronize buffers. */
 	for (struct buffer *buf = &buffers[0]; buf < &buffers[NR_BUFFERS]; buf++)
+		bflush(buf);
+	for (struct buffer *buf = &page_buffers[0]; buf < &page_buffers[NR_PAGE_BUFFERS]; buf++)
+		bflush(buf);
+}
+
+/**
+ * @brief Drops the blocks of a device from a set of block buffers.
+ * 
+ * @param dev  Device number.
+ * @param bufs Block buffers.
+ * @param n    Number of block buffers in @p bufs.
+ * 
+ * @returns Zero if the blocks were dropped, and non-zero if some of them are
+ *          in use.
+ */
+PRIVATE int bdrop(dev_t dev, struct buffer *bufs, unsigned n)
+{
+	for (struct buffer *buf = &bufs[0]; buf < &bufs[n]; buf++)
 	{
+		if (buf->dev != dev)
+			continue;
+
+		/* Wait for pending writes. */
 		blklock(buf);
-			
-		/* Skip invalid buffers. */
-		if (!(buf->flags & BUFFER_VALID))
+
+		/* In use. */
+		if (buf->count > 0)
 		{
 			blkunlock(buf);
-			continue;
+			return (-1);
 		}
-		
-		/*
-		 * Prevent double free, since a call
-		 * to brelse() will follow.
-		 */
-		disable_interrupts();
-		if (buf->count++ == 0)
+
+		buf->flags &= ~(BUFFER_VALID | BUFFER_DIRTY);
+		blkunlock(buf);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Sets the block size of a device.
+ * 
+ * @details Blocks of the old size are written back and dropped from the
+ *          block buffer cache, so that they are not mistaken for blocks of
+ *          the new size later on. Blocks are numbered in units of the new
+ *          size from then on. Devices have #BLOCK_SIZE blocks to begin with.
+ * 
+ * @param dev  Device number.
+ * @param size Block size: a power of two from #BLOCK_SIZE to #PAGE_SIZE.
+ * 
+ * @returns Upon successful completion, zero is returned. Upon failure, a
+ *          negative error code is returned instead.
+ */
+PUBLIC int bsetsize(dev_t dev, size_t size)
+{
+	int slot; /* Slot in the block size table. */
+
+	/* Unsupported block size. */
+	if ((size < BLOCK_SIZE) || (size > PAGE_SIZE) || (size & (size - 1)))
+		return (-EINVAL);
+
+	/* Nothing to be done. */
+	if (bsize(dev) == size)
+		return (0);
+
+	/* Find a slot in the block size table. */
+	slot = -1;
+	for (int i = 0; i < NR_SUPERBLOCKS; i++)
+	{
+		if ((bsizes[i].size != 0) && (bsizes[i].dev == dev))
 		{
-			buf->free_prev->free_next = buf->free_next;
-			buf->free_next->free_prev = buf->free_prev;
+			slot = i;
+			break;
 		}
-		enable_interrupts();
-		
-		/*
-		 * This will cause the buffer to be
-		 * written back to disk and then released.
-		 */
-		bwrite(buf);
+
+		if ((bsizes[i].size == 0) && (slot < 0))
+			slot = i;
 	}
+
+	/* Block size table is full. */
+	if (slot < 0)
+		return (-ENOMEM);
+
+	bsync();
+
+	/* Blocks of the old size are in use. */
+	if (bdrop(dev, buffers, NR_BUFFERS) || bdrop(dev, page_buffers, NR_PAGE_BUFFERS))
+		return (-EBUSY);
+
+	bsizes[slot].dev = dev;
+	bsizes[slot].size = (size == BLOCK_SIZE) ? 0 : size;
+
+	return (0);
+}
+
+/**
+ * @brief Gets block buffer cache statistics.
+ *
+ * @param st Where to store the statistics.
+ */
+PUBLIC void bstat(struct buffer_stats *st)
+{
+	kmemset(st, 0, sizeof(struct buffer_stats));
+
+	st->nbuffers = NR_BUFFERS + NR_PAGE_BUFFERS;
+	for (struct buffer *buf = &buffers[0]; buf < &buffers[NR_BUFFERS]; buf++)
+	{
+		if (buf->flags & BUFFER_VALID)
+			st->valid++;
+		if (buf->flags & BUFFER_DIRTY)
+			st->dirty++;
+		if (buf->count > 0)
+			st->busy++;
+	}
+	for (struct buffer *buf = &page_buffers[0]; buf < &page_buffers[NR_PAGE_BUFFERS]; buf++)
+	{
+		if (buf->flags & BUFFER_VALID)
+			st->valid++;
+		if (buf->flags & BUFFER_DIRTY)
+			st->dirty++;
+		if (buf->count > 0)
+			st->busy++;
+	}
+
+	st->hits = bcounters.hits;
+	st->misses = bcounters.misses;
+	st->writes = bcounters.writes;
+	st->ndirect = NR_DAX_BUFFERS;
+	st->direct = bcounters.direct;
 }
 
 /**
@@ -559,10 +879,10 @@ PUBLIC void binit(void)
 		buffers[i].dev = 0;
 		buffers[i].num = 0;
 		buffers[i].data = ptr;
+		buffers[i].size = BLOCK_SIZE;
 		buffers[i].count = 0;
-		buffers[i].flags = 
-			~(BUFFER_VALID | BUFFER_LOCKED | BUFFER_DIRTY | BUFFER_SYNC);
-		buffers[i].chain = NULL;
+		buffers[i].flags = 0;
+		waitq_init(&buffers[i].chain);
 		buffers[i].free_next = 
 			(i + 1 == NR_BUFFERS) ? &free_buffers : &buffers[i + 1];
 		buffers[i].free_prev = 
@@ -573,9 +893,50 @@ PUBLIC void binit(void)
 		ptr += BLOCK_SIZE;
 	}
 	
+	/* Initialize direct-access buffers. */
+	for (unsigned i = 0; i < NR_DAX_BUFFERS; i++)
+	{
+		dax_buffers[i].dev = 0;
+		dax_buffers[i].num = 0;
+		dax_buffers[i].data = NULL;
+		dax_buffers[i].size = 0;
+		dax_buffers[i].count = 0;
+		dax_buffers[i].flags = BUFFER_DAX;
+		waitq_init(&dax_buffers[i].chain);
+		dax_buffers[i].free_next = 
+			(i + 1 == NR_DAX_BUFFERS) ? &free_dax_buffers : &dax_buffers[i + 1];
+		dax_buffers[i].free_prev = 
+			(i == 0) ? &free_dax_buffers : &dax_buffers[i - 1];
+		dax_buffers[i].hash_next = &dax_buffers[i];
+		dax_buffers[i].hash_prev = &dax_buffers[i];
+	}
+	
+	/* Initialize page-sized buffers. */
+	for (unsigned i = 0; i < NR_PAGE_BUFFERS; i++)
+	{
+		page_buffers[i].dev = 0;
+		page_buffers[i].num = 0;
+		if ((page_buffers[i].data = getkpg(0)) == NULL)
+			kpanic("fs: cannot allocate page-sized buffers");
+		page_buffers[i].size = PAGE_SIZE;
+		page_buffers[i].count = 0;
+		page_buffers[i].flags = BUFFER_PAGE;
+		waitq_init(&page_buffers[i].chain);
+		page_buffers[i].free_next = 
+			(i + 1 == NR_PAGE_BUFFERS) ? &free_page_buffers : &page_buffers[i + 1];
+		page_buffers[i].free_prev = 
+			(i == 0) ? &free_page_buffers : &page_buffers[i - 1];
+		page_buffers[i].hash_next = &page_buffers[i];
+		page_buffers[i].hash_prev = &page_buffers[i];
+	}
+	
 	/* Initialize the buffer cache. */
 	free_buffers.free_next = &buffers[0];
 	free_buffers.free_prev = &buffers[NR_BUFFERS - 1];
+	free_dax_buffers.free_next = &dax_buffers[0];
+	free_dax_buffers.free_prev = &dax_buffers[NR_DAX_BUFFERS - 1];
+	free_page_buffers.free_next = &page_buffers[0];
+	free_page_buffers.free_prev = &page_buffers[NR_PAGE_BUFFERS - 1];
 	for (unsigned i = 0; i < BUFFERS_HASHTAB_SIZE; i++)
 	{
 		hashtab[i].hash_prev = &hashtab[i];
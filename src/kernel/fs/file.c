@@ -88,6 +88,74 @@ PUBLIC ssize_t dir_read(struct inode *i, void *buf, size_t n, off_t off)
 	return retour;
 }
 
+/*
+ * Reads a directory, along with the status of each entry.
+ */
+PUBLIC ssize_t dir_readplus(struct inode *i, struct dirplus *buf, size_t n, off_t *off)
+{
+	int k;                                /* Loop index.                */
+	int nbufs;                            /* Prefetched block buffers.  */
+	int ndirents;                         /* Directory entries read.    */
+	size_t nentries;                      /* Entries stored in buf.     */
+	size_t max;                           /* Entries that fit in buf.   */
+	ssize_t count;                        /* Bytes read from directory. */
+	struct inode *ip;                     /* Working inode.             */
+	ino_t nums[NR_PREFETCH];              /* Inode numbers.             */
+	struct buffer *bufs[NR_PREFETCH];     /* Prefetched block buffers.  */
+	struct d_dirent dirents[NR_PREFETCH]; /* Directory entries.         */
+	
+	max = n/sizeof(struct dirplus);
+	
+	/*
+	 * Never read more directory entries than
+	 * what fits in the buffer, so that no entry
+	 * is skipped on the next call.
+	 */
+	for (nentries = 0; nentries < max; /* noop */)
+	{
+		k = ((max - nentries) < NR_PREFETCH) ? (max - nentries) : NR_PREFETCH;
+		
+		count = dir_read(i, dirents, k*sizeof(struct d_dirent), *off);
+		
+		/* End of directory. */
+		if (count == 0)
+			break;
+		
+		/* Failed to read. */
+		if (count < 0)
+			return ((nentries > 0) ? (ssize_t)(nentries*sizeof(struct dirplus)) : -1);
+		
+		ndirents = count/sizeof(struct d_dirent);
+		
+		/* Bring in the inodes of the whole batch at once. */
+		for (k = 0; k < ndirents; k++)
+			nums[k] = dirents[k].d_ino;
+		nbufs = inode_prefetch(i, nums, ndirents, bufs);
+		
+		for (k = 0; k < ndirents; k++)
+		{
+			/* Empty entry. */
+			if (dirents[k].d_ino == INODE_NULL)
+				continue;
+			
+			/* Entry has gone away. */
+			if ((ip = inode_entry(i, dirents[k].d_name, dirents[k].d_ino)) == NULL)
+				continue;
+			
+			buf[nentries].d_ino = dirents[k].d_ino;
+			kmemcpy(buf[nentries].d_name, dirents[k].d_name, NAME_MAX);
+			inode_stat(ip, &buf[nentries].d_stat);
+			inode_put(ip);
+			nentries++;
+		}
+		
+		inode_prefetch_done(bufs, nbufs);
+		*off += count;
+	}
+	
+	return (nentries*sizeof(struct dirplus));
+}
+
 /*
  * Writes to a regular file.
  */
@@ -109,6 +177,8 @@ PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 	struct d_dirent *d; /* Directory entry. */
 	int i;
 
+	i = 0;
+
 	/* Cross mount point*/
 	if ((ip->flags & INODE_MOUNT) && (kstrcmp (filename,"..")) )
 	{
@@ -128,7 +198,9 @@ PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 	if (d == NULL)
 		return (INODE_NULL);
 	
-	brelse(buf);
+	/* Synthetic entries are not backed by a buffer. */
+	if (buf != NULL)
+		brelse(buf);
 	if (i == 1)
 		inode_unlock(ip);
 	
@@ -83,12 +83,25 @@ PUBLIC struct file *getfile(void)
 }
 
 
+/*
+ * Releases a reference to a file table entry.
+ */
+PUBLIC void putfile(struct file *f)
+{
+	struct inode *i; /* Inode. */
+	
+	if (--f->count)
+		return;
+	
+	inode_lock(i = f->inode);
+	inode_put(i);
+}
+
 /*
  * Closes a file.
  */
 PUBLIC void do_close(int fd)
 {
-	struct inode *i; /* Inode. */
 	struct file *f;  /* File.  */
 	
 	f = curr_proc->ofiles[fd];
@@ -100,11 +113,7 @@ PUBLIC void do_close(int fd)
 	curr_proc->close &= ~(1 << fd);
 	curr_proc->ofiles[fd] = NULL;	
 	
-	if (--f->count)
-		return;
-	
-	inode_lock(i = f->inode);
-	inode_put(i);
+	putfile(f);
 }
 
 /*
@@ -36,16 +36,55 @@
  *============================================================================*/
 
   
+  /**
+   * @brief Block buffer cache statistics.
+   */
+  struct buffer_stats
+  {
+    unsigned nbuffers; /**< Number of buffers.             */
+    unsigned valid;    /**< Buffers holding a block.       */
+    unsigned dirty;    /**< Buffers not written back yet.  */
+    unsigned busy;     /**< Buffers currently referenced.  */
+    unsigned hits;     /**< bread() served from the cache. */
+    unsigned misses;   /**< bread() that went to the disk. */
+    unsigned writes;   /**< Buffers written back.          */
+    unsigned ndirect;  /**< Number of direct-access buffers. */
+    unsigned direct;   /**< Blocks mapped in place.         */
+  };
+
   /* Forward definitions. */
   EXTERN void buffer_share(struct buffer *);
   EXTERN void binit(void);
+  EXTERN void bstat(struct buffer_stats *);
   
 /*============================================================================*
  *                               Inode Library                                *
  *============================================================================*/
   
+  /**
+   * @brief Inode cache statistics.
+   */
+  struct inode_stats
+  {
+    unsigned ninodes; /**< Number of in-core inodes.           */
+    unsigned valid;   /**< In-core inodes in use.              */
+    unsigned dirty;   /**< In-core inodes not written back.    */
+    unsigned pipes;   /**< In-core inodes backing pipes.       */
+    unsigned hits;    /**< inode_get() served from the cache.  */
+    unsigned misses;  /**< inode_get() that read the inode in. */
+  };
+
+  /**
+   * @brief Maximum number of inodes prefetched in one pass.
+   */
+  #define NR_PREFETCH 16
+
   /* Forward definitions. */
   EXTERN void inode_init(void);
+  EXTERN void inode_stats(struct inode_stats *);
+  EXTERN struct inode *inode_entry(struct inode *, const char *, ino_t);
+  EXTERN int inode_prefetch(struct inode *, const ino_t *, int, struct buffer **);
+  EXTERN void inode_prefetch_done(struct buffer **, int);
 
 /*============================================================================*
  *                            Super Block Library                             *
@@ -94,6 +133,7 @@
     void (*superblock_write) (struct superblock *);
     void (*superblock_stat)(struct superblock *sb, struct ustat *ubuf);
     void (*remount_fs) (void);
+    block_t (*inode_block) (struct superblock *, ino_t);
   };
   
   /**
@@ -128,6 +168,11 @@
  *                       Virtual File System  Library                         *
  *============================================================================*/
   
+  /**
+   * @brief File system flags.
+   */
+  #define FS_NODEV (1 << 0) /**< Not backed by a block device. */
+
   /**
    * @brief File system of the virtual file system.
    */
@@ -135,6 +180,7 @@
     struct superblock *(*superblock_read) (dev_t, struct superblock *);  /**< Function to read the superblock        */
     struct super_operations *so;                                         /**< Stucture of file system's functio      */
     char *name;                                                          /**< Name of the file system                */
+    unsigned flags;                                                      /**< File system flags (FS_*)               */
   };
 
   /**
@@ -152,12 +198,15 @@
   /**
    * @brief Number of the file system.
    */
-  #define MINIX 0
+  #define MINIX  0
+  #define PROCFS 1
+  #define TMPFS  2
+  #define MINIX3 3
   
   /**
    * @brief Maximum nunber of file system.
    */
-  #define NR_FILE_SYSTEM 1
+  #define NR_FILE_SYSTEM 4
 
   /**
    * @brief Function too register file system in the virtual file system .
@@ -170,6 +219,8 @@
   //PUBLIC struct inode * mountRoot ();
   PUBLIC void mountRoot();
   PUBLIC struct file_system_type *fs_from_device (dev_t);
+  EXTERN const struct mounting_point *mount_entry(int);
+  EXTERN struct superblock *superblock_probe(dev_t, struct file_system_type *);
   /**@}*/
 
 #endif /* _FS_H_ */
@@ -35,6 +35,9 @@
 #include <nanvix/syscall.h>
 #include "fs.h"
 #include "minix/minix.h"
+#include "minix3/minix3.h"
+#include "procfs/procfs.h"
+#include "tmpfs/tmpfs.h"
 
 #include <sys/fcntl.h>
 
@@ -57,6 +60,10 @@ PRIVATE struct inode *free_inodes = NULL;
 /* Inodes hash table. */
 PRIVATE struct inode *hashtab[HASHTAB_SIZE];
 
+/* Inode cache hits and misses. */
+PRIVATE unsigned inode_hits = 0;
+PRIVATE unsigned inode_misses = 0;
+
 /* File system's table.	*/
 PRIVATE struct file_system_type *file_system_table [NR_FILE_SYSTEM] = {
 	NULL
@@ -144,6 +151,22 @@ PUBLIC struct file_system_type *fs_from_device (dev_t dev){
 	return NULL;
 }
 
+/**
+ * @brief Gets an entry of the mount table.
+ *
+ * @param i Index of the entry.
+ *
+ * @returns A pointer to the requested mount point, or NULL if @p i is out of
+ *          range or the entry is not in use.
+ */
+PUBLIC const struct mounting_point *mount_entry(int i)
+{
+	if ((i < 0) || (i >= NR_MOUNTING_POINT) || (mount_table[i].free))
+		return (NULL);
+
+	return (&mount_table[i]);
+}
+
 /**
  * @brief Search if an inode is present in the mouting table as a 
  * file_system_root, don't look the first entry.
@@ -279,6 +302,7 @@ PUBLIC int mount (char *device, char *mountPoint)
 	struct file_system_type *fs;	/* The file system 										*/
 	superblock_t sb;				/* The in core super block  							*/
 	int dev;						/* The number of the device to be mounted				*/	 
+	int nodev;						/* Device is not a block device?						*/
 	int num_root;					/* Number of the root inode 							*/
 	int num_mount;					/* Number of the mount inode 							*/
 
@@ -310,6 +334,7 @@ PUBLIC int mount (char *device, char *mountPoint)
 		goto error0;
 	}
 	dev = inode_device->blocks[0];
+	nodev = !S_ISBLK(inode_device->mode);
 	inode_put (inode_device);
 	
 	/* Get the inode of the mount point */
@@ -340,7 +365,11 @@ PUBLIC int mount (char *device, char *mountPoint)
 	for (int i = 0; i < NR_FILE_SYSTEM; i++){
 		if (file_system_table[i] != NULL)
 		{
-			sb = superblock_read (dev); 
+			/* Pseudo file systems do not sit on block devices. */
+			if (!(file_system_table[i]->flags & FS_NODEV) != !nodev)
+				continue;
+
+			sb = superblock_probe (dev, file_system_table[i]); 
 			if (sb != NULL)
 			{
 				fs = file_system_table[i];
@@ -588,6 +617,11 @@ PRIVATE struct inode *inode_read(dev_t dev, ino_t num, struct file_system_type *
 		kpanic("Operation not supported by the file system.");
 
 	if (fs->so->inode_read(dev,num,ip)){
+		/* Give the inode back to the free list. */
+		ip->count--;
+		ip->free_next = free_inodes;
+		free_inodes = ip;
+		inode_unlock(ip);
 		return NULL;
 	}
 
@@ -631,7 +665,7 @@ PRIVATE void inode_free(struct inode *ip, struct file_system_type * fs)
 PUBLIC void inode_lock(struct inode *ip)
 {
 	while (ip->flags & INODE_LOCKED)
-		sleep(&ip->chain, PRIO_INODE);
+		wq_sleep(&ip->chain, PRIO_INODE, WQ_EXCLUSIVE);
 	ip->flags |= INODE_LOCKED;
 }
 
@@ -646,7 +680,7 @@ PUBLIC void inode_lock(struct inode *ip)
  */
 PUBLIC void inode_unlock(struct inode *ip)
 {
-	wakeup(&ip->chain);
+	wq_wakeup(&ip->chain);
 	ip->flags &= ~INODE_LOCKED;
 }
 
@@ -745,10 +779,6 @@ PUBLIC struct inode *inode_alloc(struct superblock *sb)
 		kpanic("No super operation in the superblock.");
 	}
 
-	/* Allocate inode. */
-	if (inode_alloc_minix(sb,ip))
-		return (NULL);
-	
 	/* Operation not supported. */
 	if (sb->s_op->inode_alloc == NULL)
 		kpanic("Operation not supported by the file system.");
@@ -784,6 +814,9 @@ PUBLIC struct inode *inode_get(dev_t dev, ino_t num)
 {
 	struct inode *ip;
 	struct file_system_type * fs;
+	struct waitq *woken; /* Wait queue we were woken up on. */
+
+	woken = NULL;
 
 repeat:
 
@@ -797,16 +830,24 @@ repeat:
 		/* Inode is locked. */
 		if (ip->flags & INODE_LOCKED)
 		{
-			sleep(&ip->chain, PRIO_INODE);
+			wq_handoff(woken, &ip->chain);
+			wq_sleep(woken = &ip->chain, PRIO_INODE, WQ_EXCLUSIVE);
 			goto repeat;
 		}
 		
+		wq_handoff(woken, &ip->chain);
 		ip->count++;
 		inode_lock(ip);
+		inode_hits++;
 		
 		return (ip);
 	}
 	
+	/* The inode we were woken up for is gone. */
+	wq_handoff(woken, NULL);
+
+	inode_misses++;
+
 	/* Read inode. */
 	fs = fs_from_device(dev);
 	if (fs == NULL)
@@ -992,6 +1033,172 @@ PUBLIC void inode_put(struct inode *ip)
 	inode_unlock(ip);
 }
 
+/**
+ * @brief Gets the status of a file.
+ * 
+ * @param ip  Target inode.
+ * @param buf Where to store the status.
+ */
+PUBLIC void inode_stat(const struct inode *ip, struct stat *buf)
+{
+	buf->st_dev = ip->dev;
+	buf->st_ino = ip->num;
+	buf->st_mode = ip->mode;
+	buf->st_nlink = ip->nlinks;
+	buf->st_uid = ip->uid;
+	buf->st_gid = ip->gid;
+	buf->st_size = ip->size;
+	buf->st_atime = ip->time;
+	buf->st_mtime = ip->time;
+	buf->st_ctime = ip->time;
+}
+
+/**
+ * @brief Gets the inode that a directory entry refers to.
+ * 
+ * @details Gets the inode of the entry named @p name, with inode number
+ *          @p num, of the directory @p dir. Mount points are crossed the same
+ *          way inode_name() does, so the inode is the one that a lookup of
+ *          the full path name would return.
+ * 
+ * @param dir  Directory inode.
+ * @param name Name of the entry.
+ * @param num  Inode number of the entry.
+ * 
+ * @returns Upon successful completion, a pointer to the inode is returned. In
+ *          this case, the inode is ensured to be locked. Upon failure, a #NULL
+ *          pointer is returned instead.
+ * 
+ * @note The directory inode must not be locked.
+ */
+PUBLIC struct inode *inode_entry(struct inode *dir, const char *name, ino_t num)
+{
+	struct inode *ip;          /* Working inode.  */
+	struct mounting_point *mp; /* Mounting point. */
+	
+	/* Parent of the root directory of a mounted file system. */
+	if ((!kstrncmp(name, "..", NAME_MAX)) && ((mp = is_root_fs(dir)) != NULL))
+	{
+		if ((ip = inode_get(mp->dev_r, mp->no_inode_mount)) == NULL)
+			return (NULL);
+		
+		num = dir_search(ip, "..");
+		inode_put(ip);
+		
+		if (num == INODE_NULL)
+			return (NULL);
+		
+		return (inode_get(mp->dev_r, num));
+	}
+	
+	ip = inode_get(dir->dev, num);
+	
+	/* Mounting point. */
+	if ((ip != NULL) && ((mp = is_mounting_point(ip)) != NULL))
+	{
+		inode_put(ip);
+		ip = inode_get(mp->dev, mp->no_inode_root_fs);
+	}
+	
+	return (ip);
+}
+
+/**
+ * @brief Asserts if an inode is in the inode cache.
+ */
+PRIVATE int inode_cached(dev_t dev, ino_t num)
+{
+	struct inode *ip;
+	
+	for (ip = hashtab[HASH(dev, num)]; ip != NULL; ip = ip->hash_next)
+	{
+		if ((ip->dev == dev) && (ip->num == num))
+			return (1);
+	}
+	
+	return (0);
+}
+
+/**
+ * @brief Prefetches the disk inodes of a batch of directory entries.
+ * 
+ * @details Reads in, in ascending block order, the inode table blocks that
+ *          hold the inodes listed in @p nums, of the file system of @p dir,
+ *          that are not in the inode cache. Each block is read once, and
+ *          stays referenced in @p bufs until inode_prefetch_done() is called,
+ *          so that the inode_get() calls that follow hit the block buffer
+ *          cache.
+ * 
+ * @param dir  Directory inode.
+ * @param nums Inode numbers. Null entries are skipped.
+ * @param n    Number of entries in @p nums (at most #NR_PREFETCH).
+ * @param bufs Where to store the prefetched block buffers.
+ * 
+ * @returns The number of block buffers stored in @p bufs.
+ */
+PUBLIC int inode_prefetch(struct inode *dir, const ino_t *nums, int n, struct buffer **bufs)
+{
+	int i, j;                    /* Loop indexes.           */
+	int nblocks;                 /* Number of blocks.       */
+	block_t blk;                 /* Working block.          */
+	block_t blocks[NR_PREFETCH]; /* Blocks to be read in.   */
+	struct file_system_type *fs; /* File system.            */
+	
+	fs = fs_from_device(dir->dev);
+	
+	/* File system does not keep an inode table. */
+	if ((fs == NULL) || (fs->so->inode_block == NULL) || (dir->sb == NULL))
+		return (0);
+	
+	if (n > NR_PREFETCH)
+		n = NR_PREFETCH;
+	
+	/* Sort blocks, dropping duplicates. */
+	nblocks = 0;
+	for (i = 0; i < n; i++)
+	{
+		/* Invalid or in-core inode. */
+		if ((nums[i] == INODE_NULL) || (nums[i] > dir->sb->ninodes))
+			continue;
+		if (inode_cached(dir->dev, nums[i]))
+			continue;
+		
+		blk = fs->so->inode_block(dir->sb, nums[i]);
+		
+		for (j = 0; (j < nblocks) && (blocks[j] < blk); j++)
+			/* noop */;
+		
+		if ((j < nblocks) && (blocks[j] == blk))
+			continue;
+		
+		for (int k = nblocks; k > j; k--)
+			blocks[k] = blocks[k - 1];
+		blocks[j] = blk;
+		nblocks++;
+	}
+	
+	/* Read in blocks. */
+	for (i = 0; i < nblocks; i++)
+		blkunlock(bufs[i] = bread(dir->dev, blocks[i]));
+	
+	return (nblocks);
+}
+
+/**
+ * @brief Releases block buffers prefetched by inode_prefetch().
+ * 
+ * @param bufs Prefetched block buffers.
+ * @param n    Number of entries in @p bufs.
+ */
+PUBLIC void inode_prefetch_done(struct buffer **bufs, int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		blklock(bufs[i]);
+		brelse(bufs[i]);
+	}
+}
+
 /**
  * @brief Breaks a path
  * 
@@ -1247,13 +1454,23 @@ PUBLIC struct inode *inode_name(const char *pathname)
  *@brief Create a file system on a device.
  *
  *@details Create a file system with ninodes inodes and nblocks blocks,
- *			with permision uid and gid.
+ *			with permision uid and gid. The file system is either "minix",
+ *			with 1 KB blocks, or "minix3", with 4 KB blocks.
  *
  */
 PUBLIC int mkfs
-(const char *diskfile, uint16_t ninodes, uint16_t nblocks, uint16_t uid,
- uint16_t gid)
+(const char *diskfile, const char *fs_name, uint16_t ninodes, uint16_t nblocks,
+ uint16_t uid, uint16_t gid)
 {
+	if (!kstrcmp(fs_name, "minix3"))
+		return minix3_mkfs(diskfile,ninodes,nblocks,uid,gid);
+
+	if (kstrcmp(fs_name, "minix"))
+	{
+		kprintf("Mkfs: unknown file system %s", fs_name);
+		return 1;
+	}
+
 	return minix_mkfs(diskfile,ninodes,nblocks,uid,gid); 
 }
 
@@ -1298,7 +1515,7 @@ PUBLIC void inode_init(void)
 	{
 		inodes[i].count = 0;
 		inodes[i].flags = ~(INODE_LOCKED | INODE_VALID);
-		inodes[i].chain = NULL;
+		waitq_init(&inodes[i].chain);
 		inodes[i].free_next = ((i + 1) < NR_INODES) ? &inodes[i + 1] : NULL;
 		inodes[i].hash_next = NULL;
 		inodes[i].hash_prev = NULL;
@@ -1311,11 +1528,41 @@ PUBLIC void inode_init(void)
 
 	/*Initialize FileSystemTable*/
 	init_minix();
+	init_procfs();
+	init_tmpfs();
+	init_minix3();
 
 	/*Initialize MountTable*/
 	init_mount_table();
 }
 
+/**
+ * @brief Gets inode cache statistics.
+ *
+ * @param st Where to store the statistics.
+ */
+PUBLIC void inode_stats(struct inode_stats *st)
+{
+	kmemset(st, 0, sizeof(struct inode_stats));
+
+	st->ninodes = NR_INODES;
+	for (struct inode *ip = &inodes[0]; ip < &inodes[NR_INODES]; ip++)
+	{
+		/* Skip free inodes. */
+		if (!(ip->flags & INODE_VALID))
+			continue;
+
+		st->valid++;
+		if (ip->flags & INODE_DIRTY)
+			st->dirty++;
+		if (ip->flags & INODE_PIPE)
+			st->pipes++;
+	}
+
+	st->hits = inode_hits;
+	st->misses = inode_misses;
+}
+
 PUBLIC struct inode *inode_semaphore(const char* pathsem, int mode)
 {
 	struct inode *inode;
@@ -159,8 +159,8 @@ PRIVATE void block_free_indirect(struct superblock *sb, block_t num)
 	/* Free indirect disk block. */
 	for (i = 0; i < NR_SINGLE; i++)
 	{
-		block_free_direct(sb, ((block_t *)buffer_data(buf))[i]);
-		((block_t *)buffer_data(buf))[i] = BLOCK_NULL;
+		block_free_direct(sb, ((zone_t *)buffer_data(buf))[i]);
+		((zone_t *)buffer_data(buf))[i] = BLOCK_NULL;
 	}
 	block_free_direct(sb, num);
 		
@@ -192,8 +192,8 @@ PRIVATE void block_free_dindirect(struct superblock *sb, block_t num)
 	/* Free direct zone. */
 	for (i = 0; i < NR_SINGLE; i++)
 	{
-		block_free_indirect(sb, ((block_t *)buffer_data(buf))[i]);
-		((block_t *)buffer_data(buf))[i] = BLOCK_NULL;
+		block_free_indirect(sb, ((zone_t *)buffer_data(buf))[i]);
+		((zone_t *)buffer_data(buf))[i] = BLOCK_NULL;
 	}
 	block_free_direct(sb, num);
 	
@@ -258,7 +258,7 @@ PUBLIC block_t create_indirect_block
 {
 	block_t phys; /* Physical block number. */
 
-	if (((block_t *)buffer_data(dest))[offset] == BLOCK_NULL && create)
+	if (((zone_t *)buffer_data(dest))[offset] == BLOCK_NULL && create)
 	{
 		/* Allocate an block. */
 		superblock_lock(ip->sb);
@@ -267,7 +267,7 @@ PUBLIC block_t create_indirect_block
 
 		if (phys != BLOCK_NULL)
 		{
-			((block_t *)buffer_data(dest))[offset] = phys;
+			((zone_t *)buffer_data(dest))[offset] = phys;
 			buffer_dirty(dest, 1);
 			inode_touch(ip);
 			brelse(dest);
@@ -282,7 +282,7 @@ PUBLIC block_t create_indirect_block
 	else
 	{
 		brelse(dest);
-		return ((block_t *)buffer_data(dest))[offset];
+		return ((zone_t *)buffer_data(dest))[offset];
 	}
 }
 
@@ -324,6 +324,83 @@ PUBLIC block_t create_direct_block(struct inode *ip, off_t offset, int create)
 		return (ip->blocks[offset]);
 }
 
+/**
+ * @brief Invalidates the block map cache of an inode.
+ * 
+ * @param ip Target inode.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC void bmap_invalidate(struct inode *ip)
+{
+	for (unsigned i = 0; i < NR_BMAP_EXTENTS; i++)
+		ip->bmap[i].count = 0;
+	ip->bmap_hand = 0;
+}
+
+/**
+ * @brief Looks up a logical block in the block map cache of an inode.
+ * 
+ * @param ip    Target inode.
+ * @param logic Logical block number.
+ * 
+ * @returns The disk block that is associated with @p logic, or #BLOCK_NULL if
+ *          it is not cached.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC block_t bmap_lookup(struct inode *ip, unsigned logic)
+{
+	struct bmap_extent *e;
+	
+	for (e = &ip->bmap[0]; e < &ip->bmap[NR_BMAP_EXTENTS]; e++)
+	{
+		if ((logic - e->logic) < e->count)
+			return (e->phys + (logic - e->logic));
+	}
+	
+	return (BLOCK_NULL);
+}
+
+/**
+ * @brief Records a resolved mapping in the block map cache of an inode.
+ * 
+ * @details Extends an extent when the mapping follows it both logically and
+ *          on disk, so that a file laid out contiguously is covered by a
+ *          single extent. Otherwise, a new extent replaces the oldest one.
+ * 
+ * @param ip    Target inode.
+ * @param logic Logical block number.
+ * @param phys  Disk block number.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC void bmap_insert(struct inode *ip, unsigned logic, block_t phys)
+{
+	struct bmap_extent *e;
+	
+	if (phys == BLOCK_NULL)
+		return;
+	
+	for (e = &ip->bmap[0]; e < &ip->bmap[NR_BMAP_EXTENTS]; e++)
+	{
+		if (e->count == 0)
+			continue;
+		
+		if ((e->logic + e->count == logic) && (e->phys + e->count == phys))
+		{
+			e->count++;
+			return;
+		}
+	}
+	
+	e = &ip->bmap[ip->bmap_hand];
+	ip->bmap_hand = (ip->bmap_hand + 1)%NR_BMAP_EXTENTS;
+	e->logic = logic;
+	e->phys = phys;
+	e->count = 1;
+}
+
 /**
  * @brief Maps a file byte offset in a disk block number.
  * 
@@ -384,6 +461,10 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 		return (ip->blocks[logic]);
 	}
 	
+	/* Indirect blocks are looked up only once. */
+	if ((phys = bmap_lookup(ip, off/BLOCK_SIZE)) != BLOCK_NULL)
+		return (phys);
+	
 	logic -= NR_ZONES_DIRECT;
 	
 	/* Single indirect block. */
@@ -410,7 +491,7 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 		buf = bread(ip->dev, phys);
 		
 		/* Create direct block. */
-		if (((block_t *)buffer_data(buf))[logic] == BLOCK_NULL && create)
+		if (((zone_t *)buffer_data(buf))[logic] == BLOCK_NULL && create)
 		{
 			superblock_lock(ip->sb);
 			phys = block_alloc(ip->sb);
@@ -418,7 +499,7 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 			
 			if (phys != BLOCK_NULL)
 			{
-				((block_t *)buffer_data(buf))[logic] = phys;
+				((zone_t *)buffer_data(buf))[logic] = phys;
 				buffer_dirty(buf, 1);
 				inode_touch(ip);
 			}
@@ -426,7 +507,10 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 		
 		brelse(buf);
 		
-		return (((block_t *)buffer_data(buf))[logic]);
+		phys = ((zone_t *)buffer_data(buf))[logic];
+		bmap_insert(ip, off/BLOCK_SIZE, phys);
+		
+		return (phys);
 	}
 	
 	logic = off - REMAINING_OFFSET;
@@ -448,7 +532,10 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 				buf = bread(ip->dev, phys);
 				if ( (phys = create_indirect_block(buf,ip,logicDouble,create)) 
 					!= BLOCK_NULL)
+				{
+					bmap_insert(ip, off/BLOCK_SIZE, phys);
 					return (phys);
+				}
 				else
 					return (BLOCK_NULL);
 			}
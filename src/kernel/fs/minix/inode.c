@@ -44,6 +44,20 @@
 /* Number of inodes per block. */
 #define INODES_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_inode))
 
+/**
+ * @brief Gets the block that holds a disk inode.
+ * 
+ * @param sb  Superblock.
+ * @param num Inode number.
+ * 
+ * @returns The number of the inode table block that holds the inode with
+ *          number @p num.
+ */
+PRIVATE block_t inode_block_minix(struct superblock *sb, ino_t num)
+{
+	return (2 + sb->imap_blocks + sb->zmap_blocks + (num - 1)/INODES_PER_BLOCK);
+}
+
 /**
  * @brief Writes an inode to disk.
  * 
@@ -66,7 +80,7 @@ PUBLIC void inode_write_minix(struct inode *ip)
 	
 	superblock_lock(sb = ip->sb);
 	
-	blk = 2 + sb->imap_blocks + sb->zmap_blocks + (ip->num - 1)/INODES_PER_BLOCK;
+	blk = inode_block_minix(sb, ip->num);
 	
 	/* Read chunk of disk inodes. */
 	buf = bread(ip->dev, blk);
@@ -124,7 +138,7 @@ PUBLIC int inode_read_minix(dev_t dev, ino_t num, struct inode *ip)
 	}
 	
 	/* Calculate block number. */
-	blk = 2 + sb->imap_blocks + sb->zmap_blocks + (num - 1)/INODES_PER_BLOCK;
+	blk = inode_block_minix(sb, num);
 	
 	/* Read chunk of disk inodes. */
 	buf = bread(dev, blk);
@@ -149,6 +163,7 @@ PUBLIC int inode_read_minix(dev_t dev, ino_t num, struct inode *ip)
 	ip->time = d_i->i_time;
 	for (unsigned i = 0; i < NR_ZONES; i++)
 		ip->blocks[i] = d_i->i_zones[i];
+	bmap_invalidate(ip);
 	ip->dev = dev;
 	ip->num = num;
 	ip->sb = sb;
@@ -233,6 +248,7 @@ PUBLIC void inode_truncate_minix(struct inode *ip)
 	
 	superblock_unlock(sb);
 	
+	bmap_invalidate(ip);
 	ip->size = 0;
 	inode_touch(ip);
 }
@@ -299,6 +315,7 @@ found:
 	ip->size = 0;
 	for (unsigned j = 0; j < NR_ZONES; j++)
 		ip->blocks[j] = BLOCK_NULL;
+	bmap_invalidate(ip);
 	ip->dev = sb->dev;
 	ip->num = num;
 	ip->sb = sb;
@@ -574,7 +591,8 @@ PRIVATE struct super_operations super_o_minix =
 		&superblock_put_minix,		/* put_super 		*/
 		&superblock_write_minix,	/* write_super 		*/
 		&superblock_stat_minix,		/* superblock_stat 	*/
-		&init_minix 				/* remount_fs 		*/
+		&init_minix, 				/* remount_fs 		*/
+		&inode_block_minix			/* inode_block 		*/
 };
 
 PUBLIC struct inode_operations inode_o_minix =
@@ -584,13 +602,15 @@ PUBLIC struct inode_operations inode_o_minix =
 	&dir_remove_minix,
 	&file_read_minix,
 	&file_write_minix,
-	&dirent_search_minix
+	&dirent_search_minix,
+	&block_map
 };
 
 PRIVATE struct file_system_type fs_minix = {
 	superblock_read_minix,
 	&super_o_minix,
-	"minix"
+	"minix",
+	0
 };
 
 PUBLIC struct super_operations * so_minix(void){
@@ -0,0 +1,1300 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * @brief Minix V3 file system.
+ *
+ * @details Minix V3 volumes have 4 KB zones, 32-bit zone pointers and 64-byte
+ *          inodes and directory entries. The device is switched to 4 KB
+ *          blocks while the file system is mounted, so that a zone is held
+ *          in a single buffer, and is looked up, read and written in one go. The inode and zone maps are pinned in the superblock
+ *          one zone at a time, so they cover four times as many objects as
+ *          the Minix V1 ones.
+ *
+ *          The in-core inode keeps the direct, single and double indirect
+ *          zones only. With 4 KB zones these already cover more than the
+ *          largest file offset, so triple indirect zones are never used.
+ *          Inode numbers are limited to 16 bits and names to #NAME_MAX
+ *          characters, as in the rest of the file system.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "../minix/minix.h"
+#include "minix3.h"
+
+/* Zones are held in page-sized buffers. */
+#if (MINIX3_BLOCK_SIZE > PAGE_SIZE)
+	#error "MINIX3_BLOCK_SIZE must not exceed PAGE_SIZE"
+#endif
+
+/**
+ * @name Zone geometry
+ */
+/**@{*/
+#define ZONES_PER_ZONE   (MINIX3_BLOCK_SIZE/sizeof(zone3_t))         /**< Zones/zone.    */
+#define INODES_PER_ZONE  (MINIX3_BLOCK_SIZE/sizeof(struct d_inode3)) /**< Inodes/zone.   */
+#define DIRENTS_PER_ZONE (MINIX3_BLOCK_SIZE/sizeof(struct d_dirent3))/**< Entries/zone.  */
+#define BITS_PER_ZONE    (MINIX3_BLOCK_SIZE << 3)                    /**< Bits/zone.     */
+/**@}*/
+
+/**
+ * @brief Maximum file size (in bytes).
+ */
+#define MINIX3_MAX_SIZE 0x7fffffff
+
+/**
+ * @brief Offset of the superblock in the first zone.
+ */
+#define MINIX3_SUPER_OFF 1024
+
+/**
+ * @brief Returns the first zone of the inode table.
+ */
+#define ITABLE(sb) \
+	(2 + (sb)->imap_blocks + (sb)->zmap_blocks)
+
+/* Forward definitions. */
+PRIVATE struct inode_operations minix3_iops;
+PRIVATE struct super_operations minix3_sops;
+
+/*============================================================================*
+ *                                   Zones                                    *
+ *============================================================================*/
+
+/**
+ * @brief Allocates a zone.
+ *
+ * @details Bit zero of the zone map is reserved, so zone @p z is tracked by
+ *          bit z - first data zone + 1. The zone is cleaned before it is
+ *          handed out.
+ *
+ * @param sb Superblock in which the zone should be allocated.
+ *
+ * @returns Upon successful completion, the allocated zone is returned. Upon
+ *          failure, #BLOCK_NULL is returned instead.
+ *
+ * @note The superblock must be locked.
+ */
+PRIVATE zone3_t minix3_zone_alloc(struct superblock *sb)
+{
+	bit_t bit;          /* Bit number in the bitmap. */
+	zone3_t num;        /* Zone number.              */
+	unsigned blk;       /* Working zone map block.   */
+	unsigned firstblk;  /* First block to check.     */
+	struct buffer *buf; /* Working buffer.           */
+
+	/* Search for a free zone. */
+	firstblk = (sb->zsearch - sb->first_data_block + 1)/BITS_PER_ZONE;
+	if (firstblk >= sb->zmap_blocks)
+		firstblk = 0;
+	blk = firstblk;
+	do
+	{
+		bit = bitmap_first_free(buffer_data(sb->zmap[blk]), MINIX3_BLOCK_SIZE);
+
+		/* Found. */
+		if (bit != BITMAP_FULL)
+		{
+			num = sb->first_data_block + blk*BITS_PER_ZONE + bit - 1;
+			if (num < sb->zones)
+				goto found;
+		}
+
+		/* Wrap around. */
+		blk = (blk + 1 < sb->zmap_blocks) ? blk + 1 : 0;
+	} while (blk != firstblk);
+
+	return (BLOCK_NULL);
+
+found:
+
+	/*
+	 * Remember zone number to
+	 * speedup next allocation.
+	 */
+	sb->zsearch = num;
+
+	/* Allocate zone. */
+	bitmap_set(buffer_data(sb->zmap[blk]), bit);
+	buffer_dirty(sb->zmap[blk], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+
+	/* Clean zone to avoid security issues. */
+	buf = bread(sb->dev, num);
+	kmemset(buffer_data(buf), 0, MINIX3_BLOCK_SIZE);
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	return (num);
+}
+
+/**
+ * @brief Frees a zone.
+ *
+ * @param sb  Superblock in which the zone should be freed.
+ * @param num Zone that shall be freed.
+ * @param lvl Level of indirection of the zone: zero for direct zones, one for
+ *            single indirect zones, and two for double indirect zones.
+ *
+ * @note The superblock must be locked.
+ */
+PRIVATE void minix3_zone_free(struct superblock *sb, zone3_t num, int lvl)
+{
+	bit_t bit;          /* Bit number in the bitmap. */
+	struct buffer *buf; /* Indirect zone.            */
+
+	/* Nothing to be done. */
+	if (num == BLOCK_NULL)
+		return;
+
+	/* Free underlying zones. */
+	if (lvl > 0)
+	{
+		buf = bread(sb->dev, num);
+		for (unsigned j = 0; j < ZONES_PER_ZONE; j++)
+			minix3_zone_free(sb, ((zone3_t *)buffer_data(buf))[j], lvl - 1);
+		brelse(buf);
+	}
+
+	/*
+	 * Remember free zone to
+	 * speedup next allocation.
+	 */
+	if (num < sb->zsearch)
+		sb->zsearch = num;
+
+	bit = num - sb->first_data_block + 1;
+	bitmap_clear(buffer_data(sb->zmap[bit/BITS_PER_ZONE]), bit%BITS_PER_ZONE);
+	buffer_dirty(sb->zmap[bit/BITS_PER_ZONE], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+}
+
+/**
+ * @brief Gets a zone pointer of an inode, allocating the zone if asked to.
+ *
+ * @param ip     Target inode.
+ * @param idx    Index of the zone pointer in the inode.
+ * @param create Allocate zone?
+ *
+ * @returns The zone, or #BLOCK_NULL if there is none.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE zone3_t minix3_zone_get(struct inode *ip, unsigned idx, int create)
+{
+	zone3_t zone;
+
+	if ((ip->blocks[idx] == BLOCK_NULL) && (create))
+	{
+		superblock_lock(ip->sb);
+		zone = minix3_zone_alloc(ip->sb);
+		superblock_unlock(ip->sb);
+
+		if (zone != BLOCK_NULL)
+		{
+			ip->blocks[idx] = zone;
+			inode_touch(ip);
+		}
+	}
+
+	return (ip->blocks[idx]);
+}
+
+/**
+ * @brief Gets a zone pointer of an indirect zone, allocating the zone if
+ *        asked to.
+ *
+ * @param ip     Target inode.
+ * @param ind    Indirect zone.
+ * @param idx    Index of the zone pointer in the indirect zone.
+ * @param create Allocate zone?
+ *
+ * @returns The zone, or #BLOCK_NULL if there is none.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE zone3_t minix3_zone_ind
+(struct inode *ip, zone3_t ind, unsigned idx, int create)
+{
+	zone3_t *p;         /* Zone pointer.        */
+	zone3_t zone;       /* Zone.                */
+	struct buffer *buf; /* Indirect zone.       */
+
+	buf = bread(ip->dev, ind);
+	p = &((zone3_t *)buffer_data(buf))[idx];
+
+	if ((*p == BLOCK_NULL) && (create))
+	{
+		superblock_lock(ip->sb);
+		zone = minix3_zone_alloc(ip->sb);
+		superblock_unlock(ip->sb);
+
+		if (zone != BLOCK_NULL)
+		{
+			*p = zone;
+			buffer_dirty(buf, 1);
+			inode_touch(ip);
+		}
+	}
+
+	zone = *p;
+	brelse(buf);
+
+	return (zone);
+}
+
+/**
+ * @brief Maps a logical zone of a file in a zone of the device.
+ *
+ * @param ip     Target inode.
+ * @param logic  Logical zone number.
+ * @param create Create zone?
+ *
+ * @returns The zone, or #BLOCK_NULL if there is none.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE zone3_t minix3_zone_map(struct inode *ip, unsigned logic, int create)
+{
+	zone3_t zone; /* Working zone. */
+
+	/* Direct zone. */
+	if (logic < MINIX3_NR_ZONES_DIRECT)
+		return (minix3_zone_get(ip, logic, create));
+
+	/* Indirect zones are looked up only once. */
+	if ((zone = bmap_lookup(ip, logic)) != BLOCK_NULL)
+		return (zone);
+
+	/* Single indirect zone. */
+	if (logic - MINIX3_NR_ZONES_DIRECT < MINIX3_NR_SINGLE)
+	{
+		zone = minix3_zone_get(ip, MINIX3_ZONE_SINGLE, create);
+		if (zone != BLOCK_NULL)
+			zone = minix3_zone_ind(ip, zone, logic - MINIX3_NR_ZONES_DIRECT, create);
+	}
+
+	/* Double indirect zone. */
+	else
+	{
+		unsigned tmp = logic - MINIX3_NR_ZONES_DIRECT - MINIX3_NR_SINGLE;
+
+		zone = minix3_zone_get(ip, MINIX3_ZONE_DOUBLE, create);
+		if (zone != BLOCK_NULL)
+			zone = minix3_zone_ind(ip, zone, tmp/MINIX3_NR_SINGLE, create);
+		if (zone != BLOCK_NULL)
+			zone = minix3_zone_ind(ip, zone, tmp%MINIX3_NR_SINGLE, create);
+	}
+
+	if (zone != BLOCK_NULL)
+		bmap_insert(ip, logic, zone);
+
+	return (zone);
+}
+
+/**
+ * @brief Maps a file byte offset in a disk block number.
+ *
+ * @details Maps the offset @p off in the file pointed to by @p ip in the
+ *          zone that holds it. If @p create is not zero and such file offset
+ *          is invalid, the file is expanded accordingly.
+ *
+ * @param ip     File to use
+ * @param off    File byte offset.
+ * @param create Create offset?
+ *
+ * @returns Upon successful completion, the disk block number that is associated
+ *          with the file byte offset is returned. Upon failure, #BLOCK_NULL is
+ *          returned instead.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE block_t minix3_block_map(struct inode *ip, off_t off, int create)
+{
+	/* File offset too big. */
+	if (off >= ip->sb->max_size)
+	{
+		curr_proc->errno = -EFBIG;
+		return (BLOCK_NULL);
+	}
+
+	/*
+	 * Create zones that are
+	 * in a valid offset.
+	 */
+	if (off < ip->size)
+		create = 1;
+
+	return (minix3_zone_map(ip, off >> MINIX3_BLOCK_SIZE_LOG2, create));
+}
+
+/*============================================================================*
+ *                              Files and Directories                         *
+ *============================================================================*/
+
+/**
+ * @brief Reads from a regular file.
+ */
+PRIVATE ssize_t minix3_file_read(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *p;             /* Writing pointer.      */
+	size_t blkoff;       /* Block offset.         */
+	size_t chunk;        /* Data chunk size.      */
+	block_t blk;         /* Working block number. */
+	struct buffer *bbuf; /* Working block buffer. */
+
+	p = buf;
+
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		blk = minix3_block_map(i, off, 0);
+
+		/* End of file reached. */
+		if (blk == BLOCK_NULL)
+			break;
+
+		bbuf = bread(i->dev, blk);
+
+		blkoff = off % MINIX3_BLOCK_SIZE;
+
+		/* Calculate read chunk size. */
+		chunk = (n < MINIX3_BLOCK_SIZE - blkoff) ? n : MINIX3_BLOCK_SIZE - blkoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+
+		kmemcpy(p, (char *)buffer_data(bbuf) + blkoff, chunk);
+		brelse(bbuf);
+
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+	}
+
+	return ((ssize_t)(p - (char *)buf));
+}
+
+/**
+ * @brief Writes to a regular file.
+ */
+PRIVATE ssize_t minix3_file_write
+(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	const char *p;       /* Reading pointer.      */
+	size_t blkoff;       /* Block offset.         */
+	size_t chunk;        /* Data chunk size.      */
+	block_t blk;         /* Working block number. */
+	struct buffer *bbuf; /* Working block buffer. */
+
+	p = buf;
+
+	/* Write data. */
+	while (n > 0)
+	{
+		blk = minix3_block_map(i, off, 1);
+
+		/* End of file reached. */
+		if (blk == BLOCK_NULL)
+			break;
+
+		bbuf = bread(i->dev, blk);
+
+		blkoff = off % MINIX3_BLOCK_SIZE;
+
+		chunk = (n < MINIX3_BLOCK_SIZE - blkoff) ? n : MINIX3_BLOCK_SIZE - blkoff;
+		kmemcpy((char *)buffer_data(bbuf) + blkoff, p, chunk);
+		buffer_dirty(bbuf, 1);
+		brelse(bbuf);
+
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+
+		/* Update file size. */
+		if (off > i->size)
+		{
+			i->size = off;
+			i->flags |= INODE_DIRTY;
+		}
+	}
+
+	return ((ssize_t)(p - (const char *)buf));
+}
+
+/**
+ * @brief Searches for an on-disk directory entry.
+ *
+ * @details Searches for a directory entry named @p filename in the directory
+ *          pointed to be @p dip. If @p create is not zero and such entry does
+ *          not exist, a free entry is handed out instead.
+ *
+ * @param dip      Directory where the directory entry shall be searched.
+ * @param filename Name of the directory entry that shall be searched.
+ * @param buf      Buffer where the directory entry is loaded.
+ * @param create   Create directory entry?
+ *
+ * @returns Upon successful completion, the directory entry is returned. In this
+ *          case, @p buf is set to point to the (locked) buffer associated to
+ *          the requested directory entry. However, upon failure, a #NULL
+ *          pointer is returned instead.
+ *
+ * @note @p dip must be locked.
+ */
+PRIVATE struct d_dirent3 *minix3_dirent_find
+(struct inode *dip, const char *filename, struct buffer **buf, int create)
+{
+	int entry;           /* Index of first free directory entry. */
+	int nentries;        /* Number of directory entries.         */
+	block_t blk;         /* Working block number.                */
+	struct d_dirent3 *d; /* Directory entry.                     */
+
+	nentries = dip->size/sizeof(struct d_dirent3);
+	entry = -1;
+
+	/* Search directory entry. */
+	for (int i = 0; i < nentries; i += DIRENTS_PER_ZONE)
+	{
+		/*
+		 * Skip invalid blocks. As directory entries
+		 * are removed from a directory, a whole block
+		 * may become free.
+		 */
+		blk = minix3_block_map(dip, i*sizeof(struct d_dirent3), 0);
+		if (blk == BLOCK_NULL)
+			continue;
+
+		*buf = bread(dip->dev, blk);
+		d = buffer_data(*buf);
+
+		for (int j = i; (j < nentries) && (j < i + (int)DIRENTS_PER_ZONE); j++, d++)
+		{
+			/* Remember entry index. */
+			if (d->d_ino == INODE_NULL)
+			{
+				if (entry < 0)
+					entry = j;
+				continue;
+			}
+
+			/* Found. */
+			if (!kstrncmp(d->d_name, filename, MINIX3_NAME_MAX))
+			{
+				/* Duplicated entry. */
+				if (create)
+				{
+					brelse(*buf);
+					*buf = NULL;
+					curr_proc->errno = -EEXIST;
+					return (NULL);
+				}
+
+				return (d);
+			}
+		}
+
+		brelse(*buf);
+	}
+
+	*buf = NULL;
+
+	/* Not found. */
+	if (!create)
+		return (NULL);
+
+	/* Expand directory. */
+	if (entry < 0)
+	{
+		entry = nentries;
+
+		blk = minix3_block_map(dip, entry*sizeof(struct d_dirent3), 1);
+
+		/* Failed to create entry. */
+		if (blk == BLOCK_NULL)
+		{
+			curr_proc->errno = -ENOSPC;
+			return (NULL);
+		}
+
+		dip->size += sizeof(struct d_dirent3);
+		inode_touch(dip);
+	}
+
+	else
+		blk = minix3_block_map(dip, entry*sizeof(struct d_dirent3), 0);
+
+	*buf = bread(dip->dev, blk);
+	d = &((struct d_dirent3 *)buffer_data(*buf))[entry%DIRENTS_PER_ZONE];
+
+	return (d);
+}
+
+/**
+ * @brief Searches for a directory entry.
+ *
+ * @details The on-disk entry is translated into a #d_dirent, so no buffer is
+ *          returned in @p buf and the returned entry is only valid until the
+ *          next search. Entries are created by minix3_dir_add(), so @p create
+ *          is ignored.
+ */
+PRIVATE struct d_dirent *minix3_dirent_search
+(struct inode *dip, const char *filename, struct buffer **buf, int create)
+{
+	PRIVATE struct d_dirent d; /* Found entry.   */
+	struct d_dirent3 *d3;      /* On-disk entry. */
+
+	UNUSED(create);
+
+	if ((d3 = minix3_dirent_find(dip, filename, buf, 0)) == NULL)
+		return (NULL);
+
+	d.d_ino = d3->d_ino;
+	kstrncpy(d.d_name, d3->d_name, NAME_MAX);
+
+	brelse(*buf);
+	*buf = NULL;
+
+	return (&d);
+}
+
+/**
+ * @brief Reads a directory.
+ *
+ * @details Entries are handed out as #d_dirent, so @p off counts entries of
+ *          that size rather than bytes of the directory. Only whole entries
+ *          are read.
+ */
+PRIVATE ssize_t minix3_dir_read(struct inode *ip, void *buf, size_t n, off_t off)
+{
+	unsigned idx;         /* Working entry index.  */
+	block_t blk;          /* Working block number. */
+	struct d_dirent *d;   /* Working entry.        */
+	struct d_dirent3 *d3; /* On-disk entry.        */
+	struct buffer *bbuf;  /* Working block buffer. */
+
+	d = buf;
+	idx = off/sizeof(struct d_dirent);
+
+	while ((n >= sizeof(struct d_dirent)) && (idx < ip->size/sizeof(struct d_dirent3)))
+	{
+		blk = minix3_block_map(ip, idx*sizeof(struct d_dirent3), 0);
+
+		/* Hole. */
+		if (blk == BLOCK_NULL)
+		{
+			kmemset(d, 0, sizeof(struct d_dirent));
+			d++; idx++;
+			n -= sizeof(struct d_dirent);
+			continue;
+		}
+
+		bbuf = bread(ip->dev, blk);
+		d3 = &((struct d_dirent3 *)buffer_data(bbuf))[idx%DIRENTS_PER_ZONE];
+
+		/* Translate entries of this block. */
+		do
+		{
+			d->d_ino = d3->d_ino;
+			kstrncpy(d->d_name, d3->d_name, NAME_MAX);
+			d++; d3++; idx++;
+			n -= sizeof(struct d_dirent);
+		} while ((n >= sizeof(struct d_dirent)) && (idx%DIRENTS_PER_ZONE)
+			&& (idx < ip->size/sizeof(struct d_dirent3)));
+
+		brelse(bbuf);
+	}
+
+	return ((ssize_t)((char *)d - (char *)buf));
+}
+
+/**
+ * @brief Adds an entry to a directory.
+ */
+PRIVATE int minix3_dir_add
+(struct inode *dinode, struct inode *inode, const char *name)
+{
+	struct buffer *buf;  /* Block buffer.         */
+	struct d_dirent3 *d; /* Disk directory entry. */
+
+	d = minix3_dirent_find(dinode, name, &buf, 1);
+
+	/* Failed to create directory entry. */
+	if (d == NULL)
+		return (-1);
+
+	kmemset(d->d_name, 0, MINIX3_NAME_MAX);
+	kstrncpy(d->d_name, name, NAME_MAX);
+	d->d_ino = inode->num;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	return (0);
+}
+
+/**
+ * @brief Removes an entry from a directory.
+ */
+PRIVATE int minix3_dir_remove(struct inode *dinode, const char *filename)
+{
+	struct buffer *buf;  /* Block buffer.    */
+	struct d_dirent3 *d; /* Directory entry. */
+	struct inode *file;  /* File inode.      */
+
+	d = minix3_dirent_find(dinode, filename, &buf, 0);
+
+	/* Not found. */
+	if (d == NULL)
+		return (-ENOENT);
+
+	/* Cannot remove '.' */
+	if (d->d_ino == dinode->num)
+	{
+		brelse(buf);
+		return (-EBUSY);
+	}
+
+	file = inode_get(dinode->dev, d->d_ino);
+
+	/* Failed to get file's inode. */
+	if (file == NULL)
+	{
+		brelse(buf);
+		return (-ENOENT);
+	}
+
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			brelse(buf);
+			return (-EPERM);
+		}
+
+		/* Directory not empty. */
+		if ((file->size/sizeof(struct d_dirent3)) > 2)
+		{
+			inode_put(file);
+			brelse(buf);
+			return (-EBUSY);
+		}
+	}
+
+	/* Remove directory entry. */
+	d->d_ino = INODE_NULL;
+
+	buffer_dirty(buf, 1);
+	inode_touch(dinode);
+	file->nlinks--;
+	inode_touch(file);
+	inode_put(file);
+	brelse(buf);
+
+	return (0);
+}
+
+/**
+ * @brief Minix V3 inode operations.
+ */
+PRIVATE struct inode_operations minix3_iops =
+{
+	&minix3_dir_read,
+	&minix3_dir_add,
+	&minix3_dir_remove,
+	&minix3_file_read,
+	&minix3_file_write,
+	&minix3_dirent_search,
+	&minix3_block_map
+};
+
+/*============================================================================*
+ *                                  Inodes                                    *
+ *============================================================================*/
+
+/**
+ * @brief Gets the device block that holds a disk inode.
+ */
+PRIVATE block_t minix3_inode_block(struct superblock *sb, ino_t num)
+{
+	return (ITABLE(sb) + (num - 1)/INODES_PER_ZONE);
+}
+
+/**
+ * @brief Writes an inode to disk.
+ *
+ * @note The inode must be locked.
+ */
+PRIVATE void minix3_inode_write(struct inode *ip)
+{
+	struct buffer *buf;    /* Buffer.      */
+	struct d_inode3 *d_i;  /* Disk inode.  */
+	struct superblock *sb; /* Super block. */
+
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY))
+		return;
+
+	superblock_lock(sb = ip->sb);
+
+	buf = bread(ip->dev, minix3_inode_block(sb, ip->num));
+	d_i = &((struct d_inode3 *)buffer_data(buf))[(ip->num - 1)%INODES_PER_ZONE];
+
+	/* Write inode to buffer. */
+	d_i->i_mode = ip->mode;
+	d_i->i_nlinks = ip->nlinks;
+	d_i->i_uid = ip->uid;
+	d_i->i_gid = ip->gid;
+	d_i->i_size = ip->size;
+	d_i->i_atime = ip->time;
+	d_i->i_mtime = ip->time;
+	d_i->i_ctime = ip->time;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		d_i->i_zones[i] = ip->blocks[i];
+	ip->flags &= ~INODE_DIRTY;
+	buffer_dirty(buf, 1);
+
+	brelse(buf);
+	superblock_unlock(sb);
+}
+
+/**
+ * @brief Reads an inode from the disk.
+ *
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ */
+PRIVATE int minix3_inode_read(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct buffer *buf;    /* Buffer.      */
+	struct d_inode3 *d_i;  /* Disk inode.  */
+	struct superblock *sb; /* Super block. */
+
+	if ((sb = superblock_get(dev)) == NULL)
+		return (1);
+
+	/* Invalid inode number. */
+	if ((num == INODE_NULL) || (num > sb->ninodes))
+		goto error0;
+
+	buf = bread(dev, minix3_inode_block(sb, num));
+	d_i = &((struct d_inode3 *)buffer_data(buf))[(num - 1)%INODES_PER_ZONE];
+
+	/* Invalid disk inode. */
+	if (d_i->i_nlinks == 0)
+		goto error1;
+
+	/* Initialize in-core inode. */
+	ip->mode = d_i->i_mode;
+	ip->nlinks = d_i->i_nlinks;
+	ip->uid = d_i->i_uid;
+	ip->gid = d_i->i_gid;
+	ip->size = d_i->i_size;
+	ip->time = d_i->i_mtime;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		ip->blocks[i] = d_i->i_zones[i];
+	bmap_invalidate(ip);
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &minix3_iops;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+
+	brelse(buf);
+	superblock_put(sb);
+
+	return (0);
+
+error1:
+	brelse(buf);
+error0:
+	superblock_put(sb);
+	return (1);
+}
+
+/**
+ * @brief Frees an inode.
+ *
+ * @details Bit zero of the inode map is reserved, so inode @p n is tracked
+ *          by bit n.
+ *
+ * @note The inode must be locked.
+ */
+PRIVATE void minix3_inode_free(struct inode *ip)
+{
+	struct superblock *sb;
+
+	superblock_lock(sb = ip->sb);
+
+	bitmap_clear(buffer_data(sb->imap[ip->num/BITS_PER_ZONE]), ip->num%BITS_PER_ZONE);
+	buffer_dirty(sb->imap[ip->num/BITS_PER_ZONE], 1);
+	if (ip->num < sb->isearch)
+		sb->isearch = ip->num;
+	sb->flags |= SUPERBLOCK_DIRTY;
+
+	superblock_unlock(sb);
+}
+
+/**
+ * @brief Truncates an inode.
+ *
+ * @note The inode must be locked.
+ */
+PRIVATE void minix3_inode_truncate(struct inode *ip)
+{
+	struct superblock *sb;
+
+	superblock_lock(sb = ip->sb);
+
+	for (unsigned j = 0; j < MINIX3_NR_ZONES_DIRECT; j++)
+		minix3_zone_free(sb, ip->blocks[j], 0);
+	minix3_zone_free(sb, ip->blocks[MINIX3_ZONE_SINGLE], 1);
+	minix3_zone_free(sb, ip->blocks[MINIX3_ZONE_DOUBLE], 2);
+	for (unsigned j = 0; j < NR_ZONES; j++)
+		ip->blocks[j] = BLOCK_NULL;
+
+	superblock_unlock(sb);
+
+	bmap_invalidate(ip);
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ *
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ *
+ * @note The superblock must not be locked.
+ */
+PRIVATE int minix3_inode_alloc(struct superblock *sb, struct inode *ip)
+{
+	ino_t num;  /* Inode number.             */
+	bit_t bit;  /* Bit number in the bitmap. */
+	unsigned i; /* Working inode map block.  */
+
+	superblock_lock(sb);
+
+	/* Search for free inode. */
+	for (i = sb->isearch/BITS_PER_ZONE; i < sb->imap_blocks; i++)
+	{
+		bit = bitmap_first_free(buffer_data(sb->imap[i]), MINIX3_BLOCK_SIZE);
+
+		/* Found. */
+		if (bit != BITMAP_FULL)
+			goto found;
+	}
+
+	goto error0;
+
+found:
+
+	/* Past the last inode. */
+	if (i*BITS_PER_ZONE + bit > sb->ninodes)
+		goto error0;
+
+	num = i*BITS_PER_ZONE + bit;
+
+	/*
+	 * Remember inode number to
+	 * speedup next allocation.
+	 */
+	sb->isearch = num;
+
+	/* Allocate inode. */
+	bitmap_set(buffer_data(sb->imap[i]), bit);
+	buffer_dirty(sb->imap[i], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+
+	/*
+	 * Initialize inode.
+	 * mode will be initialized later.
+	 */
+	ip->nlinks = 1;
+	ip->uid = curr_proc->euid;
+	ip->gid = curr_proc->egid;
+	ip->size = 0;
+	for (unsigned j = 0; j < NR_ZONES; j++)
+		ip->blocks[j] = BLOCK_NULL;
+	bmap_invalidate(ip);
+	ip->dev = sb->dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	ip->i_op = &minix3_iops;
+	superblock_unlock(sb);
+
+	return (0);
+
+error0:
+	curr_proc->errno = -ENOSPC;
+	superblock_unlock(sb);
+	return (1);
+}
+
+/*============================================================================*
+ *                                Superblock                                  *
+ *============================================================================*/
+
+/**
+ * @brief Gets file system statistics.
+ *
+ * @details Free zones are reported in #BLOCK_SIZE units.
+ */
+PRIVATE void minix3_superblock_stat(struct superblock *sb, struct ustat *ubuf)
+{
+	unsigned tfree;  /* Total free zones.  */
+	unsigned tinode; /* Total free inodes. */
+
+	tfree = 0;
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		tfree += bitmap_nclear(buffer_data(sb->zmap[i]), MINIX3_BLOCK_SIZE);
+
+	tinode = 0;
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		tinode += bitmap_nclear(buffer_data(sb->imap[i]), MINIX3_BLOCK_SIZE);
+
+	kmemset(ubuf, 0, sizeof(struct ustat));
+	ubuf->f_tfree = tfree*(MINIX3_BLOCK_SIZE/BLOCK_SIZE);
+	ubuf->f_tinode = tinode;
+}
+
+/**
+ * @brief Releases the superblock.
+ *
+ * @details The device goes back to #BLOCK_SIZE blocks once the superblock is
+ *          no longer in use.
+ */
+PRIVATE void minix3_superblock_put(struct superblock *sb)
+{
+	superblock_put_minix(sb);
+
+	if ((sb->count == 0) && (bsetsize(sb->dev, BLOCK_SIZE)))
+		kprintf("minix3: cannot restore block size of device %x", sb->dev);
+}
+
+/**
+ * @brief Minix V3 file system operations.
+ *
+ * @details The inode and zone maps are pinned in the superblock the same way
+ *          as in Minix V1, so the superblock is written back and released by
+ *          the Minix V1 routines.
+ */
+PRIVATE struct super_operations minix3_sops =
+{
+	&minix3_inode_read,      /* inode_read      */
+	&minix3_inode_write,     /* inode_write     */
+	&minix3_inode_free,      /* inode_free      */
+	&minix3_inode_truncate,  /* inode_truncate  */
+	&minix3_inode_alloc,     /* inode_alloc     */
+	NULL,                    /* notify_change   */
+	NULL,                    /* put inode       */
+	&minix3_superblock_put,  /* put_super       */
+	&superblock_write_minix, /* write_super     */
+	&minix3_superblock_stat, /* superblock_stat */
+	NULL,                    /* remount_fs      */
+	&minix3_inode_block      /* inode_block     */
+};
+
+/**
+ * @brief Reads the superblock.
+ *
+ * @details The device is switched to zone-sized blocks first, and the
+ *          superblock is read from the first zone.
+ *
+ * @returns A pointer to @p sb, locked, if @p dev holds a Minix V3 file
+ *          system, and NULL otherwise.
+ */
+PRIVATE struct superblock *minix3_superblock_read(dev_t dev, struct superblock *sb)
+{
+	struct buffer *buf;         /* Buffer disk superblock. */
+	struct d_superblock3 *d_sb; /* Disk superblock.        */
+
+	/* Device is busy. */
+	if (bsetsize(dev, MINIX3_BLOCK_SIZE))
+	{
+		kprintf("minix3: cannot set block size of device %x", dev);
+		return (NULL);
+	}
+
+	buf = bread(dev, 0);
+	d_sb = (struct d_superblock3 *)((char *)buffer_data(buf) + MINIX3_SUPER_OFF);
+
+	/* Not ours. */
+	if (d_sb->s_magic != SUPER_MAGIC_V3)
+		goto error0;
+
+	/* Unsupported geometry. */
+	if ((d_sb->s_block_size != MINIX3_BLOCK_SIZE) || (d_sb->s_log_zone_size != 0))
+	{
+		kprintf("minix3: unsupported block size");
+		goto error0;
+	}
+
+	/* Inode numbers do not fit. */
+	if (d_sb->s_ninodes > 0xffff)
+	{
+		kprintf("minix3: too many inodes");
+		goto error0;
+	}
+
+	/* Too many blocks in the inode/zone map. */
+	if ((d_sb->s_imap_nblocks > IMAP_SIZE) || (d_sb->s_bmap_nblocks > ZMAP_SIZE))
+	{
+		kprintf("minix3: too many blocks in the inode/zone map");
+		goto error0;
+	}
+
+	/* Initialize superblock. */
+	sb->buf = buf;
+	sb->ninodes = d_sb->s_ninodes;
+	sb->imap_blocks = d_sb->s_imap_nblocks;
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		blkunlock(sb->imap[i] = bread(dev, 2 + i));
+	sb->zmap_blocks = d_sb->s_bmap_nblocks;
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		blkunlock(sb->zmap[i] = bread(dev, 2 + sb->imap_blocks + i));
+	sb->first_data_block = d_sb->s_first_data_block;
+	sb->max_size = (d_sb->s_max_size > MINIX3_MAX_SIZE) ?
+		MINIX3_MAX_SIZE : (off_t)d_sb->s_max_size;
+	sb->zones = d_sb->s_nblocks;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = 0;
+	sb->zsearch = d_sb->s_first_data_block;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = &minix3_sops;
+
+	blkunlock(buf);
+
+	return (sb);
+
+error0:
+	brelse(buf);
+	bsetsize(dev, BLOCK_SIZE);
+	return (NULL);
+}
+
+/**
+ * @brief Minix V3 file system.
+ */
+PRIVATE struct file_system_type fs_minix3 = {
+	minix3_superblock_read,
+	&minix3_sops,
+	"minix3",
+	0
+};
+
+/*============================================================================*
+ *                                    mkfs                                    *
+ *============================================================================*/
+
+/**
+ * @brief Initializes an inode or zone map.
+ *
+ * @details Bit zero and the bits past the last object are marked as in use,
+ *          so that they are never handed out.
+ *
+ * @param dev    Target device.
+ * @param first  First zone of the map.
+ * @param nzones Number of zones in the map.
+ * @param nbits  Number of valid bits, including the reserved one.
+ */
+PRIVATE void minix3_map_init
+(dev_t dev, block_t first, unsigned nzones, unsigned nbits)
+{
+	struct buffer *buf;
+
+	for (unsigned i = 0; i < nzones; i++)
+	{
+		buf = bread(dev, first + i);
+		kmemset(buffer_data(buf), 0, MINIX3_BLOCK_SIZE);
+		for (unsigned j = 0; j < BITS_PER_ZONE; j++)
+		{
+			if ((i*BITS_PER_ZONE + j == 0) || (i*BITS_PER_ZONE + j >= nbits))
+				bitmap_set(buffer_data(buf), j);
+		}
+		buffer_dirty(buf, 1);
+		brelse(buf);
+	}
+}
+
+/**
+ * @brief Creates a Minix V3 file system.
+ *
+ * @param diskfile Device file on which the file system is created.
+ * @param ninodes  Number of inodes.
+ * @param nzones   Number of 4 KB zones of the file system.
+ * @param uid      User ID of the owner of the root directory.
+ * @param gid      Group ID of the owner of the root directory.
+ *
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ */
+PUBLIC int minix3_mkfs
+(const char *diskfile, uint16_t ninodes, uint32_t nzones, uint16_t uid, uint16_t gid)
+{
+	dev_t dev;                  /* Underlying device.       */
+	struct inode *ip;           /* Device inode.            */
+	struct buffer *buf;         /* Working buffer.          */
+	struct d_superblock3 *d_sb; /* Disk superblock.         */
+	struct d_inode3 *d_i;       /* Root inode.              */
+	struct d_dirent3 *d;        /* Root directory entries.  */
+	unsigned imap_nblocks;      /* Inode map blocks.        */
+	unsigned zmap_nblocks;      /* Zone map blocks.         */
+	unsigned inode_nblocks;     /* Inode blocks.            */
+	zone3_t first;              /* First data zone.         */
+
+	ip = inode_name(diskfile);
+
+	/* Problem with device inode. */
+	if (ip == NULL)
+	{
+		kprintf("minix3: device inode not found");
+		return (1);
+	}
+
+	/* Not a device. */
+	if (!S_ISCHR(ip->mode) && !S_ISBLK(ip->mode))
+	{
+		inode_put(ip);
+		kprintf("minix3: not a device");
+		return (1);
+	}
+	dev = ip->blocks[0];
+	inode_put(ip);
+
+	/* Compute dimensions of file system. */
+	#define NBLOCKS(x, y) (((x) + (y) - 1)/(y))
+	imap_nblocks = NBLOCKS(ninodes + 1, MINIX3_BLOCK_SIZE << 3);
+	zmap_nblocks = NBLOCKS(nzones, MINIX3_BLOCK_SIZE << 3);
+	inode_nblocks = NBLOCKS(ninodes, MINIX3_BLOCK_SIZE/sizeof(struct d_inode3));
+	first = 2 + imap_nblocks + zmap_nblocks + inode_nblocks;
+
+	/* Does not fit. */
+	if ((ninodes == 0) || (first >= nzones) ||
+		(imap_nblocks > IMAP_SIZE) || (zmap_nblocks > ZMAP_SIZE))
+	{
+		kprintf("minix3: bad file system dimensions");
+		return (1);
+	}
+
+	/* Device is busy. */
+	if (bsetsize(dev, MINIX3_BLOCK_SIZE))
+	{
+		kprintf("minix3: cannot set block size of device %x", dev);
+		return (1);
+	}
+
+	/* Clean up boot block, superblock and inodes. */
+	for (block_t i = 0; i < first; i++)
+	{
+		buf = bread(dev, i);
+		kmemset(buffer_data(buf), 0, MINIX3_BLOCK_SIZE);
+		buffer_dirty(buf, 1);
+		brelse(buf);
+	}
+
+	/* Superblock. */
+	buf = bread(dev, 0);
+	d_sb = (struct d_superblock3 *)((char *)buffer_data(buf) + MINIX3_SUPER_OFF);
+	d_sb->s_ninodes = ninodes;
+	d_sb->s_imap_nblocks = imap_nblocks;
+	d_sb->s_bmap_nblocks = zmap_nblocks;
+	d_sb->s_first_data_block = first;
+	d_sb->s_log_zone_size = 0;
+	d_sb->s_max_size = MINIX3_MAX_SIZE;
+	d_sb->s_nblocks = nzones;
+	d_sb->s_magic = SUPER_MAGIC_V3;
+	d_sb->s_block_size = MINIX3_BLOCK_SIZE;
+	d_sb->s_disk_version = 0;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	/* Inode and zone maps. */
+	minix3_map_init(dev, 2, imap_nblocks, ninodes + 1);
+	minix3_map_init(dev, 2 + imap_nblocks, zmap_nblocks, nzones - first + 1);
+
+	/* Root inode and its zone. */
+	buf = bread(dev, 2 + imap_nblocks);
+	bitmap_set(buffer_data(buf), 1);
+	buffer_dirty(buf, 1);
+	brelse(buf);
+	buf = bread(dev, 2);
+	bitmap_set(buffer_data(buf), INODE_ROOT);
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	buf = bread(dev, 2 + imap_nblocks + zmap_nblocks);
+	d_i = &((struct d_inode3 *)buffer_data(buf))[INODE_ROOT - 1];
+	d_i->i_mode = S_IFDIR | S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+	d_i->i_nlinks = 2;
+	d_i->i_uid = uid;
+	d_i->i_gid = gid;
+	d_i->i_size = 2*sizeof(struct d_dirent3);
+	d_i->i_atime = d_i->i_mtime = d_i->i_ctime = CURRENT_TIME;
+	d_i->i_zones[0] = first;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	buf = bread(dev, first);
+	kmemset(buffer_data(buf), 0, MINIX3_BLOCK_SIZE);
+	d = buffer_data(buf);
+	d[0].d_ino = INODE_ROOT;
+	kstrcpy(d[0].d_name, ".");
+	d[1].d_ino = INODE_ROOT;
+	kstrcpy(d[1].d_name, "..");
+	buffer_dirty(buf, 1);
+	brelse(buf);
+
+	/* Written back on the way. */
+	if (bsetsize(dev, BLOCK_SIZE))
+		kprintf("minix3: cannot restore block size of device %x", dev);
+
+	return (0);
+}
+
+/**
+ * @brief Registers the Minix V3 file system.
+ */
+PUBLIC void init_minix3(void)
+{
+	if (fs_register(MINIX3, &fs_minix3))
+		kpanic("Failed to register minix3 file system");
+}
@@ -32,7 +32,7 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 	r = buf;
 	
 	/* No writers. */
-	wakeup(&inode->chain);
+	wq_wakeup_all(&inode->chain);
 	if (inode->count != 2)
 		return (0);
 	
@@ -43,11 +43,11 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 		while (inode->head == inode->tail)
 		{
 			/* No writers. */
-			wakeup(&inode->chain);
+			wq_wakeup_all(&inode->chain);
 			if (inode->count != 2)
 				return (r - buf);
 				
-			sleep(&inode->chain, PRIO_INODE);
+			wq_sleep(&inode->chain, PRIO_INODE, WQ_SHARED);
 			
 			/* Awaken by a signal. */
 			if (issig())
@@ -60,7 +60,7 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 		
 		*r++ = inode->pipe[inode->tail];
 		inode->tail = (inode->tail + 1)%inode->size;
-		wakeup(&inode->chain);
+		wq_wakeup_all(&inode->chain);
 	}
 	
 	return (r - buf);
@@ -77,7 +77,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 	w = buf;
 	
 	/* No readers. */
-	wakeup(&inode->chain);
+	wq_wakeup_all(&inode->chain);
 	if (inode->count != 2)
 	{
 		curr_proc->errno = -EPIPE;
@@ -92,7 +92,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 		while ((inode->head + 1)%inode->size == inode->tail)
 		{
 			/* No readers. */
-			wakeup(&inode->chain);
+			wq_wakeup_all(&inode->chain);
 			if (inode->count != 2)
 			{
 				curr_proc->errno = -EPIPE;
@@ -100,7 +100,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 				return (-1);
 			}
 	
-			sleep(&inode->chain, PRIO_INODE);
+			wq_sleep(&inode->chain, PRIO_INODE, WQ_SHARED);
 			
 			/* Awaken by a signal. */
 			if (issig())
@@ -112,7 +112,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 		
 		inode->pipe[inode->head] = *w++;
 		inode->head = (inode->head + 1)%inode->size;
-		wakeup(&inode->chain);
+		wq_wakeup_all(&inode->chain);
 	}
 	
 	return (w - buf);
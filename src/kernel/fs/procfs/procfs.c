@@ -0,0 +1,865 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Process file system.
+ *
+ * @details The process file system exports kernel state as plain text files
+ *          that are generated when they are read, so looking at them costs
+ *          neither buffer cache slots nor disk I/O. The root directory holds
+ *          system-wide files and one directory per process, named after its
+ *          process ID.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <ustat.h>
+
+#include "../fs.h"
+#include "procfs.h"
+
+/**
+ * @name Inode numbers
+ */
+/**@{*/
+#define PROCFS_INO_ROOT INODE_ROOT /**< Root directory.          */
+#define PROCFS_INO_FILE          2 /**< First top-level file.    */
+#define PROCFS_INO_PID      0x1000 /**< First per-process inode. */
+/**@}*/
+
+/**
+ * @brief Builds the inode number of a per-process entry.
+ *
+ * @details Processes are numbered by their slot in the process table,
+ *          since process IDs are never reused and would soon outgrow inode
+ *          numbers. Entry zero is the process directory itself, and entry
+ *          i > 0 is the i-th file in it.
+ */
+#define PROCFS_INO(p, entry) \
+	(PROCFS_INO_PID + (((p) - IDLE) << 2) + (entry))
+
+/**
+ * @brief Gets the process table slot of a per-process inode.
+ */
+#define PROCFS_INO_SLOT_OF(num) \
+	(((num) - PROCFS_INO_PID) >> 2)
+
+/**
+ * @brief Gets the entry of a per-process inode.
+ */
+#define PROCFS_INO_ENTRY_OF(num) \
+	(((num) - PROCFS_INO_PID) & 3)
+
+/**
+ * @brief Maximum length of a generated line.
+ */
+#define PROCFS_LINE_MAX 128
+
+/**
+ * @brief Output buffer of a generated file.
+ */
+struct procfs_buf
+{
+	char *data;  /**< Underlying data. */
+	size_t size; /**< Buffer size.     */
+	size_t len;  /**< Bytes written.   */
+};
+
+/**
+ * @brief Synthetic file.
+ */
+struct procfs_file
+{
+	const char *name;                                    /**< File name. */
+	void (*show)(struct procfs_buf *, struct process *); /**< Generator. */
+};
+
+/* Forward definitions. */
+PRIVATE void show_buffers(struct procfs_buf *, struct process *);
+PRIVATE void show_inodes(struct procfs_buf *, struct process *);
+PRIVATE void show_meminfo(struct procfs_buf *, struct process *);
+PRIVATE void show_mounts(struct procfs_buf *, struct process *);
+PRIVATE void show_interrupts(struct procfs_buf *, struct process *);
+PRIVATE void show_sched(struct procfs_buf *, struct process *);
+PRIVATE void show_status(struct procfs_buf *, struct process *);
+PRIVATE void show_maps(struct procfs_buf *, struct process *);
+
+/**
+ * @brief Top-level files.
+ */
+#define NR_ROOT_FILES 6
+PRIVATE const struct procfs_file root_files[NR_ROOT_FILES] = {
+	{ "buffers",    &show_buffers    },
+	{ "inodes",     &show_inodes     },
+	{ "meminfo",    &show_meminfo    },
+	{ "mounts",     &show_mounts     },
+	{ "interrupts", &show_interrupts },
+	{ "sched",      &show_sched      }
+};
+
+/**
+ * @brief Per-process files (at most three).
+ */
+#define NR_PID_FILES 2
+PRIVATE const struct procfs_file pid_files[NR_PID_FILES] = {
+	{ "status", &show_status },
+	{ "maps",   &show_maps   }
+};
+
+/**
+ * @brief Process state names.
+ */
+PRIVATE const char *states[] = {
+	"dead", "zombie", "running", "ready", "waiting", "sleeping", "stopped"
+};
+
+/*============================================================================*
+ *                                 Generators                                 *
+ *============================================================================*/
+
+/**
+ * @brief Appends formatted text to a generated file.
+ *
+ * @param b   Target buffer.
+ * @param fmt Formatted string.
+ *
+ * @details Output that does not fit in the buffer is silently dropped.
+ */
+PRIVATE void procfs_printf(struct procfs_buf *b, const char *fmt, ...)
+{
+	size_t n;                    /* Characters to append. */
+	va_list args;                /* Variable arguments.   */
+	char line[PROCFS_LINE_MAX];  /* Formatted line.       */
+
+	va_start(args, fmt);
+	n = kvsprintf(line, fmt, args);
+	va_end(args);
+
+	n = KMIN(n, b->size - b->len);
+	kmemcpy(&b->data[b->len], line, n);
+	b->len += n;
+}
+
+/**
+ * @brief Converts nanoseconds to milliseconds.
+ */
+#define NS_TO_MS(ns) ((unsigned)((ns)/(NSEC_PER_SEC/1000)))
+
+/**
+ * @brief Generates block buffer cache statistics.
+ */
+PRIVATE void show_buffers(struct procfs_buf *b, struct process *p)
+{
+	struct buffer_stats st;
+
+	UNUSED(p);
+
+	bstat(&st);
+	procfs_printf(b, "buffers:\t%d\n", st.nbuffers);
+	procfs_printf(b, "valid:\t%d\n", st.valid);
+	procfs_printf(b, "dirty:\t%d\n", st.dirty);
+	procfs_printf(b, "busy:\t%d\n", st.busy);
+	procfs_printf(b, "hits:\t%d\n", st.hits);
+	procfs_printf(b, "misses:\t%d\n", st.misses);
+	procfs_printf(b, "writes:\t%d\n", st.writes);
+	procfs_printf(b, "dax:\t%d\n", st.ndirect);
+	procfs_printf(b, "mapped:\t%d\n", st.direct);
+}
+
+/**
+ * @brief Generates inode cache statistics.
+ */
+PRIVATE void show_inodes(struct procfs_buf *b, struct process *p)
+{
+	struct inode_stats st;
+
+	UNUSED(p);
+
+	inode_stats(&st);
+	procfs_printf(b, "inodes:\t%d\n", st.ninodes);
+	procfs_printf(b, "valid:\t%d\n", st.valid);
+	procfs_printf(b, "dirty:\t%d\n", st.dirty);
+	procfs_printf(b, "pipes:\t%d\n", st.pipes);
+	procfs_printf(b, "hits:\t%d\n", st.hits);
+	procfs_printf(b, "misses:\t%d\n", st.misses);
+}
+
+/**
+ * @brief Generates memory usage statistics.
+ */
+PRIVATE void show_meminfo(struct procfs_buf *b, struct process *p)
+{
+	struct mm_stats st;
+
+	UNUSED(p);
+
+	frame_stats(&st);
+	kpool_stats(&st);
+	procfs_printf(b, "page_size:\t%d\n", PAGE_SIZE);
+	procfs_printf(b, "frames:\t%d\n", st.frames);
+	procfs_printf(b, "frames_used:\t%d\n", st.frames_used);
+	procfs_printf(b, "frames_shared:\t%d\n", st.frames_shared);
+	procfs_printf(b, "kpages:\t%d\n", st.kpages);
+	procfs_printf(b, "kpages_used:\t%d\n", st.kpages_used);
+}
+
+/**
+ * @brief Generates the mount table.
+ *
+ * @details Each line holds the mounted device, the file system type and
+ *          the device and inode number of the mount point.
+ */
+PRIVATE void show_mounts(struct procfs_buf *b, struct process *p)
+{
+	const struct mounting_point *mp;
+
+	UNUSED(p);
+
+	for (int i = 0; i < NR_MOUNTING_POINT; i++)
+	{
+		if ((mp = mount_entry(i)) == NULL)
+			continue;
+
+		/* Root file system. */
+		if (mp->no_inode_mount < 0)
+		{
+			procfs_printf(b, "%x %s /\n", mp->dev, mp->fs->name);
+			continue;
+		}
+
+		procfs_printf(b, "%x %s %x:%d\n",
+			mp->dev, mp->fs->name, mp->dev_r, mp->no_inode_mount);
+	}
+}
+
+/**
+ * @brief Generates interrupt counters.
+ */
+PRIVATE void show_interrupts(struct procfs_buf *b, struct process *p)
+{
+	UNUSED(p);
+
+	for (int i = 0; i < NR_HWINT; i++)
+		procfs_printf(b, "%d:\t%d\n", i, hwint_counts[i]);
+}
+
+/**
+ * @brief Generates scheduler counters.
+ */
+PRIVATE void show_sched(struct procfs_buf *b, struct process *p)
+{
+	unsigned count[PROC_STOPPED + 1]; /* Processes in each state. */
+
+	UNUSED(p);
+
+	kmemset(count, 0, sizeof(count));
+	for (p = IDLE; p <= LAST_PROC; p++)
+	{
+		if (IS_VALID(p) && (p->state <= PROC_STOPPED))
+			count[p->state]++;
+	}
+
+	procfs_printf(b, "uptime_ms:\t%d\n", NS_TO_MS(clock_ns()));
+	procfs_printf(b, "idle_ms:\t%d\n", NS_TO_MS(IDLE->utime + IDLE->ktime));
+	procfs_printf(b, "ticks:\t%d\n", ticks);
+	procfs_printf(b, "switches:\t%d\n", nswitches);
+	procfs_printf(b, "forks:\t%d\n", next_pid);
+	procfs_printf(b, "procs:\t%d\n", nprocs);
+	for (int i = PROC_ZOMBIE; i <= PROC_STOPPED; i++)
+		procfs_printf(b, "%s:\t%d\n", states[i], count[i]);
+}
+
+/**
+ * @brief Generates the status of a process.
+ */
+PRIVATE void show_status(struct procfs_buf *b, struct process *p)
+{
+	/* Charge time up to now. */
+	account(curr_proc, TRUE);
+
+	procfs_printf(b, "name:\t%s\n", p->name);
+	procfs_printf(b, "state:\t%s\n",
+		(p->state <= PROC_STOPPED) ? states[p->state] : "unknown");
+	procfs_printf(b, "pid:\t%d\n", p->pid);
+	procfs_printf(b, "ppid:\t%d\n", (p->father != NULL) ? p->father->pid : 0);
+	procfs_printf(b, "pgrp:\t%d\n", (p->pgrp != NULL) ? p->pgrp->pid : 0);
+	procfs_printf(b, "uid:\t%d\n", p->uid);
+	procfs_printf(b, "euid:\t%d\n", p->euid);
+	procfs_printf(b, "gid:\t%d\n", p->gid);
+	procfs_printf(b, "egid:\t%d\n", p->egid);
+	procfs_printf(b, "priority:\t%s%d\n",
+		(p->priority < 0) ? "-" : "", KMAX(p->priority, -p->priority));
+	procfs_printf(b, "nice:\t%s%d\n",
+		(p->nice < 0) ? "-" : "", KMAX(p->nice, -p->nice));
+	procfs_printf(b, "size:\t%d\n", p->size);
+	procfs_printf(b, "children:\t%d\n", p->nchildren);
+	procfs_printf(b, "utime_ms:\t%d\n", NS_TO_MS(p->utime));
+	procfs_printf(b, "ktime_ms:\t%d\n", NS_TO_MS(p->ktime));
+	procfs_printf(b, "minflt:\t%d\n", p->ru.minflt);
+	procfs_printf(b, "majflt:\t%d\n", p->ru.majflt);
+	procfs_printf(b, "cowflt:\t%d\n", p->ru.cowflt);
+	procfs_printf(b, "inblock:\t%d\n", p->ru.inblock);
+	procfs_printf(b, "oublock:\t%d\n", p->ru.oublock);
+	procfs_printf(b, "nvcsw:\t%d\n", p->ru.nvcsw);
+	procfs_printf(b, "nivcsw:\t%d\n", p->ru.nivcsw);
+	procfs_printf(b, "syscalls:\t%d\n", p->ru.nsyscalls);
+}
+
+/**
+ * @brief Generates the memory map of a process.
+ *
+ * @details Each line holds the address range, the access permissions, a
+ *          shared (s) or private (p) flag, the region name and, for regions
+ *          backed by a file, the device and inode number of that file.
+ */
+PRIVATE void show_maps(struct procfs_buf *b, struct process *p)
+{
+	addr_t start;          /* Start of the region. */
+	const char *name;      /* Region name.         */
+	struct region *reg;    /* Working region.      */
+	struct pregion *preg;  /* Working pregion.     */
+
+	for (int i = 0; i < NR_PREGIONS; i++)
+	{
+		preg = &p->pregs[i];
+
+		/* Unused region. */
+		if ((reg = preg->reg) == NULL)
+			continue;
+
+		if (preg == TEXT(p))
+			name = "text";
+		else if (preg == HEAP(p))
+			name = "heap";
+		else if (preg == STACK(p))
+			name = "stack";
+		else if (preg == SEMS(p))
+			name = "sems";
+		else
+			name = "data";
+
+		start = (reg->flags & REGION_DOWNWARDS) ?
+			preg->start - reg->size : preg->start;
+
+		procfs_printf(b, "%x-%x %c%c%c%c %s",
+			start,
+			start + reg->size,
+			(reg->mode & S_IRUSR) ? 'r' : '-',
+			(reg->mode & S_IWUSR) ? 'w' : '-',
+			(reg->mode & S_IXUSR) ? 'x' : '-',
+			(reg->flags & REGION_SHARED) ? 's' : 'p',
+			name
+		);
+
+		if (reg->file.inode != NULL)
+		{
+			procfs_printf(b, " %x:%d",
+				reg->file.inode->dev, reg->file.inode->num);
+		}
+
+		procfs_printf(b, "\n");
+	}
+}
+
+/*============================================================================*
+ *                               Directories                                  *
+ *============================================================================*/
+
+/**
+ * @brief Gets the process of a per-process inode.
+ *
+ * @param ip Per-process inode.
+ *
+ * @returns A pointer to the process, or NULL if it is gone. A process that
+ *          took over its slot afterwards is told apart by its ID.
+ */
+PRIVATE struct process *procfs_proc(const struct inode *ip)
+{
+	struct process *p;
+
+	p = &proctab[PROCFS_INO_SLOT_OF(ip->num)];
+
+	if ((!IS_VALID(p)) || (p->pid != ip->u.procfs_pid))
+		return (NULL);
+
+	return (p);
+}
+
+/**
+ * @brief Sets the name of a directory entry.
+ *
+ * @param d   Target directory entry.
+ * @param fmt Formatted name.
+ */
+PRIVATE void procfs_dname(struct d_dirent *d, const char *fmt, ...)
+{
+	va_list args;               /* Variable arguments. */
+	char name[PROCFS_LINE_MAX]; /* Formatted name.     */
+
+	va_start(args, fmt);
+	name[kvsprintf(name, fmt, args)] = '\0';
+	va_end(args);
+
+	kmemset(d->d_name, 0, MINIX_NAME_MAX);
+	kstrncpy(d->d_name, name, MINIX_NAME_MAX);
+}
+
+/**
+ * @brief Gets an entry of a directory.
+ *
+ * @param ip  Directory inode.
+ * @param idx Index of the entry.
+ * @param d   Where to store the entry.
+ *
+ * @returns Zero if the entry exists, and non-zero otherwise.
+ */
+PRIVATE int procfs_dirent(struct inode *ip, unsigned idx, struct d_dirent *d)
+{
+	struct process *p;
+
+	/* Dot entries. */
+	if (idx < 2)
+	{
+		d->d_ino = (idx == 0) ? ip->num : PROCFS_INO_ROOT;
+		procfs_dname(d, "%s", (idx == 0) ? "." : "..");
+		return (0);
+	}
+
+	idx -= 2;
+
+	/* Process directory. */
+	if (ip->num != PROCFS_INO_ROOT)
+	{
+		if (idx >= NR_PID_FILES)
+			return (-1);
+
+		/* Process is gone. */
+		if (procfs_proc(ip) == NULL)
+			return (-1);
+
+		d->d_ino = ip->num + 1 + idx;
+		procfs_dname(d, "%s", pid_files[idx].name);
+		return (0);
+	}
+
+	/* Top-level file. */
+	if (idx < NR_ROOT_FILES)
+	{
+		d->d_ino = PROCFS_INO_FILE + idx;
+		procfs_dname(d, "%s", root_files[idx].name);
+		return (0);
+	}
+
+	idx -= NR_ROOT_FILES;
+
+	/* Process directories. */
+	for (p = IDLE; p <= LAST_PROC; p++)
+	{
+		if (!IS_VALID(p))
+			continue;
+
+		if (idx-- == 0)
+		{
+			d->d_ino = PROCFS_INO(p, 0);
+			procfs_dname(d, "%d", p->pid);
+			return (0);
+		}
+	}
+
+	return (-1);
+}
+
+/**
+ * @brief Reads a directory.
+ *
+ * @details Only whole entries are read.
+ */
+PRIVATE ssize_t procfs_dir_read(struct inode *ip, void *buf, size_t n, off_t off)
+{
+	unsigned idx;      /* Working entry index. */
+	struct d_dirent *d; /* Working entry.       */
+
+	d = buf;
+	idx = off/sizeof(struct d_dirent);
+
+	while (n >= sizeof(struct d_dirent))
+	{
+		if (procfs_dirent(ip, idx++, d))
+			break;
+
+		d++;
+		n -= sizeof(struct d_dirent);
+	}
+
+	return ((ssize_t)((char *)d - (char *)buf));
+}
+
+/**
+ * @brief Searches for a directory entry.
+ *
+ * @details Entries are generated on the fly, so no buffer is returned in
+ *          @p buf and the returned entry is only valid until the next search.
+ */
+PRIVATE struct d_dirent *procfs_dirent_search
+(struct inode *ip, const char *filename, struct buffer **buf, int create)
+{
+	PRIVATE struct d_dirent d; /* Found entry. */
+
+	UNUSED(create);
+
+	*buf = NULL;
+
+	for (unsigned idx = 0; !procfs_dirent(ip, idx, &d); idx++)
+	{
+		if (!kstrncmp(d.d_name, filename, MINIX_NAME_MAX))
+			return (&d);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Directories are read-only.
+ */
+PRIVATE int procfs_dir_add(struct inode *dip, struct inode *ip, const char *name)
+{
+	UNUSED(dip);
+	UNUSED(ip);
+	UNUSED(name);
+
+	return (-EPERM);
+}
+
+/**
+ * @brief Directories are read-only.
+ */
+PRIVATE int procfs_dir_remove(struct inode *dip, const char *name)
+{
+	UNUSED(dip);
+	UNUSED(name);
+
+	return (-EPERM);
+}
+
+/*============================================================================*
+ *                                   Files                                    *
+ *============================================================================*/
+
+/**
+ * @brief Reads a file.
+ *
+ * @details The whole file is generated into a kernel page and the requested
+ *          chunk is copied out, so files are capped at one page.
+ */
+PRIVATE ssize_t procfs_file_read(struct inode *ip, void *buf, size_t n, off_t off)
+{
+	size_t chunk;                  /* Bytes copied out. */
+	struct process *p;             /* Target process.   */
+	struct procfs_buf b;           /* Generated file.   */
+	const struct procfs_file *f;   /* Synthetic file.   */
+
+	p = NULL;
+
+	/* Per-process file. */
+	if (ip->num >= PROCFS_INO_PID)
+	{
+		if ((p = procfs_proc(ip)) == NULL)
+		{
+			curr_proc->errno = -ESRCH;
+			return (-1);
+		}
+
+		f = &pid_files[PROCFS_INO_ENTRY_OF(ip->num) - 1];
+	}
+
+	/* Top-level file. */
+	else
+		f = &root_files[ip->num - PROCFS_INO_FILE];
+
+	if ((b.data = getkpg(0)) == NULL)
+	{
+		curr_proc->errno = -ENOMEM;
+		return (-1);
+	}
+
+	b.size = PAGE_SIZE;
+	b.len = 0;
+	f->show(&b, p);
+
+	chunk = 0;
+	if ((size_t)off < b.len)
+	{
+		chunk = KMIN(n, b.len - off);
+		kmemcpy(buf, &b.data[off], chunk);
+	}
+
+	putkpg(b.data);
+
+	return ((ssize_t)chunk);
+}
+
+/**
+ * @brief Files are read-only.
+ */
+PRIVATE ssize_t procfs_file_write
+(struct inode *ip, const void *buf, size_t n, off_t off)
+{
+	UNUSED(ip);
+	UNUSED(buf);
+	UNUSED(n);
+	UNUSED(off);
+
+	curr_proc->errno = -EPERM;
+	return (-1);
+}
+
+/**
+ * @brief Process file system inode operations.
+ */
+PRIVATE struct inode_operations procfs_iops =
+{
+	&procfs_dir_read,
+	&procfs_dir_add,
+	&procfs_dir_remove,
+	&procfs_file_read,
+	&procfs_file_write,
+	&procfs_dirent_search,
+	NULL
+};
+
+/*============================================================================*
+ *                          Inodes and Superblock                             *
+ *============================================================================*/
+
+/**
+ * @brief Reads an inode.
+ *
+ * @returns Zero if the inode exists, and non-zero otherwise.
+ */
+PRIVATE int procfs_inode_read(dev_t dev, ino_t num, struct inode *ip)
+{
+	mode_t mode;           /* File mode.      */
+	struct process *p;     /* Target process. */
+	struct superblock *sb; /* Superblock.     */
+
+	p = NULL;
+
+	/* Root directory. */
+	if (num == PROCFS_INO_ROOT)
+		mode = S_IFDIR | MAY_READ | MAY_EXEC;
+
+	/* Top-level file. */
+	else if ((num >= PROCFS_INO_FILE) && (num < PROCFS_INO_FILE + NR_ROOT_FILES))
+		mode = S_IFREG | MAY_READ;
+
+	/* Process directory or file. */
+	else if (num >= PROCFS_INO_PID)
+	{
+		if (PROCFS_INO_ENTRY_OF(num) > NR_PID_FILES)
+			return (-1);
+
+		if (PROCFS_INO_SLOT_OF(num) >= PROC_MAX)
+			return (-1);
+
+		p = &proctab[PROCFS_INO_SLOT_OF(num)];
+		if (!IS_VALID(p))
+			return (-1);
+
+		mode = (PROCFS_INO_ENTRY_OF(num) == 0) ?
+			S_IFDIR | MAY_READ | MAY_EXEC : S_IFREG | MAY_READ;
+	}
+
+	/* No such inode. */
+	else
+		return (-1);
+
+	if ((sb = superblock_get(dev)) == NULL)
+		return (-1);
+
+	ip->mode = mode;
+	ip->nlinks = (S_ISDIR(mode)) ? 2 : 1;
+	ip->uid = (p != NULL) ? p->uid : 0;
+	ip->gid = (p != NULL) ? p->gid : 0;
+	ip->size = 0;
+	ip->time = CURRENT_TIME;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &procfs_iops;
+	ip->u.procfs_pid = (p != NULL) ? p->pid : 0;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+
+	superblock_put(sb);
+
+	return (0);
+}
+
+/**
+ * @brief Nothing to write back.
+ */
+PRIVATE void procfs_inode_write(struct inode *ip)
+{
+	UNUSED(ip);
+}
+
+/**
+ * @brief Nothing to free.
+ */
+PRIVATE void procfs_inode_free(struct inode *ip)
+{
+	UNUSED(ip);
+}
+
+/**
+ * @brief Nothing to truncate.
+ */
+PRIVATE void procfs_inode_truncate(struct inode *ip)
+{
+	UNUSED(ip);
+}
+
+/**
+ * @brief Files cannot be created.
+ */
+PRIVATE int procfs_inode_alloc(struct superblock *sb, struct inode *ip)
+{
+	UNUSED(sb);
+	UNUSED(ip);
+
+	curr_proc->errno = -EPERM;
+	return (-1);
+}
+
+/**
+ * @brief Releases the superblock.
+ */
+PRIVATE void procfs_superblock_put(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+
+	if (--sb->count == 0)
+		sb->flags &= ~SUPERBLOCK_VALID;
+}
+
+/**
+ * @brief Nothing to write back.
+ */
+PRIVATE void procfs_superblock_write(struct superblock *sb)
+{
+	UNUSED(sb);
+}
+
+/**
+ * @brief There are neither free blocks nor free inodes.
+ */
+PRIVATE void procfs_superblock_stat(struct superblock *sb, struct ustat *ubuf)
+{
+	UNUSED(sb);
+
+	kmemset(ubuf, 0, sizeof(struct ustat));
+}
+
+/**
+ * @brief Process file system operations.
+ */
+PRIVATE struct super_operations procfs_sops =
+{
+	&procfs_inode_read,       /* inode_read     */
+	&procfs_inode_write,      /* inode_write    */
+	&procfs_inode_free,       /* inode_free     */
+	&procfs_inode_truncate,   /* inode_truncate */
+	&procfs_inode_alloc,      /* inode_alloc    */
+	NULL,                     /* notify_change  */
+	NULL,                     /* put inode      */
+	&procfs_superblock_put,   /* put_super      */
+	&procfs_superblock_write, /* write_super    */
+	&procfs_superblock_stat,  /* superblock_stat */
+	NULL,                     /* remount_fs     */
+	NULL                      /* inode_block    */
+};
+
+/**
+ * @brief Reads the superblock.
+ *
+ * @returns A pointer to @p sb if @p dev is the process file system device,
+ *          and NULL otherwise.
+ */
+PRIVATE struct superblock *procfs_superblock_read(dev_t dev, struct superblock *sb)
+{
+	/* Not ours. */
+	if (dev != PROC_DEV)
+		return (NULL);
+
+	sb->buf = NULL;
+	sb->ninodes = 0;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = 0;
+	sb->max_size = PAGE_SIZE;
+	sb->zones = 0;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~SUPERBLOCK_DIRTY;
+	sb->flags |= SUPERBLOCK_VALID | SUPERBLOCK_RDONLY;
+	sb->isearch = 0;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = &procfs_sops;
+
+	return (sb);
+}
+
+/**
+ * @brief Process file system.
+ */
+PRIVATE struct file_system_type fs_procfs = {
+	procfs_superblock_read,
+	&procfs_sops,
+	"proc",
+	FS_NODEV
+};
+
+/**
+ * @brief Registers the process file system.
+ */
+PUBLIC void init_procfs(void)
+{
+	if (fs_register(PROCFS, &fs_procfs))
+		kpanic("Failed to register process file system");
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Process file system.
+ */
+
+#ifndef _PROCFS_H_
+#define _PROCFS_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/dev.h>
+
+	/**
+	 * @brief Device number the process file system is mounted from.
+	 */
+	#define PROC_DEV DEVID(PROC_MAJOR, 0, CHRDEV)
+
+	/* Forward definitions. */
+	EXTERN void init_procfs(void);
+
+#endif /* _PROCFS_H_ */
@@ -259,6 +259,39 @@ PUBLIC struct superblock *superblock_read(dev_t dev)
 	return (sb);
 }
 
+/**
+ * @brief Probes a device for a file system.
+ *
+ * @details Asks the file system @p fs to read its superblock from the device
+ *          @p dev. This is used at mount time, before the device has an entry
+ *          in the mount table.
+ *
+ * @param dev Device number.
+ * @param fs  File system to probe for.
+ *
+ * @returns If the device holds such a file system, a pointer to the in-core
+ *          superblock is returned. The superblock is ensured to be locked in
+ *          this case. Otherwise, a NULL pointer is returned instead.
+ */
+PUBLIC struct superblock *superblock_probe(dev_t dev, struct file_system_type *fs)
+{
+	struct superblock *sb;
+
+	/* Get empty superblock. */
+	sb = superblock_empty();
+	if (sb == NULL)
+		return (NULL);
+
+	/* Not this file system. */
+	if (fs->superblock_read(dev, sb) == NULL)
+	{
+		superblock_unlock(sb);
+		return (NULL);
+	}
+
+	return (sb);
+}
+
 /**
  * @brief Synchronizes the superblock table.
  * 
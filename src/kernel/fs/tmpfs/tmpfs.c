@@ -0,0 +1,877 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Temporary file system.
+ *
+ * @details The temporary file system keeps files in kernel pages and
+ *          directories in an in-memory hash table, so it never goes through
+ *          the block buffer cache nor touches a disk. File reads and writes
+ *          copy straight between the pages of a file and the caller's
+ *          buffer. Contents last until the system is shut down.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @name File system parameters
+ */
+/**@{*/
+#define TMPFS_NR_NODES   256 /**< Number of nodes (inode zero is unused). */
+#define TMPFS_NR_DIRENTS 512 /**< Number of directory entries.            */
+#define TMPFS_HASH_SIZE  128 /**< Directory hash table size (2^x).        */
+#define TMPFS_MAX_PAGES 1024 /**< Maximum number of pages in use.         */
+#define TMPFS_NR_DIRECT    8 /**< Direct pages per file.                  */
+/**@}*/
+
+/* Error checking. */
+#if (TMPFS_HASH_SIZE & (TMPFS_HASH_SIZE - 1))
+	#error "TMPFS_HASH_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Number of pages mapped by the indirect page of a file.
+ */
+#define TMPFS_NR_INDIRECT (PAGE_SIZE/sizeof(char *))
+
+/**
+ * @brief Maximum file size (in bytes).
+ */
+#define TMPFS_MAX_SIZE ((TMPFS_NR_DIRECT + TMPFS_NR_INDIRECT)*PAGE_SIZE)
+
+/**
+ * @brief Directory entry.
+ */
+struct tmpfs_dirent
+{
+	ino_t dir;                       /**< Directory inode number.     */
+	ino_t ino;                       /**< File inode number.          */
+	char name[NAME_MAX];             /**< File name.                  */
+	struct tmpfs_dirent *hash_next;  /**< Next entry in the hash chain. */
+	struct tmpfs_dirent *next;       /**< Next entry in the directory.  */
+};
+
+/**
+ * @brief File system node.
+ *
+ * @details The in-core inode is authoritative while it is cached, and
+ *          its attributes are copied back here by tmpfs_inode_write().
+ */
+struct tmpfs_node
+{
+	int used;                       /**< Node in use?                */
+	mode_t mode;                    /**< Access permissions.         */
+	nlink_t nlinks;                 /**< Number of links.            */
+	uid_t uid;                      /**< Owner's user ID.            */
+	gid_t gid;                      /**< Owner's group ID.           */
+	off_t size;                     /**< File size (in bytes).       */
+	time_t time;                    /**< Last access time.           */
+	ino_t parent;                   /**< Parent directory.           */
+	char *direct[TMPFS_NR_DIRECT];  /**< Direct data pages.          */
+	char **indirect;                /**< Indirect page.              */
+	struct tmpfs_dirent *head;      /**< First directory entry.      */
+	struct tmpfs_dirent *tail;      /**< Last directory entry.       */
+};
+
+/**
+ * @brief File system nodes, indexed by inode number.
+ */
+PRIVATE struct tmpfs_node nodes[TMPFS_NR_NODES];
+
+/**
+ * @brief Directory entries.
+ */
+PRIVATE struct tmpfs_dirent dirents[TMPFS_NR_DIRENTS];
+
+/**
+ * @brief Free directory entries.
+ */
+PRIVATE struct tmpfs_dirent *free_dirents = NULL;
+
+/**
+ * @brief Directory entries hash table.
+ */
+PRIVATE struct tmpfs_dirent *hashtab[TMPFS_HASH_SIZE];
+
+/**
+ * @brief Number of pages in use.
+ */
+PRIVATE unsigned npages = 0;
+
+/*============================================================================*
+ *                                   Pages                                    *
+ *============================================================================*/
+
+/**
+ * @brief Allocates a clean page.
+ *
+ * @returns A pointer to the page, or NULL if the file system is full.
+ */
+PRIVATE void *tmpfs_getpg(void)
+{
+	void *pg;
+
+	if (npages >= TMPFS_MAX_PAGES)
+		return (NULL);
+
+	if ((pg = getkpg(1)) == NULL)
+		return (NULL);
+
+	npages++;
+
+	return (pg);
+}
+
+/**
+ * @brief Releases a page.
+ */
+PRIVATE void tmpfs_putpg(void *pg)
+{
+	if (pg == NULL)
+		return;
+
+	putkpg(pg);
+	npages--;
+}
+
+/**
+ * @brief Gets the page slot of a file.
+ *
+ * @param node   Target node.
+ * @param pgno   Page number in the file.
+ * @param create Allocate the indirect page if needed?
+ *
+ * @returns A pointer to the slot holding page @p pgno, or NULL if there is
+ *          no such slot.
+ */
+PRIVATE char **tmpfs_slot(struct tmpfs_node *node, unsigned pgno, int create)
+{
+	/* Direct page. */
+	if (pgno < TMPFS_NR_DIRECT)
+		return (&node->direct[pgno]);
+
+	pgno -= TMPFS_NR_DIRECT;
+
+	/* File too big. */
+	if (pgno >= TMPFS_NR_INDIRECT)
+		return (NULL);
+
+	if (node->indirect == NULL)
+	{
+		if (!create)
+			return (NULL);
+
+		if ((node->indirect = tmpfs_getpg()) == NULL)
+			return (NULL);
+	}
+
+	return (&node->indirect[pgno]);
+}
+
+/**
+ * @brief Releases all pages of a file.
+ */
+PRIVATE void tmpfs_release(struct tmpfs_node *node)
+{
+	for (unsigned i = 0; i < TMPFS_NR_DIRECT; i++)
+	{
+		tmpfs_putpg(node->direct[i]);
+		node->direct[i] = NULL;
+	}
+
+	if (node->indirect != NULL)
+	{
+		for (unsigned i = 0; i < TMPFS_NR_INDIRECT; i++)
+			tmpfs_putpg(node->indirect[i]);
+
+		tmpfs_putpg(node->indirect);
+		node->indirect = NULL;
+	}
+}
+
+/*============================================================================*
+ *                                Directories                                 *
+ *============================================================================*/
+
+/**
+ * @brief Hashes a directory entry.
+ */
+PRIVATE unsigned tmpfs_hash(ino_t dir, const char *name)
+{
+	unsigned h;
+
+	h = dir;
+	for (unsigned i = 0; (i < NAME_MAX) && (name[i] != '\0'); i++)
+		h = h*31 + (unsigned char)name[i];
+
+	return (h & (TMPFS_HASH_SIZE - 1));
+}
+
+/**
+ * @brief Looks up a directory entry.
+ *
+ * @param dir  Directory inode number.
+ * @param name File name.
+ *
+ * @returns The directory entry, or NULL if there is none.
+ */
+PRIVATE struct tmpfs_dirent *tmpfs_lookup(ino_t dir, const char *name)
+{
+	struct tmpfs_dirent *e;
+
+	for (e = hashtab[tmpfs_hash(dir, name)]; e != NULL; e = e->hash_next)
+	{
+		if ((e->dir == dir) && (!kstrncmp(e->name, name, NAME_MAX)))
+			return (e);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Gets the idx-th entry of a directory.
+ *
+ * @details Entries zero and one are "." and "..", and the remaining ones
+ *          are listed in the order they were added.
+ *
+ * @returns Zero if there is such entry, and non-zero otherwise.
+ */
+PRIVATE int tmpfs_dirent(struct inode *ip, unsigned idx, struct d_dirent *d)
+{
+	struct tmpfs_dirent *e;
+
+	kmemset(d, 0, sizeof(struct d_dirent));
+
+	if (idx == 0)
+	{
+		d->d_ino = ip->num;
+		kstrcpy(d->d_name, ".");
+		return (0);
+	}
+
+	if (idx == 1)
+	{
+		d->d_ino = nodes[ip->num].parent;
+		kstrcpy(d->d_name, "..");
+		return (0);
+	}
+
+	for (e = nodes[ip->num].head, idx -= 2; (e != NULL) && (idx > 0); idx--)
+		e = e->next;
+
+	if (e == NULL)
+		return (-1);
+
+	d->d_ino = e->ino;
+	kstrncpy(d->d_name, e->name, NAME_MAX);
+
+	return (0);
+}
+
+/**
+ * @brief Reads a directory.
+ *
+ * @details Only whole entries are read.
+ */
+PRIVATE ssize_t tmpfs_dir_read(struct inode *ip, void *buf, size_t n, off_t off)
+{
+	unsigned idx;       /* Working entry index. */
+	struct d_dirent *d; /* Working entry.       */
+
+	d = buf;
+	idx = off/sizeof(struct d_dirent);
+
+	while (n >= sizeof(struct d_dirent))
+	{
+		if (tmpfs_dirent(ip, idx++, d))
+			break;
+
+		d++;
+		n -= sizeof(struct d_dirent);
+	}
+
+	return ((ssize_t)((char *)d - (char *)buf));
+}
+
+/**
+ * @brief Searches for a directory entry.
+ *
+ * @details Entries do not live in buffers, so no buffer is returned in
+ *          @p buf and the returned entry is only valid until the next search.
+ *          Entries are created by tmpfs_dir_add(), so @p create is ignored.
+ */
+PRIVATE struct d_dirent *tmpfs_dirent_search
+(struct inode *ip, const char *filename, struct buffer **buf, int create)
+{
+	PRIVATE struct d_dirent d; /* Found entry. */
+	struct tmpfs_dirent *e;    /* Hashed entry. */
+
+	UNUSED(create);
+
+	*buf = NULL;
+
+	if (!kstrcmp(filename, "."))
+		d.d_ino = ip->num;
+
+	else if (!kstrcmp(filename, ".."))
+		d.d_ino = nodes[ip->num].parent;
+
+	else if ((e = tmpfs_lookup(ip->num, filename)) != NULL)
+		d.d_ino = e->ino;
+
+	else
+		return (NULL);
+
+	kstrncpy(d.d_name, filename, NAME_MAX);
+
+	return (&d);
+}
+
+/**
+ * @brief Adds an entry to a directory.
+ */
+PRIVATE int tmpfs_dir_add(struct inode *dip, struct inode *ip, const char *name)
+{
+	struct tmpfs_dirent *e;
+	struct tmpfs_node *dir;
+
+	/* Name already taken. */
+	if ((!kstrcmp(name, ".")) || (!kstrcmp(name, "..")))
+		return (-EEXIST);
+	if (tmpfs_lookup(dip->num, name) != NULL)
+		return (-EEXIST);
+
+	/* Directory table is full. */
+	if ((e = free_dirents) == NULL)
+		return (-ENOSPC);
+	free_dirents = e->next;
+
+	e->dir = dip->num;
+	e->ino = ip->num;
+	kstrncpy(e->name, name, NAME_MAX);
+
+	/* Insert in the hash table. */
+	e->hash_next = hashtab[tmpfs_hash(e->dir, e->name)];
+	hashtab[tmpfs_hash(e->dir, e->name)] = e;
+
+	/* Append to the directory. */
+	dir = &nodes[dip->num];
+	e->next = NULL;
+	if (dir->tail != NULL)
+		dir->tail->next = e;
+	else
+		dir->head = e;
+	dir->tail = e;
+
+	/* Its '..' entry links back to us. */
+	if (S_ISDIR(ip->mode) && (nodes[ip->num].parent == INODE_NULL))
+	{
+		nodes[ip->num].parent = dip->num;
+		dip->nlinks++;
+	}
+
+	dip->size += sizeof(struct d_dirent);
+	inode_touch(dip);
+
+	return (0);
+}
+
+/**
+ * @brief Unlinks a directory entry.
+ */
+PRIVATE void tmpfs_unlink(struct tmpfs_dirent *e)
+{
+	struct tmpfs_node *dir;   /* Parent directory. */
+	struct tmpfs_dirent *p;   /* Previous entry.   */
+	struct tmpfs_dirent **pp; /* Working link.     */
+
+	for (pp = &hashtab[tmpfs_hash(e->dir, e->name)]; *pp != e; pp = &(*pp)->hash_next)
+		/* noop */;
+	*pp = e->hash_next;
+
+	dir = &nodes[e->dir];
+	if (dir->head == e)
+		p = NULL;
+	else
+	{
+		for (p = dir->head; p->next != e; p = p->next)
+			/* noop */;
+	}
+
+	if (p == NULL)
+		dir->head = e->next;
+	else
+		p->next = e->next;
+	if (dir->tail == e)
+		dir->tail = p;
+
+	e->next = free_dirents;
+	free_dirents = e;
+}
+
+/**
+ * @brief Removes an entry from a directory.
+ */
+PRIVATE int tmpfs_dir_remove(struct inode *dip, const char *filename)
+{
+	struct inode *file;     /* File inode.      */
+	struct tmpfs_dirent *e; /* Directory entry. */
+
+	/* Cannot remove '.' nor '..' */
+	if ((!kstrcmp(filename, ".")) || (!kstrcmp(filename, "..")))
+		return (-EBUSY);
+
+	/* Not found. */
+	if ((e = tmpfs_lookup(dip->num, filename)) == NULL)
+		return (-ENOENT);
+
+	/* Failed to get file's inode. */
+	if ((file = inode_get(dip->dev, e->ino)) == NULL)
+		return (-ENOENT);
+
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			return (-EPERM);
+		}
+
+		/* Directory not empty. */
+		if (nodes[file->num].head != NULL)
+		{
+			inode_put(file);
+			return (-EBUSY);
+		}
+	}
+
+	/* Its '..' entry goes away too. */
+	if (S_ISDIR(file->mode) && (nodes[file->num].parent == dip->num))
+	{
+		nodes[file->num].parent = INODE_NULL;
+		dip->nlinks--;
+	}
+
+	tmpfs_unlink(e);
+
+	dip->size -= sizeof(struct d_dirent);
+	inode_touch(dip);
+	file->nlinks--;
+	inode_touch(file);
+	inode_put(file);
+
+	return (0);
+}
+
+/*============================================================================*
+ *                                   Files                                    *
+ *============================================================================*/
+
+/**
+ * @brief Reads from a file.
+ *
+ * @details Data is copied straight from the pages of the file. Holes read
+ *          as zeros.
+ */
+PRIVATE ssize_t tmpfs_file_read(struct inode *ip, void *buf, size_t n, off_t off)
+{
+	char *p;               /* Writing pointer. */
+	char **slot;           /* Page slot.       */
+	size_t pgoff;          /* Page offset.     */
+	size_t chunk;          /* Data chunk size. */
+	struct tmpfs_node *node; /* File node.     */
+
+	p = buf;
+	node = &nodes[ip->num];
+
+	while ((n > 0) && (off < ip->size))
+	{
+		pgoff = off % PAGE_SIZE;
+		chunk = KMIN(n, PAGE_SIZE - pgoff);
+		chunk = KMIN(chunk, (size_t)(ip->size - off));
+
+		slot = tmpfs_slot(node, off/PAGE_SIZE, 0);
+
+		if ((slot == NULL) || (*slot == NULL))
+			kmemset(p, 0, chunk);
+		else
+			kmemcpy(p, *slot + pgoff, chunk);
+
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+	}
+
+	return ((ssize_t)(p - (char *)buf));
+}
+
+/**
+ * @brief Writes to a file.
+ *
+ * @details Data is copied straight to the pages of the file, which are
+ *          allocated on first touch.
+ */
+PRIVATE ssize_t tmpfs_file_write
+(struct inode *ip, const void *buf, size_t n, off_t off)
+{
+	const char *p;           /* Reading pointer. */
+	char **slot;             /* Page slot.       */
+	size_t pgoff;            /* Page offset.     */
+	size_t chunk;            /* Data chunk size. */
+	struct tmpfs_node *node; /* File node.       */
+
+	p = buf;
+	node = &nodes[ip->num];
+
+	while (n > 0)
+	{
+		slot = tmpfs_slot(node, off/PAGE_SIZE, 1);
+
+		/* File system full. */
+		if (slot == NULL)
+			break;
+		if ((*slot == NULL) && ((*slot = tmpfs_getpg()) == NULL))
+			break;
+
+		pgoff = off % PAGE_SIZE;
+		chunk = KMIN(n, PAGE_SIZE - pgoff);
+		kmemcpy(*slot + pgoff, p, chunk);
+
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+
+		/* Update file size. */
+		if (off > ip->size)
+		{
+			ip->size = off;
+			ip->flags |= INODE_DIRTY;
+		}
+	}
+
+	/* Nothing written. */
+	if ((n > 0) && (p == buf))
+	{
+		curr_proc->errno = ((size_t)off >= TMPFS_MAX_SIZE) ? -EFBIG : -ENOSPC;
+		return (-1);
+	}
+
+	return ((ssize_t)(p - (const char *)buf));
+}
+
+/**
+ * @brief Temporary file system inode operations.
+ */
+PRIVATE struct inode_operations tmpfs_iops =
+{
+	&tmpfs_dir_read,
+	&tmpfs_dir_add,
+	&tmpfs_dir_remove,
+	&tmpfs_file_read,
+	&tmpfs_file_write,
+	&tmpfs_dirent_search,
+	NULL
+};
+
+/*============================================================================*
+ *                          Inodes and Superblock                             *
+ *============================================================================*/
+
+/**
+ * @brief Loads an in-core inode from a node.
+ */
+PRIVATE void tmpfs_inode_load(struct inode *ip, ino_t num, struct superblock *sb)
+{
+	struct tmpfs_node *node;
+
+	node = &nodes[num];
+
+	ip->mode = node->mode;
+	ip->nlinks = node->nlinks;
+	ip->uid = node->uid;
+	ip->gid = node->gid;
+	ip->size = node->size;
+	ip->time = node->time;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	ip->dev = sb->dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &tmpfs_iops;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+}
+
+/**
+ * @brief Reads an inode.
+ *
+ * @returns Zero if the inode exists, and non-zero otherwise.
+ */
+PRIVATE int tmpfs_inode_read(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct superblock *sb;
+
+	/* No such inode. */
+	if ((num == INODE_NULL) || (num >= TMPFS_NR_NODES) || (!nodes[num].used))
+		return (-1);
+
+	if ((sb = superblock_get(dev)) == NULL)
+		return (-1);
+
+	tmpfs_inode_load(ip, num, sb);
+
+	superblock_put(sb);
+
+	return (0);
+}
+
+/**
+ * @brief Writes an inode back to its node.
+ */
+PRIVATE void tmpfs_inode_write(struct inode *ip)
+{
+	struct tmpfs_node *node;
+
+	node = &nodes[ip->num];
+
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY) || (!node->used))
+		return;
+
+	node->mode = ip->mode;
+	node->nlinks = ip->nlinks;
+	node->uid = ip->uid;
+	node->gid = ip->gid;
+	node->size = ip->size;
+	node->time = ip->time;
+	ip->flags &= ~INODE_DIRTY;
+}
+
+/**
+ * @brief Frees an inode.
+ *
+ * @details The pages of the file are released here rather than in
+ *          tmpfs_inode_truncate(), so that a freed node never holds pages.
+ */
+PRIVATE void tmpfs_inode_free(struct inode *ip)
+{
+	struct tmpfs_node *node;
+
+	node = &nodes[ip->num];
+
+	tmpfs_release(node);
+	node->used = 0;
+}
+
+/**
+ * @brief Truncates an inode.
+ */
+PRIVATE void tmpfs_inode_truncate(struct inode *ip)
+{
+	tmpfs_release(&nodes[ip->num]);
+
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int tmpfs_inode_alloc(struct superblock *sb, struct inode *ip)
+{
+	ino_t num;
+	struct tmpfs_node *node;
+
+	/* Search for a free node. */
+	for (num = INODE_ROOT + 1; num < TMPFS_NR_NODES; num++)
+	{
+		if (!nodes[num].used)
+			goto found;
+	}
+
+	curr_proc->errno = -ENOSPC;
+	return (-1);
+
+found:
+
+	node = &nodes[num];
+	kmemset(node, 0, sizeof(struct tmpfs_node));
+	node->used = 1;
+	node->nlinks = 1;
+	node->uid = curr_proc->euid;
+	node->gid = curr_proc->egid;
+	node->parent = INODE_NULL;
+	node->time = CURRENT_TIME;
+
+	/* Mode will be initialized later. */
+	tmpfs_inode_load(ip, num, sb);
+
+	return (0);
+}
+
+/**
+ * @brief Releases the superblock.
+ *
+ * @details Files are kept when the file system is unmounted.
+ */
+PRIVATE void tmpfs_superblock_put(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+
+	if (--sb->count == 0)
+		sb->flags &= ~SUPERBLOCK_VALID;
+}
+
+/**
+ * @brief Nothing to write back.
+ */
+PRIVATE void tmpfs_superblock_write(struct superblock *sb)
+{
+	UNUSED(sb);
+}
+
+/**
+ * @brief Gets file system statistics.
+ */
+PRIVATE void tmpfs_superblock_stat(struct superblock *sb, struct ustat *ubuf)
+{
+	ino_t tinode;
+
+	UNUSED(sb);
+
+	tinode = 0;
+	for (ino_t num = INODE_ROOT + 1; num < TMPFS_NR_NODES; num++)
+	{
+		if (!nodes[num].used)
+			tinode++;
+	}
+
+	kmemset(ubuf, 0, sizeof(struct ustat));
+	ubuf->f_tfree = (TMPFS_MAX_PAGES - npages)*(PAGE_SIZE/BLOCK_SIZE);
+	ubuf->f_tinode = tinode;
+}
+
+/**
+ * @brief Temporary file system operations.
+ */
+PRIVATE struct super_operations tmpfs_sops =
+{
+	&tmpfs_inode_read,       /* inode_read     */
+	&tmpfs_inode_write,      /* inode_write    */
+	&tmpfs_inode_free,       /* inode_free     */
+	&tmpfs_inode_truncate,   /* inode_truncate */
+	&tmpfs_inode_alloc,      /* inode_alloc    */
+	NULL,                    /* notify_change  */
+	NULL,                    /* put inode      */
+	&tmpfs_superblock_put,   /* put_super      */
+	&tmpfs_superblock_write, /* write_super    */
+	&tmpfs_superblock_stat,  /* superblock_stat */
+	NULL,                    /* remount_fs     */
+	NULL                     /* inode_block    */
+};
+
+/**
+ * @brief Reads the superblock.
+ *
+ * @returns A pointer to @p sb if @p dev is the temporary file system device,
+ *          and NULL otherwise.
+ */
+PRIVATE struct superblock *tmpfs_superblock_read(dev_t dev, struct superblock *sb)
+{
+	/* Not ours. */
+	if (dev != TMP_DEV)
+		return (NULL);
+
+	sb->buf = NULL;
+	sb->ninodes = TMPFS_NR_NODES - 1;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = 0;
+	sb->max_size = TMPFS_MAX_SIZE;
+	sb->zones = TMPFS_MAX_PAGES;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = 0;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = &tmpfs_sops;
+
+	return (sb);
+}
+
+/**
+ * @brief Temporary file system.
+ */
+PRIVATE struct file_system_type fs_tmpfs = {
+	tmpfs_superblock_read,
+	&tmpfs_sops,
+	"tmpfs",
+	FS_NODEV
+};
+
+/**
+ * @brief Initializes and registers the temporary file system.
+ */
+PUBLIC void init_tmpfs(void)
+{
+	struct tmpfs_node *root;
+
+	/* Build free list of directory entries. */
+	for (unsigned i = 0; i < TMPFS_NR_DIRENTS; i++)
+	{
+		dirents[i].next = free_dirents;
+		free_dirents = &dirents[i];
+	}
+
+	root = &nodes[INODE_ROOT];
+	root->used = 1;
+	root->mode = S_IFDIR | S_IRWXU | S_IRWXG | S_IRWXO;
+	root->nlinks = 2;
+	root->size = 2*sizeof(struct d_dirent);
+	root->time = CURRENT_TIME;
+	root->parent = INODE_ROOT;
+
+	if (fs_register(TMPFS, &fs_tmpfs))
+		kpanic("Failed to register temporary file system");
+}
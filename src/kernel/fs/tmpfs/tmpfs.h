@@ -0,0 +1,40 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Temporary file system.
+ */
+
+#ifndef _TMPFS_H_
+#define _TMPFS_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/dev.h>
+
+	/**
+	 * @brief Device number the temporary file system is mounted from.
+	 */
+	#define TMP_DEV DEVID(TMP_MAJOR, 0, CHRDEV)
+
+	/* Forward definitions. */
+	EXTERN void init_tmpfs(void);
+
+#endif /* _TMPFS_H_ */
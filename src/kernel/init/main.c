@@ -20,6 +20,8 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/8250.h>
+#include <dev/klog.h>
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
 #include <nanvix/hal.h>
@@ -84,12 +86,17 @@ PUBLIC void kmain(const char* cmdline)
 			if (nprocs == 1)
 			{	
 				kprintf("you may now turn off your computer");
+				klog_flush();
 				disable_interrupts();
+#ifdef SERIAL_ENABLE
+				uart8250_flush();
+#endif
 				while (1)
 					halt();
 			}
 		}
 		
+		klog_flush();
 		halt();
 		yield();
 	}
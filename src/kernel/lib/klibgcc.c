@@ -157,3 +157,58 @@ long __umodsi3 (long a, long b)
 {
 	return udivmodsi4 (a, b, 1);
 }
+
+unsigned long long
+udivmoddi4(unsigned long long num, unsigned long long den, int modwanted)
+{
+	unsigned long long bit = 1;
+	unsigned long long res = 0;
+
+	while (den < num && bit && !(den & (1ULL<<63)))
+	{
+		den <<=1;
+		bit <<=1;
+	}
+
+	while (bit)
+	{
+		if (num >= den)
+		{
+			num -= den;
+			res |= bit;
+		}
+		bit >>=1;
+		den >>=1;
+	}
+
+	if (modwanted)
+		return num;
+
+	return res;
+}
+
+/**
+ * @brief Calculates the quotient of the unsigned 64-bit division of a and b.
+ * 
+ * @param a first number
+ * @param b second number
+ * 
+ * @returns Returns the quotient of the unsigned division of a and b.
+ */
+unsigned long long __udivdi3 (unsigned long long a, unsigned long long b)
+{
+	return udivmoddi4 (a, b, 0);
+}
+
+/**
+ * @brief Calculates the remainder of the unsigned 64-bit division of a and b.
+ * 
+ * @param a first number
+ * @param b second number
+ * 
+ * @returns Returns the remainder of the unsigned division of a and b.
+ */
+unsigned long long __umoddi3 (unsigned long long a, unsigned long long b)
+{
+	return udivmoddi4 (a, b, 1);
+}
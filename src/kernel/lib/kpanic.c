@@ -17,6 +17,8 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/8250.h>
+#include <dev/klog.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/hal.h>
@@ -42,7 +44,8 @@ PUBLIC void kpanic(const char *fmt, ...)
 	buffer[i++] = '\n';
 	va_end(args);
 
-	/* Save on kernel log and write on kout. */
+	/* Flush pending messages, save on kernel log and write on kout. */
+	klog_flush();
 	cdev_write(kout, buffer, i);
 	klog_write(0, buffer, i);
 	
@@ -52,6 +55,11 @@ PUBLIC void kpanic(const char *fmt, ...)
 	 */
 	disable_interrupts();
 	
+#ifdef SERIAL_ENABLE
+	/* Nobody is going to drain the serial port anymore. */
+	uart8250_flush();
+#endif
+	
 	while(1);
 
 	halt();
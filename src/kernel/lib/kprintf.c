@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/klog.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/klib.h>
@@ -36,15 +37,10 @@ PUBLIC dev_t kout = DEVID(NULL_MAJOR, 0, CHRDEV);
  */
 PUBLIC void chkout(dev_t dev)
 {	
-	ssize_t n;                 /* Number of bytes to be flushed. */
-	char buffer[KBUFFER_SIZE]; /* Temporary buffer.              */
-	
 	kout = dev;
 	
 	/* Flush the content of kernel log. */
-	n = klog_read(0, buffer, KLOG_SIZE);
-	
-	cdev_write(kout, buffer, n);
+	klog_flush();
 }
 
 /**
@@ -87,13 +83,15 @@ PUBLIC char get_code(const char *buffer)
  * @brief Writes on the screen a formated string.
  * 
  * @param fmt Formated string.
+ *
+ * @details The string is only recorded in the kernel log, and it reaches
+ *          the kernel's output device at the next klog_flush().
  */
 PUBLIC void kprintf(const char *fmt, ...)
 {
-	int i;                         /* Loop index.                              */
-	va_list args;                  /* Variable arguments list.                 */
-	char buffer[KBUFFER_SIZE + 1]; /* Temporary buffer.                        */
-	const char *buffer_no_code;    /* Temporary buffer for log level printing. */
+	int i;                         /* Loop index.              */
+	va_list args;                  /* Variable arguments list. */
+	char buffer[KBUFFER_SIZE + 1]; /* Temporary buffer.        */
 	
 	/* Convert to raw string. */
 	va_start(args, fmt);
@@ -101,8 +99,6 @@ PUBLIC void kprintf(const char *fmt, ...)
 	buffer[i++] = '\n';
 	va_end(args);
 
-	/* Save on kernel log, skip code in case it's not correctly done and write on kout. */
+	/* Save on kernel log. */
 	klog_write(0, buffer, i);
-	buffer_no_code = skip_code(buffer, &i);
-	cdev_write(kout, buffer_no_code, i);
 }
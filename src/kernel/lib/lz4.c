@@ -0,0 +1,129 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <sys/types.h>
+#include <stdint.h>
+
+/**
+ * @brief Minimum length of an LZ4 match.
+ */
+#define LZ4_MINMATCH 4
+
+/**
+ * @brief Reads an LZ4 length extension.
+ *
+ * @param ip   Read pointer.
+ * @param iend End of input.
+ * @param len  Length to extend.
+ *
+ * @returns The extended length, or SIZE_MAX if the input is truncated.
+ */
+PRIVATE size_t lz4_length(const uint8_t **ip, const uint8_t *iend, size_t len)
+{
+	uint8_t b;
+
+	do
+	{
+		if (*ip >= iend)
+			return (SIZE_MAX);
+
+		b = *(*ip)++;
+		len += b;
+	} while (b == 255);
+
+	return (len);
+}
+
+/**
+ * @brief Decompresses an LZ4 block.
+ *
+ * @param src    Compressed block.
+ * @param srclen Size of the compressed block (in bytes).
+ * @param dst    Where the block should be decompressed to.
+ * @param dstlen Size of @p dst (in bytes).
+ *
+ * @returns The number of bytes decompressed, or -1 if the block is
+ *          malformed or does not fit in @p dst.
+ */
+PUBLIC ssize_t lz4_decompress(const void *src, size_t srclen, void *dst, size_t dstlen)
+{
+	size_t len;          /* Literal or match length. */
+	size_t offset;       /* Match offset.            */
+	unsigned token;      /* Sequence token.          */
+	uint8_t *op;         /* Write pointer.           */
+	const uint8_t *ip;   /* Read pointer.            */
+	const uint8_t *iend; /* End of input.            */
+	uint8_t *oend;       /* End of output.           */
+
+	ip = src;
+	iend = ip + srclen;
+	op = dst;
+	oend = op + dstlen;
+
+	while (ip < iend)
+	{
+		token = *ip++;
+
+		/* Literals. */
+		len = token >> 4;
+		if ((len == 15) && ((len = lz4_length(&ip, iend, len)) == SIZE_MAX))
+			return (-1);
+		if ((len > (size_t)(iend - ip)) || (len > (size_t)(oend - op)))
+			return (-1);
+		kmemcpy(op, ip, len);
+		ip += len;
+		op += len;
+
+		/* Last sequence has no match. */
+		if (ip == iend)
+			break;
+
+		/* Match. */
+		if (iend - ip < 2)
+			return (-1);
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if ((offset == 0) || (offset > (size_t)(op - (uint8_t *)dst)))
+			return (-1);
+
+		len = token & 15;
+		if ((len == 15) && ((len = lz4_length(&ip, iend, len)) == SIZE_MAX))
+			return (-1);
+		len += LZ4_MINMATCH;
+		if (len > (size_t)(oend - op))
+			return (-1);
+
+		/* Non-overlapping match. */
+		if (offset >= len)
+			kmemcpy(op, op - offset, len);
+
+		/* Overlapping match repeats the last offset bytes. */
+		else
+		{
+			for (size_t i = 0; i < len; i++)
+				op[i] = op[i - offset];
+		}
+
+		op += len;
+	}
+
+	return ((ssize_t)(op - (uint8_t *)dst));
+}
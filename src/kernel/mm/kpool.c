@@ -111,3 +111,19 @@ PUBLIC void putkpg(void *kpg)
 	if (kpages[i]-- == 0)
 		kpanic("mm: double free on kernel page");
 }
+
+/**
+ * @brief Gets kernel page pool statistics.
+ *
+ * @param st Where to store the statistics.
+ */
+PUBLIC void kpool_stats(struct mm_stats *st)
+{
+	st->kpages = NR_KPAGES;
+	st->kpages_used = 0;
+	for (unsigned i = 0; i < NR_KPAGES; i++)
+	{
+		if (kpages[i] > 0)
+			st->kpages_used++;
+	}
+}
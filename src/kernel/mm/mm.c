@@ -118,6 +118,17 @@ PUBLIC int chkmem(const void *addr, size_t size, mode_t mask)
 
 	unlockreg(reg);
 	
+	/*
+	 * Regions may have holes that fault for good,
+	 * such as counters of semaphores that were not
+	 * opened, so each page must be backed.
+	 */
+	for (addr_t pg = ADDR(addr) & PAGE_MASK; (ret) && (pg < ADDR(addr) + size); pg += PAGE_SIZE)
+	{
+		if (!upgvalid(curr_proc, pg))
+			ret = 0;
+	}
+	
 	return (ret);
 }
 
@@ -146,6 +157,10 @@ PUBLIC int fubyte(const void *addr)
 	if ((preg = findreg(curr_proc, (addr_t)addr)) == NULL)
 		return (-1);
 	
+	/* Hole in the region. */
+	if (!upgvalid(curr_proc, (addr_t)addr))
+		return (-1);
+	
 	return (*((char *)addr));
 }
 
@@ -174,5 +189,9 @@ PUBLIC int fudword(const void *addr)
 	if ((preg = findreg(curr_proc, (addr_t)addr)) == NULL)
 		return (-1);
 	
+	/* Hole in the region. */
+	if (!upgvalid(curr_proc, (addr_t)addr))
+		return (-1);
+	
 	return (*((int *)addr));
 }
@@ -29,6 +29,7 @@
 	EXTERN void linkupg(struct pte *, struct pte *);
 	EXTERN void mappgtab(struct process *, addr_t, void *);
 	EXTERN void markpg(struct pte *, int);
+	EXTERN int shareupg(struct pte *, struct pte *);
 	EXTERN void umappgtab(struct process *, addr_t);
 
 #endif /* _MM_H_ */
@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
@@ -121,6 +122,25 @@ PRIVATE inline int frame_is_shared(addr_t addr)
 	return (frames[frame_addr_to_id(addr)] > 1);
 }
 
+/**
+ * @brief Gets page frame statistics.
+ *
+ * @param st Where to store the statistics.
+ */
+PUBLIC void frame_stats(struct mm_stats *st)
+{
+	st->frames = NR_FRAMES;
+	st->frames_used = 0;
+	st->frames_shared = 0;
+	for (unsigned i = 0; i < NR_FRAMES; i++)
+	{
+		if (frames[i] > 0)
+			st->frames_used++;
+		if (frames[i] > 1)
+			st->frames_shared++;
+	}
+}
+
 /*============================================================================*
  *                              Paging System                                 *
  *============================================================================*/
@@ -602,6 +622,50 @@ PUBLIC void linkupg(struct pte *upg1, struct pte *upg2)
 	kmemcpy(upg2, upg1, sizeof(struct pte));
 }
 
+/**
+ * @brief Shares a page.
+ * 
+ * @param upg1 Source page.
+ * @param upg2 Target page.
+ * 
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ * 
+ * @details Unlike linkupg(), both pages keep referring to the same page
+ *          frame when written to. A source page that is not present gets
+ *          a zeroed page frame first.
+ */
+PUBLIC int shareupg(struct pte *upg1, struct pte *upg2)
+{
+	void *kpg;    /* Zeroed kernel page. */
+	addr_t paddr; /* Page frame.         */
+	
+	/* Allocate source page. */
+	if (!pte_is_present(upg1))
+	{
+		if ((kpg = getkpg(1)) == NULL)
+			return (-1);
+		
+		if (!(paddr = frame_alloc()))
+		{
+			putkpg(kpg);
+			return (-1);
+		}
+		
+		physcpy(paddr << PAGE_SHIFT, ADDR(kpg) - KBASE_VIRT, PAGE_SIZE);
+		putkpg(kpg);
+		
+		pte_init(upg1, 1);
+		upg1->frame = paddr;
+	}
+	
+	frame_share(upg1->frame);
+	
+	kmemcpy(upg2, upg1, sizeof(struct pte));
+	tlb_flush();
+	
+	return (0);
+}
+
 /**
  * @brief Destroys the page directory of a process.
  * 
@@ -615,6 +679,97 @@ PUBLIC void dstrypgdir(struct process *proc)
 	putkpg(proc->pgdir);
 }
 
+/**
+ * @brief Asserts if a user page is resident in memory.
+ * 
+ * @param proc Target process.
+ * @param addr Target address.
+ * 
+ * @returns Non-zero if the page that contains @p addr is present in the
+ *          address space of @p proc, and zero otherwise.
+ * 
+ * @note This function never faults, so it is safe to call it from
+ *       interrupt handlers.
+ */
+PUBLIC int upgpresent(struct process *proc, addr_t addr)
+{
+	/* Kernel address space. */
+	if (IN_KERNEL(addr))
+		return (0);
+	
+	if (!pde_is_present(getpde(proc, addr)))
+		return (0);
+	
+	return (pte_is_present(getpte(proc, addr)));
+}
+
+/**
+ * @brief Asserts if a user page may be accessed.
+ * 
+ * @param proc Target process.
+ * @param addr Target address.
+ * 
+ * @returns Non-zero if the page that contains @p addr is either present or
+ *          brought in on demand, and zero otherwise.
+ * 
+ * @note Unlike upgpresent(), this function accepts demand pages, which the
+ *       kernel may touch on behalf of @p proc and have them faulted in.
+ */
+PUBLIC int upgvalid(struct process *proc, addr_t addr)
+{
+	struct pte *pg; /* Working page table entry. */
+	
+	/* Kernel address space. */
+	if (IN_KERNEL(addr))
+		return (0);
+	
+	if (!pde_is_present(getpde(proc, addr)))
+		return (0);
+	
+	pg = getpte(proc, addr);
+	
+	return (pte_is_present(pg) || pte_is_fill(pg) || pte_is_zero(pg));
+}
+
+/**
+ * @brief Fills a user page of a process.
+ * 
+ * @param proc Target process.
+ * @param addr Address of the target page.
+ * @param kpg  Kernel page holding the contents of the target page.
+ * 
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ *          non-zero is returned instead.
+ * 
+ * @details This function populates a demand zero page of a process that is
+ *          not running, so that it does not fault on it when it runs.
+ */
+PUBLIC int upgfill(struct process *proc, addr_t addr, void *kpg)
+{
+	addr_t paddr;   /* Page frame.               */
+	struct pte *pg; /* Working page table entry. */
+	
+	/* Kernel address space. */
+	if (IN_KERNEL(addr))
+		return (-1);
+	
+	pg = getpte(proc, addr & PAGE_MASK);
+	
+	/* Not a demand zero page. */
+	if (!pte_is_zero(pg))
+		return (-1);
+	
+	if (!(paddr = frame_alloc()))
+		return (-1);
+	
+	pte_init(pg, 1);
+	pg->frame = paddr;
+	
+	physcpy(paddr << PAGE_SHIFT, ADDR(kpg) - KBASE_VIRT, PAGE_SIZE);
+	
+	return (0);
+}
+
 /**
  * @brief Handles a validity page fault.
  * 
@@ -635,6 +790,8 @@ PUBLIC int vfault(addr_t addr)
 
 	addr2 = addr;
 
+	TRACE(TRACE_VFAULT, addr, 0, 0);
+
 	/*
 	 * Number of attempts to allocate a faulting page to a (possible)
 	 * stack.
@@ -690,6 +847,8 @@ PUBLIC int vfault(addr_t addr)
 	{
 		if (readpg(reg, addr))
 			goto error1;
+
+		curr_proc->ru.majflt++;
 	}
 
 	/* Demand zero. */
@@ -709,6 +868,8 @@ PUBLIC int vfault(addr_t addr)
 			i++;
 		}
 		while (i < page_count);
+
+		curr_proc->ru.minflt++;
 	}
 
 	unlockreg(reg);
@@ -733,6 +894,8 @@ PUBLIC int pfault(addr_t addr)
 	struct pte *pg;       /* Faulting page.          */
 	struct pregion *preg; /* Working process region. */
 
+	TRACE(TRACE_PFAULT, addr, 0, 0);
+
 	/* Outside virtual address space. */
 	if ((preg = findreg(curr_proc, addr)) == NULL)
 		goto error0;
@@ -749,6 +912,8 @@ PUBLIC int pfault(addr_t addr)
 	if (cow_disable(pg))
 		goto error1;
 
+	curr_proc->ru.cowflt++;
+
 	unlockreg(preg->reg);
 	return(0);
 
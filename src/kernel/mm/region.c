@@ -759,6 +759,76 @@ PUBLIC struct region *dupreg(struct region *reg)
 	return (new_reg);
 }
 
+/**
+ * @brief Gets a page of a memory region.
+ * 
+ * @param reg Memory region that grows upwards.
+ * @param off Offset of the page in the memory region.
+ * 
+ * @returns Upon success a pointer to the page table entry of the page is
+ *          returned. Upon failure, a NULL pointer is returned instead.
+ */
+PRIVATE struct pte *regpte(struct region *reg, addr_t off)
+{
+	unsigned i, j, k; /* Loop indexes. */
+	
+	/* Out of the region. */
+	if ((reg->flags & REGION_DOWNWARDS) || (off >= reg->size))
+		return (NULL);
+	
+	i = off >> MREGION_SHIFT;
+	j = (off >> PGTAB_SHIFT) - (REGION_PGTABS*i);
+	k = ((PAGE_MASK^PGTAB_MASK) & off) >> PAGE_SHIFT;
+	
+	return (&reg->mtab[i]->pgtab[j][k]);
+}
+
+/**
+ * @brief Shares a page between two memory regions.
+ * 
+ * @param dst Target memory region.
+ * @param src Source memory region.
+ * @param off Offset of the page in both memory regions.
+ * 
+ * @returns Zero upon success, and non-zero otherwise.
+ * 
+ * @details The page is allocated in @p src if it is not there yet, and it
+ *          replaces whatever page @p dst had at @p off. Unlike dupreg(),
+ *          the page is never copied on write afterwards.
+ */
+PUBLIC int sharepg(struct region *dst, struct region *src, addr_t off)
+{
+	struct pte *spg; /* Source page. */
+	struct pte *dpg; /* Target page. */
+	
+	if (((spg = regpte(src, off)) == NULL) || ((dpg = regpte(dst, off)) == NULL))
+		return (-1);
+	
+	/* Already shared. */
+	if ((pte_is_present(spg)) && (pte_is_present(dpg)) && (spg->frame == dpg->frame))
+		return (0);
+	
+	freeupg(dpg);
+	
+	return (shareupg(spg, dpg));
+}
+
+/**
+ * @brief Drops a page of a memory region.
+ * 
+ * @param reg Memory region.
+ * @param off Offset of the page in the memory region.
+ * 
+ * @details The page is left unmapped, so that accessing it faults.
+ */
+PUBLIC void droppg(struct region *reg, addr_t off)
+{
+	struct pte *pg; /* Working page. */
+	
+	if ((pg = regpte(reg, off)) != NULL)
+		freeupg(pg);
+}
+
 /**
  * @brief Changes the size of memory region.
  * 
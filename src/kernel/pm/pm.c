@@ -69,12 +69,14 @@ PUBLIC pid_t next_pid = 0;
  */
 PUBLIC unsigned nprocs = 0;
 
+/**
+ * @brief Number of context switches.
+ */
+PUBLIC unsigned nswitches = 0;
+
 /* semtable init */
 PUBLIC struct ksem semtable[SEM_OPEN_MAX];
 
-/* Processes waiting for a semaphore */
-PUBLIC struct process* semwaiters[PROC_MAX];
-
 PUBLIC struct ksem sembuf;
 
 PUBLIC struct inode *semdirectory;
@@ -128,13 +130,20 @@ PUBLIC void pm_init(void)
 	IDLE->ktime = 0;
 	IDLE->cutime = 0;
 	IDLE->cktime = 0;
+	IDLE->tstamp = 0;
+	kmemset(&IDLE->ru, 0, sizeof(struct pcounters));
+	kmemset(&IDLE->cru, 0, sizeof(struct pcounters));
 	IDLE->state = PROC_RUNNING;
 	IDLE->counter = PROC_QUANTUM;
 	IDLE->priority = PRIO_USER;
 	IDLE->nice = NZERO;
 	IDLE->alarm = 0;
+	IDLE->ns_deadline = 0;
 	IDLE->next = NULL;
 	IDLE->chain = NULL;
+	IDLE->wq = NULL;
+	IDLE->wq_next = NULL;
+	IDLE->wq_prev = NULL;
 	
 	nprocs++;
 
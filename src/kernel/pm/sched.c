@@ -18,11 +18,14 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/prof.h>
+#include <dev/trace.h>
 #include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/pm.h>
 #include <signal.h>
+#include <stdint.h>
 
 /**
  * @brief Calculates the effective priority of a process.
@@ -90,6 +93,163 @@ PUBLIC void resume(struct process *proc)
 		sched(proc);
 }
 
+/**
+ * @brief Charges CPU time to a process.
+ *
+ * @details Charges the time elapsed since the last accounting of @p proc to
+ *          its kernel or user CPU time, depending on @p kernel.
+ *
+ * @param proc   Target process.
+ * @param kernel Charge kernel time?
+ */
+PUBLIC void account(struct process *proc, int kernel)
+{
+	uint64_t now;
+
+	now = clock_ns();
+
+	if (kernel)
+		proc->ktime += now - proc->tstamp;
+	else
+		proc->utime += now - proc->tstamp;
+
+	proc->tstamp = now;
+}
+
+/**
+ * @brief Adds resource usage counters.
+ *
+ * @param dst Target counters.
+ * @param src Counters to add.
+ */
+PRIVATE void pcounters_add(struct pcounters *dst, const struct pcounters *src)
+{
+	dst->minflt += src->minflt;
+	dst->majflt += src->majflt;
+	dst->cowflt += src->cowflt;
+	dst->inblock += src->inblock;
+	dst->oublock += src->oublock;
+	dst->nvcsw += src->nvcsw;
+	dst->nivcsw += src->nivcsw;
+	dst->nsyscalls += src->nsyscalls;
+	dst->pipein += src->pipein;
+	dst->pipeout += src->pipeout;
+	dst->ttyin += src->ttyin;
+	dst->ttyout += src->ttyout;
+}
+
+/**
+ * @brief Charges the resources used by a terminated child to its father.
+ *
+ * @details Resources used by the children that @p child has waited for are
+ *          charged as well.
+ *
+ * @param father Father process.
+ * @param child  Terminated child process.
+ */
+PUBLIC void account_child(struct process *father, struct process *child)
+{
+	father->cutime += child->utime + child->cutime;
+	father->cktime += child->ktime + child->cktime;
+	pcounters_add(&father->cru, &child->ru);
+	pcounters_add(&father->cru, &child->cru);
+}
+
+/**
+ * @brief Charges user time on system call entry.
+ */
+PUBLIC void account_enter(void)
+{
+	account(curr_proc, FALSE);
+	curr_proc->ru.nsyscalls++;
+}
+
+/**
+ * @brief Charges kernel time on system call exit.
+ */
+PUBLIC void account_leave(void)
+{
+	account(curr_proc, TRUE);
+}
+
+/**
+ * @brief Fires expired alarms and nanosleep timers.
+ *
+ * @returns The number of processes that were awaken.
+ */
+PUBLIC int timer_expire(void)
+{
+	int n;             /* Awaken processes. */
+	uint64_t now;      /* Current time.     */
+	struct process *p; /* Working process.  */
+
+	n = 0;
+	now = clock_ns();
+
+	for (p = FIRST_PROC; p <= LAST_PROC; p++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
+			continue;
+
+		/* Alarm has expired. */
+		if ((p->alarm) && (p->alarm < ticks))
+			p->alarm = 0, sndsig(p, SIGALRM), n++;
+
+		/* Nanosleep has expired. */
+		if ((p->ns_deadline) && (p->ns_deadline <= now))
+			p->ns_deadline = 0, wakeup(&p->ns_chain), n++;
+	}
+
+	return (n);
+}
+
+/**
+ * @brief Programs the next clock event.
+ *
+ * @details Asks the clock to interrupt at the earliest of the pending alarms,
+ *          nanosleep deadlines, the next profiling sample and the end of the
+ *          quantum of @p proc, so that the processor is not woken up for
+ *          nothing.
+ *
+ * @param proc Process that is about to run.
+ */
+PUBLIC void timer_arm(struct process *proc)
+{
+	uint64_t now;      /* Current time.    */
+	uint64_t next;     /* Next deadline.   */
+	uint64_t alarm;    /* Alarm deadline.  */
+	struct process *p; /* Working process. */
+
+	now = clock_ns();
+	next = prof_next(now);
+
+	/* End of quantum. */
+	if (proc != IDLE)
+		next = now + (uint64_t)((proc->counter > 0) ? proc->counter : 1)*NSEC_PER_TICK;
+
+	for (p = FIRST_PROC; p <= LAST_PROC; p++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
+			continue;
+
+		if ((p->ns_deadline) && (p->ns_deadline < next))
+			next = p->ns_deadline;
+
+		if (p->alarm)
+		{
+			alarm = now + (uint64_t)((p->alarm >= ticks) ?
+				p->alarm - ticks + 1 : 0)*NSEC_PER_TICK;
+
+			if (alarm < next)
+				next = alarm;
+		}
+	}
+
+	clock_event(next);
+}
+
 /**
  * @brief Yields the processor.
  */
@@ -97,9 +257,12 @@ PUBLIC void yield(void)
 {
 	struct process *p;    /* Working process.     */
 	struct process *next; /* Next process to run. */
+	int preempted;        /* Preempted?           */
+
+	preempted = (curr_proc->state == PROC_RUNNING);
 
 	/* Re-schedule process for execution. */
-	if (curr_proc->state == PROC_RUNNING)
+	if (preempted)
 	{
 		sched(curr_proc);
 
@@ -120,22 +283,10 @@ PUBLIC void yield(void)
 
 	/* Remember this process. */
 	last_proc = curr_proc;
+	account(curr_proc, TRUE);
 
 	/* Check alarm and nanosleep. */
-	for (p = FIRST_PROC; p <= LAST_PROC; p++)
-	{
-		/* Skip invalid processes. */
-		if (!IS_VALID(p))
-			continue;
-
-		/* Alarm has expired. */
-		if ((p->alarm) && (p->alarm < ticks))
-			p->alarm = 0, sndsig(p, SIGALRM);
-
-		/* Nanosleep has expired. */
-		if ((p->ns_ticks) && (p->ns_ticks < ticks))
-			p->ns_ticks = 0, wakeup(&p->ns_chain);
-	}
+	timer_expire();
 
 	/* Choose a process to run next. */
 	next = IDLE;
@@ -190,9 +341,22 @@ PUBLIC void yield(void)
 		}
 	}
 
+	/* Program next clock event. */
+	timer_arm(next);
+
 	/* Schedule only different processes. */
 	if (curr_proc != next)
 	{
+		TRACE(TRACE_SWITCH, next->pid, curr_proc->state, 0);
+
+		nswitches++;
+		if (preempted)
+			curr_proc->ru.nivcsw++;
+		else
+			curr_proc->ru.nvcsw++;
+
+		next->tstamp = clock_ns();
+
 		/* Save and restore FPU/SIMD context. */
 		fpu_save(curr_proc);
 		fpu_restore(next);
@@ -122,7 +122,9 @@ PUBLIC void sndsig(struct process *proc, int sig)
 	/* Wake up process. */
 	if (proc->state == PROC_WAITING)
 	{
-		if (proc == *proc->chain)
+		if (proc->wq != NULL)
+			wq_remove(proc);
+		else if (proc == *proc->chain)
 			*proc->chain = proc->next;
 		else
 		{
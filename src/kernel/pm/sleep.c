@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
@@ -74,6 +75,8 @@ PUBLIC void sleep(struct process **chain, int priority)
 	curr_proc->priority = priority;
 	curr_proc->chain = chain;
 	
+	TRACE(TRACE_SLEEP, chain, priority, 0);
+	
 	yield();
 }
 
@@ -96,6 +99,9 @@ PUBLIC void wakeup(struct process **chain)
 		return;
 	}
 	
+	if (*chain != NULL)
+		TRACE(TRACE_WAKEUP, chain, (*chain)->pid, 0);
+	
 	/* Wakeup sleeping processes. */
 	while (*chain != NULL)
 	{
@@ -103,3 +109,205 @@ PUBLIC void wakeup(struct process **chain)
 		*chain = (*chain)->next;
 	}
 }
+
+/*============================================================================*
+ *                                Wait Queues                                 *
+ *============================================================================*/
+
+/**
+ * @brief Wait queue for idle process.
+ */
+PRIVATE struct waitq *idle_wq = NULL;
+
+/**
+ * @brief Initializes a wait queue.
+ * 
+ * @param wq Target wait queue.
+ */
+PUBLIC void waitq_init(struct waitq *wq)
+{
+	wq->head = NULL;
+	wq->tail = NULL;
+}
+
+/**
+ * @brief Removes a process from the wait queue where it is sleeping.
+ * 
+ * @param proc Target process.
+ * 
+ * @note This function runs in constant time.
+ */
+PUBLIC void wq_remove(struct process *proc)
+{
+	struct waitq *wq = proc->wq;
+
+	/* Nothing to do. */
+	if (wq == NULL)
+		return;
+
+	if (proc->wq_prev != NULL)
+		proc->wq_prev->wq_next = proc->wq_next;
+	else
+		wq->head = proc->wq_next;
+
+	if (proc->wq_next != NULL)
+		proc->wq_next->wq_prev = proc->wq_prev;
+	else
+		wq->tail = proc->wq_prev;
+
+	proc->wq = NULL;
+	proc->wq_next = NULL;
+	proc->wq_prev = NULL;
+	proc->flags &= ~(1 << PROC_EXCL);
+}
+
+/**
+ * @brief Puts the current process to sleep in a wait queue.
+ * 
+ * @details Puts the current process to sleep in the wait queue pointed to by
+ *          @p wq, with a priority @p priority. Shared waiters are all awaken
+ *          by wq_wakeup(), whereas exclusive waiters are awaken one at a time.
+ *          Shared waiters are inserted in the front of the queue, and
+ *          exclusive waiters are inserted in the back of the queue, in FIFO
+ *          order.
+ * 
+ *          If @p priority if greater than or equal to zero, then the process
+ *          is set to an interruptible sleeping state. Otherwise, it is put is
+ *          an uninterruptible sleeping state.
+ * 
+ * @param wq        Wait queue where the process should be put.
+ * @param priority  Priority that the process shall assume after waking up.
+ * @param exclusive Exclusive wait (WQ_EXCLUSIVE) or shared wait (WQ_SHARED)?
+ */
+PUBLIC void wq_sleep(struct waitq *wq, int priority, int exclusive)
+{
+	/* Idle process trying to sleep. See sleep(). */
+	if (curr_proc == IDLE)
+	{
+		idle_wq = wq;
+		enable_interrupts();
+		while (idle_wq == wq)
+			noop();
+		return;
+	}
+
+	/*
+	 * The sleep request is interruptible and the process
+	 * has already received a signal, so there is no
+	 * need to sleep.
+	 */
+	if ((priority >= 0) && (curr_proc->received))
+		return;
+
+	/* Exclusive waiter: insert in the back. */
+	if (exclusive)
+	{
+		curr_proc->flags |= (1 << PROC_EXCL);
+		curr_proc->wq_next = NULL;
+		curr_proc->wq_prev = wq->tail;
+		if (wq->tail != NULL)
+			wq->tail->wq_next = curr_proc;
+		else
+			wq->head = curr_proc;
+		wq->tail = curr_proc;
+	}
+
+	/* Shared waiter: insert in the front. */
+	else
+	{
+		curr_proc->flags &= ~(1 << PROC_EXCL);
+		curr_proc->wq_prev = NULL;
+		curr_proc->wq_next = wq->head;
+		if (wq->head != NULL)
+			wq->head->wq_prev = curr_proc;
+		else
+			wq->tail = curr_proc;
+		wq->head = curr_proc;
+	}
+
+	/* Put process to sleep. */
+	curr_proc->state = (priority >= 0) ? PROC_WAITING : PROC_SLEEPING;
+	curr_proc->priority = priority;
+	curr_proc->wq = wq;
+
+	TRACE(TRACE_SLEEP, wq, priority, exclusive);
+
+	yield();
+}
+
+/**
+ * @brief Wakes up processes that are sleeping in a wait queue.
+ * 
+ * @details Wakes up all shared waiters and the first exclusive waiter.
+ * 
+ * @param wq Target wait queue.
+ */
+PUBLIC void wq_wakeup(struct waitq *wq)
+{
+	int exclusive;
+	struct process *p;
+
+	/* Wakeup idle process. See wakeup(). */
+	if (idle_wq == wq)
+	{
+		idle_wq = NULL;
+		return;
+	}
+
+	if (wq->head != NULL)
+		TRACE(TRACE_WAKEUP, wq, wq->head->pid, 0);
+
+	while ((p = wq->head) != NULL)
+	{
+		exclusive = p->flags & (1 << PROC_EXCL);
+
+		wq_remove(p);
+		sched(p);
+
+		if (exclusive)
+			break;
+	}
+}
+
+/**
+ * @brief Passes on an exclusive wakeup that was not used.
+ * 
+ * @details An exclusive waiter that is woken up for an object, but goes for
+ *          another one after looking it up again, must wake up the next
+ *          waiter in its place. Otherwise, that waiter could sleep for good
+ *          on an object that is free.
+ * 
+ * @param woken Wait queue the caller was woken up on, or NULL.
+ * @param wq    Wait queue of the object the caller goes for, or NULL.
+ */
+PUBLIC void wq_handoff(struct waitq *woken, struct waitq *wq)
+{
+	if ((woken != NULL) && (woken != wq))
+		wq_wakeup(woken);
+}
+
+/**
+ * @brief Wakes up all processes that are sleeping in a wait queue.
+ * 
+ * @param wq Target wait queue.
+ */
+PUBLIC void wq_wakeup_all(struct waitq *wq)
+{
+	struct process *p;
+
+	/* Wakeup idle process. See wakeup(). */
+	if (idle_wq == wq)
+	{
+		idle_wq = NULL;
+		return;
+	}
+
+	if (wq->head != NULL)
+		TRACE(TRACE_WAKEUP, wq, wq->head->pid, 0);
+
+	while ((p = wq->head) != NULL)
+	{
+		wq_remove(p);
+		sched(p);
+	}
+}
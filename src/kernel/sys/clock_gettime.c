@@ -0,0 +1,72 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Gets the time of a clock.
+ *
+ * @param clk_id Target clock.
+ * @param tp     Where the time should be stored.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure, a
+ *          negative error code is returned instead.
+ */
+PUBLIC int sys_clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+	uint64_t ns;
+
+	/* Invalid buffer. */
+	if (!chkmem(tp, sizeof(struct timespec), MAY_WRITE))
+		return (-EFAULT);
+
+	switch (clk_id)
+	{
+		/* Wall clock time. */
+		case CLOCK_REALTIME:
+			ns = (uint64_t)startup_time*NSEC_PER_SEC + clock_ns();
+			break;
+
+		/* Time since boot. */
+		case CLOCK_MONOTONIC:
+			ns = clock_ns();
+			break;
+
+		/* CPU time of the calling process. */
+		case CLOCK_PROCESS_CPUTIME_ID:
+			account(curr_proc, TRUE);
+			ns = curr_proc->utime + curr_proc->ktime;
+			break;
+
+		default:
+			return (-EINVAL);
+	}
+
+	tp->tv_sec = ns/NSEC_PER_SEC;
+	tp->tv_nsec = ns%NSEC_PER_SEC;
+
+	return (0);
+}
@@ -24,6 +24,7 @@
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <sys/spawn.h>
 #include <elf.h>
 #include <errno.h>
 
@@ -48,7 +49,7 @@ PRIVATE int is_elf(struct elf32_fhdr *header)
  * region data when vfault in BSS sections occur.
  */
 PRIVATE void find_bss(
-	struct inode *inode, off_t shdr_off,
+	struct process *proc, struct inode *inode, off_t shdr_off,
 	size_t shdr_num, size_t shdr_size
 )
 {
@@ -94,7 +95,7 @@ PRIVATE void find_bss(
 		 * Saves the gathered data into the current
 		 * (already allocated) data region.
 		 */
-		preg = DATA(curr_proc);
+		preg = DATA(proc);
 		preg->reg->bss.start = sec[i].sh_addr;
 		preg->reg->bss.off   = sec[i].sh_offset;
 		preg->reg->bss.size  = sec[i].sh_size;
@@ -104,7 +105,7 @@ PRIVATE void find_bss(
 	/* If not found, fill with zeroed data. */
 	if (i == shdr_num)
 	{
-		preg = DATA(curr_proc);
+		preg = DATA(proc);
 		preg->reg->bss.start = 0;
 		preg->reg->bss.off   = 0;
 		preg->reg->bss.size  = 0;
@@ -121,9 +122,9 @@ error0:
 }
 
 /*
- * Loads an ELF 32 executable.
+ * Loads an ELF 32 executable into a process.
  */
-PRIVATE addr_t load_elf32(struct inode *inode)
+PRIVATE addr_t load_elf32(struct process *proc, struct inode *inode)
 {
 	int i;                  /* Loop index.                    */
 	addr_t addr;            /* Region address.                */
@@ -140,7 +141,14 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 	int ph_re;              /* Amount of Exec. Prog. Headers. */
 	int ph_rw;              /* Amount of RW Program Headers.  */
 	
-	blk = block_map(inode, 0, 0);
+	/* Not backed by disk blocks. */
+	if (inode->i_op->block_map == NULL)
+	{
+		curr_proc->errno = -ENOEXEC;
+		return (0);
+	}
+	
+	blk = inode->i_op->block_map(inode, 0, 0);
 	
 	/* Empty file. */
 	if (blk == BLOCK_NULL)
@@ -210,7 +218,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 				return (0);
 			}
 		
-			preg = TEXT(curr_proc);
+			preg = TEXT(proc);
 
 			/* Failed to allocate region. */
 			if ((reg = xalloc(inode, seg[i].p_offset, seg[i].p_filesz)) == NULL)
@@ -220,7 +228,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 		/* Data section. */
 		else
 		{
-			if (ph_rw > NR_DATA_REGIONS)
+			if (ph_rw >= NR_DATA_REGIONS)
 			{
 				kprintf("data sections exceed the maximum supported!");
 				
@@ -229,8 +237,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 				return (0);
 			}
 			
-			preg = DATA(curr_proc);
-			preg = DATA(curr_proc) + ph_rw;
+			preg = DATA(proc) + ph_rw;
 			ph_rw++;
 		
 			/* Failed to allocate region. */
@@ -241,7 +248,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 		}
 		
 		/* Attach memory region. */
-		if (attachreg(curr_proc, preg, addr, reg))
+		if (attachreg(proc, preg, addr, reg))
 		{
 			freereg(reg);
 			brelse(header);
@@ -270,7 +277,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 	 * errors will not abort the execve() execution and Nanvix will
 	 * try to proceed anyway.
 	 */
-	find_bss(inode, shdr_off, shdr_num, shdr_size);
+	find_bss(proc, inode, shdr_off, shdr_num, shdr_size);
 
 	return (entry);
 
@@ -460,6 +467,59 @@ PRIVATE const char *get_binary_name(const char *pathname)
 	return (binname);
 }
 
+/*
+ * Loads an executable into a process and attaches its stack and heap.
+ */
+PRIVATE addr_t load(struct process *proc, struct inode *inode)
+{
+	addr_t entry;       /* Program entry point. */
+	struct region *reg; /* Process region.      */
+	
+	/* Load executable. */
+	if (!(entry = load_elf32(proc, inode)))
+		return (0);
+
+	/* Attach stack region. */
+	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_DOWNWARDS)) == NULL)
+		goto error0;
+	if (attachreg(proc, STACK(proc), USTACK_ADDR - 1, reg))
+		goto error1;
+	unlockreg(reg);
+
+	/* Attach heap region. */
+	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_UPWARDS)) == NULL)
+		goto error0;
+	if (attachreg(proc, HEAP(proc), UHEAP_ADDR, reg))
+		goto error1;
+	unlockreg(reg);
+	
+	return (entry);
+
+error1:
+	freereg(reg);
+error0:
+	curr_proc->errno = -ENOMEM;
+	return (0);
+}
+
+/*
+ * Resets caught signals to their default actions.
+ */
+PRIVATE void resetsig(struct process *proc)
+{
+	int i;
+	
+	proc->restorer = NULL;
+	for (i = 0; i < NR_SIGNALS; i++)
+	{
+		if (proc->handlers[i] != SIG_DFL)
+		{
+			if (proc->handlers[i] != SIG_IGN)
+				proc->handlers[i] = SIG_DFL;
+		}
+	}
+}
+
 /*
  * Executes a program.
  */
@@ -467,7 +527,6 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 {
 	int i;                /* Loop index.          */
 	struct inode *inode;  /* File inode.          */
-	struct region *reg;   /* Process region.      */
 	addr_t entry;         /* Program entry point. */
 	addr_t sp;            /* User stack pointer.  */
 	char *pathname;       /* Path name.           */
@@ -516,38 +575,16 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 	}
 	
 	/* Reset signal handlers. */
-	curr_proc->restorer = NULL;
-	for (i = 0; i < NR_SIGNALS; i++)
-	{
-		if (curr_proc->handlers[i] != SIG_DFL)
-		{
-			if (curr_proc->handlers[i] != SIG_IGN)
-				curr_proc->handlers[i] = SIG_DFL;
-		}
-	}
+	resetsig(curr_proc);
 
 	/* Detach process memory regions. */
 	for (i = 0; i < NR_PREGIONS; i++)
 		detachreg(curr_proc, &curr_proc->pregs[i]);
 	
 	/* Load executable. */
-	if (!(entry = load_elf32(inode)))
+	if (!(entry = load(curr_proc, inode)))
 		goto die0;
 
-	/* Attach stack region. */
-	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_DOWNWARDS)) == NULL)
-		goto die0;
-	if (attachreg(curr_proc, STACK(curr_proc), USTACK_ADDR - 1, reg))
-		goto die1;
-	unlockreg(reg);
-
-	/* Attach heap region. */
-	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_UPWARDS)) == NULL)
-		goto die0;
-	if (attachreg(curr_proc, HEAP(curr_proc), UHEAP_ADDR, reg))
-		goto die1;
-	unlockreg(reg);
-
 	/* Assign binary name to the process name. */
 	kstrncpy(curr_proc->name, get_binary_name(pathname), NAME_MAX);
 	
@@ -561,11 +598,366 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 	/* Will not return. */
 	return (0);
 
-die1:
-	freereg(reg);
 die0:
 	inode_put(inode);
 	putname(pathname);
 	die(((SIGSEGV & 0xff) << 16) | (1 << 9));
 	return (-1);
 }
+
+/*
+ * Releases a file descriptor table built by spawn_files().
+ */
+PRIVATE void spawn_putfiles(struct file **ofiles)
+{
+	int i;
+	
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		if (ofiles[i] != NULL)
+		{
+			putfile(ofiles[i]);
+			ofiles[i] = NULL;
+		}
+	}
+}
+
+/*
+ * Builds the file descriptor table of a spawned process.
+ *
+ * The table of the calling process is duplicated, file actions are
+ * applied in order and, as execve() would do, file descriptors that
+ * are marked as close-on-exec are closed at last.
+ */
+PRIVATE int spawn_files
+(struct file **ofiles, const struct spawn_action *actions, int nactions)
+{
+	int i;               /* Loop index.         */
+	int fd;              /* File descriptor.    */
+	int newfd;           /* Target descriptor.  */
+	int close;           /* Close on exec?      */
+	char *name;          /* Path name.          */
+	struct file *f;      /* File.               */
+	struct inode *inode; /* Underlying inode.   */
+	
+	/* Duplicate file descriptor table. */
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		if ((ofiles[i] = curr_proc->ofiles[i]) != NULL)
+			ofiles[i]->count++;
+	}
+	close = curr_proc->close;
+	
+	/* Apply file actions. */
+	for (i = 0; i < nactions; i++)
+	{
+		fd = actions[i].fd;
+		
+		/* Bad file descriptor. */
+		if ((fd < 0) || (fd >= OPEN_MAX))
+			goto ebadf;
+		
+		switch (actions[i].type)
+		{
+			/* Open file. */
+			case SPAWN_OPEN:
+				if ((name = getname(actions[i].path)) == NULL)
+					goto error;
+				
+				/* Too many files open in the system. */
+				if ((f = getfile()) == NULL)
+				{
+					putname(name);
+					curr_proc->errno = -ENFILE;
+					goto error;
+				}
+				
+				f->count = 1;
+				if ((inode = do_open(name, actions[i].oflag, actions[i].mode)) == NULL)
+				{
+					putname(name);
+					f->count = 0;
+					goto error;
+				}
+				putname(name);
+				
+				f->oflag = actions[i].oflag;
+				f->pos = 0;
+				f->inode = inode;
+				
+				if (ofiles[fd] != NULL)
+					putfile(ofiles[fd]);
+				ofiles[fd] = f;
+				close &= ~(1 << fd);
+				break;
+			
+			/* Close file. */
+			case SPAWN_CLOSE:
+				if (ofiles[fd] != NULL)
+				{
+					putfile(ofiles[fd]);
+					ofiles[fd] = NULL;
+				}
+				break;
+			
+			/* Duplicate file descriptor. */
+			case SPAWN_DUP2:
+				newfd = actions[i].newfd;
+				
+				/* Bad file descriptor. */
+				if ((newfd < 0) || (newfd >= OPEN_MAX) || (ofiles[fd] == NULL))
+					goto ebadf;
+				
+				if (newfd != fd)
+				{
+					ofiles[fd]->count++;
+					if (ofiles[newfd] != NULL)
+						putfile(ofiles[newfd]);
+					ofiles[newfd] = ofiles[fd];
+				}
+				close &= ~(1 << newfd);
+				break;
+			
+			/* Invalid action. */
+			default:
+				curr_proc->errno = -EINVAL;
+				goto error;
+		}
+	}
+	
+	/* Close file descriptors. */
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		if ((close & (1 << i)) && (ofiles[i] != NULL))
+		{
+			putfile(ofiles[i]);
+			ofiles[i] = NULL;
+		}
+	}
+	
+	return (0);
+
+ebadf:
+	curr_proc->errno = -EBADF;
+error:
+	spawn_putfiles(ofiles);
+	return (-1);
+}
+
+/*
+ * Creates a process that executes a program.
+ *
+ * The child is built directly from the executable: the address space of
+ * the calling process is never duplicated, and arguments are copied
+ * straight into the first page of the new user stack.
+ */
+PUBLIC pid_t sys_spawn
+(const char *filename, const char **argv, const char **envp, const struct spawn *sp)
+{
+	int i;                                          /* Loop index.          */
+	int err;                                        /* Error code.          */
+	pid_t pid;                                      /* Child's ID.          */
+	addr_t entry;                                   /* Program entry point. */
+	addr_t usp;                                     /* User stack pointer.  */
+	char *pathname;                                 /* Path name.           */
+	char *stack;                                    /* Stack page.          */
+	struct inode *inode;                            /* File inode.          */
+	struct process *p;                              /* Working process.     */
+	struct process *proc;                           /* Child process.       */
+	struct process *pgrp;                           /* Process group.       */
+	struct intstack *s;                             /* Child's registers.   */
+	struct spawn attr;                              /* Spawn attributes.    */
+	struct spawn_action actions[SPAWN_ACTIONS_MAX]; /* File actions.        */
+	struct file *ofiles[OPEN_MAX];                  /* File descriptors.    */
+	
+	/* Get spawn attributes. */
+	if (sp == NULL)
+		kmemset(&attr, 0, sizeof(struct spawn));
+	else
+	{
+		if (!chkmem(sp, sizeof(struct spawn), MAY_READ))
+			return (-EFAULT);
+		kmemcpy(&attr, sp, sizeof(struct spawn));
+	}
+	
+	/* Unsupported attributes. */
+	if (attr.flags & ~(SPAWN_RESETIDS | SPAWN_SETPGROUP | SPAWN_SETSIGDEF))
+		return (-EINVAL);
+	
+	/* Get file actions. */
+	if ((attr.nactions < 0) || (attr.nactions > SPAWN_ACTIONS_MAX))
+		return (-EINVAL);
+	if (attr.nactions > 0)
+	{
+		if (!chkmem(attr.actions, attr.nactions*sizeof(struct spawn_action), MAY_READ))
+			return (-EFAULT);
+		kmemcpy(actions, attr.actions, attr.nactions*sizeof(struct spawn_action));
+	}
+	
+	/* Get process group. */
+	pgrp = NULL;
+	if ((attr.flags & SPAWN_SETPGROUP) && (attr.pgroup != 0))
+	{
+		for (p = FIRST_PROC; p <= LAST_PROC; p++)
+		{
+			if ((IS_VALID(p)) && (p->pid == attr.pgroup))
+				break;
+		}
+		
+		/* No such process group. */
+		if ((p > LAST_PROC) || (!IS_LEADER(p)))
+			return (-EPERM);
+		
+		pgrp = p;
+	}
+	
+	/* Get path name. */
+	if ((pathname = getname(filename)) == NULL)
+		return (curr_proc->errno);
+	
+	/* Build arguments. */
+	if ((stack = getkpg(1)) == NULL)
+	{
+		err = -ENOMEM;
+		goto error0;
+	}
+	if (!(usp = buildargs(stack + PAGE_SIZE - ARG_MAX, ARG_MAX, argv, envp)))
+	{
+		err = curr_proc->errno;
+		goto error1;
+	}
+	
+	/* Get file's inode. */
+	if ((inode = inode_name(pathname)) == NULL)
+	{
+		err = curr_proc->errno;
+		goto error1;
+	}
+	
+	/* Not a regular file. */
+	if (!S_ISREG(inode->mode))
+	{
+		err = -EACCES;
+		goto error2;
+	}
+	
+	/* Not allowed. */
+	if (!permission(inode->mode, inode->uid, inode->gid, curr_proc, MAY_EXEC, 0))
+	{
+		err = -EACCES;
+		goto error2;
+	}
+	
+	/*
+	 * Build file descriptor table only now, so that a
+	 * failed spawn does not create or truncate files.
+	 * The executable is unlocked meanwhile, since file
+	 * actions may open it as well.
+	 */
+	inode_unlock(inode);
+	err = spawn_files(ofiles, actions, attr.nactions);
+	inode_lock(inode);
+	if (err)
+	{
+		err = curr_proc->errno;
+		goto error2;
+	}
+	
+	if ((proc = proc_alloc()) == NULL)
+	{
+		err = -EAGAIN;
+		goto error3;
+	}
+	
+	/* Failed to create process page directory. */
+	if (crtpgdir(proc))
+	{
+		proc->flags = 0;
+		err = -ENOMEM;
+		goto error3;
+	}
+	
+	/* Load executable. */
+	if (!(entry = load(proc, inode)))
+	{
+		err = curr_proc->errno;
+		goto error4;
+	}
+	
+	/* Fill in the first page of the user stack. */
+	if (upgfill(proc, USTACK_ADDR - PAGE_SIZE, stack))
+	{
+		err = -ENOMEM;
+		goto error4;
+	}
+	
+	/* Initialize process. */
+	proc_inherit(proc);
+	for (i = 0; i < OPEN_MAX; i++)
+		proc->ofiles[i] = ofiles[i];
+	proc->close = 0;
+	resetsig(proc);
+	kstrncpy(proc->name, get_binary_name(pathname), NAME_MAX);
+	
+	/* Reset signals to default actions. */
+	if (attr.flags & SPAWN_SETSIGDEF)
+	{
+		for (i = 1; i < NR_SIGNALS; i++)
+		{
+			if (attr.sigdefault & (1 << i))
+				proc->handlers[i] = SIG_DFL;
+		}
+	}
+	
+	/* Set process group. */
+	if (attr.flags & SPAWN_SETPGROUP)
+		proc->pgrp = (pgrp != NULL) ? pgrp : proc;
+	
+	/* Reset effective IDs. */
+	if (attr.flags & SPAWN_RESETIDS)
+	{
+		proc->euid = proc->uid;
+		proc->egid = proc->gid;
+	}
+	
+	/* Start at the program's entry point. */
+	s = (struct intstack *)proc->kesp;
+#ifdef i386
+	s->eip = entry;
+	s->useresp = usp;
+	s->ebp = 0;
+#elif or1k
+	s->epcr = entry;
+	s->gpr[1] = usp;
+	s->gpr[2] = 0;
+#endif
+	
+	sched(proc);
+	
+	curr_proc->nchildren++;
+	
+	nprocs++;
+	
+	pid = proc->pid;
+	
+	inode_put(inode);
+	putkpg(stack);
+	putname(pathname);
+	
+	return (pid);
+
+error4:
+	for (i = 0; i < NR_PREGIONS; i++)
+		detachreg(proc, &proc->pregs[i]);
+	dstrypgdir(proc);
+	proc->flags = 0;
+error3:
+	spawn_putfiles(ofiles);
+error2:
+	inode_put(inode);
+error1:
+	putkpg(stack);
+error0:
+	putname(pathname);
+	return (err);
+}
@@ -17,25 +17,27 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/clock.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <sys/sem.h>
 #include <sys/types.h>
 #include <errno.h>
 
-/*
- * Creates a new process.
+/**
+ * @brief Allocates a process table entry.
+ *
+ * @returns Upon success, a process table entry that is marked as being
+ *          created is returned. If the process table is full, a NULL
+ *          pointer is returned instead.
  */
-PUBLIC pid_t sys_fork(void)
+PUBLIC struct process *proc_alloc(void)
 {
-	int i;                /* Loop index.     */
-	int err;              /* Error?          */
-	struct process *proc; /* Process.        */
-	struct region *reg;   /* Memory region.  */
-	struct pregion *preg; /* Process region. */
+	struct process *proc;
 
 	/*
 	 * Prevent non-privileged user from using the last
@@ -43,7 +45,7 @@ PUBLIC pid_t sys_fork(void)
 	 * user can invoke kill() if something goes wrong.
 	 */
 	if ((nprocs + 1 >= PROC_MAX) && (!IS_SUPERUSER(curr_proc)))
-		return (-EAGAIN);
+		return (NULL);
 
 	/* Search for a free process. */
 	for (proc = FIRST_PROC; proc <= LAST_PROC; proc++)
@@ -55,12 +57,87 @@ PUBLIC pid_t sys_fork(void)
 
 	kprintf("process table overflow");
 
-	return (-EAGAIN);
+	return (NULL);
 
 found:
 
 	/* Mark process as beeing created. */
 	proc->flags = 1 << PROC_NEW;
+	proc->size = 0;
+
+	return (proc);
+}
+
+/**
+ * @brief Initializes a child of the calling process.
+ *
+ * @param proc Target process.
+ *
+ * @details All attributes but memory regions and opened files are inherited
+ *          from the calling process.
+ */
+PUBLIC void proc_inherit(struct process *proc)
+{
+	int i;
+
+	proc->intlvl = 1;
+	proc->received = 0;
+	proc->restorer = curr_proc->restorer;
+	kmemcpy(&proc->simd_state, &curr_proc->simd_state, sizeof(proc->simd_state));
+	for (i = 0; i < NR_SIGNALS; i++)
+		proc->handlers[i] = curr_proc->handlers[i];
+	proc->irqlvl = curr_proc->irqlvl;
+	proc->pmcs.enable_counters = 0;
+	proc->pwd = curr_proc->pwd;
+	proc->pwd->count++;
+	proc->root = curr_proc->root;
+	proc->root->count++;
+	proc->umask = curr_proc->umask;
+	proc->tty = curr_proc->tty;
+	proc->status = 0;
+	proc->nchildren = 0;
+	proc->uid = curr_proc->uid;
+	proc->euid = curr_proc->euid;
+	proc->suid = curr_proc->suid;
+	proc->gid = curr_proc->gid;
+	proc->egid = curr_proc->egid;
+	proc->sgid = curr_proc->sgid;
+	proc->pid = next_pid++;
+	proc->pgrp = curr_proc->pgrp;
+	proc->father = curr_proc;
+	kstrncpy(proc->name, curr_proc->name, NAME_MAX);
+	proc->utime = 0;
+	proc->ktime = 0;
+	proc->cutime = 0;
+	proc->cktime = 0;
+	proc->tstamp = clock_ns();
+	kmemset(&proc->ru, 0, sizeof(struct pcounters));
+	kmemset(&proc->cru, 0, sizeof(struct pcounters));
+	proc->priority = curr_proc->priority;
+	proc->nice = curr_proc->nice;
+	proc->alarm = 0;
+	proc->ns_deadline = 0;
+	proc->ns_chain = NULL;
+	proc->next = NULL;
+	proc->chain = NULL;
+	proc->wq = NULL;
+	proc->wq_next = NULL;
+	proc->wq_prev = NULL;
+}
+
+/*
+ * Creates a new process.
+ */
+PUBLIC pid_t sys_fork(void)
+{
+	int i;                /* Loop index.     */
+	int err;              /* Error?          */
+	struct process *proc; /* Process.        */
+	struct region *reg;   /* Memory region.  */
+	struct pregion *preg; /* Process region. */
+
+	if ((proc = proc_alloc()) == NULL)
+		return (-EAGAIN);
 
 	err = crtpgdir(proc);
 
@@ -81,6 +158,14 @@ found:
 		if (preg == NULL || preg->reg == NULL)
 			continue;
 
+		/* Semaphore counters are shared, not copied. */
+		if (preg == SEMS(curr_proc))
+		{
+			if (semdup(proc))
+				goto error1;
+			continue;
+		}
+
 		lockreg(preg->reg);
 		reg = dupreg(preg->reg);
 		unlockreg(preg->reg);
@@ -106,19 +191,7 @@ found:
 	}
 
 	/* Initialize process. */
-	proc->intlvl = 1;
-	proc->received = 0;
-	proc->restorer = curr_proc->restorer;
-	kmemcpy(&proc->simd_state, &curr_proc->simd_state, sizeof(proc->simd_state));
-	for (i = 0; i < NR_SIGNALS; i++)
-		proc->handlers[i] = curr_proc->handlers[i];
-	proc->irqlvl = curr_proc->irqlvl;
-	proc->pmcs.enable_counters = 0;
-	proc->size = curr_proc->size;
-	proc->pwd = curr_proc->pwd;
-	proc->pwd->count++;
-	proc->root = curr_proc->root;
-	proc->root->count++;
+	proc_inherit(proc);
 	for (i = 0; i < OPEN_MAX; i++)
 	{
 		proc->ofiles[i] = curr_proc->ofiles[i];
@@ -128,31 +201,6 @@ found:
 			proc->ofiles[i]->count++;
 	}
 	proc->close = curr_proc->close;
-	proc->umask = curr_proc->umask;
-	proc->tty = curr_proc->tty;
-	proc->status = 0;
-	proc->nchildren = 0;
-	proc->uid = curr_proc->uid;
-	proc->euid = curr_proc->euid;
-	proc->suid = curr_proc->suid;
-	proc->gid = curr_proc->gid;
-	proc->egid = curr_proc->egid;
-	proc->sgid = curr_proc->sgid;
-	proc->pid = next_pid++;
-	proc->pgrp = curr_proc->pgrp;
-	proc->father = curr_proc;
-	kstrncpy(proc->name, curr_proc->name, NAME_MAX);
-	proc->utime = 0;
-	proc->ktime = 0;
-	proc->cutime = 0;
-	proc->cktime = 0;
-	proc->priority = curr_proc->priority;
-	proc->nice = curr_proc->nice;
-	proc->alarm = 0;
-	proc->ns_ticks = 0;
-	proc->ns_chain = NULL;
-	proc->next = NULL;
-	proc->chain = NULL;
 	sched(proc);
 
 	curr_proc->nchildren++;
@@ -0,0 +1,233 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/syscall.h>
+#include <sys/futex.h>
+#include <errno.h>
+
+/**
+ * @brief Number of futexes.
+ *
+ * @details A process sleeps on at most one futex at a time, so there is no
+ *          point in having more futexes than processes.
+ */
+#define NR_FUTEXES PROC_MAX
+
+/**
+ * @brief Futex.
+ *
+ * @details A futex is identified by the memory region and the offset of the
+ *          word it refers to, rather than by its virtual address. Thus,
+ *          processes that share a memory region at different addresses
+ *          still agree on the futex, while private regions never collide.
+ */
+PRIVATE struct futex
+{
+	struct region *reg; /**< Underlying memory region.   */
+	addr_t off;         /**< Offset within that region.  */
+	int count;          /**< Number of waiting processes. */
+	struct waitq wq;    /**< Waiting processes.          */
+} futextab[NR_FUTEXES];
+
+/**
+ * @brief Locates the memory region of a futex word.
+ *
+ * @param uaddr Address of the futex word.
+ *
+ * @returns Upon success, the process memory region where the futex word
+ *          lies is returned. Upon failure, a NULL pointer is returned
+ *          instead.
+ */
+PRIVATE struct pregion *futex_region(int *uaddr)
+{
+	struct pregion *preg;
+
+	/* Misaligned word. */
+	if (ADDR(uaddr) & (sizeof(int) - 1))
+		return (NULL);
+
+	if ((preg = findreg(curr_proc, ADDR(uaddr))) == NULL)
+		return (NULL);
+
+	/* Not allowed. */
+	if (!(accessreg(curr_proc, preg->reg) & MAY_WRITE))
+		return (NULL);
+
+	/* Hole in the region, such as an unopened semaphore counter. */
+	if (!upgvalid(curr_proc, ADDR(uaddr)))
+		return (NULL);
+
+	return (preg);
+}
+
+/**
+ * @brief Looks up a futex.
+ *
+ * @param preg  Process memory region where the futex word lies.
+ * @param uaddr Address of the futex word.
+ * @param alloc Allocate the futex if it is not in use?
+ *
+ * @returns The futex that refers to the word, or a NULL pointer if there is
+ *          no such futex and @p alloc is zero.
+ */
+PRIVATE struct futex *futex_get(struct pregion *preg, int *uaddr, int alloc)
+{
+	addr_t off;
+	struct region *reg;
+	struct futex *f, *free;
+
+	/*
+	 * Each process has a view of the semaphore counters
+	 * of its own, laid out the same way, so the offset
+	 * alone identifies a counter.
+	 */
+	reg = (preg == SEMS(curr_proc)) ? NULL : preg->reg;
+	off = ADDR(uaddr) - preg->start;
+	free = NULL;
+
+	for (f = &futextab[0]; f < &futextab[NR_FUTEXES]; f++)
+	{
+		/* Skip unused futexes. */
+		if (f->count == 0)
+		{
+			if (free == NULL)
+				free = f;
+			continue;
+		}
+
+		/* Found. */
+		if ((f->reg == reg) && (f->off == off))
+			return (f);
+	}
+
+	/* Allocate futex. */
+	if ((alloc) && (free != NULL))
+	{
+		free->reg = reg;
+		free->off = off;
+		return (free);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Sleeps on a futex word.
+ *
+ * @param uaddr Address of the futex word.
+ * @param val   Expected value of the futex word.
+ *
+ * @returns Upon successful completion, zero is returned. If the futex word
+ *          does not hold @p val, -EAGAIN is returned. If the calling process
+ *          was interrupted by a signal, -EINTR is returned.
+ *
+ * @note The kernel is non-preemptive, so no other process may change the
+ *       futex word between the check and the sleep.
+ */
+PUBLIC int futex_wait(int *uaddr, int val)
+{
+	struct futex *f;
+	struct pregion *preg;
+
+	if ((preg = futex_region(uaddr)) == NULL)
+		return (-EFAULT);
+
+	/* Word has changed. */
+	if (*uaddr != val)
+		return (-EAGAIN);
+
+	if ((f = futex_get(preg, uaddr, 1)) == NULL)
+		return (-ENOLCK);
+
+	f->count++;
+	wq_sleep(&f->wq, curr_proc->priority, WQ_EXCLUSIVE);
+	f->count--;
+
+	/* Awaken by a signal. */
+	if (issig())
+	{
+		/* Pass on a wakeup that we may have consumed. */
+		if (f->count > 0)
+			wq_wakeup(&f->wq);
+
+		return (-EINTR);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Wakes up processes sleeping on a futex word.
+ *
+ * @param uaddr Address of the futex word.
+ * @param n     Maximum number of processes to wake up.
+ *
+ * @returns Upon successful completion, the number of processes awaken is
+ *          returned. Upon failure, a negative error code is returned instead.
+ */
+PUBLIC int futex_wake(int *uaddr, int n)
+{
+	int woken;
+	struct futex *f;
+	struct pregion *preg;
+
+	if ((preg = futex_region(uaddr)) == NULL)
+		return (-EFAULT);
+
+	/* Nobody is waiting. */
+	if ((f = futex_get(preg, uaddr, 0)) == NULL)
+		return (0);
+
+	/* Waiters are exclusive, so each wakeup releases a single one. */
+	for (woken = 0; (woken < n) && (f->wq.head != NULL); woken++)
+		wq_wakeup(&f->wq);
+
+	return (woken);
+}
+
+/**
+ * @brief Waits on or wakes up processes waiting on a user address.
+ *
+ * @param uaddr Address of the futex word.
+ * @param op    Operation: FUTEX_WAIT or FUTEX_WAKE.
+ * @param val   Expected value for FUTEX_WAIT, or maximum number of processes
+ *              to wake up for FUTEX_WAKE.
+ *
+ * @returns See futex_wait() and futex_wake().
+ */
+PUBLIC int sys_futex(int *uaddr, int op, int val)
+{
+	switch (op)
+	{
+		case FUTEX_WAIT:
+			return (futex_wait(uaddr, val));
+
+		case FUTEX_WAKE:
+			return (futex_wake(uaddr, val));
+
+		default:
+			break;
+	}
+
+	return (-EINVAL);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/mm.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Reads directory entries along with their status.
+ */
+PUBLIC ssize_t sys_getdentsplus(int fd, struct dirplus *buf, size_t n)
+{
+	struct file *f;  /* File.                 */
+	ssize_t count;   /* Bytes actually read.  */
+	
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (-EBADF);
+	
+	/* File not opened for reading. */
+	if (ACCMODE(f->oflag) == O_WRONLY)
+		return (-EBADF);
+	
+	/* Not a directory. */
+	if (!S_ISDIR(f->inode->mode))
+		return (-ENOTDIR);
+	
+	/* Buffer too small. */
+	if (n < sizeof(struct dirplus))
+		return (-EINVAL);
+	
+	/* Invalid buffer. */
+	if (!chkmem(buf, n, MAY_WRITE))
+		return (-EFAULT);
+	
+	count = dir_readplus(f->inode, buf, n, &f->pos);
+	
+	/* Failed to read. */
+	if (count < 0)
+		return (curr_proc->errno);
+	
+	return (count);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/resource.h>
+#include <errno.h>
+#include <stdint.h>
+
+/**
+ * @brief Converts nanoseconds to a time value.
+ *
+ * @param tv Target time value.
+ * @param ns Nanoseconds.
+ */
+PRIVATE void ns2tv(struct timeval *tv, uint64_t ns)
+{
+	tv->tv_sec = ns/NSEC_PER_SEC;
+	tv->tv_usec = (ns%NSEC_PER_SEC)/NSEC_PER_USEC;
+}
+
+/**
+ * @brief Gets resource usage.
+ *
+ * @param who   RUSAGE_SELF or RUSAGE_CHILDREN.
+ * @param usage Where to store resource usage.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure, a
+ *          negative error code is returned instead.
+ */
+PUBLIC int sys_getrusage(int who, struct rusage *usage)
+{
+	uint64_t utime;           /* User time.      */
+	uint64_t ktime;           /* Kernel time.    */
+	const struct pcounters *c; /* Usage counters. */
+
+	/* Not a valid buffer. */
+	if (!chkmem(usage, sizeof(struct rusage), MAY_WRITE))
+		return (-EINVAL);
+
+	/* Calling process. */
+	if (who == RUSAGE_SELF)
+	{
+		account(curr_proc, TRUE);
+		utime = curr_proc->utime;
+		ktime = curr_proc->ktime;
+		c = &curr_proc->ru;
+	}
+
+	/* Terminated children. */
+	else if (who == RUSAGE_CHILDREN)
+	{
+		utime = curr_proc->cutime;
+		ktime = curr_proc->cktime;
+		c = &curr_proc->cru;
+	}
+
+	else
+		return (-EINVAL);
+
+	ns2tv(&usage->ru_utime, utime);
+	ns2tv(&usage->ru_stime, ktime);
+	usage->ru_minflt = c->minflt + c->cowflt;
+	usage->ru_majflt = c->majflt;
+	usage->ru_inblock = c->inblock;
+	usage->ru_oublock = c->oublock;
+	usage->ru_nvcsw = c->nvcsw;
+	usage->ru_nivcsw = c->nivcsw;
+
+	return (0);
+}
@@ -34,6 +34,7 @@ PUBLIC int sys_mkfs(const char *diskfile, const char *fs_name, int size)
 	unsigned nblocks;		/* # data blocks in the file system.	*/
 	char * kdiskfile;		/* file of the diskfile 				*/
 	char * kfs_name;		/* name of the file system				*/
+	int ret;				/* Return value.						*/
 
 	/*Get the number of inode*/
 	ninodes=size >>16;
@@ -47,10 +48,17 @@ PUBLIC int sys_mkfs(const char *diskfile, const char *fs_name, int size)
 	
 	/* Get target directory. */
 	if ((kfs_name = getname(fs_name)) == NULL)
+	{
+		putname(kdiskfile);
 		return (curr_proc->errno);
+	}
 
 	kprintf("%s,%s,%d,%d",kdiskfile,kfs_name, ninodes, nblocks);
 
-	mkfs(diskfile, ninodes, nblocks,0,0);
-	return 1;
+	ret = mkfs(kdiskfile, kfs_name, ninodes, nblocks,0,0);
+	
+	putname(kfs_name);
+	putname(kdiskfile);
+	
+	return (ret);
 }
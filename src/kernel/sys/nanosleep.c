@@ -20,9 +20,12 @@
 #include <nanvix/const.h>
 #include <nanvix/klib.h>
 #include <nanvix/clock.h>
+#include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <sys/types.h>
 #include <errno.h>
 #include <signal.h>
+#include <time.h>
 
 /*
  * @brief Puts the current process to sleep for a given
@@ -30,44 +33,62 @@
  *
  * @param tv_sec Seconds to sleep.
  * @param tv_nsec Nanoseconds to sleep.
+ * @param rmtp If not NULL and the sleep is interrupted by a
+ * signal, the remaining time to sleep is stored in it.
  *
- * @return Returns 0 if success, otherwise, the number of remaining
- * ticks to sleep.
+ * @return Returns 0 if success, otherwise, a negative error
+ * code.
  *
- * @note: Although Nanvix appears to support nanosecond precision,
- * it actually supports millisecond precision. If tv_nsec is less
- * than the supported precision, the process will sleep for the
- * shortest supported time (currently 10ms).
+ * @note The sleep deadline is kept in nanoseconds and the clock
+ * is programmed to fire right at it, so the actual precision is
+ * bounded by the clocksource (microseconds on TSC-capable CPUs)
+ * rather than by the clock tick.
  */
-PUBLIC int sys_nanosleep(int tv_sec, int tv_nsec)
+PUBLIC int sys_nanosleep(int tv_sec, int tv_nsec, struct timespec *rmtp)
 {
-	int curr_ticks;
-	int tv_msec;
-	curr_ticks = ticks;
+	uint64_t now;
+	uint64_t deadline;
+	uint64_t remaining;
 
 	/* Values range. */
 	if (tv_sec < 0 || tv_nsec < 0 || tv_sec >= 1000000000 || tv_nsec >= 1000000000)
 		return (-EINVAL);
 
-	/* Nanvix only supports ms precision. */
-	tv_msec = tv_nsec/1000000;
-	curr_proc->ns_ticks = curr_ticks + tv_sec*CLOCK_FREQ;
+	/* Invalid buffer. */
+	if ((rmtp != NULL) && (!chkmem(rmtp, sizeof(struct timespec), MAY_WRITE)))
+		return (-EFAULT);
 
-	/*
-	 * Check if Nanvix is able to proceed with the given granularity (ms),
-	 * if not, lets sleep within the minimal amount of time supported.
-	 */
-	if (tv_msec >= CLOCK_INTERVAL_PER_MS)
-		curr_proc->ns_ticks += (unsigned) tv_msec/CLOCK_INTERVAL_PER_MS;
-	else if (tv_nsec != 0)
-		curr_proc->ns_ticks += 1;
+	/* Nothing to do. */
+	if ((tv_sec == 0) && (tv_nsec == 0))
+		return (0);
+
+	curr_proc->ns_deadline = clock_ns() +
+		(uint64_t)tv_sec*NSEC_PER_SEC + (unsigned)tv_nsec;
 
 	/* Susped process. */
 	sleep(&curr_proc->ns_chain, PRIO_USER);
 
 	/*  Wakeup on signal receipt. */
 	if (issig() != SIGNULL)
-		return (curr_proc->ns_ticks - ticks);
+	{
+		now = clock_ns();
+		deadline = curr_proc->ns_deadline;
+		curr_proc->ns_deadline = 0;
+
+		/* Deadline is already gone. */
+		if (deadline <= now)
+			return (0);
+
+		remaining = deadline - now;
+
+		if (rmtp != NULL)
+		{
+			rmtp->tv_sec = remaining/NSEC_PER_SEC;
+			rmtp->tv_nsec = remaining%NSEC_PER_SEC;
+		}
+
+		return (-EINTR);
+	}
 
 	return (0);
 }
@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/clock.h>
 #include <nanvix/klib.h>
 #include <nanvix/pm.h>
 
@@ -98,10 +99,10 @@ PUBLIC int sys_ps()
 		prepareValue(p->nice, nice, 7);
 
 		/* Utime */
-		prepareValue(p->utime, utime, 8);
+		prepareValue(p->utime/NSEC_PER_TICK, utime, 8);
 
 		/* Ktime */
-		prepareValue(p->ktime, ktime, 10);
+		prepareValue(p->ktime/NSEC_PER_TICK, ktime, 10);
 		
 		kprintf("%s%s%s%s%s%s%s%s",name, pid, 
 			uid, priority, nice, utime, ktime, states[(int)p->state] );
@@ -0,0 +1,92 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/pstat.h>
+#include <errno.h>
+
+/* Error checking. */
+#if (PSTAT_ZOMBIE != PROC_ZOMBIE) || (PSTAT_RUNNING != PROC_RUNNING) || \
+    (PSTAT_READY != PROC_READY) || (PSTAT_WAITING != PROC_WAITING) ||   \
+    (PSTAT_SLEEPING != PROC_SLEEPING) || (PSTAT_STOPPED != PROC_STOPPED)
+	#error "process states do not match"
+#endif
+
+/**
+ * @brief Takes a snapshot of the process table.
+ *
+ * @param buf Where to store process snapshots.
+ * @param n   Number of entries in @p buf.
+ *
+ * @returns Upon successful completion, the number of snapshots stored in
+ *          @p buf is returned. Upon failure, a negative error code is
+ *          returned instead.
+ *
+ * @details Unlike ps(), nothing is printed, so this is cheap enough to be
+ *          sampled periodically.
+ */
+PUBLIC int sys_pstat(struct pstat *buf, int n)
+{
+	int count;         /* Snapshots taken. */
+	struct process *p; /* Working process. */
+
+	/* Invalid number of entries. */
+	if (n <= 0)
+		return (-EINVAL);
+
+	/* No more than PROC_MAX snapshots are ever taken. */
+	if (n > PROC_MAX)
+		n = PROC_MAX;
+
+	/* Not a valid buffer. */
+	if (!chkmem(buf, n*sizeof(struct pstat), MAY_WRITE))
+		return (-EINVAL);
+
+	/* Charge time up to now. */
+	account(curr_proc, TRUE);
+
+	count = 0;
+	for (p = IDLE; (p <= LAST_PROC) && (count < n); p++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
+			continue;
+
+		buf->pid = p->pid;
+		buf->ppid = (p->father != NULL) ? p->father->pid : 0;
+		buf->pgrp = (p->pgrp != NULL) ? p->pgrp->pid : 0;
+		buf->uid = p->uid;
+		buf->state = p->state;
+		buf->priority = p->priority;
+		buf->nice = p->nice;
+		buf->size = p->size;
+		buf->utime = p->utime;
+		buf->ktime = p->ktime;
+		kmemcpy(&buf->ru, &p->ru, sizeof(struct pcounters));
+		kstrncpy(buf->name, p->name, PSTAT_NAME_MAX - 1);
+		buf->name[PSTAT_NAME_MAX - 1] = '\0';
+
+		buf++, count++;
+	}
+
+	return (count);
+}
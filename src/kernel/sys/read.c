@@ -64,6 +64,8 @@ PUBLIC ssize_t sys_read(int fd, void *buf, size_t n)
 	{		
 		dev = i->blocks[0];
 		count = cdev_read(dev, buf, n);
+		if ((MAJOR(dev) == TTY_MAJOR) && (count > 0))
+			curr_proc->ru.ttyin += count;
 		return (count);
 	}
 	
@@ -77,8 +79,9 @@ PUBLIC ssize_t sys_read(int fd, void *buf, size_t n)
 	/* Pipe file. */
 	else if (S_ISFIFO(i->mode))
 	{
-		kprintf("read from pipe");
 		count = pipe_read(i, buf, n);
+		if (count > 0)
+			curr_proc->ru.pipein += count;
 	}
 	
 	/* Regular file. */
@@ -1,8 +1,23 @@
 #include <sys/sem.h>
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
+#include <nanvix/region.h>
 #include <limits.h>
 #include <nanvix/fs.h>
+#include <semaphore.h>
+
+/* Size of the semaphore pages */
+#define SEM_PAGES_SIZE (SEM_OPEN_MAX << SEM_PAGE_SHIFT)
+
+/* Offset of a semaphore page */
+#define SEM_PAGE_OFF(idx) ((addr_t)(idx) << SEM_PAGE_SHIFT)
+
+#if (SEM_PAGE_SHIFT != PAGE_SHIFT)
+	#error "SEM_PAGE_SHIFT should match PAGE_SHIFT"
+#endif
+
+/* Semaphore pages, never attached to any process */
+PRIVATE struct region *semstore = NULL;
 
 /**
  *	@brief Make a semaphore slot available for
@@ -18,8 +33,176 @@ void freesem(struct ksem *sem)
 	for (int i = 0; i<PROC_MAX; i++)
 		sem->currprocs[i] = -1;
 
-	for (int i = 0; i<PROC_MAX; i++)
-		sem->semwaiters[i] = NULL;
+	/* Processes that still map the counter keep it */
+	if (semstore != NULL)
+		droppg(semstore, SEM_PAGE_OFF(sem - semtable));
+}
+
+/**
+ *	@brief Allocates a view of the semaphore pages
+ *		   with no counter mapped
+ *
+ *	@returns The view, locked, upon successful completion,
+ *			 NULL otherwise
+ */
+PRIVATE struct region *semview(void)
+{
+	struct region *reg;
+
+	reg = allocreg(MAY_READ | MAY_WRITE, SEM_PAGES_SIZE, 0);
+
+	if (reg == NULL)
+		return NULL;
+
+	for (int i = 0; i < SEM_OPEN_MAX; i++)
+		droppg(reg, SEM_PAGE_OFF(i));
+
+	return reg;
+}
+
+/**
+ *	@brief Attaches a view of the semaphore pages
+ *		   to the calling process
+ *
+ *	@details Semaphore counters live in user memory so
+ *			 that libc can operate on them without
+ *			 entering the kernel when there is no
+ *			 contention. Each process has a view of
+ *			 its own, where only the counters of the
+ *			 semaphores it opened are mapped.
+ *
+ *	@returns 0 upon successful completion,
+ *			 -1 otherwise
+ */
+int semmap(void)
+{
+	struct region *reg;
+	struct pregion *preg;
+
+	preg = SEMS(curr_proc);
+
+	/* Already attached */
+	if (preg->reg != NULL)
+		return 0;
+
+	if (semstore == NULL)
+	{
+		semstore = allocreg(MAY_READ | MAY_WRITE, SEM_PAGES_SIZE, REGION_STICKY);
+
+		if (semstore == NULL)
+			return -1;
+
+		unlockreg(semstore);
+	}
+
+	if ((reg = semview()) == NULL)
+		return -1;
+
+	if (attachreg(curr_proc, preg, SEM_PAGE_ADDR, reg))
+	{
+		unlockreg(reg);
+		freereg(reg);
+		return -1;
+	}
+
+	unlockreg(reg);
+
+	return 0;
+}
+
+/**
+ *	@brief Maps the counter of a semaphore in the
+ *		   view of the calling process
+ *
+ *	@details The counter of a new semaphore is allocated,
+ *			 zeroed, on the first mapping.
+ *
+ *	@returns 0 upon successful completion,
+ *			 -1 otherwise
+ */
+int semattach(int idx)
+{
+	struct pregion *preg;
+
+	preg = SEMS(curr_proc);
+
+	/* View not attached */
+	if (preg->reg == NULL)
+		return -1;
+
+	return sharepg(preg->reg, semstore, SEM_PAGE_OFF(idx));
+}
+
+/**
+ *	@brief Unmaps the counter of a semaphore from the
+ *		   view of the calling process
+ */
+void semdetach(int idx)
+{
+	struct pregion *preg;
+
+	preg = SEMS(curr_proc);
+
+	if (preg->reg != NULL)
+		droppg(preg->reg, SEM_PAGE_OFF(idx));
+}
+
+/**
+ *	@brief Gives a child process the semaphore
+ *		   counters of the calling process
+ *
+ *	@details Counters are shared, rather than copied
+ *			 on write like the rest of the address space.
+ *
+ *	@returns 0 upon successful completion,
+ *			 -1 otherwise
+ */
+int semdup(struct process *proc)
+{
+	struct region *reg;
+	struct region *parent;
+
+	parent = SEMS(curr_proc)->reg;
+
+	if ((reg = semview()) == NULL)
+		return -1;
+
+	for (int i = 0; i < SEM_OPEN_MAX; i++)
+	{
+		/* Semaphore not opened */
+		if (!upgpresent(curr_proc, ADDR(SEMCOUNT(i))))
+			continue;
+
+		if (sharepg(reg, parent, SEM_PAGE_OFF(i)))
+			goto error;
+	}
+
+	if (attachreg(proc, SEMS(proc), SEM_PAGE_ADDR, reg))
+		goto error;
+
+	unlockreg(reg);
+
+	return 0;
+
+error:
+	unlockreg(reg);
+	freereg(reg);
+	return -1;
+}
+
+/**
+ *	@brief Gets the counter of a semaphore, as
+ *		   mapped in the calling process
+ *
+ *	@returns The counter if it is mapped,
+ *			 NULL otherwise
+ */
+struct semcount *semcount(int idx)
+{
+	if (!upgpresent(curr_proc, ADDR(SEMCOUNT(idx))))
+		return NULL;
+
+	return SEMCOUNT(idx);
 }
 
 /**
@@ -70,6 +70,9 @@ PUBLIC int sys_semclose(int idx)
 	}
 	else
 	{
+		/* The process cannot reach the counter anymore */
+		semdetach(idx);
+
 		if (seminode->count == 1 && seminode->nlinks == 0)
 			freesem(&semtable[idx]);
 		
@@ -1,5 +1,6 @@
 #include <fcntl.h>
 #include <sys/sem.h>
+#include <semaphore.h>
 #include <nanvix/klib.h>
 #include <nanvix/fs.h>
 #include <errno.h>
@@ -12,7 +13,8 @@
 int add_table(int value, const char* semname, int idx, struct inode* seminode)
 {
 	sem_path(semname, semtable[idx].name);
-	semtable[idx].value = value;
+	SEMCOUNT(idx)->value = value;
+	SEMCOUNT(idx)->waiters = 0;
 	semtable[idx].currprocs[0] = curr_proc->pid;
 	semtable[idx].num = seminode->num;
 	semtable[idx].dev = seminode->dev;
@@ -46,6 +48,10 @@ PUBLIC int sys_semopen(const char* name, int oflag, mode_t mode, int value)
 	if (namevalid(name) == (-1))
 		return (ENAMETOOLONG);
 
+	/* Semaphore counters are kept in user memory */
+	if (semmap())
+		return (-ENOMEM);
+
 	if (existence_semaphore(name) == (-1))	/* This semaphore does not exist */
 	{
 		if(oflag & O_CREAT)	
@@ -74,12 +80,17 @@ PUBLIC int sys_semopen(const char* name, int oflag, mode_t mode, int value)
 			if (semid < 0) 
 				return (-ENFILE);
 
+			/* Maps the counter of the new semaphore */
+			if (semattach(semid))
+				return (-ENOMEM);
+
 			/* Creates the inode */
 			if (!(inode = inode_semaphore(name, mode)))
 			{
 				/*  Access forbiden to the parent directory 
 				 * 	or parent directory doesn't exist
 				 */
+				semdetach(semid);
 				return (-EACCES);
 			}
 			/* Add the semaphore in the semaphore table */
@@ -127,6 +138,14 @@ PUBLIC int sys_semopen(const char* name, int oflag, mode_t mode, int value)
 			return (-EMFILE);
 		}
 
+		/* Maps the counter */
+		if (semattach(semid))
+		{
+			inode_put(inode);
+			inode_unlock(inode);
+			return (-ENOMEM);
+		}
+
 		semtable[semid].currprocs[freeslot] = curr_proc->pid;
 	}
 
@@ -1,4 +1,6 @@
 #include <sys/sem.h>
+#include <sys/futex.h>
+#include <semaphore.h>
 #include <errno.h>
 
 /**
@@ -10,10 +12,14 @@
  *
  * @returns 0 in case of successful completion,
  *			Corresponding error code otherwise.
+ *
+ * @note libc carries out this operation in user space and
+ *		 only wakes up waiters through futex(). This system
+ *		 call is kept for binary compatibility.
  */
 PUBLIC int sys_sempost(int idx)
 {
-	struct inode *seminode;
+	struct semcount *count;
 	int i;
 
 	if (!SEM_IS_VALID(idx))
@@ -21,7 +27,6 @@ PUBLIC int sys_sempost(int idx)
 
 	for (i = 0; i < PROC_MAX; i++)
 	{
-		/* Removing the proc pid in the semaphore procs table */
 		if (semtable[idx].currprocs[i] == curr_proc->pid)
 			break;
 	}
@@ -30,18 +35,15 @@ PUBLIC int sys_sempost(int idx)
 	if (i == PROC_MAX)
 		return (-1);
 
-	seminode = inode_get(semtable[idx].dev, semtable[idx].num);
-
-	if (seminode == NULL)
+	/* Semaphore counter not mapped */
+	if ((count = semcount(idx)) == NULL)
 		return (-EINVAL);
 
-	semtable[idx].value++;
+	count->value++;
 	
-	if (semtable[idx].value == 1)
-		wakeup(semtable[idx].semwaiters);
-
-	inode_put(seminode);
-	inode_unlock(seminode);
+	/* Each post can satisfy a single waiter. */
+	if (count->waiters > 0)
+		futex_wake((int *)&count->value, 1);
 
 	return (0);
 }
@@ -1,4 +1,6 @@
 #include <sys/sem.h>
+#include <sys/futex.h>
+#include <semaphore.h>
 #include <errno.h>
 
 /**
@@ -10,14 +12,18 @@
  * @returns 0 in case of successful completion
  *			Corresponding error code otherwise.
  *
+ * @note libc carries out this operation in user space and
+ *		 only sleeps on the semaphore counter through futex().
+ *		 This system call is kept for binary compatibility.
+ *
  * TODO for error detection :
  *			EDEADLK : A deadlock condition was detected.
  *					  Seems not implemented on other OS
  */
 PUBLIC int sys_semwait(int idx)
 {
-	struct inode *seminode;
-	int i;
+	struct semcount *count;
+	int i, ret;
 	
 	if (!SEM_IS_VALID(idx))
 		return (-EINVAL);
@@ -32,27 +38,22 @@ PUBLIC int sys_semwait(int idx)
 	if (i == PROC_MAX)
 		return (-EINVAL);
 
-	seminode = inode_get(semtable[idx].dev, semtable[idx].num);
-
-	if (seminode == NULL)
+	/* Semaphore counter not mapped */
+	if ((count = semcount(idx)) == NULL)
 		return (-EINVAL);
 
-	inode_unlock(seminode);
-
-	while (semtable[idx].value <= 0)
+	while (count->value <= 0)
 	{
-		sleep(semtable[idx].semwaiters,curr_proc->priority);
+		count->waiters++;
+		ret = futex_wait((int *)&count->value, count->value);
+		count->waiters--;
 		
 		/* Awaken by a signal. */
-		if (issig())
-		{
-			inode_put(seminode);
-			return (-EINTR);
-		}
+		if ((ret < 0) && (ret != -EAGAIN))
+			return (ret);
 	}
 
-	semtable[idx].value--;
-	inode_put(seminode);
+	count->value--;
 
 	return (0);
-}
\ No newline at end of file
+}
@@ -40,16 +40,7 @@ PUBLIC int sys_stat(const char *path, struct stat *buf)
 	if (ip == NULL)
 		return (curr_proc->errno);
 	
-	buf->st_dev = ip->dev;
-	buf->st_ino = ip->num;
-	buf->st_mode = ip->mode;
-	buf->st_nlink = ip->nlinks;
-	buf->st_uid = ip->uid;
-	buf->st_gid = ip->gid;
-	buf->st_size = ip->size;
-	buf->st_atime = ip->time;
-	buf->st_mtime = ip->time;
-	buf->st_ctime = ip->time;
+	inode_stat(ip, buf);
 	
 	inode_put(ip);
 	
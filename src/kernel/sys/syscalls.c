@@ -86,5 +86,11 @@ PUBLIC void (*syscalls_table[NR_SYSCALLS])(void)  = {
 	(void (*)(void))&sys_sempost,
 	(void (*)(void))&sys_acct,
 	(void (*)(void))&sys_rmdir,
-	(void (*)(void))&sys_nanosleep
+	(void (*)(void))&sys_nanosleep,
+	(void (*)(void))&sys_clock_gettime,
+	(void (*)(void))&sys_futex,
+	(void (*)(void))&sys_spawn,
+	(void (*)(void))&sys_getrusage,
+	(void (*)(void))&sys_pstat,
+	(void (*)(void))&sys_getdentsplus
 };
@@ -39,10 +39,12 @@ PUBLIC clock_t sys_times(struct tms *buffer)
 	if (!chkmem(buffer, sizeof(struct tms), MAY_WRITE))
 		return (-EINVAL);
 	
-	buffer->tms_utime = curr_proc->utime*CLOCK_FREQ;
-	buffer->tms_stime = curr_proc->ktime*CLOCK_FREQ;
-	buffer->tms_cutime = curr_proc->cutime*CLOCK_FREQ;
-	buffer->tms_cstime = curr_proc->cktime*CLOCK_FREQ;
+	account(curr_proc, TRUE);
+	
+	buffer->tms_utime = curr_proc->utime/NSEC_PER_TICK;
+	buffer->tms_stime = curr_proc->ktime/NSEC_PER_TICK;
+	buffer->tms_cutime = curr_proc->cutime/NSEC_PER_TICK;
+	buffer->tms_cstime = curr_proc->cktime/NSEC_PER_TICK;
 	
 	return (CURRENT_TIME*CLOCK_FREQ);
 }
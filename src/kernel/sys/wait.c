@@ -83,8 +83,7 @@ repeat:
 				 * process before burying it.
 				 */
 				pid = p->pid;
-				curr_proc->cutime += p->utime;
-				curr_proc->cktime += p->ktime;
+				account_child(curr_proc, p);
 
 				/* Bury child process. */
 				bury(p);
@@ -64,6 +64,8 @@ PUBLIC ssize_t sys_write(int fd, const void *buf, size_t n)
 	{
 		dev = i->blocks[0];
 		count = cdev_write(dev, buf, n);
+		if ((MAJOR(dev) == TTY_MAJOR) && (count > 0))
+			curr_proc->ru.ttyout += count;
 		return (count);
 	}
 	
@@ -77,8 +79,9 @@ PUBLIC ssize_t sys_write(int fd, const void *buf, size_t n)
 	/* Pipe file. */
 	else if (S_ISFIFO(i->mode))
 	{
-		kprintf("write to pipe");
 		count = pipe_write(i, buf, n);
+		if (count > 0)
+			curr_proc->ru.pipeout += count;
 	}
 	
 	/* Regular file. */
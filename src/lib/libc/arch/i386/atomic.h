@@ -0,0 +1,67 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARCH_I386_ATOMIC_H_
+#define ARCH_I386_ATOMIC_H_
+
+	/**
+	 * @brief Atomically compares and swaps a word.
+	 *
+	 * @param p   Target word.
+	 * @param old Expected value.
+	 * @param new New value.
+	 *
+	 * @returns Non-zero if the word held @p old and was set to @p new, and
+	 *          zero otherwise.
+	 */
+	static inline int atomic_cas(volatile int *p, int old, int new)
+	{
+		int prev;
+
+		__asm__ volatile (
+			"lock; cmpxchgl %2, %1"
+			: "=a" (prev), "+m" (*p)
+			: "r" (new), "0" (old)
+			: "memory"
+		);
+
+		return (prev == old);
+	}
+
+	/**
+	 * @brief Atomically adds to a word.
+	 *
+	 * @param p Target word.
+	 * @param n Value to add.
+	 *
+	 * @returns The value of the word before the addition.
+	 */
+	static inline int atomic_add(volatile int *p, int n)
+	{
+		__asm__ volatile (
+			"lock; xaddl %0, %1"
+			: "+r" (n), "+m" (*p)
+			:
+			: "memory"
+		);
+
+		return (n);
+	}
+
+#endif /* ARCH_I386_ATOMIC_H_ */
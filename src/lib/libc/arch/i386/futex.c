@@ -0,0 +1,60 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <sys/futex.h>
+#include <errno.h>
+#include <reent.h>
+
+/**
+ * @brief Waits on or wakes up processes waiting on a user address.
+ *
+ * @param uaddr Address of the futex word.
+ * @param op    Operation: FUTEX_WAIT or FUTEX_WAKE.
+ * @param val   Expected value of the word for FUTEX_WAIT, or maximum
+ *              number of processes to wake up for FUTEX_WAKE.
+ *
+ * @returns Upon successful completion, FUTEX_WAIT returns zero and
+ *          FUTEX_WAKE returns the number of processes awaken. Upon failure,
+ *          -1 is returned and errno is set to indicate the error.
+ */
+int futex(volatile int *uaddr, int op, int val)
+{
+	int ret;
+
+	__asm__ volatile (
+		"int $0x80"
+		: "=a" (ret)
+		: "0" (NR_futex),
+		  "b" (uaddr),
+		  "c" (op),
+		  "d" (val)
+		: "memory"
+	);
+
+	/* Error. */
+	if (ret < 0)
+	{
+		errno = -ret;
+		_REENT->_errno = -ret;
+		return (-1);
+	}
+
+	return (ret);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <dirent.h>
+#include <errno.h>
+#include <reent.h>
+
+/**
+ * @brief Reads directory entries along with their status.
+ *
+ * @param fd     Directory file descriptor.
+ * @param buf    Where to store the directory entries.
+ * @param nbytes Size of @p buf (in bytes).
+ *
+ * @returns Upon successful completion, the number of bytes stored in @p buf
+ *          is returned, or zero at the end of the directory. Upon failure,
+ *          -1 is returned and errno set to indicate the error.
+ */
+int getdentsplus(int fd, struct dirplus *buf, size_t nbytes)
+{
+	int ret;
+
+	__asm__ volatile (
+		"int $0x80"
+		: "=a" (ret)
+		: "0" (NR_getdentsplus),
+		  "b" (fd),
+		  "c" (buf),
+		  "d" (nbytes)
+		: "memory"
+	);
+
+	/* Error. */
+	if (ret < 0)
+	{
+		errno = -ret;
+		_REENT->_errno = -ret;
+		return (-1);
+	}
+
+	return (ret);
+}
@@ -21,6 +21,7 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <reent.h>
+#include <time.h>
 
 /*
  * @brief Get the time expressed as seconds and microseconds since
@@ -34,17 +35,19 @@
 int gettimeofday(struct timeval *tp, void *tzp)
 {
 	int ret;
+	struct timespec ts;
 
 	/* Timezone obsolete, should be NULL. */
 	if (tzp)
 		return (-1);
 
-	/* Use the time() to get the seconds. */
 	__asm__ volatile (
 		"int $0x80"
 		: "=a" (ret)
-		: "0" (NR_time),
-		  "b" (NULL)
+		: "0" (NR_clock_gettime),
+		  "b" (CLOCK_REALTIME),
+		  "c" (&ts)
+		: "memory"
 	);
 
 	/* Error. */
@@ -55,8 +58,8 @@ int gettimeofday(struct timeval *tp, void *tzp)
 		return (-1);
 	}
 	
-	tp->tv_usec = 0;
-	tp->tv_sec  = ret;
+	tp->tv_sec  = ts.tv_sec;
+	tp->tv_usec = ts.tv_nsec/1000;
 
 	return (0);
 }
@@ -18,10 +18,10 @@
  */
 
 #include <nanvix/syscall.h>
-#include <nanvix/clock.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <reent.h>
+#include <time.h>
 
 /*
  * Suspends  the execution of the process until either at least
@@ -56,31 +56,16 @@ int nanosleep(const struct timespec *rqtp, struct timespec *rmtp)
 		: "=a" (ret)
 		: "0" (NR_nanosleep),
 		  "b" (tv_sec),
-		  "c" (tv_nsec)
+		  "c" (tv_nsec),
+		  "d" (rmtp)
+		: "memory"
 	);
 
 	/* Error. */
-	if (ret != 0)
+	if (ret < 0)
 	{
-		/* Invalid values */
-		if (ret < 0)
-		{
-			errno = -ret;
-			_REENT->_errno = -ret;
-			return (-1);
-		}
-
-		/* Interrupted by a signal. */
-		errno = EINTR;
-		_REENT->_errno = EINTR;
-
-		/* Shall we update rmtp with the remaining time?. */
-		if (rmtp != NULL)
-		{
-			rmtp->tv_sec  = ret/CLOCK_FREQ;
-			rmtp->tv_nsec = (ret % CLOCK_FREQ) * CLOCK_INTERVAL_PER_MS;
-		}
-
+		errno = -ret;
+		_REENT->_errno = -ret;
 		return (-1);
 	}
 
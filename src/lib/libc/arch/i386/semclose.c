@@ -14,16 +14,10 @@
  */
 int sem_close(sem_t* sem)
 {	
-	int ret, i;
+	int ret;
 
-	if (sem == NULL)
-		return (-1);
-
-	for (i = 0; i < OPEN_MAX; i++)
-		if (usem[i] == sem)
-			break;
-
-	if (i == OPEN_MAX)
+	if ((sem == NULL) || (sem->semid < 0) || (sem->semid >= SEM_OPEN_MAX) ||
+		(usem[sem->semid] != sem))
 		return (-1);
 
 	__asm__ volatile (
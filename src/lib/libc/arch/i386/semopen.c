@@ -84,6 +84,7 @@ sem_t* sem_open(const char* name, int oflag, ...)
 	}
 
 	s->semid=ret;
+	s->count=SEMCOUNT(ret);
 	usem[ret] = s;
 
 	return (s);
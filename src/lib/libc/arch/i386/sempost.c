@@ -1,6 +1,8 @@
 #include <nanvix/syscall.h>
+#include <sys/futex.h>
 #include <stdlib.h>
 #include <errno.h>
+#include "atomic.h"
 
 /**
  *	@brief Post action : increments semaphore value
@@ -11,33 +13,31 @@
  *
  *	@returns 0 in case of successful completion
  *			 (-1) otherwise
+ *
+ *	@details The kernel is only entered if some process
+ *			 is waiting on the semaphore.
  */
 int sem_post(sem_t* sem)
 {	
-	int ret, i;
+	struct semcount *count;
 
-	if (sem == NULL)
+	if ((sem == NULL) || (sem->semid < 0) || (sem->semid >= SEM_OPEN_MAX) ||
+		(usem[sem->semid] != sem))
+	{
+		errno = EINVAL;
 		return (-1);
+	}
 
-	for (i = 0; i < OPEN_MAX; i++)
-		if (usem[i] == sem)
-			break;
-
-	if (i == OPEN_MAX)
-		return (-1);
+	count = sem->count;
 
-	__asm__ volatile (
-		"int $0x80"
-		: "=a" (ret)
-		: "0" (NR_sempost),
-		  "b" (sem->semid)
-	);
+	atomic_add(&count->value, 1);
 
-	if (ret < 0)
+	/* Each post can satisfy a single waiter. */
+	if (count->waiters > 0)
 	{
-		errno = ret;
-		return (-1);
+		if (futex(&count->value, FUTEX_WAKE, 1) < 0)
+			return (-1);
 	}
 
 	return (0);
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #include <nanvix/syscall.h>
+#include <sys/futex.h>
 #include <errno.h>
+#include "atomic.h"
 
 /**
  * @brief Wait action : consume a ressource if available
@@ -10,33 +12,53 @@
  * @returns 0 in case of successful completion
  *			(-1) otherwise
  *
+ * @details The semaphore counter lives in memory shared with
+ *			every process that opened the semaphore, so an
+ *			available ressource is consumed without entering
+ *			the kernel. Only when the semaphore is exhausted
+ *			does the caller register itself as a waiter and
+ *			sleep in futex().
  */
 int sem_wait(sem_t *sem)
 {	
-	int ret, i;
+	int value;
+	struct semcount *count;
 
-	if (sem == NULL)
+	if ((sem == NULL) || (sem->semid < 0) || (sem->semid >= SEM_OPEN_MAX) ||
+		(usem[sem->semid] != sem))
+	{
+		errno = EINVAL;
 		return (-1);
+	}
 
-	for (i = 0; i < OPEN_MAX; i++)
-		if (usem[i] == sem)
-			break;
-
-	if (i == OPEN_MAX)
-		return (-1);
+	count = sem->count;
 
-	__asm__ volatile (
-		"int $0x80"
-		: "=a" (ret)
-		: "0" (NR_semwait),
-		  "b" (sem->semid)
-	);
+	/* Fast path. */
+	while ((value = count->value) > 0)
+	{
+		if (atomic_cas(&count->value, value, value - 1))
+			return (0);
+	}
 
-	if (ret < 0)
+	/* Slow path. */
+	atomic_add(&count->waiters, 1);
+	for (;;)
 	{
-		errno = ret;
-		return (-1);
+		if ((value = count->value) > 0)
+		{
+			if (atomic_cas(&count->value, value, value - 1))
+				break;
+			continue;
+		}
+
+		/* Awaken by a signal. */
+		if ((futex(&count->value, FUTEX_WAIT, value) < 0) && (errno == EINTR))
+		{
+			atomic_add(&count->waiters, -1);
+			return (-1);
+		}
 	}
+	atomic_add(&count->waiters, -1);
 
 	return (0);
-}
\ No newline at end of file
+}
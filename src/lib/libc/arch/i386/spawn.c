@@ -0,0 +1,486 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <sys/spawn.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <reent.h>
+
+/**
+ * @brief Spawn attributes.
+ */
+struct __posix_spawnattr
+{
+	struct spawn sp;  /**< Kernel attributes. */
+	sigset_t sigmask; /**< Signal mask.       */
+};
+
+/**
+ * @brief Spawn file actions.
+ */
+struct __posix_spawn_file_actions
+{
+	int nactions;                                   /**< Number of actions. */
+	struct spawn_action actions[SPAWN_ACTIONS_MAX]; /**< Actions.           */
+};
+
+/**
+ * @brief Issues the spawn() system call.
+ */
+static pid_t __spawn
+(const char *filename, char *const argv[], char *const envp[], const struct spawn *sp)
+{
+	pid_t ret;
+	
+	__asm__ volatile (
+		"int $0x80"
+		: "=a" (ret)
+		: "0" (NR_spawn),
+		  "b" (filename),
+		  "c" (argv),
+		  "d" (envp),
+		  "D" (sp)
+		: "memory"
+	);
+	
+	return (ret);
+}
+
+/**
+ * @brief Creates a process that executes a program.
+ *
+ * @param filename Path name of the program.
+ * @param argv     Argument list.
+ * @param envp     Environment.
+ * @param sp       Spawn attributes (may be NULL).
+ *
+ * @returns Upon successful completion, the ID of the child process is
+ *          returned. Upon failure, -1 is returned and errno is set to
+ *          indicate the error.
+ */
+pid_t spawn(const char *filename, char *const argv[], char *const envp[], const struct spawn *sp)
+{
+	pid_t ret;
+	
+	ret = __spawn(filename, argv, envp, sp);
+	
+	/* Error. */
+	if (ret < 0)
+	{
+		errno = -ret;
+		_REENT->_errno = -ret;
+		return (-1);
+	}
+	
+	return (ret);
+}
+
+/*============================================================================*
+ *                                 posix_spawn()                              *
+ *============================================================================*/
+
+/**
+ * @brief Spawns a process.
+ *
+ * @returns Upon successful completion, zero is returned and the ID of the
+ *          child process is stored in @p pid. Upon failure, an error number
+ *          is returned instead.
+ */
+int posix_spawn
+(
+	pid_t *pid,
+	const char *path,
+	const posix_spawn_file_actions_t *file_actions,
+	const posix_spawnattr_t *attrp,
+	char *const argv[],
+	char *const envp[]
+)
+{
+	pid_t ret;
+	struct spawn sp;
+	
+	if ((attrp != NULL) && (*attrp != NULL))
+		sp = (*attrp)->sp;
+	else
+		memset(&sp, 0, sizeof(struct spawn));
+	
+	sp.nactions = 0;
+	sp.actions = NULL;
+	if ((file_actions != NULL) && (*file_actions != NULL))
+	{
+		sp.nactions = (*file_actions)->nactions;
+		sp.actions = (*file_actions)->actions;
+	}
+	
+	if ((ret = __spawn(path, argv, envp, &sp)) < 0)
+		return (-ret);
+	
+	if (pid != NULL)
+		*pid = ret;
+	
+	return (0);
+}
+
+/**
+ * @brief Spawns a process, searching for the program in PATH.
+ *
+ * @returns Upon successful completion, zero is returned and the ID of the
+ *          child process is stored in @p pid. Upon failure, an error number
+ *          is returned instead.
+ */
+int posix_spawnp
+(
+	pid_t *pid,
+	const char *file,
+	const posix_spawn_file_actions_t *file_actions,
+	const posix_spawnattr_t *attrp,
+	char *const argv[],
+	char *const envp[]
+)
+{
+	int err;    /* Error number.        */
+	int denied; /* Access denied?       */
+	char *name; /* Working path name.   */
+	int length; /* File name length.    */
+	char *path; /* Working path.        */
+	char *p;    /* End of working path. */
+	
+	/* Use given path. */
+	if (strchr(file, '/') != NULL)
+		return (posix_spawn(pid, file, file_actions, attrp, argv, envp));
+	
+	denied = 0;
+	length = strlen(file) + 1;
+	
+	/* No directory to search. */
+	if ((path = getenv("PATH")) == NULL)
+		return (ENOENT);
+	
+	name = malloc(length + strlen(path));
+	if (name == NULL)
+		return (ENOMEM);
+	
+	/* Search for executable. */
+	do
+	{
+		/* No directory to search. */
+		if (*path == '\0')
+		{
+			err = ENOENT;
+			goto out;
+		}
+		
+		/* Get end of path. */
+		p = strchr(path, ':');
+		if (p == NULL)
+			p = strchr(path, '\0');
+		
+		/* Build path name.  */
+		memcpy(name, path, p - path);
+		name[p - path] = '/';
+		memcpy(&name[(p - path) + 1], file, length);
+		
+		err = posix_spawn(pid, name, file_actions, attrp, argv, envp);
+		
+		/* Failed to execute. */
+		switch (err)
+		{
+			/* Fall through. */
+			case EACCES:
+				denied = 1;
+			case ENOENT:
+				break;
+			
+			default:
+				goto out;
+		}
+		
+		path = strchr(path, ':');
+		
+	} while ((path != NULL) && (*++path != '\0'));
+
+	/* 
+	 * At least one failure was due to
+	 * permissions. 
+	 */
+	err = (denied) ? EACCES : ENOENT;
+
+out:
+	free(name);
+	return (err);
+}
+
+/*============================================================================*
+ *                                 File Actions                               *
+ *============================================================================*/
+
+/**
+ * @brief Initializes a file actions object.
+ */
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t *file_actions)
+{
+	if ((*file_actions = malloc(sizeof(struct __posix_spawn_file_actions))) == NULL)
+		return (ENOMEM);
+	
+	(*file_actions)->nactions = 0;
+	
+	return (0);
+}
+
+/**
+ * @brief Destroys a file actions object.
+ */
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t *file_actions)
+{
+	int i;
+	struct spawn_action *a;
+	
+	if (*file_actions == NULL)
+		return (EINVAL);
+	
+	for (i = 0; i < (*file_actions)->nactions; i++)
+	{
+		a = &(*file_actions)->actions[i];
+		if (a->type == SPAWN_OPEN)
+			free((void *)a->path);
+	}
+	
+	free(*file_actions);
+	*file_actions = NULL;
+	
+	return (0);
+}
+
+/**
+ * @brief Appends a file action.
+ */
+static struct spawn_action *addaction
+(posix_spawn_file_actions_t *file_actions, int type, int fd, int *err)
+{
+	struct spawn_action *a;
+	
+	/* Bad file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX))
+	{
+		*err = EBADF;
+		return (NULL);
+	}
+	
+	/* Too many actions. */
+	if ((*file_actions)->nactions >= SPAWN_ACTIONS_MAX)
+	{
+		*err = ENOMEM;
+		return (NULL);
+	}
+	
+	a = &(*file_actions)->actions[(*file_actions)->nactions];
+	a->type = type;
+	a->fd = fd;
+	a->newfd = fd;
+	a->oflag = 0;
+	a->mode = 0;
+	a->path = NULL;
+	
+	return (a);
+}
+
+/**
+ * @brief Adds an open() action to a file actions object.
+ */
+int posix_spawn_file_actions_addopen
+(posix_spawn_file_actions_t *file_actions, int fd, const char *path, int oflag, mode_t mode)
+{
+	int err;
+	struct spawn_action *a;
+	
+	if ((a = addaction(file_actions, SPAWN_OPEN, fd, &err)) == NULL)
+		return (err);
+	
+	if ((a->path = strdup(path)) == NULL)
+		return (ENOMEM);
+	a->oflag = oflag;
+	a->mode = mode;
+	
+	(*file_actions)->nactions++;
+	
+	return (0);
+}
+
+/**
+ * @brief Adds a dup2() action to a file actions object.
+ */
+int posix_spawn_file_actions_adddup2
+(posix_spawn_file_actions_t *file_actions, int fd, int newfd)
+{
+	int err;
+	struct spawn_action *a;
+	
+	/* Bad file descriptor. */
+	if ((newfd < 0) || (newfd >= OPEN_MAX))
+		return (EBADF);
+	
+	if ((a = addaction(file_actions, SPAWN_DUP2, fd, &err)) == NULL)
+		return (err);
+	
+	a->newfd = newfd;
+	
+	(*file_actions)->nactions++;
+	
+	return (0);
+}
+
+/**
+ * @brief Adds a close() action to a file actions object.
+ */
+int posix_spawn_file_actions_addclose
+(posix_spawn_file_actions_t *file_actions, int fd)
+{
+	int err;
+	
+	if (addaction(file_actions, SPAWN_CLOSE, fd, &err) == NULL)
+		return (err);
+	
+	(*file_actions)->nactions++;
+	
+	return (0);
+}
+
+/*============================================================================*
+ *                                  Attributes                                *
+ *============================================================================*/
+
+/**
+ * @brief Initializes a spawn attributes object.
+ */
+int posix_spawnattr_init(posix_spawnattr_t *attr)
+{
+	if ((*attr = malloc(sizeof(struct __posix_spawnattr))) == NULL)
+		return (ENOMEM);
+	
+	memset(*attr, 0, sizeof(struct __posix_spawnattr));
+	
+	return (0);
+}
+
+/**
+ * @brief Destroys a spawn attributes object.
+ */
+int posix_spawnattr_destroy(posix_spawnattr_t *attr)
+{
+	if (*attr == NULL)
+		return (EINVAL);
+	
+	free(*attr);
+	*attr = NULL;
+	
+	return (0);
+}
+
+/**
+ * @brief Gets the spawn flags.
+ */
+int posix_spawnattr_getflags(const posix_spawnattr_t *attr, short *flags)
+{
+	*flags = (*attr)->sp.flags;
+	
+	return (0);
+}
+
+/**
+ * @brief Sets the spawn flags.
+ */
+int posix_spawnattr_setflags(posix_spawnattr_t *attr, short flags)
+{
+	/* Invalid flags. */
+	if (flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP |
+	              POSIX_SPAWN_SETSCHEDPARAM | POSIX_SPAWN_SETSCHEDULER |
+	              POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK))
+		return (EINVAL);
+	
+	(*attr)->sp.flags = flags;
+	
+	return (0);
+}
+
+/**
+ * @brief Gets the spawn process group.
+ */
+int posix_spawnattr_getpgroup(const posix_spawnattr_t *attr, pid_t *pgroup)
+{
+	*pgroup = (*attr)->sp.pgroup;
+	
+	return (0);
+}
+
+/**
+ * @brief Sets the spawn process group.
+ */
+int posix_spawnattr_setpgroup(posix_spawnattr_t *attr, pid_t pgroup)
+{
+	(*attr)->sp.pgroup = pgroup;
+	
+	return (0);
+}
+
+/**
+ * @brief Gets the set of signals to be reset to default.
+ */
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t *attr, sigset_t *sigdefault)
+{
+	*sigdefault = (*attr)->sp.sigdefault;
+	
+	return (0);
+}
+
+/**
+ * @brief Sets the set of signals to be reset to default.
+ */
+int posix_spawnattr_setsigdefault(posix_spawnattr_t *attr, const sigset_t *sigdefault)
+{
+	(*attr)->sp.sigdefault = *sigdefault;
+	
+	return (0);
+}
+
+/**
+ * @brief Gets the spawn signal mask.
+ */
+int posix_spawnattr_getsigmask(const posix_spawnattr_t *attr, sigset_t *sigmask)
+{
+	*sigmask = (*attr)->sigmask;
+	
+	return (0);
+}
+
+/**
+ * @brief Sets the spawn signal mask.
+ *
+ * @note Signals cannot be masked in Nanvix, so spawning a process with
+ *       POSIX_SPAWN_SETSIGMASK fails with EINVAL.
+ */
+int posix_spawnattr_setsigmask(posix_spawnattr_t *attr, const sigset_t *sigmask)
+{
+	(*attr)->sigmask = *sigmask;
+	
+	return (0);
+}
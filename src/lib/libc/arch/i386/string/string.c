@@ -0,0 +1,87 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief CPUID feature flag (EDX) for SSE2.
+ */
+#define CPUID_SSE2 (1 << 26)
+
+/* Generic routines. */
+extern void *__memcpy_generic(void *, const void *, size_t);
+extern void *__memset_generic(void *, int, size_t);
+extern void *__memchr_generic(const void *, int, size_t);
+extern int __memcmp_generic(const void *, const void *, size_t);
+extern size_t __strlen_generic(const char *);
+extern char *__strchr_generic(const char *, int);
+extern int __strcmp_generic(const char *, const char *);
+
+/* SSE2 routines. */
+extern void *__memcpy_sse2(void *, const void *, size_t);
+extern void *__memset_sse2(void *, int, size_t);
+extern void *__memchr_sse2(const void *, int, size_t);
+extern int __memcmp_sse2(const void *, const void *, size_t);
+extern size_t __strlen_sse2(const char *);
+extern char *__strchr_sse2(const char *, int);
+extern int __strcmp_sse2(const char *, const char *);
+
+/*
+ * Routines called by the string functions. They start out generic, so that
+ * string functions work even before __string_init() runs.
+ */
+void *(*__memcpy_impl)(void *, const void *, size_t) = __memcpy_generic;
+void *(*__memset_impl)(void *, int, size_t) = __memset_generic;
+void *(*__memchr_impl)(const void *, int, size_t) = __memchr_generic;
+int (*__memcmp_impl)(const void *, const void *, size_t) = __memcmp_generic;
+size_t (*__strlen_impl)(const char *) = __strlen_generic;
+char *(*__strchr_impl)(const char *, int) = __strchr_generic;
+int (*__strcmp_impl)(const char *, const char *) = __strcmp_generic;
+
+/**
+ * @brief Selects string routines for the underlying processor.
+ *
+ * @details Switches to the SSE2 routines when CPUID reports SSE2 support.
+ *          Otherwise, the generic routines are kept.
+ */
+void __string_init(void)
+{
+	unsigned eax, ebx, ecx, edx;
+
+	__asm__ volatile (
+		"cpuid"
+		: "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+		: "0" (1)
+	);
+
+	((void) eax);
+	((void) ebx);
+	((void) ecx);
+
+	if (!(edx & CPUID_SSE2))
+		return;
+
+	__memcpy_impl = __memcpy_sse2;
+	__memset_impl = __memset_sse2;
+	__memchr_impl = __memchr_sse2;
+	__memcmp_impl = __memcmp_sse2;
+	__strlen_impl = __strlen_sse2;
+	__strchr_impl = __strchr_sse2;
+	__strcmp_impl = __strcmp_sse2;
+}
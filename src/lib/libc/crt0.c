@@ -26,8 +26,11 @@
  */
 extern int main(int argc, char **argv);
 extern void _init(void);
+#ifdef i386
+extern void __string_init(void);
+#endif
 
-sem_t *usem[OPEN_MAX];
+sem_t *usem[SEM_OPEN_MAX];
 
 /*
  * Entry point of the program.
@@ -40,6 +43,11 @@ void _start(int argc, char **argv, char **envp)
 	for (int i = 0; i < OPEN_MAX; i++)
 		usem[i] = NULL;
 
+#ifdef i386
+	/* Select string routines. */
+	__string_init();
+#endif
+
 	/* Call _init. */
 	_init();
 
@@ -28,8 +28,11 @@
  */
 struct dirent *readdir(DIR *dirp)
 {
-	struct dirent *buf; /* Buffer.         */
-	struct dirent *dp;  /* Working dirent. */
+	struct dirent *dp; /* Working dirent. */
+	
+	/* Buffer holds entries read by readdirplus(). */
+	if ((dirp->flags & _DIR_PLUS) && (dirp->count > 0))
+		return ((struct dirent *)readdirplus(dirp));
 	
 	/* End of directory. */
 	if (dirp->flags & _DIR_EOD)
@@ -40,7 +43,8 @@ struct dirent *readdir(DIR *dirp)
 		/* Get next non-empty directory entry. */
 		while (--dirp->count >= 0)
 		{
-			dp = dirp->ptr++;
+			dp = (struct dirent *)dirp->ptr;
+			dirp->ptr += sizeof(struct dirent);
 			
 			/* Found. */
 			if (dp->d_ino != INODE_NULL)
@@ -48,19 +52,19 @@ struct dirent *readdir(DIR *dirp)
 		}
 		
 		/* Allocate buffer. */
-		if ((buf = dirp->buf) == NULL)
+		if (dirp->buf == NULL)
 		{
-			buf = malloc(_DIR_BUFSIZ);
+			dirp->buf = malloc(_DIR_PLUSSIZ);
 			/* Failed to allocate buffer. */
-			if (buf == NULL)
+			if (dirp->buf == NULL)
 				return (NULL);
 		}
 		
-		dirp->count = read(dirp->fd, buf, _DIR_BUFSIZ)/sizeof(struct dirent);
+		dirp->count = read(dirp->fd, dirp->buf, _DIR_BUFSIZ)/sizeof(struct dirent);
 		
 		/* Reset buffer. */
-		dirp->ptr = buf;
-		dirp->buf = buf;
+		dirp->ptr = dirp->buf;
+		dirp->flags &= ~_DIR_PLUS;
 		
 		/* Error while reading. */
 		if (dirp->count <= 0)
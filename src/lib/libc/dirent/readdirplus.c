@@ -0,0 +1,88 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Reads a directory, along with the status of each entry.
+ */
+struct dirplus *readdirplus(DIR *dirp)
+{
+	struct dirplus *dp; /* Working entry.            */
+	int n;              /* Bytes read from the file. */
+	
+	/*
+	 * Buffer holds entries read by readdir(),
+	 * so hand them back to the underlying file.
+	 */
+	if (!(dirp->flags & _DIR_PLUS) && (dirp->count > 0))
+	{
+		if (lseek(dirp->fd, -(off_t)(dirp->count*sizeof(struct dirent)), SEEK_CUR) < 0)
+			return (NULL);
+		
+		dirp->count = 0;
+	}
+	
+	/* Get next entry. */
+	if ((dirp->flags & _DIR_PLUS) && (dirp->count > 0))
+	{
+		dirp->count--;
+		dp = (struct dirplus *)dirp->ptr;
+		dirp->ptr += sizeof(struct dirplus);
+		
+		return (dp);
+	}
+	
+	/* End of directory. */
+	if (dirp->flags & _DIR_EOD)
+		return (NULL);
+	
+	/* Allocate buffer. */
+	if (dirp->buf == NULL)
+	{
+		dirp->buf = malloc(_DIR_PLUSSIZ);
+		/* Failed to allocate buffer. */
+		if (dirp->buf == NULL)
+			return (NULL);
+	}
+	
+	n = getdentsplus(dirp->fd, (struct dirplus *)dirp->buf, _DIR_PLUSSIZ);
+	
+	/* Reset buffer. */
+	dirp->ptr = dirp->buf;
+	dirp->count = 0;
+	dirp->flags |= _DIR_PLUS;
+	
+	/* Error while reading. */
+	if (n <= 0)
+	{
+		/* End of directory. */
+		if (n == 0)
+			dirp->flags |= _DIR_EOD;
+		
+		return (NULL);
+	}
+	
+	dirp->count = n/sizeof(struct dirplus) - 1;
+	dirp->ptr += sizeof(struct dirplus);
+	
+	return ((struct dirplus *)dirp->buf);
+}
@@ -18,6 +18,7 @@
  */
 
 #include <dirent.h>
+#include <unistd.h>
 
 /*
  * Rewinds a directory stream.
@@ -26,7 +27,9 @@ void rewinddir(DIR *dirp)
 {
 	/* Invalidate buffer. */
 	dirp->count = 0;
-	dirp->buf = dirp->ptr;
-	dirp->flags &= ~_DIR_EOD;
+	dirp->ptr = dirp->buf;
+	dirp->flags &= ~(_DIR_EOD | _DIR_PLUS);
+	
+	lseek(dirp->fd, 0, SEEK_SET);
 }
 
@@ -907,6 +907,12 @@ _DEFUN(_VFPRINTF_R, (data, fp, fmt0, ap),
 	is_pos_arg = 0;
 #endif
 
+	/*
+	 * Formats made only of the common conversions take the fast path.
+	 */
+	if (__sfastprint_r (data, fp, fmt, ap, &ret))
+		goto done;
+
 	/*
 	 * Scan the format for conversions (`%' character).
 	 */
@@ -0,0 +1,480 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include "local.h"
+#include "fvwrite.h"
+
+/**
+ * @name Fast Formatting Path
+ *
+ * @details Formats with up to FAST_NCONV conversions, all of the form
+ *          %[-0+ ][width][l]{d,i,u,x,X} or %[-0+ ][width]{s,c,%}, are
+ *          handled here instead of by the vfprintf() state machine. Output
+ *          goes straight into the stream buffer whenever a piece fits in
+ *          it without a flush, and through __sprint_r()/__ssprint_r()
+ *          otherwise, so that buffering, truncation and error semantics
+ *          are those of the generic path.
+ */
+/**@{*/
+#define FAST_LADJUST 001  /**< Left adjustment ('-').  */
+#define FAST_ZEROPAD 002  /**< Zero padding ('0').     */
+#define FAST_PLUS    004  /**< Always signed ('+').    */
+#define FAST_SPACE   010  /**< Blank for plus (' ').   */
+#define FAST_LONG    020  /**< Long argument ('l').    */
+#define FAST_NCONV   8    /**< Most conversions taken. */
+#define FAST_WIDTH   4096 /**< Widest field taken.     */
+#define FAST_PADSIZE 16   /**< Pad chunk size.         */
+/**@}*/
+
+/**
+ * @brief Asserts if n bytes may be copied straight into the buffer of fp.
+ *
+ * @details That is, if they fit there without bringing the buffer to the
+ *          point where __sfvwrite_r() would flush it. Line buffered
+ *          streams keep a non-positive _w, and have _bf._size plus that
+ *          much room.
+ */
+#define FAST_FITS(fp, n) \
+	((n) < (((fp)->_flags & __SLBF) ? (fp)->_w + (fp)->_bf._size : (fp)->_w))
+
+/**
+ * @brief Parsed conversion.
+ */
+struct fastconv
+{
+	const char *lit; /**< Plain characters before the conversion. */
+	int litlen;      /**< Number of plain characters.             */
+	int flags;       /**< Flags.                                  */
+	int width;       /**< Field width.                            */
+	int conv;        /**< Conversion, or zero at end of format.   */
+};
+
+/* Defined by the INTEGER_ONLY versions of vfprintf(). */
+int __sprint_r(struct _reent *, FILE *, register struct __suio *);
+int __ssprint_r(struct _reent *, FILE *, register struct __suio *);
+
+/**
+ * @brief Decimal digit pairs, from "00" to "99".
+ */
+static const char digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/**
+ * @brief Pad chunks.
+ */
+static const char blanks[FAST_PADSIZE] =
+	{' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ',' '};
+static const char zeroes[FAST_PADSIZE] =
+	{'0','0','0','0','0','0','0','0','0','0','0','0','0','0','0','0'};
+
+/**
+ * @brief Writes bytes to a stream the way the generic path would.
+ *
+ * @param ptr Reentrancy structure.
+ * @param fp  Target stream.
+ * @param p   Bytes to write.
+ * @param n   Number of bytes.
+ *
+ * @returns Zero upon success, and EOF otherwise.
+ */
+static int fast_write(struct _reent *ptr, FILE *fp, const char *p, int n)
+{
+	struct __suio uio;
+	struct __siov iov;
+
+	if (n <= 0)
+		return (0);
+
+	iov.iov_base = p;
+	iov.iov_len = n;
+	uio.uio_iov = &iov;
+	uio.uio_iovcnt = 1;
+	uio.uio_resid = n;
+
+	if (fp->_flags & __SSTR)
+		return (__ssprint_r(ptr, fp, &uio));
+
+	return (__sprint_r(ptr, fp, &uio));
+}
+
+/**
+ * @brief Writes padding to a stream the way the generic path would.
+ *
+ * @param ptr  Reentrancy structure.
+ * @param fp   Target stream.
+ * @param with Pad chunk.
+ * @param n    Number of pad characters.
+ *
+ * @returns Zero upon success, and EOF otherwise.
+ */
+static int fast_pad(struct _reent *ptr, FILE *fp, const char *with, int n)
+{
+	for (/* noop */; n > FAST_PADSIZE; n -= FAST_PADSIZE)
+	{
+		if (fast_write(ptr, fp, with, FAST_PADSIZE))
+			return (EOF);
+	}
+
+	return (fast_write(ptr, fp, with, n));
+}
+
+/**
+ * @brief Writes a converted field to a stream piece by piece.
+ *
+ * @details This is for fields that do not fit in the stream buffer. The
+ *          pieces are those of the generic path: blank padding, sign, zero
+ *          padding, body and left-adjusting blank padding.
+ *
+ * @param ptr    Reentrancy structure.
+ * @param fp     Target stream.
+ * @param adjust FAST_LADJUST and FAST_ZEROPAD flags of the conversion.
+ * @param pad    Number of pad characters.
+ * @param sign   Sign character, or zero if none.
+ * @param cp     Body of the field.
+ * @param size   Size of the body.
+ *
+ * @returns Zero upon success, and EOF otherwise.
+ */
+static int fast_field(
+	struct _reent *ptr,
+	FILE *fp,
+	int adjust,
+	int pad,
+	char sign,
+	const char *cp,
+	int size)
+{
+	if ((adjust == 0) && fast_pad(ptr, fp, blanks, pad))
+		return (EOF);
+	if (sign && fast_write(ptr, fp, &sign, 1))
+		return (EOF);
+	if ((adjust == FAST_ZEROPAD) && fast_pad(ptr, fp, zeroes, pad))
+		return (EOF);
+	if (fast_write(ptr, fp, cp, size))
+		return (EOF);
+	if ((adjust & FAST_LADJUST) && fast_pad(ptr, fp, blanks, pad))
+		return (EOF);
+
+	return (0);
+}
+
+/**
+ * @brief Parses a format for the fast path.
+ *
+ * @param fmt   Format string.
+ * @param convs Store location for the parsed conversions, and an end
+ *              marker.
+ *
+ * @returns Non-zero if the fast path handles fmt, and zero otherwise.
+ */
+static int fast_parse(const char *fmt, struct fastconv *convs)
+{
+	int ch;
+	struct fastconv *c;
+
+	for (c = convs; /* noop */; c++)
+	{
+		c->lit = fmt;
+		while ((*fmt != '\0') && (*fmt != '%'))
+			fmt++;
+		c->litlen = fmt - c->lit;
+
+		if (*fmt++ == '\0')
+		{
+			c->conv = 0;
+			return (1);
+		}
+
+		if (c == &convs[FAST_NCONV])
+			return (0);
+
+		/* Flags. */
+		c->flags = 0;
+		for (;;)
+		{
+			switch (ch = *fmt++)
+			{
+				case '-': c->flags |= FAST_LADJUST; continue;
+				case '0': c->flags |= FAST_ZEROPAD; continue;
+				case '+': c->flags |= FAST_PLUS;    continue;
+				case ' ': c->flags |= FAST_SPACE;   continue;
+			}
+			break;
+		}
+
+		/* Width. */
+		c->width = 0;
+		while ((ch >= '0') && (ch <= '9'))
+		{
+			if ((c->width = c->width*10 + (ch - '0')) > FAST_WIDTH)
+				return (0);
+			ch = *fmt++;
+		}
+
+		/* Conversion. */
+		if (ch == 'l')
+		{
+			c->flags |= FAST_LONG;
+			ch = *fmt++;
+		}
+		switch (ch)
+		{
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'x':
+			case 'X':
+				break;
+
+			/* Wide characters and strings are left to the generic path. */
+			case 's':
+			case 'c':
+			case '%':
+				if (c->flags & FAST_LONG)
+					return (0);
+				break;
+
+			default:
+				return (0);
+		}
+		c->conv = ch;
+	}
+}
+
+/**
+ * @brief Formats output of a stdarg argument list, fast path.
+ *
+ * @details Nothing is consumed from ap nor written to fp unless the whole
+ *          format is taken.
+ *
+ * @param ptr  Reentrancy structure.
+ * @param fp   Target stream, which must be ready for writing.
+ * @param fmt  Format string.
+ * @param ap   Argument list.
+ * @param retp Store location for the number of characters written, or EOF
+ *             upon failure, with the error indicator of fp set.
+ *
+ * @returns Non-zero if the format was taken, and zero otherwise.
+ */
+int __sfastprint_r(
+	struct _reent *ptr,
+	FILE *fp,
+	const char *fmt,
+	va_list ap,
+	int *retp)
+{
+	int n;
+	int ret;
+	long v;
+	char *p, *bp;
+	char sign;
+	int size;
+	int adjust;
+	int realsz, pad;
+	unsigned long u, q;
+	const char *cp, *d, *xdigs;
+	struct fastconv *c;
+	struct fastconv convs[FAST_NCONV + 1];
+	char buf[3*sizeof(long) + 1];
+	char *const end = &buf[sizeof(buf)];
+
+	/* Unbuffered streams write every piece out, leave them alone. */
+	if ((fp->_flags & (__SNBF | __SSTR)) == __SNBF)
+		return (0);
+#ifdef __SCLE
+	if (fp->_flags & __SCLE)
+		return (0);
+#endif
+#ifdef _WIDE_ORIENT
+	if (fp->_flags2 & __SWID)
+		return (0);
+#endif
+
+	if (!fast_parse(fmt, convs))
+		return (0);
+
+	ret = 0;
+
+	for (c = convs; /* noop */; c++)
+	{
+		/* Plain characters. */
+		if ((n = c->litlen) > 0)
+		{
+			if (FAST_FITS(fp, n) && (!(fp->_flags & __SLBF) ||
+				(memchr(c->lit, '\n', n) == NULL)))
+			{
+				memcpy(fp->_p, c->lit, n);
+				fp->_p += n;
+				fp->_w -= n;
+			}
+			else if (fast_write(ptr, fp, c->lit, n))
+				goto error;
+			ret += n;
+		}
+
+		if (c->conv == 0)
+			break;
+
+		sign = '\0';
+		bp = end;
+
+		switch (c->conv)
+		{
+			case 'd':
+			case 'i':
+				v = (c->flags & FAST_LONG) ? va_arg(ap, long) : va_arg(ap, int);
+				if (v < 0)
+				{
+					u = -(unsigned long)v;
+					sign = '-';
+				}
+				else
+				{
+					u = v;
+					if (c->flags & FAST_PLUS)
+						sign = '+';
+					else if (c->flags & FAST_SPACE)
+						sign = ' ';
+				}
+				goto decimal;
+
+			case 'u':
+				u = (c->flags & FAST_LONG) ?
+					va_arg(ap, unsigned long) : va_arg(ap, unsigned);
+decimal:
+				/* Two digits per division. */
+				while (u >= 100)
+				{
+					q = u/100;
+					d = &digit_pairs[(u - q*100)*2];
+					*--bp = d[1];
+					*--bp = d[0];
+					u = q;
+				}
+				if (u >= 10)
+				{
+					*--bp = digit_pairs[u*2 + 1];
+					*--bp = digit_pairs[u*2];
+				}
+				else
+					*--bp = '0' + u;
+				cp = bp;
+				size = end - bp;
+				break;
+
+			case 'x':
+			case 'X':
+				u = (c->flags & FAST_LONG) ?
+					va_arg(ap, unsigned long) : va_arg(ap, unsigned);
+				xdigs = (c->conv == 'x') ?
+					"0123456789abcdef" : "0123456789ABCDEF";
+				do
+				{
+					*--bp = xdigs[u & 15];
+					u >>= 4;
+				} while (u != 0);
+				cp = bp;
+				size = end - bp;
+				break;
+
+			case 's':
+				if ((cp = va_arg(ap, const char *)) == NULL)
+					cp = "(null)";
+				size = strlen(cp);
+				break;
+
+			case 'c':
+				*--bp = va_arg(ap, int);
+				cp = bp;
+				size = 1;
+				break;
+
+			/* '%' */
+			default:
+				*--bp = '%';
+				cp = bp;
+				size = 1;
+				break;
+		}
+
+		realsz = (sign) ? size + 1 : size;
+		pad = (c->width > realsz) ? c->width - realsz : 0;
+		adjust = c->flags & (FAST_LADJUST | FAST_ZEROPAD);
+
+		/* Straight into the buffer. */
+		if (FAST_FITS(fp, realsz + pad) && (!(fp->_flags & __SLBF) ||
+			(memchr(cp, '\n', size) == NULL)))
+		{
+			p = (char *)fp->_p;
+			if ((pad > 0) && (adjust == 0))
+			{
+				for (n = pad; n > 0; n--)
+					*p++ = ' ';
+			}
+			if (sign)
+				*p++ = sign;
+			if ((pad > 0) && (adjust == FAST_ZEROPAD))
+			{
+				for (n = pad; n > 0; n--)
+					*p++ = '0';
+			}
+			if (c->conv == 's')
+			{
+				memcpy(p, cp, size);
+				p += size;
+			}
+			else
+			{
+				for (n = size; n > 0; n--)
+					*p++ = *cp++;
+			}
+			if ((pad > 0) && (adjust & FAST_LADJUST))
+			{
+				for (n = pad; n > 0; n--)
+					*p++ = ' ';
+			}
+			fp->_w -= realsz + pad;
+			fp->_p = (unsigned char *)p;
+		}
+
+		/* Piece by piece. */
+		else if (fast_field(ptr, fp, adjust, pad, sign, cp, size))
+			goto error;
+
+		ret += realsz + pad;
+	}
+
+	*retp = ret;
+	return (1);
+
+error:
+	*retp = EOF;
+	return (1);
+}
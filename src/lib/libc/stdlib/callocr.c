@@ -822,7 +822,17 @@ struct mallinfo {
 
 
 #ifndef DEFAULT_TRIM_THRESHOLD
-#define DEFAULT_TRIM_THRESHOLD (128L * 1024L)
+#define DEFAULT_TRIM_THRESHOLD (512L * 1024L)
+#endif
+
+/*
+    Each time the heap grows back after a trim, the trim threshold is
+    doubled, up to MAX_TRIM_THRESHOLD. Programs that repeatedly free and
+    reallocate a large working set then stop bouncing the break.
+*/
+
+#ifndef MAX_TRIM_THRESHOLD
+#define MAX_TRIM_THRESHOLD (8L * 1024L * 1024L)
 #endif
 
 /*
@@ -876,7 +886,7 @@ struct mallinfo {
 
 
 #ifndef DEFAULT_TOP_PAD
-#define DEFAULT_TOP_PAD        (0)
+#define DEFAULT_TOP_PAD        (64L * 1024L)
 #endif
 
 /*
@@ -1067,11 +1077,15 @@ extern Void_t*     sbrk();
 
 #ifdef INTERNAL_NEWLIB
 
-#define cALLOc		_calloc_r
-#define fREe		_free_r
-#define mALLOc		_malloc_r
+/*
+ * The small-object front end in smallocr.c owns the public names of the
+ * routines that take or return any object, and falls back to these.
+ */
+#define cALLOc		_dlcalloc_r
+#define fREe		_dlfree_r
+#define mALLOc		_dlmalloc_r
 #define mEMALIGn	_memalign_r
-#define rEALLOc		_realloc_r
+#define rEALLOc		_dlrealloc_r
 #define vALLOc		_valloc_r
 #define pvALLOc		_pvalloc_r
 #define mALLINFo	_mallinfo_r
@@ -1079,7 +1093,7 @@ extern Void_t*     sbrk();
 
 #define malloc_stats			_malloc_stats_r
 #define malloc_trim			_malloc_trim_r
-#define malloc_usable_size		_malloc_usable_size_r
+#define malloc_usable_size		_dlmalloc_usable_size_r
 
 #define malloc_update_mallinfo		__malloc_update_mallinfo
 
@@ -1090,6 +1104,9 @@ extern Void_t*     sbrk();
 #define malloc_sbrk_base		__malloc_sbrk_base
 #define malloc_top_pad			__malloc_top_pad
 #define malloc_trim_threshold		__malloc_trim_threshold
+#define malloc_brk_grows		__malloc_brk_grows
+#define malloc_brk_trims		__malloc_brk_trims
+#define malloc_brk_trimmed		__malloc_brk_trimmed
 
 #else /* ! INTERNAL_NEWLIB */
 
@@ -1750,6 +1767,9 @@ extern mbinptr av_[NAV * 2 + 2];
 #ifdef SEPARATE_OBJECTS
 #define trim_threshold		malloc_trim_threshold
 #define top_pad			malloc_top_pad
+#define brk_grows		malloc_brk_grows
+#define brk_trims		malloc_brk_trims
+#define brk_trimmed		malloc_brk_trimmed
 #define n_mmaps_max		malloc_n_mmaps_max
 #define mmap_threshold		malloc_mmap_threshold
 #define sbrk_base		malloc_sbrk_base
@@ -1768,6 +1788,12 @@ extern mbinptr av_[NAV * 2 + 2];
 
 STATIC unsigned long trim_threshold   = DEFAULT_TRIM_THRESHOLD;
 STATIC unsigned long top_pad          = DEFAULT_TOP_PAD;
+
+/* Number of times the break was moved up and down, and whether it was
+   last moved down. */
+STATIC unsigned long brk_grows        = 0;
+STATIC unsigned long brk_trims        = 0;
+STATIC int           brk_trimmed      = 0;
 #if HAVE_MMAP
 STATIC unsigned int  n_mmaps_max      = DEFAULT_MMAP_MAX;
 STATIC unsigned long mmap_threshold   = DEFAULT_MMAP_THRESHOLD;
@@ -1800,6 +1826,9 @@ STATIC unsigned long max_mmapped_mem = 0;
 
 extern unsigned long trim_threshold;
 extern unsigned long top_pad;
+extern unsigned long brk_grows;
+extern unsigned long brk_trims;
+extern int           brk_trimmed;
 #if HAVE_MMAP
 extern unsigned int  n_mmaps_max;
 extern unsigned long mmap_threshold;
@@ -2234,6 +2263,12 @@ static void malloc_extend_top(RARG nb) RDECL INTERNAL_SIZE_T nb;
       (brk < old_end && old_top != initial_top))
     return;
 
+  /* The heap grows back after a trim: widen the hysteresis band. */
+  brk_grows++;
+  if (brk_trimmed && trim_threshold < MAX_TRIM_THRESHOLD)
+    trim_threshold <<= 1;
+  brk_trimmed = 0;
+
   sbrked_mem += sbrk_size;
 
   if (brk == old_end /* can just add bytes to current top, unless
@@ -3331,7 +3366,8 @@ void cfree(mem) Void_t *mem;
 #endif
 {
 #ifdef INTERNAL_NEWLIB
-  fREe(_REENT, mem);
+  extern void _free_r(struct _reent *, void *);
+  _free_r(_REENT, mem);
 #else
   fREe(mem);
 #endif
@@ -3424,6 +3460,8 @@ int malloc_trim(RARG pad) RDECL size_t pad;
         /* Success. Adjust top accordingly. */
         set_head(top, (top_size - extra) | PREV_INUSE);
         sbrked_mem -= extra;
+        brk_trims++;
+        brk_trimmed = 1;
         check_chunk(top);
 	MALLOC_UNLOCK;
         return 1;
@@ -232,6 +232,7 @@ _DEFUN (_dtoa_r,
   _Bigint *b, *b1, *delta, *mlo = NULL, *mhi, *S;
   double ds;
   char *s, *s0;
+  char fbuf[20];
 
   d.d = _d;
 
@@ -288,6 +289,23 @@ _DEFUN (_dtoa_r,
       return s;
     }
 
+  /* Try to get by with 64-bit integer arithmetic (Grisu). */
+  if ((mode == 0 || mode == 2 || mode == 3)
+      && (i = __dtoa_fast (d.d, mode, ndigits, fbuf, decpt)) > 0)
+    {
+      j = sizeof (__ULong);
+      for (_REENT_MP_RESULT_K(ptr) = 0; sizeof (_Bigint) - sizeof (__ULong) + j <= (size_t)i;
+	   j <<= 1)
+	_REENT_MP_RESULT_K(ptr)++;
+      _REENT_MP_RESULT(ptr) = Balloc (ptr, _REENT_MP_RESULT_K(ptr));
+      s = (char *) _REENT_MP_RESULT(ptr);
+      memcpy (s, fbuf, i);
+      s[i] = 0;
+      if (rve)
+	*rve = s + i;
+      return s;
+    }
+
   b = d2b (ptr, d.d, &be, &bbits);
 #ifdef Sudden_Underflow
   i = (int) (word0 (d) >> Exp_shift1 & (Exp_mask >> Exp_shift1));
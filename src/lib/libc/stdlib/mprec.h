@@ -402,6 +402,8 @@ int		_EXFUN(gethex,(struct _reent *p, _CONST char **sp, _CONST struct FPI *fpi,
 double		_EXFUN(ratio,(_Bigint *a, _Bigint *b));
 __ULong		_EXFUN(any_on,(_Bigint *b, int k));
 void		_EXFUN(copybits,(__ULong *c, int n, _Bigint *b));
+int		_EXFUN(__dtoa_fast,(double d, int mode, int ndigits, char *buf, int *decpt));
+int		_EXFUN(__strtod_fast,(__uint64_t w, int q, double *d));
 #if defined(PREFER_SIZE_OVER_SPEED) || defined(__OPTIMIZE_SIZE__) || defined(_SMALL_HEXDIG)
 unsigned char _EXFUN(__hexdig_fun,(unsigned char));
 #endif /* !defined(PREFER_SIZE_OVER_SPEED) && !defined(__OPTIMIZE_SIZE__) && !defined(_SMALL_HEXDIG) */
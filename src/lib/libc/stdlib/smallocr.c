@@ -0,0 +1,332 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <reent.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @name Small-Object Front End
+ *
+ * @details Requests of up to SMALL_MAX bytes are served from per-class
+ *          free lists, and otherwise bump-allocated from slabs that are
+ *          themselves taken from the back end allocator. Each small object
+ *          is preceded by a header that holds its size class and the
+ *          SMALL_TAG bit. The back end keeps chunk sizes in that same word,
+ *          and since they are multiples of 8 that bit is never set there.
+ */
+/**@{*/
+#define SMALL_MAX     256                     /**< Largest small request.   */
+#define SMALL_GRAIN   8                       /**< Size class granularity.  */
+#define SMALL_TAG     4                       /**< Small object header tag. */
+#define SMALL_HDR     sizeof(size_t)          /**< Header size.             */
+#define SLAB_SIZE     4096                    /**< Slab size.               */
+#define NR_CLASSES    ((SMALL_MAX + SMALL_HDR)/SMALL_GRAIN + 2)
+/**@}*/
+
+/**
+ * @brief Size class of a small request.
+ */
+#define SMALL_CLASS(n) (((n) + SMALL_HDR + SMALL_GRAIN - 1)/SMALL_GRAIN)
+
+/**
+ * @brief Usable size of objects in a size class.
+ */
+#define SMALL_SIZE(c) ((c)*SMALL_GRAIN - SMALL_HDR)
+
+/* Back end allocator. */
+extern void *_dlmalloc_r(struct _reent *, size_t);
+extern void _dlfree_r(struct _reent *, void *);
+extern void *_dlrealloc_r(struct _reent *, void *, size_t);
+extern void *_dlcalloc_r(struct _reent *, size_t, size_t);
+extern size_t _dlmalloc_usable_size_r(struct _reent *, void *);
+extern void __malloc_lock(struct _reent *);
+extern void __malloc_unlock(struct _reent *);
+
+/* Back end bookkeeping. */
+extern struct mallinfo __malloc_current_mallinfo;
+extern unsigned long __malloc_max_sbrked_mem;
+extern unsigned long __malloc_trim_threshold;
+extern unsigned long __malloc_brk_grows;
+extern unsigned long __malloc_brk_trims;
+
+/**
+ * @brief Size classes.
+ */
+static struct
+{
+	void *free; /**< Free objects.               */
+	char *bump; /**< Next never-used slot.       */
+	char *end;  /**< End of the current slab.    */
+} classes[NR_CLASSES];
+
+/**
+ * @brief Allocation statistics.
+ */
+static struct mallstat stats;
+
+/**
+ * @brief Gets the header of an object.
+ */
+#define HEADER(p) (((size_t *)(p))[-1])
+
+/**
+ * @brief Carves a new slab for a size class.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param c         Size class.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+static int small_grow(struct _reent *reent_ptr, int c)
+{
+	char *slab;
+
+	if ((slab = _dlmalloc_r(reent_ptr, SLAB_SIZE)) == NULL)
+		return (-1);
+
+	/* First header right before an aligned address. */
+	classes[c].bump = slab + SMALL_GRAIN - SMALL_HDR;
+	classes[c].end = slab + SLAB_SIZE;
+
+	stats.nslabs++;
+	stats.slab_bytes += SLAB_SIZE;
+
+	return (0);
+}
+
+/**
+ * @brief Allocates a small object.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param n         Requested size.
+ *
+ * @returns A pointer to the object, or NULL if there is no memory left.
+ */
+static void *small_alloc(struct _reent *reent_ptr, size_t n)
+{
+	int c;
+	char *p;
+	size_t slot;
+
+	c = SMALL_CLASS(n);
+	slot = c*SMALL_GRAIN;
+
+	__malloc_lock(reent_ptr);
+
+	/* Reuse a freed object. */
+	if ((p = classes[c].free) != NULL)
+	{
+		classes[c].free = *(void **)p;
+		stats.nreuse++;
+	}
+
+	/* Bump-allocate a new one. */
+	else
+	{
+		if (classes[c].bump + slot > classes[c].end)
+		{
+			if (small_grow(reent_ptr, c))
+			{
+				__malloc_unlock(reent_ptr);
+				reent_ptr->_errno = ENOMEM;
+				return (NULL);
+			}
+		}
+
+		p = classes[c].bump + SMALL_HDR;
+		HEADER(p) = (c*SMALL_GRAIN) | SMALL_TAG;
+		classes[c].bump += slot;
+	}
+
+	stats.nmalloc++;
+	stats.nsmall++;
+	stats.small_bytes += SMALL_SIZE(c);
+
+	__malloc_unlock(reent_ptr);
+
+	return (p);
+}
+
+/**
+ * @brief Allocates memory.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param n         Requested size.
+ *
+ * @returns A pointer to the allocated memory, or NULL if there is no memory
+ *          left.
+ */
+void *_malloc_r(struct _reent *reent_ptr, size_t n)
+{
+	void *p;
+
+	if (n <= SMALL_MAX)
+		return (small_alloc(reent_ptr, n));
+
+	if ((p = _dlmalloc_r(reent_ptr, n)) != NULL)
+		stats.nmalloc++;
+
+	return (p);
+}
+
+/**
+ * @brief Frees memory.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param p         Memory to free.
+ */
+void _free_r(struct _reent *reent_ptr, void *p)
+{
+	int c;
+
+	if (p == NULL)
+		return;
+
+	stats.nfree++;
+
+	/* Large object. */
+	if (!(HEADER(p) & SMALL_TAG))
+	{
+		_dlfree_r(reent_ptr, p);
+		return;
+	}
+
+	c = HEADER(p)/SMALL_GRAIN;
+
+	__malloc_lock(reent_ptr);
+	*(void **)p = classes[c].free;
+	classes[c].free = p;
+	stats.small_bytes -= SMALL_SIZE(c);
+	__malloc_unlock(reent_ptr);
+}
+
+/**
+ * @brief Reallocates memory.
+ *
+ * @details Small objects stay in place as long as the new size fits their
+ *          size class. Large objects are left to the back end, even when
+ *          they shrink.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param p         Memory to reallocate.
+ * @param n         Requested size.
+ *
+ * @returns A pointer to the reallocated memory, or NULL if there is no
+ *          memory left, in which case @p p is left untouched.
+ */
+void *_realloc_r(struct _reent *reent_ptr, void *p, size_t n)
+{
+	void *q;
+	size_t size;
+
+	if (p == NULL)
+		return (_malloc_r(reent_ptr, n));
+
+	/* Large object. */
+	if (!(HEADER(p) & SMALL_TAG))
+		return (_dlrealloc_r(reent_ptr, p, n));
+
+	size = SMALL_SIZE(HEADER(p)/SMALL_GRAIN);
+	if (n <= size)
+		return (p);
+
+	if ((q = _malloc_r(reent_ptr, n)) == NULL)
+		return (NULL);
+
+	memcpy(q, p, size);
+	_free_r(reent_ptr, p);
+
+	return (q);
+}
+
+/**
+ * @brief Allocates zeroed memory for an array.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param nmemb     Number of elements.
+ * @param size      Size of an element.
+ *
+ * @returns A pointer to the allocated memory, or NULL if there is no memory
+ *          left.
+ */
+void *_calloc_r(struct _reent *reent_ptr, size_t nmemb, size_t size)
+{
+	void *p;
+
+	/* Overflow. */
+	if ((size != 0) && (nmemb > SIZE_MAX/size))
+	{
+		reent_ptr->_errno = ENOMEM;
+		return (NULL);
+	}
+
+	if (nmemb*size > SMALL_MAX)
+	{
+		if ((p = _dlcalloc_r(reent_ptr, nmemb, size)) != NULL)
+			stats.nmalloc++;
+		return (p);
+	}
+
+	if ((p = small_alloc(reent_ptr, nmemb*size)) != NULL)
+		memset(p, 0, nmemb*size);
+
+	return (p);
+}
+
+/**
+ * @brief Gets the usable size of allocated memory.
+ *
+ * @param reent_ptr Reentrancy structure.
+ * @param p         Allocated memory.
+ *
+ * @returns The number of bytes that may be used in @p p.
+ */
+size_t _malloc_usable_size_r(struct _reent *reent_ptr, void *p)
+{
+	if (p == NULL)
+		return (0);
+
+	if (!(HEADER(p) & SMALL_TAG))
+		return (_dlmalloc_usable_size_r(reent_ptr, p));
+
+	return (SMALL_SIZE(HEADER(p)/SMALL_GRAIN));
+}
+
+/**
+ * @brief Gets allocation statistics.
+ *
+ * @param buf Where to store the statistics.
+ */
+void mallstat(struct mallstat *buf)
+{
+	__malloc_lock(_REENT);
+
+	stats.heap = __malloc_current_mallinfo.arena;
+	stats.heap_max = __malloc_max_sbrked_mem;
+	stats.trim_threshold = __malloc_trim_threshold;
+	stats.brk_grows = __malloc_brk_grows;
+	stats.brk_trims = __malloc_brk_trims;
+	*buf = stats;
+
+	__malloc_unlock(_REENT);
+}
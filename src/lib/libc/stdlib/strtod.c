@@ -189,6 +189,7 @@ _DEFUN (_strtod_r, (ptr, s00, se),
 	U aadj1, rv, rv0;
 	Long L;
 	__ULong y, z;
+	__uint64_t w;
 	_Bigint *bb = NULL, *bb1, *bd = NULL, *bd0, *bs = NULL, *delta = NULL;
 #ifdef Avoid_Underflow
 	__ULong Lsb, Lsb1;
@@ -493,6 +494,23 @@ _DEFUN (_strtod_r, (ptr, s00, se),
 			}
 #endif
 		}
+
+	/* Up to 19 digits fit in 64 bits: try Eisel-Lemire. */
+	if (nd <= 19
+#ifndef RND_PRODQUOT
+#ifndef Honor_FLT_ROUNDS
+		&& Flt_Rounds == 1
+#endif
+#endif
+			) {
+		for(w = 0, s1 = s0, i = 0; i < nd; i++, s1++) {
+			if (i == nd0)
+				s1 += strlen (_localeconv_r (ptr)->decimal_point);
+			w = 10*w + *s1 - '0';
+			}
+		if (__strtod_fast(w, e, &dval(rv)))
+			goto ret;
+		}
 	e1 += nd - k;
 
 #ifdef IEEE_Arith
@@ -0,0 +1,63 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/fdlibm.h"
+#include "x87.h"
+
+static const long double log2e = 1.44269504088896340736L;
+
+static const double
+ln2_hi = 6.93147180369123816490e-01, /* 0x3fe62e42, 0xfee00000 */
+ln2_lo = 1.90821492927058770002e-10; /* 0x3dea39ef, 0x35793c76 */
+
+/**
+ * @brief Computes the exponential of an array of numbers.
+ *
+ * @param y Store location for results.
+ * @param x Numbers.
+ * @param n Number of numbers.
+ *
+ * @details x is reduced to k*ln(2) + r, with |r| <= ln(2)/2, in extended
+ *          precision, and e raised to r comes from f2xm1. Both are exact
+ *          enough for the result to be rounded once, when stored. Numbers
+ *          whose exponential is not a normal double are left to
+ *          __ieee754_exp().
+ */
+void vexp(double *y, const double *x, int n)
+{
+	int i;
+	__int32_t hx;
+	long double k, r;
+
+	for (i = 0; i < n; i++)
+	{
+		GET_HIGH_WORD(hx, x[i]);
+
+		/* |x| >= 708. */
+		if ((hx & 0x7fffffff) >= 0x40862000)
+		{
+			y[i] = __ieee754_exp(x[i]);
+			continue;
+		}
+
+		k = x87_frndint(x[i]*log2e);
+		r = (x[i] - k*ln2_hi) - k*ln2_lo;
+		y[i] = x87_fscale(x87_f2xm1(r*log2e) + 1.0L, k);
+	}
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/fdlibm.h"
+#include "x87.h"
+
+static const long double ln2 = 6.93147180559945309417e-01L;
+
+/**
+ * @brief Computes the natural logarithm of an array of numbers.
+ *
+ * @param y Store location for results.
+ * @param x Numbers.
+ * @param n Number of numbers.
+ *
+ * @details The logarithm comes from fyl2x, or from fyl2xp1 near one,
+ *          where x - 1 is exact. Zero, negative, subnormal and non-finite
+ *          numbers are left to __ieee754_log().
+ */
+void vlog(double *y, const double *x, int n)
+{
+	int i;
+	__int32_t hx;
+
+	for (i = 0; i < n; i++)
+	{
+		GET_HIGH_WORD(hx, x[i]);
+
+		if ((hx < 0x00100000) || (hx >= 0x7ff00000))
+			y[i] = __ieee754_log(x[i]);
+		else if ((x[i] > 0.75) && (x[i] < 1.25))
+			y[i] = x87_fyl2xp1(x[i] - 1.0, ln2);
+		else
+			y[i] = x87_fyl2x(x[i], ln2);
+	}
+}
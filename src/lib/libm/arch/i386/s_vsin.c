@@ -0,0 +1,87 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/fdlibm.h"
+#include "x87.h"
+
+static const long double two_over_pi = 6.36619772367581343076e-01L;
+
+static const double
+pio2_1  = 1.57079632673412561417e+00, /* 0x3ff921fb, 0x54400000 */
+pio2_2  = 6.07710050630396597660e-11, /* 0x3dd0b461, 0x1a600000 */
+pio2_3  = 2.02226624871116645580e-21, /* 0x3ba3198a, 0x2e000000 */
+pio2_3t = 8.47842766036889956997e-32; /* 0x397b839a, 0x252049c1 */
+
+/**
+ * @brief Computes the sine of an array of numbers.
+ *
+ * @param y Store location for results.
+ * @param x Numbers.
+ * @param n Number of numbers.
+ *
+ * @details fsin is only used within [-pi/4, pi/4], where it is accurate.
+ *          Numbers below 2^20*pi/2 are reduced to that range in extended
+ *          precision, by subtracting k*pi/2 in pieces of 33 bits, so that
+ *          all products are exact. Larger numbers are reduced by
+ *          __ieee754_rem_pio2(). Inf and NaN are left to sin().
+ */
+void vsin(double *y, const double *x, int n)
+{
+	int i;
+	__int32_t ix;
+	double z[2];
+	long double k, r;
+
+	for (i = 0; i < n; i++)
+	{
+		GET_HIGH_WORD(ix, x[i]);
+		ix &= 0x7fffffff;
+
+		/* |x| <= pi/4. */
+		if (ix <= 0x3fe921fb)
+			y[i] = x87_fsin(x[i]);
+
+		else if (ix >= 0x7ff00000)
+			y[i] = sin(x[i]);
+
+		else
+		{
+			/* |x| < 2^20*pi/2. */
+			if (ix < 0x413921fb)
+			{
+				k = x87_frndint(x[i]*two_over_pi);
+				r = (x[i] - k*pio2_1) - k*pio2_2;
+				r = (r - k*pio2_3) - k*pio2_3t;
+			}
+			else
+			{
+				k = __ieee754_rem_pio2(x[i], z);
+				r = (long double) z[0] + z[1];
+			}
+
+			switch ((int) k & 3)
+			{
+				case 0: y[i] = x87_fsin(r); break;
+				case 1: y[i] = x87_fcos(r); break;
+				case 2: y[i] = -x87_fsin(r); break;
+				default: y[i] = -x87_fcos(r); break;
+			}
+		}
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file x87.h
+ *
+ * @brief x87 FPU instructions.
+ */
+
+#ifndef X87_H_
+#define X87_H_
+
+	/**
+	 * @brief Computes 2 raised to x, minus one, for |x| <= 1.
+	 *
+	 * @param x Number.
+	 */
+	static inline long double x87_f2xm1(long double x)
+	{
+		long double r;
+		__asm__ ("f2xm1" : "=t" (r) : "0" (x));
+		return (r);
+	}
+
+	/**
+	 * @brief Multiplies x by 2 raised to the integral value n.
+	 *
+	 * @param x Number.
+	 * @param n Integral exponent.
+	 */
+	static inline long double x87_fscale(long double x, long double n)
+	{
+		long double r;
+		__asm__ ("fscale" : "=t" (r) : "0" (x), "u" (n));
+		return (r);
+	}
+
+	/**
+	 * @brief Rounds x to an integral value, in the current rounding mode.
+	 *
+	 * @param x Number.
+	 */
+	static inline long double x87_frndint(long double x)
+	{
+		long double r;
+		__asm__ ("frndint" : "=t" (r) : "0" (x));
+		return (r);
+	}
+
+	/**
+	 * @brief Computes y times the base 2 logarithm of x, for x > 0.
+	 *
+	 * @param x Number.
+	 * @param y Factor.
+	 */
+	static inline long double x87_fyl2x(long double x, long double y)
+	{
+		long double r;
+		__asm__ ("fyl2x" : "=t" (r) : "0" (x), "u" (y) : "st(1)");
+		return (r);
+	}
+
+	/**
+	 * @brief Computes y times the base 2 logarithm of 1 + x, for
+	 * |x| < 1 - sqrt(2)/2.
+	 *
+	 * @param x Number.
+	 * @param y Factor.
+	 */
+	static inline long double x87_fyl2xp1(long double x, long double y)
+	{
+		long double r;
+		__asm__ ("fyl2xp1" : "=t" (r) : "0" (x), "u" (y) : "st(1)");
+		return (r);
+	}
+
+	/**
+	 * @brief Computes the sine of x, for |x| <= pi/4.
+	 *
+	 * @param x Number.
+	 */
+	static inline long double x87_fsin(long double x)
+	{
+		long double r;
+		__asm__ ("fsin" : "=t" (r) : "0" (x));
+		return (r);
+	}
+
+	/**
+	 * @brief Computes the cosine of x, for |x| <= pi/4.
+	 *
+	 * @param x Number.
+	 */
+	static inline long double x87_fcos(long double x)
+	{
+		long double r;
+		__asm__ ("fcos" : "=t" (r) : "0" (x));
+		return (r);
+	}
+
+#endif /* X87_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fdlibm.h"
+
+/**
+ * @brief Computes the natural logarithm of an array of numbers.
+ *
+ * @param y Store location for results.
+ * @param x Numbers.
+ * @param n Number of numbers.
+ *
+ * @details y[i] is set to the natural logarithm of x[i], for each i < n.
+ *          x and y may be the same array. Unlike log(), this does not set
+ *          errno.
+ */
+void vlog(double *y, const double *x, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		y[i] = __ieee754_log(x[i]);
+}
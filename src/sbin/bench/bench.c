@@ -0,0 +1,1028 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <math.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Output formats.
+ */
+/**@{*/
+#define FORMAT_CSV  0 /**< Comma-separated values. */
+#define FORMAT_JSON 1 /**< JSON.                   */
+/**@}*/
+
+/**
+ * @brief Benchmark parameters.
+ */
+/**@{*/
+#define BENCH_PATH   "/sbin/bench"      /**< Path to this program.         */
+#define BENCH_FILE   "/home/bench.tmp"  /**< Scratch file.                 */
+#define BENCH_SEM1   "/home/mysem/bsem1" /**< First handoff semaphore.     */
+#define BENCH_SEM2   "/home/mysem/bsem2" /**< Second handoff semaphore.    */
+#define FILE_SIZE    (256*1024)         /**< Scratch file size.            */
+#define BULK_SIZE    (512*1024)         /**< Bytes moved by bulk transfer. */
+#define FAULT_PAGES  64                 /**< Pages touched by fault tests. */
+#define PAGE_SIZE    4096               /**< Page size.                    */
+#define CAL_NS       50000000LL         /**< TSC calibration interval.     */
+/**@}*/
+
+/**
+ * @brief Initialized data, so that it is loaded on demand from the binary.
+ */
+static char fill_area[FAULT_PAGES*PAGE_SIZE] = { 1 };
+
+/**
+ * @brief Scratch buffer.
+ */
+static char buffer[16384];
+
+/**
+ * @brief Program arguments.
+ */
+static struct
+{
+	int format;       /**< Output format.        */
+	const char *tag;  /**< Run label.            */
+	int scale;        /**< Iteration multiplier. */
+	char **only;      /**< Selected benchmarks.  */
+	int nonly;        /**< Selected benchmarks.  */
+} args = { FORMAT_CSV, "", 1, NULL, 0 };
+
+/**
+ * @brief TSC frequency (in kHz).
+ */
+static uint64_t tsc_khz = 0;
+
+/**
+ * @brief Number of printed results.
+ */
+static int nresults = 0;
+
+/*============================================================================*
+ *                                 Utilities                                  *
+ *============================================================================*/
+
+/**
+ * @brief Reads the time stamp counter.
+ */
+static inline uint64_t rdtsc(void)
+{
+	uint32_t lo, hi;
+
+	__asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+
+	return (((uint64_t)hi << 32) | lo);
+}
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static long long monotonic(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+/**
+ * @brief Calibrates the time stamp counter against the monotonic clock.
+ */
+static void calibrate(void)
+{
+	long long t0, t1;
+	uint64_t c0, c1;
+
+	t0 = monotonic();
+	c0 = rdtsc();
+	do
+		t1 = monotonic();
+	while (t1 - t0 < CAL_NS);
+	c1 = rdtsc();
+
+	tsc_khz = ((c1 - c0)*1000000ULL)/(uint64_t)(t1 - t0);
+}
+
+/**
+ * @brief Converts an unsigned 64-bit integer to a decimal string.
+ *
+ * @details Avoids depending on long long support in printf().
+ */
+static const char *u64str(uint64_t x, char *buf)
+{
+	char *p = buf + 20;
+
+	*p = '\0';
+	do
+	{
+		*--p = '0' + (x % 10);
+		x /= 10;
+	} while (x != 0);
+
+	return (p);
+}
+
+/**
+ * @brief Prints a benchmark result.
+ *
+ * @param name   Benchmark name.
+ * @param size   Operation size (in bytes), if any.
+ * @param iters  Number of operations.
+ * @param cycles Elapsed TSC cycles.
+ */
+static void report(const char *name, unsigned size, unsigned iters, uint64_t cycles)
+{
+	uint64_t per_op, ns_op, kbps;
+	char b1[21], b2[21], b3[21], b4[21];
+
+	if (iters == 0)
+		iters = 1;
+
+	per_op = cycles/iters;
+	ns_op = (tsc_khz) ? (cycles*1000000ULL/tsc_khz)/iters : 0;
+	kbps = ((size) && (cycles) && (tsc_khz)) ?
+		((uint64_t)size*iters*tsc_khz)/cycles : 0;
+
+	if (args.format == FORMAT_JSON)
+	{
+		printf("%s\n    {\"bench\": \"%s\", \"size\": %u, \"iters\": %u, "
+			"\"cycles\": %s, \"cycles_per_op\": %s, \"ns_per_op\": %s, "
+			"\"kb_per_s\": %s}",
+			(nresults) ? "," : "", name, size, iters, u64str(cycles, b1),
+			u64str(per_op, b2), u64str(ns_op, b3), u64str(kbps, b4));
+	}
+	else
+	{
+		printf("%s,%s,%u,%u,%s,%s,%s,%s\n", args.tag, name, size, iters,
+			u64str(cycles, b1), u64str(per_op, b2), u64str(ns_op, b3),
+			u64str(kbps, b4));
+	}
+
+	nresults++;
+}
+
+/**
+ * @brief Runs a measurement in a fresh child process.
+ *
+ * @param fn Measurement function. It returns elapsed cycles.
+ *
+ * @returns The cycles measured by the child.
+ */
+static uint64_t in_child(uint64_t (*fn)(void))
+{
+	int fd[2];
+	pid_t pid;
+	uint64_t cycles;
+
+	cycles = 0;
+
+	if (pipe(fd) < 0)
+		return (0);
+
+	if ((pid = fork()) < 0)
+	{
+		close(fd[0]);
+		close(fd[1]);
+		return (0);
+	}
+
+	/* Child. */
+	if (pid == 0)
+	{
+		close(fd[0]);
+		cycles = fn();
+		write(fd[1], &cycles, sizeof(cycles));
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(fd[1]);
+	if (read(fd[0], &cycles, sizeof(cycles)) != sizeof(cycles))
+		cycles = 0;
+	close(fd[0]);
+	wait(NULL);
+
+	return (cycles);
+}
+
+/*============================================================================*
+ *                               Process Benchmarks                           *
+ *============================================================================*/
+
+/**
+ * @brief Null system call.
+ */
+static void bench_null(void)
+{
+	uint64_t t0, t1;
+	unsigned n = 10000*args.scale;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		getppid();
+	t1 = rdtsc();
+
+	report("null_syscall", 0, n, t1 - t0);
+}
+
+/**
+ * @brief fork() followed by wait().
+ */
+static void bench_fork(void)
+{
+	uint64_t t0, t1;
+	unsigned n = 100*args.scale;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		if (fork() == 0)
+			_exit(EXIT_SUCCESS);
+		wait(NULL);
+	}
+	t1 = rdtsc();
+
+	report("fork_wait", 0, n, t1 - t0);
+}
+
+/**
+ * @brief fork() followed by execve() and wait().
+ */
+static void bench_exec(void)
+{
+	uint64_t t0, t1;
+	unsigned n = 50*args.scale;
+	char *const argv[] = { "bench", "--exit", NULL };
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		if (fork() == 0)
+			_exit(execve(BENCH_PATH, argv, environ));
+		wait(NULL);
+	}
+	t1 = rdtsc();
+
+	report("fork_exec", 0, n, t1 - t0);
+}
+
+/*============================================================================*
+ *                                 IPC Benchmarks                             *
+ *============================================================================*/
+
+/**
+ * @brief Pipe round trips between two processes.
+ *
+ * @param n Number of round trips.
+ *
+ * @returns The cycles elapsed in all round trips.
+ */
+static uint64_t pingpong(unsigned n)
+{
+	char c;
+	uint64_t t0, t1;
+	int p2c[2], c2p[2];
+
+	c = 0;
+
+	if (pipe(p2c) < 0)
+		return (0);
+	if (pipe(c2p) < 0)
+	{
+		close(p2c[0]);
+		close(p2c[1]);
+		return (0);
+	}
+
+	/* Child: echo bytes back. */
+	if (fork() == 0)
+	{
+		close(p2c[1]);
+		close(c2p[0]);
+		while (read(p2c[0], &c, 1) == 1)
+			write(c2p[1], &c, 1);
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(p2c[0]);
+	close(c2p[1]);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		write(p2c[1], &c, 1);
+		read(c2p[0], &c, 1);
+	}
+	t1 = rdtsc();
+
+	close(p2c[1]);
+	close(c2p[0]);
+	wait(NULL);
+
+	return (t1 - t0);
+}
+
+/**
+ * @brief Pipe ping-pong latency.
+ */
+static void bench_pingpong(void)
+{
+	unsigned n = 1000*args.scale;
+
+	report("pipe_pingpong", 1, n, pingpong(n));
+}
+
+/**
+ * @brief Context switch cost.
+ *
+ * @details A ping-pong round trip costs two context switches plus four pipe
+ *          operations. The pipe operations are measured without switching
+ *          and subtracted.
+ */
+static void bench_ctxsw(void)
+{
+	char c;
+	int fd[2];
+	uint64_t t0, t1;
+	uint64_t rtt, ops;
+	unsigned n = 1000*args.scale;
+
+	c = 0;
+
+	if (pipe(fd) < 0)
+		return;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		write(fd[1], &c, 1);
+		read(fd[0], &c, 1);
+	}
+	t1 = rdtsc();
+	ops = t1 - t0;
+
+	close(fd[0]);
+	close(fd[1]);
+
+	rtt = pingpong(n);
+
+	report("ctxsw", 0, 2*n, (rtt > 2*ops) ? rtt - 2*ops : 0);
+}
+
+/**
+ * @brief Pipe bulk throughput.
+ */
+static void bench_bulk(void)
+{
+	int fd[2];
+	ssize_t ret;
+	size_t total;
+	uint64_t t0, t1;
+	const unsigned size = PAGE_SIZE;
+
+	if (pipe(fd) < 0)
+		return;
+
+	/* Child: produce data. */
+	if (fork() == 0)
+	{
+		close(fd[0]);
+		for (total = 0; total < BULK_SIZE; total += size)
+			write(fd[1], buffer, size);
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(fd[1]);
+
+	total = 0;
+	t0 = rdtsc();
+	while ((ret = read(fd[0], buffer, size)) > 0)
+		total += ret;
+	t1 = rdtsc();
+
+	close(fd[0]);
+	wait(NULL);
+
+	report("pipe_bulk", size, total/size, t1 - t0);
+}
+
+/**
+ * @brief Semaphore handoff between two processes.
+ */
+static void bench_sem(void)
+{
+	sem_t *s1, *s2;
+	uint64_t t0, t1;
+	unsigned n = 500*args.scale;
+
+	s1 = sem_open(BENCH_SEM1, O_CREAT, 0644, 0);
+	s2 = sem_open(BENCH_SEM2, O_CREAT, 0644, 0);
+
+	if ((s1 == NULL) || (s2 == NULL))
+		return;
+
+	/* Child: bounce the token back. */
+	if (fork() == 0)
+	{
+		s1 = sem_open(BENCH_SEM1, O_RDWR);
+		s2 = sem_open(BENCH_SEM2, O_RDWR);
+		for (unsigned i = 0; i < n; i++)
+		{
+			sem_wait(s1);
+			sem_post(s2);
+		}
+		sem_close(s1);
+		sem_close(s2);
+		_exit(EXIT_SUCCESS);
+	}
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		sem_post(s1);
+		sem_wait(s2);
+	}
+	t1 = rdtsc();
+
+	wait(NULL);
+
+	sem_close(s1);
+	sem_close(s2);
+	sem_unlink(BENCH_SEM1);
+	sem_unlink(BENCH_SEM2);
+
+	report("sem_handoff", 0, n, t1 - t0);
+}
+
+/*============================================================================*
+ *                               File Benchmarks                              *
+ *============================================================================*/
+
+/**
+ * @brief Linear congruential generator.
+ */
+static unsigned next_rand(unsigned *seed)
+{
+	*seed = *seed*1103515245 + 12345;
+
+	return ((*seed >> 16) & 0x7fff);
+}
+
+/**
+ * @brief File read/write at a given block size.
+ */
+static void bench_file_size(unsigned size)
+{
+	int fd;
+	unsigned seed;
+	uint64_t t0, t1;
+	unsigned nblocks = FILE_SIZE/size;
+
+	if ((fd = open(BENCH_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+		return;
+
+	/* Sequential write. */
+	t0 = rdtsc();
+	for (unsigned i = 0; i < nblocks; i++)
+		write(fd, buffer, size);
+	t1 = rdtsc();
+	report("file_seq_write", size, nblocks, t1 - t0);
+
+	/* Sequential read. */
+	lseek(fd, 0, SEEK_SET);
+	t0 = rdtsc();
+	for (unsigned i = 0; i < nblocks; i++)
+		read(fd, buffer, size);
+	t1 = rdtsc();
+	report("file_seq_read", size, nblocks, t1 - t0);
+
+	/* Random read. */
+	seed = 1;
+	t0 = rdtsc();
+	for (unsigned i = 0; i < nblocks; i++)
+	{
+		lseek(fd, (off_t)(next_rand(&seed) % nblocks)*size, SEEK_SET);
+		read(fd, buffer, size);
+	}
+	t1 = rdtsc();
+	report("file_rand_read", size, nblocks, t1 - t0);
+
+	/* Random write. */
+	seed = 1;
+	t0 = rdtsc();
+	for (unsigned i = 0; i < nblocks; i++)
+	{
+		lseek(fd, (off_t)(next_rand(&seed) % nblocks)*size, SEEK_SET);
+		write(fd, buffer, size);
+	}
+	t1 = rdtsc();
+	report("file_rand_write", size, nblocks, t1 - t0);
+
+	close(fd);
+	unlink(BENCH_FILE);
+}
+
+/**
+ * @brief File read/write at several block sizes.
+ */
+static void bench_file(void)
+{
+	bench_file_size(512);
+	bench_file_size(4096);
+	bench_file_size(16384);
+}
+
+/*============================================================================*
+ *                             Page Fault Benchmarks                          *
+ *============================================================================*/
+
+/**
+ * @brief Touches fresh heap pages.
+ */
+static uint64_t touch_zero(void)
+{
+	char *p;
+	uint64_t t0, t1;
+
+	if ((p = malloc(FAULT_PAGES*PAGE_SIZE)) == NULL)
+		return (0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < FAULT_PAGES; i++)
+		p[i*PAGE_SIZE] = 1;
+	t1 = rdtsc();
+
+	return (t1 - t0);
+}
+
+/**
+ * @brief Writes to pages shared copy-on-write with the parent.
+ */
+static uint64_t touch_cow(void)
+{
+	uint64_t t0, t1;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < FAULT_PAGES; i++)
+		fill_area[i*PAGE_SIZE + 1] = 2;
+	t1 = rdtsc();
+
+	return (t1 - t0);
+}
+
+/**
+ * @brief Reads pages that are loaded on demand from the binary.
+ */
+static uint64_t touch_fill(void)
+{
+	volatile char c;
+	uint64_t t0, t1;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < FAULT_PAGES; i++)
+		c = fill_area[i*PAGE_SIZE];
+	t1 = rdtsc();
+
+	((void) c);
+
+	return (t1 - t0);
+}
+
+/**
+ * @brief Page fault rates.
+ *
+ * @details Each measurement runs in a fresh child. The fill test runs before
+ *          the parent touches the initialized data, so the child faults it in
+ *          from the binary. The parent then touches it so that the COW test
+ *          finds resident, shared pages.
+ */
+static void bench_fault(void)
+{
+	report("pf_zero", PAGE_SIZE, FAULT_PAGES, in_child(touch_zero));
+	report("pf_fill", PAGE_SIZE, FAULT_PAGES, in_child(touch_fill));
+
+	for (unsigned i = 0; i < FAULT_PAGES; i++)
+		fill_area[i*PAGE_SIZE] = 1;
+
+	report("pf_cow", PAGE_SIZE, FAULT_PAGES, in_child(touch_cow));
+}
+
+/*============================================================================*
+ *                              String Benchmarks                             *
+ *============================================================================*/
+
+/**
+ * @brief String functions at a given size.
+ *
+ * @details Source and destination are misaligned, so that the unaligned
+ *          heads and tails of the routines are accounted for.
+ */
+static void bench_string_size(unsigned size)
+{
+	uint64_t t0, t1;
+	volatile uintptr_t sink;
+	char *src = &buffer[1];
+	char *dst = &buffer[sizeof(buffer)/2 + 3];
+	unsigned n = 2000*args.scale;
+
+	sink = 0;
+
+	memset(buffer, 'a', sizeof(buffer));
+	src[size - 1] = dst[size - 1] = '\0';
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += (uintptr_t)memcpy(dst, src, size);
+	t1 = rdtsc();
+	report("str_memcpy", size, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += (uintptr_t)memset(dst, 0, size - 1);
+	t1 = rdtsc();
+	report("str_memset", size, n, t1 - t0);
+
+	memcpy(dst, src, size);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += (uintptr_t)memchr(src, '\0', size);
+	t1 = rdtsc();
+	report("str_memchr", size, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += memcmp(dst, src, size);
+	t1 = rdtsc();
+	report("str_memcmp", size, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += strlen(src);
+	t1 = rdtsc();
+	report("str_strlen", size, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += (uintptr_t)strchr(src, 'b');
+	t1 = rdtsc();
+	report("str_strchr", size, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += strcmp(dst, src);
+	t1 = rdtsc();
+	report("str_strcmp", size, n, t1 - t0);
+
+	((void) sink);
+}
+
+/**
+ * @brief String functions at several sizes.
+ */
+static void bench_string(void)
+{
+	bench_string_size(16);
+	bench_string_size(256);
+	bench_string_size(4096);
+}
+
+/*============================================================================*
+ *                          Formatted Output Benchmarks                       *
+ *============================================================================*/
+
+/**
+ * @brief snprintf() of common conversions.
+ *
+ * @details The _generic runs prepend a "%.0s" conversion, which prints
+ *          nothing but keeps the format off the fast path.
+ */
+static void bench_printf(void)
+{
+	uint64_t t0, t1;
+	volatile int sink;
+	unsigned n = 2000*args.scale;
+
+	sink = 0;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += snprintf(buffer, 64, "%d", i*7919);
+	t1 = rdtsc();
+	report("printf_int", 0, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += snprintf(buffer, 64, "%.0s%d", "", i*7919);
+	t1 = rdtsc();
+	report("printf_int_generic", 0, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += snprintf(buffer, 64, "%-8d %s %08x %u\n", i*7919, "name", i, i);
+	t1 = rdtsc();
+	report("printf_mixed", 0, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += snprintf(buffer, 64, "%.0s%-8d %s %08x %u\n", "", i*7919, "name", i, i);
+	t1 = rdtsc();
+	report("printf_mixed_generic", 0, n, t1 - t0);
+
+	((void) sink);
+}
+
+/*============================================================================*
+ *                      Floating-Point Conversion Benchmarks                  *
+ *============================================================================*/
+
+/**
+ * @brief snprintf() and strtod() of doubles.
+ *
+ * @details The _long run parses numbers with more digits than the fast
+ *          path takes, and so measures the bignum code.
+ */
+static void bench_float(void)
+{
+	uint64_t t0, t1;
+	volatile double sink;
+	unsigned n = 1000*args.scale;
+
+	sink = 0;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		snprintf(buffer, 64, "%.17g", i*1.1 + 0.3);
+	t1 = rdtsc();
+	report("float_printf_g17", 0, n, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		snprintf(buffer, 64, "%e", i*1.1 + 0.3);
+	t1 = rdtsc();
+	report("float_printf_e", 0, n, t1 - t0);
+
+	snprintf(buffer, 64, "%.17g", 1.1 + 0.3);
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += strtod(buffer, NULL);
+	t1 = rdtsc();
+	report("float_strtod", 0, n, t1 - t0);
+
+	strcpy(buffer, "1.399999999999999911182158029987");
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		sink += strtod(buffer, NULL);
+	t1 = rdtsc();
+	report("float_strtod_long", 0, n, t1 - t0);
+
+	((void) sink);
+}
+
+/*============================================================================*
+ *                          Math Library Benchmarks                           *
+ *============================================================================*/
+
+/**
+ * @brief Numbers per batch of the math library benchmarks.
+ */
+#define MATH_BATCH 256
+
+/**
+ * @brief Scalar and batched math library functions.
+ *
+ * @details Each run computes the same numbers, one per call or
+ *          MATH_BATCH per call, and reports the cost of one number.
+ */
+static void bench_math(void)
+{
+	uint64_t t0, t1;
+	volatile double sink;
+	static double x[MATH_BATCH], y[MATH_BATCH];
+	unsigned n = 100*args.scale;
+
+	sink = 0;
+	for (int i = 0; i < MATH_BATCH; i++)
+		x[i] = (i - MATH_BATCH/2)*0.0625 + 0.03125;
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		for (int j = 0; j < MATH_BATCH; j++)
+			sink += sqrt(fabs(x[j]));
+	}
+	t1 = rdtsc();
+	report("math_sqrt", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		for (int j = 0; j < MATH_BATCH; j++)
+			sink += floor(x[j]);
+	}
+	t1 = rdtsc();
+	report("math_floor", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		for (int j = 0; j < MATH_BATCH; j++)
+			y[j] = exp(x[j]);
+	}
+	t1 = rdtsc();
+	report("math_exp", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		vexp(y, x, MATH_BATCH);
+	t1 = rdtsc();
+	report("math_vexp", 0, n*MATH_BATCH, t1 - t0);
+
+	for (int i = 0; i < MATH_BATCH; i++)
+		x[i] = fabs(x[i]);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		for (int j = 0; j < MATH_BATCH; j++)
+			y[j] = log(x[j]);
+	}
+	t1 = rdtsc();
+	report("math_log", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		vlog(y, x, MATH_BATCH);
+	t1 = rdtsc();
+	report("math_vlog", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+	{
+		for (int j = 0; j < MATH_BATCH; j++)
+			y[j] = sin(x[j]);
+	}
+	t1 = rdtsc();
+	report("math_sin", 0, n*MATH_BATCH, t1 - t0);
+
+	t0 = rdtsc();
+	for (unsigned i = 0; i < n; i++)
+		vsin(y, x, MATH_BATCH);
+	t1 = rdtsc();
+	report("math_vsin", 0, n*MATH_BATCH, t1 - t0);
+
+	((void) sink);
+}
+
+/*============================================================================*
+ *                                    main                                    *
+ *============================================================================*/
+
+/**
+ * @brief Benchmarks.
+ */
+static const struct
+{
+	const char *name;  /**< Benchmark name.     */
+	void (*fn)(void);  /**< Benchmark function. */
+} benchmarks[] = {
+	{ "null",     bench_null     },
+	{ "fork",     bench_fork     },
+	{ "exec",     bench_exec     },
+	{ "pingpong", bench_pingpong },
+	{ "bulk",     bench_bulk     },
+	{ "file",     bench_file     },
+	{ "fault",    bench_fault    },
+	{ "sem",      bench_sem      },
+	{ "ctxsw",    bench_ctxsw    },
+	{ "string",   bench_string   },
+	{ "printf",   bench_printf   },
+	{ "float",    bench_float    },
+	{ "math",     bench_math     },
+	{ NULL,       NULL           }
+};
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: bench [options] [benchmarks]\n\n");
+	printf("Brief: Runs microbenchmarks on Nanvix.\n\n");
+	printf("Options:\n");
+	printf("  --csv           Print results as CSV (default)\n");
+	printf("  --json          Print results as JSON\n");
+	printf("  --scale <n>     Multiply iteration counts by n\n");
+	printf("  --tag <label>   Label results of this run\n");
+	printf("\nBenchmarks:\n ");
+	for (int i = 0; benchmarks[i].name != NULL; i++)
+		printf(" %s", benchmarks[i].name);
+	printf("\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Asserts if a benchmark was selected.
+ */
+static int selected(const char *name)
+{
+	if (args.nonly == 0)
+		return (1);
+
+	for (int i = 0; i < args.nonly; i++)
+	{
+		if (!strcmp(args.only[i], name))
+			return (1);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Microbenchmark utility.
+ */
+int main(int argc, char **argv)
+{
+	char b[21];
+
+	/* Target of the fork_exec benchmark. */
+	if ((argc == 2) && (!strcmp(argv[1], "--exit")))
+		return (EXIT_SUCCESS);
+
+	args.only = &argv[argc];
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--csv"))
+			args.format = FORMAT_CSV;
+		else if (!strcmp(argv[i], "--json"))
+			args.format = FORMAT_JSON;
+		else if ((!strcmp(argv[i], "--scale")) && (i + 1 < argc))
+			args.scale = atoi(argv[++i]);
+		else if ((!strcmp(argv[i], "--tag")) && (i + 1 < argc))
+			args.tag = argv[++i];
+		else if (argv[i][0] == '-')
+			usage();
+		else
+		{
+			/* Benchmark names are the trailing arguments. */
+			args.only = &argv[i];
+			args.nonly = argc - i;
+			break;
+		}
+	}
+
+	if (args.scale < 1)
+		args.scale = 1;
+
+	calibrate();
+
+	if (args.format == FORMAT_JSON)
+		printf("{\"tag\": \"%s\", \"tsc_khz\": %s, \"results\": [",
+			args.tag, u64str(tsc_khz, b));
+	else
+		printf("tag,bench,size,iters,cycles,cycles_per_op,ns_per_op,kb_per_s\n");
+
+	fflush(stdout);
+
+	for (int i = 0; benchmarks[i].name != NULL; i++)
+	{
+		if (!selected(benchmarks[i].name))
+			continue;
+
+		benchmarks[i].fn();
+		fflush(stdout);
+	}
+
+	if (args.format == FORMAT_JSON)
+		printf("\n]}\n");
+
+	return (EXIT_SUCCESS);
+}
@@ -19,7 +19,11 @@
  */
 
 #include <assert.h>
+#include <dev/prof.h>
 #include <nanvix/config.h>
+#include <sys/futex.h>
+#include <sys/pstat.h>
+#include <sys/resource.h>
 #include <sys/times.h>
 #include <sys/wait.h>
 #include <sys/sem.h>
@@ -32,6 +36,13 @@
 #include <limits.h>
 #include <semaphore.h>
 #include <errno.h>
+#include <time.h>
+#include <stropts.h>
+#include <spawn.h>
+#include <dirent.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdint.h>
 
 /* Test flags. */
 #define VERBOSE	 (1 << 10)
@@ -43,6 +54,19 @@ static unsigned flags = VERBOSE;
  *							   Synthetic Works								  *
  *============================================================================*/
 
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static long long clock_monotonic(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+		return (-1);
+
+	return ((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
 /**
  * @brief Performs some dummy CPU-intensive computation.
  */
@@ -605,6 +629,129 @@ static int sem_test_open_close(void)
 	return (0); 
 } 
 
+/**
+ * @brief Gets the system call counter of a process.
+ *
+ * @param pid ID of the target process.
+ *
+ * @returns The number of system calls made so far, or zero on failure.
+ */
+static uint32_t sem_nsyscalls(pid_t pid)
+{
+	int n;
+	static struct pstat table[PROC_MAX];
+
+	if ((n = pstat(table, PROC_MAX)) <= 0)
+		return (0);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (table[i].pid == pid)
+			return (table[i].ru.nsyscalls);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Semaphore fast path test.
+ *
+ * @details Uncontended sem_wait() and sem_post() only touch the semaphore
+ *          counter, so they must not make any system call, and must leave
+ *          no waiter behind.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sem_fastpath_test(void)
+{
+	int ret;                 /* Return value.         */
+	pid_t pid;               /* Process ID.           */
+	sem_t *sem;              /* Semaphore.            */
+	uint32_t s0, s1, s2, s3; /* System call counters. */
+	const int n = 1000;      /* Number of rounds.     */
+
+	const char *name = "/home/mysem/fast";
+
+	if ((sem = sem_open(name, O_CREAT, 0644, 1)) == NULL)
+		return (-1);
+
+	ret = 0;
+	pid = getpid();
+
+	/* System calls taken by sampling the counter itself. */
+	s0 = sem_nsyscalls(pid);
+	s1 = sem_nsyscalls(pid);
+
+	/* Uncontended wait/post pairs. */
+	s2 = sem_nsyscalls(pid);
+	for (int i = 0; i < n; i++)
+	{
+		if ((sem_wait(sem) < 0) || (sem_post(sem) < 0))
+			ret = -1;
+	}
+	s3 = sem_nsyscalls(pid);
+
+	if ((s0 == 0) || ((s3 - s2) != (s1 - s0)))
+		ret = -1;
+
+	if ((sem->count->value != 1) || (sem->count->waiters != 0))
+		ret = -1;
+
+	sem_close(sem);
+	sem_unlink(name);
+
+	return (ret);
+}
+
+/**
+ * @brief Semaphore isolation test.
+ *
+ * @details Counters of semaphores that the process did not open are not
+ *          mapped, so system calls that touch them must fail with EFAULT.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sem_fault_test(void)
+{
+	int ret;            /* Return value.       */
+	int fd[2];          /* Pipe.               */
+	sem_t *sem;         /* Semaphore.          */
+	volatile int *hole; /* Unopened counter.   */
+
+	const char *name = "/home/mysem/fault";
+
+	if ((sem = sem_open(name, O_CREAT, 0644, 1)) == NULL)
+		return (-1);
+
+	ret = 0;
+	hole = &SEMCOUNT((sem->semid + 1)%SEM_OPEN_MAX)->value;
+
+	if ((futex(hole, FUTEX_WAIT, 0) != -1) || (errno != EFAULT))
+		ret = -1;
+
+	if ((futex(hole, FUTEX_WAKE, 1) != -1) || (errno != EFAULT))
+		ret = -1;
+
+	if (pipe(fd) == 0)
+	{
+		if (write(fd[1], "x", 1) != 1)
+			ret = -1;
+
+		if ((read(fd[0], (void *)hole, 1) != -1) || (errno != EFAULT))
+			ret = -1;
+
+		close(fd[0]);
+		close(fd[1]);
+	}
+	else
+		ret = -1;
+
+	sem_close(sem);
+	sem_unlink(name);
+
+	return (ret);
+}
+
 /*============================================================================*
  *								  FPU test									  *
  *============================================================================*/
@@ -794,6 +941,125 @@ int simd_test(void)
 #endif
 }
 
+/*============================================================================*
+ *								  Clock Tests								  *
+ *============================================================================*/
+
+/**
+ * @brief Clock test 0.
+ *
+ * @details Checks that the monotonic clock never goes backwards.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int clock_test0(void)
+{
+	long long t0, t1;
+
+	t0 = clock_monotonic();
+	for (int i = 0; i < 1000; i++)
+	{
+		t1 = clock_monotonic();
+
+		if ((t1 < 0) || (t1 < t0))
+			return (-1);
+
+		t0 = t1;
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Clock test 1.
+ *
+ * @details Sleeps for short amounts of time and checks that the actual sleep
+ *			time is not shorter than requested.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int clock_test1(void)
+{
+	long long t0, t1;
+	struct timespec req;
+	static const long naps[] = { 50000, 200000, 1000000, 2500000 };
+
+	for (unsigned i = 0; i < sizeof(naps)/sizeof(naps[0]); i++)
+	{
+		req.tv_sec = 0;
+		req.tv_nsec = naps[i];
+
+		t0 = clock_monotonic();
+		if (nanosleep(&req, NULL) < 0)
+			return (-1);
+		t1 = clock_monotonic();
+
+		if (t1 - t0 < naps[i])
+			return (-1);
+
+		if (flags & VERBOSE)
+			printf("  nanosleep(%ld ns): %d us\n", naps[i], (int)((t1 - t0)/1000));
+	}
+
+	return (0);
+}
+
+/*============================================================================*
+ *                                Profiler                                    *
+ *============================================================================*/
+
+/**
+ * @brief Profiler test 0.
+ *
+ * @details Samples a busy loop and checks that the profiler attributes
+ *          user mode samples to the running process.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int prof_test0(void)
+{
+	int fd;
+	ssize_t n;
+	int found;
+	long long t0;
+	struct prof_sample samples[8];
+
+	if ((fd = open("/dev/prof", O_RDONLY)) < 0)
+		return (-1);
+
+	ioctl(fd, PROF_RESET);
+	if (ioctl(fd, PROF_START) < 0)
+	{
+		close(fd);
+		return (-1);
+	}
+
+	/* Spin for a while. */
+	t0 = clock_monotonic();
+	while (clock_monotonic() - t0 < 50000000LL)
+		work_cpu();
+
+	ioctl(fd, PROF_STOP);
+
+	found = 0;
+	while ((n = read(fd, samples, sizeof(samples))) > 0)
+	{
+		for (int i = 0; i < n/(ssize_t)sizeof(struct prof_sample); i++)
+		{
+			if (samples[i].depth < 1)
+				found = -1;
+
+			else if ((found == 0) && (samples[i].pid == getpid()) &&
+				!(samples[i].flags & PROF_KERNEL))
+				found = 1;
+		}
+	}
+
+	close(fd);
+
+	return ((found == 1) ? 0 : -1);
+}
+
 /*============================================================================*
  *							 Memory Violation								  *
  *============================================================================*/
@@ -821,82 +1087,1757 @@ static int test_mem0(void)
 }
 
 /*============================================================================*
- *									 main									  *
+ *								  spawn_test								  *
  *============================================================================*/
 
 /**
- * @brief Prints program usage and exits.
- * 
- * @details Prints the program usage and exists gracefully.
+ * @brief Spawn test 0.
+ *
+ * @details Spawns echo with its standard output redirected to a pipe and
+ *          checks what comes out of it.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
  */
-static void usage(void)
+static int spawn_test0(void)
 {
-	printf("Usage: test [options]\n\n");
-	printf("Brief: Performs regression tests on Nanvix.\n\n");
-	printf("Options:\n");
-	printf("  fpu	  Floating Point Unit Test\n");
-	printf("  simd    Streaming SIMD Extensions Test\n");
-	printf("  io	  I/O Test\n");
-	printf("  ipc	  Interprocess Communication Test\n");
-	printf("  paging  Paging System Test\n");
-	printf("  stack	  Stack growth Test\n");
-	printf("  sched	  Scheduling Test\n");
-	printf("  sem	  Semaphore Tests\n");
-	printf("  mem	  Memory Violation Tests\n");
+	int ret;
+	pid_t pid;
+	int status;
+	int pipefd[2];
+	char buf[16];
+	ssize_t n, nread;
+	posix_spawn_file_actions_t actions;
+	char *args[] = { "echo", "spawned", NULL };
+
+	if (pipe(pipefd) < 0)
+		return (-1);
 
-	exit(EXIT_SUCCESS);
+	ret = -1;
+
+	if (posix_spawn_file_actions_init(&actions))
+		goto out0;
+	if (posix_spawn_file_actions_adddup2(&actions, pipefd[1], 1))
+		goto out1;
+	if (posix_spawn_file_actions_addclose(&actions, pipefd[0]))
+		goto out1;
+	if (posix_spawn_file_actions_addclose(&actions, pipefd[1]))
+		goto out1;
+
+	if (posix_spawn(&pid, "/bin/echo", &actions, NULL, args, environ))
+		goto out1;
+
+	close(pipefd[1]);
+	pipefd[1] = -1;
+
+	/* Read output. */
+	nread = 0;
+	while ((n = read(pipefd[0], &buf[nread], sizeof(buf) - 1 - nread)) > 0)
+		nread += n;
+	buf[nread] = '\0';
+
+	while (wait(&status) != pid)
+		/* noop */;
+
+	if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		goto out1;
+
+	ret = (strcmp(buf, "spawned\n")) ? -1 : 0;
+
+out1:
+	posix_spawn_file_actions_destroy(&actions);
+out0:
+	close(pipefd[0]);
+	if (pipefd[1] >= 0)
+		close(pipefd[1]);
+	return (ret);
 }
 
 /**
- * @brief System testing utility.
+ * @brief Spawn test 1.
+ *
+ * @details Checks that spawning a missing program fails in the parent.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
  */
-int main(int argc, char **argv)
+static int spawn_test1(void)
 {
-	/* Missing arguments? */
-	if (argc <= 1)
-		usage();
+	pid_t pid;
+	char *args[] = { "missing", NULL };
 
-	for (int i = 1; i < argc; i++)
+	if (posix_spawn(&pid, "/bin/missing", NULL, NULL, args, environ) != ENOENT)
+		return (-1);
+
+	if (posix_spawnp(&pid, "missing", NULL, NULL, args, environ) != ENOENT)
+		return (-1);
+
+	return (0);
+}
+
+/*============================================================================*
+ *								  rusage_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Resource usage test 0.
+ *
+ * @details Reaps a child that touches its memory and checks that its page
+ *          faults are accounted to the parent.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int rusage_test0(void)
+{
+	pid_t pid;
+	int status;
+	struct rusage before, after;
+
+	if (getrusage(RUSAGE_CHILDREN, &before) < 0)
+		return (-1);
+
+	if ((pid = fork()) < 0)
+		return (-1);
+
+	/* Child process. */
+	if (pid == 0)
 	{
-		/* I/O test. */
-		if (!strcmp(argv[i], "io"))
-		{
-			printf("I/O Test\n");
-			printf("  Result:			  [%s]\n", 
-				   (!io_test()) ? "PASSED" : "FAILED");
-		}
-		
-		/* Paging system test. */
-		else if (!strcmp(argv[i], "paging"))
-		{
-			printf("Demand Zero Test\n");
-			printf("  Result:			  [%s]\n",
-				   (!demand_zero_test()) ? "PASSED" : "FAILED");
-		}
+		work_cpu();
+		_exit(EXIT_SUCCESS);
+	}
 
-		/* Stack growth test. */
-		else if (!strcmp(argv[i], "stack"))
-		{
-			printf("Stack Grow Test\n");
-			printf("  Result:			  [%s]\n",
-				   (!stack_grow_test()) ? "PASSED" : "FAILED");
-		}
-		
-		/* Scheduling test. */
-		else if (!strcmp(argv[i], "sched"))
+	if (waitpid(pid, &status, 0) != pid)
+		return (-1);
+
+	if (getrusage(RUSAGE_CHILDREN, &after) < 0)
+		return (-1);
+
+	/* Child broke copy-on-write pages. */
+	if (after.ru_minflt <= before.ru_minflt)
+		return (-1);
+
+	/* Invalid request. */
+	if ((getrusage(-42, &after) != -1) || (errno != EINVAL))
+		return (-1);
+
+	return (0);
+}
+
+/**
+ * @brief Resource usage test 1.
+ *
+ * @details Checks that the calling process shows up in the process table
+ *          snapshot and that its system call counter moves.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int rusage_test1(void)
+{
+	int i, n;
+	uint32_t nsyscalls;
+	static struct pstat table[PROC_MAX];
+
+	nsyscalls = 0;
+	for (int k = 0; k < 2; k++)
+	{
+		if ((n = pstat(table, PROC_MAX)) <= 0)
+			return (-1);
+
+		for (i = 0; i < n; i++)
 		{
-			printf("Scheduling Tests\n");
-			printf("  waiting for child	 [%s]\n",
-				   (!sched_test0()) ? "PASSED" : "FAILED");
-			printf("  dynamic priorities [%s]\n",
-				   (!sched_test1()) ? "PASSED" : "FAILED");
-			printf("  scheduler stress	 [%s]\n",
-				   (!sched_test2() &&
-					!sched_test3() &&
-					!sched_test4()) ? "PASSED" : "FAILED");
+			if (table[i].pid == getpid())
+				break;
 		}
 
-		/* FPU test. */
+		/* Not found. */
+		if (i == n)
+			return (-1);
+
+		if ((table[i].state != PSTAT_RUNNING) || (table[i].ppid != getppid()))
+			return (-1);
+
+		/* Counter must grow between snapshots. */
+		if ((k == 1) && (table[i].ru.nsyscalls <= nsyscalls))
+			return (-1);
+		nsyscalls = table[i].ru.nsyscalls;
+	}
+
+	return (0);
+}
+
+/*============================================================================*
+ *								  procfs_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Reads a whole file into a buffer.
+ *
+ * @returns The number of bytes read, or -1 on failure.
+ */
+static ssize_t read_file(const char *path, char *buf, size_t size)
+{
+	int fd;
+	ssize_t n, total;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return (-1);
+
+	total = 0;
+	while ((n = read(fd, &buf[total], size - total - 1)) > 0)
+		total += n;
+
+	close(fd);
+
+	if (n < 0)
+		return (-1);
+
+	buf[total] = '\0';
+	return (total);
+}
+
+/**
+ * @brief Process file system test 0.
+ *
+ * @details Reads the status of the calling process and checks that it
+ *          reports the right process ID.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int procfs_test0(void)
+{
+	char path[32];
+	char expected[32];
+	static char buf[1024];
+
+	sprintf(path, "/proc/%d/status", getpid());
+	sprintf(expected, "\npid:\t%d\n", getpid());
+
+	if (read_file(path, buf, sizeof(buf)) <= 0)
+		return (-1);
+
+	if (strstr(buf, expected) == NULL)
+		return (-1);
+
+	/* Files are read-only. */
+	if (open(path, O_WRONLY) >= 0)
+		return (-1);
+
+	return (0);
+}
+
+/**
+ * @brief Process file system test 1.
+ *
+ * @details Lists the root directory and checks that it holds system-wide
+ *          files and the directory of the calling process.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int procfs_test1(void)
+{
+	DIR *dir;
+	struct dirent *d;
+	int found_self, found_sched;
+	static char buf[1024];
+
+	found_self = found_sched = 0;
+
+	if ((dir = opendir("/proc")) == NULL)
+		return (-1);
+
+	while ((d = readdir(dir)) != NULL)
+	{
+		if (!strcmp(d->d_name, "sched"))
+			found_sched = 1;
+		else if (atoi(d->d_name) == getpid())
+			found_self = 1;
+	}
+
+	closedir(dir);
+
+	if (!found_self || !found_sched)
+		return (-1);
+
+	if (read_file("/proc/sched", buf, sizeof(buf)) <= 0)
+		return (-1);
+
+	return ((strstr(buf, "switches:") != NULL) ? 0 : -1);
+}
+
+/*============================================================================*
+ *								  tmpfs_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Size of the file written by tmpfs_test0() (in bytes).
+ */
+#define TMPFS_TEST_SIZE (3*PAGE_SIZE + 123)
+
+/**
+ * @brief Temporary file system test 0.
+ *
+ * @details Writes a file that spans several pages, reads it back through
+ *          a hole and removes it.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int tmpfs_test0(void)
+{
+	int fd;
+	static char buf[TMPFS_TEST_SIZE];
+
+	for (int i = 0; i < TMPFS_TEST_SIZE; i++)
+		buf[i] = (char)i;
+
+	if ((fd = open("/tmp/test0", O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+
+	if (write(fd, buf, TMPFS_TEST_SIZE) != TMPFS_TEST_SIZE)
+		goto error;
+
+	/* Leave a hole. */
+	if (lseek(fd, 2*TMPFS_TEST_SIZE, SEEK_SET) < 0)
+		goto error;
+	if (write(fd, buf, 1) != 1)
+		goto error;
+
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		goto error;
+	memset(buf, 0xff, TMPFS_TEST_SIZE);
+	if (read(fd, buf, TMPFS_TEST_SIZE) != TMPFS_TEST_SIZE)
+		goto error;
+	for (int i = 0; i < TMPFS_TEST_SIZE; i++)
+	{
+		if (buf[i] != (char)i)
+			goto error;
+	}
+
+	if (read(fd, buf, TMPFS_TEST_SIZE) != TMPFS_TEST_SIZE)
+		goto error;
+	for (int i = 0; i < TMPFS_TEST_SIZE; i++)
+	{
+		if (buf[i] != 0)
+			goto error;
+	}
+
+	close(fd);
+
+	if (unlink("/tmp/test0") < 0)
+		return (-1);
+
+	return ((open("/tmp/test0", O_RDONLY) < 0) ? 0 : -1);
+
+error:
+	close(fd);
+	unlink("/tmp/test0");
+	return (-1);
+}
+
+/**
+ * @brief Temporary file system test 1.
+ *
+ * @details Creates a couple of files and checks that they are listed and
+ *          looked up by name.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int tmpfs_test1(void)
+{
+	int fd;
+	DIR *dir;
+	struct dirent *d;
+	int found_a, found_b;
+	static char buf[16];
+
+	if ((fd = open("/tmp/a", O_WRONLY | O_CREAT | O_EXCL, 0666)) < 0)
+		return (-1);
+	write(fd, "a", 1);
+	close(fd);
+
+	if ((fd = open("/tmp/b", O_WRONLY | O_CREAT | O_EXCL, 0666)) < 0)
+		goto error;
+	write(fd, "bb", 2);
+	close(fd);
+
+	/* Name already taken. */
+	if (open("/tmp/a", O_WRONLY | O_CREAT | O_EXCL, 0666) >= 0)
+		goto error;
+
+	found_a = found_b = 0;
+	if ((dir = opendir("/tmp")) == NULL)
+		goto error;
+	while ((d = readdir(dir)) != NULL)
+	{
+		if (!strcmp(d->d_name, "a"))
+			found_a = 1;
+		else if (!strcmp(d->d_name, "b"))
+			found_b = 1;
+	}
+	closedir(dir);
+
+	if (!found_a || !found_b)
+		goto error;
+
+	if ((read_file("/tmp/b", buf, sizeof(buf)) != 2) || (strcmp(buf, "bb")))
+		goto error;
+
+	unlink("/tmp/a");
+	unlink("/tmp/b");
+
+	return (0);
+
+error:
+	unlink("/tmp/a");
+	unlink("/tmp/b");
+	return (-1);
+}
+
+/*============================================================================*
+ *									 main									  *
+ *============================================================================*/
+
+/*============================================================================*
+ *								  bmap_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Number of 1 KB blocks written by bmap_test0().
+ *
+ * @details Enough to reach the double indirect zone of a Minix inode.
+ */
+#define BMAP_TEST_BLOCKS (7 + 512 + 8)
+
+/**
+ * @brief Writes and checks a file, block by block.
+ *
+ * @param fd   Target file.
+ * @param seed Pattern seed.
+ *
+ * @returns Zero if the file reads back as written, and non-zero otherwise.
+ */
+static int bmap_fill(int fd, int seed)
+{
+	static char buf[1024];
+
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		return (-1);
+	for (int i = 0; i < BMAP_TEST_BLOCKS; i++)
+	{
+		memset(buf, (char)(i + seed), sizeof(buf));
+		if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+			return (-1);
+	}
+
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		return (-1);
+	for (int i = 0; i < BMAP_TEST_BLOCKS; i++)
+	{
+		if (read(fd, buf, sizeof(buf)) != sizeof(buf))
+			return (-1);
+		for (unsigned j = 0; j < sizeof(buf); j++)
+		{
+			if (buf[j] != (char)(i + seed))
+				return (-1);
+		}
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Block map test 0.
+ *
+ * @details Writes a file that spans indirect zones, truncates it while
+ *          another file grabs the freed blocks, and writes it again, so
+ *          that stale cached block mappings would show up as corrupted
+ *          data.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int bmap_test0(void)
+{
+	int fd, fd2;
+	int ret;
+
+	ret = -1;
+
+	if ((fd = open("/home/bmap0", O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+	if ((fd2 = open("/home/bmap1", O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		goto out1;
+
+	if (bmap_fill(fd, 0))
+		goto out0;
+
+	/* Free the blocks and have them reused by another file. */
+	close(fd);
+	if ((fd = open("/home/bmap0", O_RDWR | O_TRUNC)) < 0)
+		goto out0;
+	if (bmap_fill(fd2, 1))
+		goto out0;
+
+	if (bmap_fill(fd, 2))
+		goto out0;
+	ret = 0;
+
+out0:
+	close(fd2);
+	unlink("/home/bmap1");
+out1:
+	close(fd);
+	unlink("/home/bmap0");
+	return (ret);
+}
+
+/*============================================================================*
+ *								 dirplus_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Number of files created by dirplus_test0().
+ */
+#define DIRPLUS_TEST_FILES 40
+
+/**
+ * @brief Directory read with attributes test 0.
+ *
+ * @details Creates files of distinct sizes, lists their directory with
+ *          readdirplus() and checks that the status of each entry matches
+ *          what stat() reports.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int dirplus_test0(void)
+{
+	int fd;
+	int ret;
+	int nfound;
+	DIR *dir;
+	struct stat st;
+	struct dirplus *d;
+	char path[PATH_MAX];
+	char name[NAME_MAX + 1];
+
+	ret = -1;
+	nfound = 0;
+
+	for (int i = 0; i < DIRPLUS_TEST_FILES; i++)
+	{
+		sprintf(path, "/home/dirplus%d", i);
+		if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0640)) < 0)
+			goto out;
+		if (write(fd, path, i) != i)
+		{
+			close(fd);
+			goto out;
+		}
+		close(fd);
+	}
+
+	if ((dir = opendir("/home")) == NULL)
+		goto out;
+
+	name[NAME_MAX] = '\0';
+	while ((d = readdirplus(dir)) != NULL)
+	{
+		strncpy(name, d->d_name, NAME_MAX);
+		sprintf(path, "/home/%s", name);
+
+		if (stat(path, &st) < 0)
+			break;
+
+		/* Status mismatch. */
+		if ((st.st_ino != d->d_stat.st_ino) ||
+			(st.st_mode != d->d_stat.st_mode) ||
+			(st.st_nlink != d->d_stat.st_nlink) ||
+			(st.st_uid != d->d_stat.st_uid) ||
+			(st.st_size != d->d_stat.st_size))
+			break;
+
+		if (!strncmp(name, "dirplus", 7))
+		{
+			if (d->d_stat.st_size != atoi(&name[7]))
+				break;
+			nfound++;
+		}
+	}
+
+	if ((d == NULL) && (nfound == DIRPLUS_TEST_FILES))
+		ret = 0;
+
+	closedir(dir);
+
+out:
+	for (int i = 0; i < DIRPLUS_TEST_FILES; i++)
+	{
+		sprintf(path, "/home/dirplus%d", i);
+		unlink(path);
+	}
+
+	return (ret);
+}
+
+/**
+ * @brief Directory read with attributes test 1.
+ *
+ * @details Lists a directory alternating readdir() and readdirplus() on
+ *          the same stream, and checks that no entry is lost or repeated.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int dirplus_test1(void)
+{
+	DIR *dir;
+	int n0, n1;
+	ino_t sum0, sum1;
+	struct dirent *d;
+
+	n0 = n1 = 0;
+	sum0 = sum1 = 0;
+
+	if ((dir = opendir("/")) == NULL)
+		return (-1);
+
+	while ((d = readdir(dir)) != NULL)
+		n0++, sum0 += d->d_ino;
+
+	rewinddir(dir);
+
+	for (int i = 0; /* noop */; i++)
+	{
+		d = (i & 1) ? (struct dirent *)readdirplus(dir) : readdir(dir);
+		if (d == NULL)
+			break;
+		n1++, sum1 += d->d_ino;
+	}
+
+	closedir(dir);
+
+	return (((n0 > 2) && (n0 == n1) && (sum0 == sum1)) ? 0 : -1);
+}
+
+/*============================================================================*
+ *								 string_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Largest length tried by the string tests.
+ */
+#define STRING_TEST_MAX 300
+
+/**
+ * @brief Buffers for the string tests.
+ */
+static unsigned char string_a[STRING_TEST_MAX + 64];
+static unsigned char string_b[STRING_TEST_MAX + 64];
+static unsigned char string_r[STRING_TEST_MAX + 64];
+
+/**
+ * @brief Fills the string test buffers with a pattern.
+ *
+ * @param seed Pattern seed.
+ */
+static void string_fill(unsigned seed)
+{
+	for (unsigned i = 0; i < sizeof(string_a); i++)
+	{
+		string_a[i] = 1 + (i*7 + seed)%251;
+		string_b[i] = string_r[i] = 1 + (i*13 + seed)%241;
+	}
+}
+
+/**
+ * @brief String test 0.
+ *
+ * @details Checks memcpy(), memset(), memcmp() and memchr() against byte
+ *          loops for every alignment of source and destination within 16
+ *          bytes, and for lengths that exercise both the short and the
+ *          long paths, including the bytes right past each end.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int string_test0(void)
+{
+	const unsigned char *e;
+
+	for (unsigned s = 0; s < 16; s++)
+	{
+		for (unsigned d = 0; d < 16; d++)
+		{
+			for (unsigned n = 0; n <= STRING_TEST_MAX; n += (n < 80) ? 1 : 37)
+			{
+				string_fill(s + d + n);
+
+				/* memcpy() */
+				if (memcpy(string_b + d, string_a + s, n) != string_b + d)
+					return (-1);
+				for (unsigned i = 0; i < n; i++)
+					string_r[d + i] = string_a[s + i];
+				for (unsigned i = 0; i < sizeof(string_b); i++)
+				{
+					if (string_b[i] != string_r[i])
+						return (-1);
+				}
+
+				/* memcmp() */
+				if (memcmp(string_b + d, string_a + s, n) != 0)
+					return (-1);
+				if (n > 0)
+				{
+					string_b[d + n - 1]++;
+					if (memcmp(string_b + d, string_a + s, n) <= 0)
+						return (-1);
+					string_b[d + n/2] = 0;
+					if (memcmp(string_b + d, string_a + s, n) >= 0)
+						return (-1);
+				}
+
+				/* memchr() */
+				string_a[s + n] = 0xff;
+				string_a[s + n/3] = 0xff;
+				e = (n > 0) ? &string_a[s + n/3] : NULL;
+				if (memchr(string_a + s, 0xff, n) != e)
+					return (-1);
+				if (memchr(string_a + s, 0xff, n/3) != NULL)
+					return (-1);
+
+				/* memset() */
+				if (memset(string_b + d, s*17, n) != string_b + d)
+					return (-1);
+				for (unsigned i = 0; i < n; i++)
+					string_r[d + i] = s*17;
+				for (unsigned i = 0; i < sizeof(string_b); i++)
+				{
+					if (string_b[i] != string_r[i])
+						return (-1);
+				}
+			}
+		}
+	}
+
+	return (0);
+}
+
+/**
+ * @brief String test 1.
+ *
+ * @details Checks strlen(), strchr() and strcmp() against byte loops for
+ *          every alignment of the strings within 16 bytes.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int string_test1(void)
+{
+	char *a, *b;
+
+	for (unsigned s = 0; s < 16; s++)
+	{
+		for (unsigned d = 0; d < 16; d++)
+		{
+			for (unsigned n = 0; n <= STRING_TEST_MAX; n += (n < 80) ? 1 : 37)
+			{
+				string_fill(s + d + n);
+				a = (char *)&string_a[s];
+				b = (char *)&string_b[d];
+				a[n] = 0;
+
+				/* strlen() */
+				if (strlen(a) != n)
+					return (-1);
+
+				/* strchr() */
+				if (strchr(a, 0) != &a[n])
+					return (-1);
+				if ((n > 0) && (strchr(a, a[n - 1]) != memchr(a, a[n - 1], n)))
+					return (-1);
+				a[n + 1] = (char)0xff;
+				if (strchr(a, 0xff) != NULL)
+					return (-1);
+
+				/* strcmp() */
+				memcpy(b, a, n + 1);
+				if (strcmp(a, b) != 0)
+					return (-1);
+				if (n > 0)
+				{
+					b[n - 1] = (char)0xff;
+					if (strcmp(a, b) >= 0)
+						return (-1);
+					if (strcmp(b, a) <= 0)
+						return (-1);
+					b[n - 1] = 0;
+					if (strcmp(a, b) <= 0)
+						return (-1);
+				}
+			}
+		}
+	}
+
+	return (0);
+}
+
+/*============================================================================*
+ *								 malloc_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Number of objects live at once in malloc_test0().
+ */
+#define MALLOC_TEST_OBJECTS 512
+
+/**
+ * @brief Objects of malloc_test0().
+ */
+static struct
+{
+	unsigned char *p; /**< Object.   */
+	size_t size;      /**< Size.     */
+} malloc_objs[MALLOC_TEST_OBJECTS];
+
+/**
+ * @brief Checks the contents of an object of malloc_test0().
+ *
+ * @param i    Object index.
+ * @param size Number of bytes to check.
+ *
+ * @returns Zero if the object holds its pattern, and non-zero otherwise.
+ */
+static int malloc_check(int i, size_t size)
+{
+	for (size_t j = 0; j < size; j++)
+	{
+		if (malloc_objs[i].p[j] != (unsigned char)(i + j))
+			return (-1);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Fills an object of malloc_test0() with its pattern.
+ *
+ * @param i Object index.
+ */
+static void malloc_pattern(int i)
+{
+	for (size_t j = 0; j < malloc_objs[i].size; j++)
+		malloc_objs[i].p[j] = (unsigned char)(i + j);
+}
+
+/**
+ * @brief Memory allocator test 0.
+ *
+ * @details Randomly allocates, reallocates and frees objects of small and
+ *          large sizes, and checks that no object is corrupted, that every
+ *          object is aligned and large enough, and that the allocation
+ *          statistics balance out at the end.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int malloc_test0(void)
+{
+	int ret;
+	unsigned seed;
+	unsigned char *p;
+	struct mallstat st0, st1;
+
+	ret = 0;
+	seed = 1;
+
+	mallstat(&st0);
+
+	for (int k = 0; k < 20000; k++)
+	{
+		int i;
+		size_t size;
+
+		seed = seed*1103515245 + 12345;
+		i = (seed >> 16) % MALLOC_TEST_OBJECTS;
+		seed = seed*1103515245 + 12345;
+		size = (seed & 7) ? (seed >> 16) % 300 : (seed >> 16) % 8192;
+
+		/* Allocate. */
+		if (malloc_objs[i].p == NULL)
+		{
+			if (k & 1)
+				p = calloc(1, size);
+			else
+				p = malloc(size);
+			if ((p == NULL) || ((uintptr_t)p & 7))
+				return (-1);
+			if ((k & 1))
+			{
+				for (size_t j = 0; j < size; j++)
+				{
+					if (p[j] != 0)
+						ret = -1;
+				}
+			}
+			if (malloc_usable_size(p) < size)
+				ret = -1;
+			malloc_objs[i].p = p;
+			malloc_objs[i].size = size;
+			malloc_pattern(i);
+		}
+
+		/* Reallocate. */
+		else if (k & 2)
+		{
+			if (malloc_check(i, malloc_objs[i].size))
+				ret = -1;
+			if ((p = realloc(malloc_objs[i].p, size)) == NULL)
+				return (-1);
+			malloc_objs[i].p = p;
+			if (malloc_check(i, (size < malloc_objs[i].size) ?
+				size : malloc_objs[i].size))
+			{
+				ret = -1;
+			}
+			malloc_objs[i].size = size;
+			malloc_pattern(i);
+		}
+
+		/* Free. */
+		else
+		{
+			if (malloc_check(i, malloc_objs[i].size))
+				ret = -1;
+			free(malloc_objs[i].p);
+			malloc_objs[i].p = NULL;
+		}
+	}
+
+	for (int i = 0; i < MALLOC_TEST_OBJECTS; i++)
+	{
+		if (malloc_objs[i].p == NULL)
+			continue;
+		if (malloc_check(i, malloc_objs[i].size))
+			ret = -1;
+		free(malloc_objs[i].p);
+		malloc_objs[i].p = NULL;
+	}
+
+	mallstat(&st1);
+
+	/* Every object was given back. */
+	if (st1.small_bytes != st0.small_bytes)
+		ret = -1;
+	if (st1.nmalloc - st0.nmalloc != st1.nfree - st0.nfree)
+		ret = -1;
+
+	return (ret);
+}
+
+/**
+ * @brief Memory allocator test 1.
+ *
+ * @details Measures churn of small objects, then allocates and frees a
+ *          large working set several times over, which must not move the
+ *          break down and up every time.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int malloc_test1(void)
+{
+	unsigned seed;
+	long long t0, t1;
+	struct mallstat st0, st1;
+	static void *objs[256];
+	const int n = 200;
+
+	seed = 1;
+
+	/* Small object churn. */
+	t0 = clock_monotonic();
+	for (int k = 0; k < n; k++)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			seed = seed*1103515245 + 12345;
+			if ((objs[i] = malloc(8 + (seed >> 16)%120)) == NULL)
+				return (-1);
+		}
+		for (int i = 0; i < 256; i++)
+			free(objs[i]);
+	}
+	t1 = clock_monotonic();
+
+	if (flags & VERBOSE)
+		printf("  malloc/free: %d ns\n", (int)((t1 - t0)/(n*256)));
+
+	mallstat(&st0);
+
+	/* Large working set. */
+	for (int k = 0; k < 16; k++)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			if ((objs[i] = malloc(4000)) == NULL)
+				return (-1);
+		}
+		for (int i = 255; i >= 0; i--)
+			free(objs[i]);
+	}
+
+	mallstat(&st1);
+
+	if (flags & VERBOSE)
+	{
+		printf("  brk grows: %lu trims: %lu\n",
+			st1.brk_grows - st0.brk_grows, st1.brk_trims - st0.brk_trims);
+	}
+
+	return ((st1.brk_trims - st0.brk_trims < 4) ? 0 : -1);
+}
+
+/*============================================================================*
+ *								 printf_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Formats of integers that take the printf() fast path.
+ */
+static const char *printf_ifmts[] = {
+	"%d", "%i", "%u", "%x", "%X", "%ld", "%lu", "%lx", "%7d", "%-7d|",
+	"%07d", "%+d", "% d", "%+05d", "%-+8d|", "%012X", "%0-9u|", "%c",
+	"%5c", "%%", "%5%", "x=%d y=%x z=%u\n", "%30d", NULL
+};
+
+/**
+ * @brief Formats of strings that take the printf() fast path.
+ */
+static const char *printf_sfmts[] = {
+	"%s", "%8s", "%-8s|", "%08s", "<%s> %s\n", NULL
+};
+
+/**
+ * @brief Integers for the printf() tests.
+ */
+static const int printf_ivals[] = {
+	0, 1, -1, 9, 10, 99, 100, 12345, -12345, 99999, 100000,
+	INT_MAX, INT_MIN, 0x7fffabcd, -1000000000
+};
+
+/**
+ * @brief Strings for the printf() tests.
+ */
+static const char *printf_svals[] = {
+	"", "a", "hello, world", "line\nbreak", NULL
+};
+
+/**
+ * @brief Builds a format that takes the generic printf() path.
+ *
+ * @details A leading "%.0s" prints nothing for an extra "" argument, but
+ *          it is not a conversion that the fast path takes.
+ *
+ * @param buf Store location for the format.
+ * @param fmt Format to extend.
+ *
+ * @returns buf.
+ */
+static char *printf_generic(char *buf, const char *fmt)
+{
+	strcpy(buf, "%.0s");
+	return (strcat(buf, fmt));
+}
+
+/**
+ * @brief printf test 0.
+ *
+ * @details Checks snprintf() on the fast path against the generic path,
+ *          for every buffer size up to the full output.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int printf_test0(void)
+{
+	int ra, rb;
+	char gfmt[32];
+	char a[64], b[64];
+
+	for (int i = 0; printf_ifmts[i] != NULL; i++)
+	{
+		printf_generic(gfmt, printf_ifmts[i]);
+
+		for (unsigned j = 0; j < sizeof(printf_ivals)/sizeof(int); j++)
+		{
+			int v = printf_ivals[j];
+
+			for (int n = sizeof(a); n >= 0; n = (n > 40) ? 40 : n - 1)
+			{
+				memset(a, '#', sizeof(a));
+				memset(b, '#', sizeof(b));
+				ra = snprintf(a, n, printf_ifmts[i], v, v, v);
+				rb = snprintf(b, n, gfmt, "", v, v, v);
+				if ((ra != rb) || (memcmp(a, b, sizeof(a))))
+					return (-1);
+			}
+		}
+	}
+
+	for (int i = 0; printf_sfmts[i] != NULL; i++)
+	{
+		printf_generic(gfmt, printf_sfmts[i]);
+
+		for (unsigned j = 0; j < sizeof(printf_svals)/sizeof(char *); j++)
+		{
+			const char *s = printf_svals[j];
+
+			for (int n = sizeof(a); n >= 0; n = (n > 40) ? 40 : n - 1)
+			{
+				memset(a, '#', sizeof(a));
+				memset(b, '#', sizeof(b));
+				ra = snprintf(a, n, printf_sfmts[i], s, s);
+				rb = snprintf(b, n, gfmt, "", s, s);
+				if ((ra != rb) || (memcmp(a, b, sizeof(a))))
+					return (-1);
+			}
+		}
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Writes the printf test 1 output to a stream.
+ *
+ * @param fp      Target stream.
+ * @param mode    Buffering mode.
+ * @param generic Take the generic path?
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+static int printf_stream(FILE *fp, int mode, int generic)
+{
+	char ifmt[32], sfmt[32];
+
+	/* Small buffer, so that fields straddle flushes. */
+	if (setvbuf(fp, NULL, mode, 64) != 0)
+		return (-1);
+
+	for (unsigned j = 0; j < sizeof(printf_ivals)/sizeof(int); j++)
+	{
+		int v = printf_ivals[j];
+		const char *s = printf_svals[j%(sizeof(printf_svals)/sizeof(char *))];
+
+		for (int i = 0; printf_ifmts[i] != NULL; i++)
+		{
+			if (!generic)
+				fprintf(fp, printf_ifmts[i], v, v, v);
+			else
+				fprintf(fp, printf_generic(ifmt, printf_ifmts[i]), "", v, v, v);
+		}
+		for (int i = 0; printf_sfmts[i] != NULL; i++)
+		{
+			if (!generic)
+				fprintf(fp, printf_sfmts[i], s, s);
+			else
+				fprintf(fp, printf_generic(sfmt, printf_sfmts[i]), "", s, s);
+		}
+	}
+
+	return (ferror(fp) || fflush(fp));
+}
+
+/**
+ * @brief printf test 1.
+ *
+ * @details Checks fprintf() on the fast path against the generic path on
+ *          fully and line buffered files, then measures snprintf().
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int printf_test1(void)
+{
+	FILE *fa, *fb;
+	long long t0, t1, t2;
+	char a[64], b[64];
+	const int n = 20000;
+	static const int modes[] = { _IOFBF, _IOLBF };
+
+	fa = fb = NULL;
+
+	for (unsigned m = 0; m < sizeof(modes)/sizeof(int); m++)
+	{
+		if ((fa = fopen("/tmp/printfa", "w+")) == NULL)
+			goto error;
+		if ((fb = fopen("/tmp/printfb", "w+")) == NULL)
+			goto error;
+
+		if (printf_stream(fa, modes[m], 0) || printf_stream(fb, modes[m], 1))
+			goto error;
+
+		rewind(fa);
+		rewind(fb);
+		for (;;)
+		{
+			size_t na = fread(a, 1, sizeof(a), fa);
+			size_t nb = fread(b, 1, sizeof(b), fb);
+
+			if ((na != nb) || (memcmp(a, b, na)))
+				goto error;
+			if (na == 0)
+				break;
+		}
+
+		fclose(fa);
+		fclose(fb);
+		fa = fb = NULL;
+	}
+
+	/* Throughput. */
+	t0 = clock_monotonic();
+	for (int i = 0; i < n; i++)
+		snprintf(a, sizeof(a), "%-8d %s %08x %u\n", i*7919, "name", i, i);
+	t1 = clock_monotonic();
+	for (int i = 0; i < n; i++)
+		snprintf(b, sizeof(b), "%.0s%-8d %s %08x %u\n", "", i*7919, "name", i, i);
+	t2 = clock_monotonic();
+
+	if (flags & VERBOSE)
+	{
+		printf("  snprintf: %d ns generic: %d ns\n",
+			(int)((t1 - t0)/n), (int)((t2 - t1)/n));
+	}
+
+	unlink("/tmp/printfa");
+	unlink("/tmp/printfb");
+
+	return ((strcmp(a, b)) ? -1 : 0);
+
+error:
+	if (fa != NULL)
+		fclose(fa);
+	if (fb != NULL)
+		fclose(fb);
+	unlink("/tmp/printfa");
+	unlink("/tmp/printfb");
+	return (-1);
+}
+
+/*============================================================================*
+ *								 float_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Numbers tried by the floating-point tests.
+ */
+#define FLOAT_TEST_N 4000
+
+/**
+ * @brief Edge cases for the floating-point tests.
+ */
+static const double float_vals[] = {
+	1.0, 0.1, 0.3, 0.5, 2.0/3.0, 4.35, 1e-7, 1e15, 1e16, 1e23,
+	123456.789, 999999.9999995, 9007199254740993.0, 5e-324,
+	2.2250738585072014e-308, 1.7976931348623157e308
+};
+
+/**
+ * @brief Gets a number for the floating-point tests.
+ *
+ * @details The edge cases come first, then short decimals alternate with
+ *          random bit patterns.
+ *
+ * @param i    Number index.
+ * @param seed Random seed.
+ *
+ * @returns A positive, finite and non-zero double.
+ */
+static double float_value(int i, uint64_t *seed)
+{
+	union { double d; uint64_t u; } x;
+
+	if (i < (int)(sizeof(float_vals)/sizeof(double)))
+		return (float_vals[i]);
+
+	do
+	{
+		*seed ^= *seed << 13;
+		*seed ^= *seed >> 7;
+		*seed ^= *seed << 17;
+		x.u = *seed & 0x7fffffffffffffffULL;
+	} while (((x.u >> 52) == 0x7ff) || (x.u == 0));
+
+	/* Short decimal. */
+	if (i & 1)
+	{
+		x.d = (double)(1 + x.u%1000000);
+		for (int j = (x.u >> 32)%12; j > 0; j--)
+			x.d /= 10;
+	}
+
+	return (x.d);
+}
+
+/**
+ * @brief Converts a double to decimal digits with _dtoa_r().
+ *
+ * @param d     Number.
+ * @param mode  Conversion mode.
+ * @param n     Digit count.
+ * @param buf   Store location for the digits.
+ * @param decpt Store location for the decimal point position.
+ *
+ * @returns The number of digits, trailing zeros suppressed.
+ */
+static int float_digits(double d, int mode, int n, char *buf, int *decpt)
+{
+	int sign;
+	char *s, *end;
+
+	s = _dtoa_r(_REENT, d, mode, n, decpt, &sign, &end);
+
+	/* Modes above 5 may leave trailing zeros. */
+	while ((end > s) && (end[-1] == '0'))
+		end--;
+	memcpy(buf, s, end - s);
+	buf[end - s] = '\0';
+
+	return (end - s);
+}
+
+/**
+ * @brief Floating-point test 0.
+ *
+ * @details Checks the digits of _dtoa_r() in modes 2 and 3 against modes
+ *          6 and 7, which give the same digits but go straight to the
+ *          bignum code, and checks that the shortest digits of mode 0 read
+ *          back, while one digit fewer does not.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int float_test0(void)
+{
+	int n, dp, da, db;
+	char a[32], b[32], s[48];
+	uint64_t seed = 88172645463325252ULL;
+
+	for (int i = 0; i < FLOAT_TEST_N; i++)
+	{
+		double d = float_value(i, &seed);
+
+		/* Shortest digits. */
+		n = float_digits(d, 0, 0, a, &dp);
+		snprintf(s, sizeof(s), "0.%se%d", a, dp);
+		if (strtod(s, NULL) != d)
+			return (-1);
+		if (n > 1)
+		{
+			float_digits(d, 6, n - 1, b, &db);
+			snprintf(s, sizeof(s), "0.%se%d", b, db);
+			if (strtod(s, NULL) == d)
+				return (-1);
+		}
+
+		/* Significant digits. */
+		for (n = 1; n <= 17; n++)
+		{
+			float_digits(d, 2, n, a, &da);
+			float_digits(d, 6, n, b, &db);
+			if ((da != db) || (strcmp(a, b)))
+				return (-1);
+		}
+
+		/* Digits after the decimal point. */
+		if ((dp < -20) || (dp > 10))
+			continue;
+		for (n = 0; n <= 8; n++)
+		{
+			float_digits(d, 3, n, a, &da);
+			float_digits(d, 7, n, b, &db);
+			if ((da != db) || (strcmp(a, b)))
+				return (-1);
+		}
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Floating-point test 1.
+ *
+ * @details Checks strtod() on numbers of up to 19 digits, which take the
+ *          fast path, against the same numbers padded with zeros to more
+ *          digits than it takes. Then checks that "%.17g" reads back, and
+ *          measures both conversions.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int float_test1(void)
+{
+	long long t0, t1, t2;
+	char a[64], b[64];
+	uint64_t seed = 88172645463325252ULL;
+	const int n = 1000;
+
+	for (int i = 0; i < FLOAT_TEST_N; i++)
+	{
+		uint64_t w;
+		int e;
+
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+
+		w = seed >> 1;
+		for (int j = 19 - i%19; j > 1; j--)
+			w /= 10;
+		e = (int)((seed >> 40)%660) - 340;
+
+		snprintf(a, sizeof(a), "%llue%d", (unsigned long long)w + 1, e);
+		snprintf(b, sizeof(b), "%llu000000000000000000000e%d",
+			(unsigned long long)w + 1, e - 21);
+		if (strtod(a, NULL) != strtod(b, NULL))
+			return (-1);
+	}
+
+	for (int i = 0; i < FLOAT_TEST_N; i++)
+	{
+		double d = float_value(i, &seed);
+
+		snprintf(a, sizeof(a), "%.17g", d);
+		if (strtod(a, NULL) != d)
+			return (-1);
+	}
+
+	/* Throughput. */
+	t0 = clock_monotonic();
+	for (int i = 0; i < n; i++)
+		snprintf(a, sizeof(a), "%.17g", i*1.1 + 0.3);
+	t1 = clock_monotonic();
+	for (int i = 0; i < n; i++)
+		strtod(a, NULL);
+	t2 = clock_monotonic();
+
+	if (flags & VERBOSE)
+	{
+		printf("  %%.17g: %d ns strtod: %d ns\n",
+			(int)((t1 - t0)/n), (int)((t2 - t1)/n));
+	}
+
+	return (0);
+}
+
+/*============================================================================*
+ *								 math_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Numbers tried by the math library tests.
+ */
+#define MATH_TEST_N 4000
+
+/**
+ * @brief Edge cases for the math library tests.
+ */
+static const double math_vals[] = {
+	0.0, -0.0, 0.5, -0.5, 1.5, -1.5, 2.5, -2.5, 0.49999999999999994,
+	4503599627370495.5, 4503599627370497.0, -4503599627370497.0,
+	2147483646.5, -2147483648.0, 5e-324, -5e-324, 1e300, -1e300
+};
+
+/* fdlibm functions, without error handling. */
+extern double __ieee754_sqrt(double);
+extern double __ieee754_exp(double);
+extern double __ieee754_log(double);
+
+/**
+ * @brief Gets a number for the math library tests.
+ *
+ * @details The edge cases, infinities and a NaN come first, then numbers
+ *          with a few fraction bits alternate with random bit patterns.
+ *
+ * @param i    Number index.
+ * @param seed Random seed.
+ */
+static double math_value(int i, uint64_t *seed)
+{
+	union { double d; uint64_t u; } x;
+	int n = sizeof(math_vals)/sizeof(double);
+
+	if (i < n)
+		return (math_vals[i]);
+	if (i == n)
+		return (INFINITY);
+	if (i == n + 1)
+		return (-INFINITY);
+	if (i == n + 2)
+		return (NAN);
+
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	x.u = *seed;
+
+	/* Near an integer. */
+	if (i & 1)
+		x.d = (double)((int64_t)x.u >> 20)/(1 << (x.u & 15));
+
+	return (x.d);
+}
+
+/**
+ * @brief Asserts if two doubles are the same, or both NaN.
+ */
+static int math_same(double a, double b)
+{
+	union { double d; uint64_t u; } x, y;
+
+	if (isnan(a) && isnan(b))
+		return (1);
+
+	x.d = a;
+	y.d = b;
+
+	return (x.u == y.u);
+}
+
+/**
+ * @brief Gets the distance between two doubles, in units in the last place.
+ */
+static uint64_t math_ulps(double a, double b)
+{
+	union { double d; int64_t i; } x, y;
+
+	if (isnan(a) && isnan(b))
+		return (0);
+
+	x.d = a;
+	y.d = b;
+	if (x.i < 0)
+		x.i = INT64_MIN - x.i;
+	if (y.i < 0)
+		y.i = INT64_MIN - y.i;
+
+	return ((x.i > y.i) ? (uint64_t)(x.i - y.i) : (uint64_t)(y.i - x.i));
+}
+
+/**
+ * @brief Rounds a double to the nearest integral value, ties to even.
+ */
+static double math_rint(double x)
+{
+	double i, f;
+
+	f = modf(x, &i);
+	if ((fabs(f) > 0.5) || ((fabs(f) == 0.5) && (fmod(i, 2.0) != 0)))
+		return (i + copysign(1.0, x));
+
+	return (i);
+}
+
+/**
+ * @brief Math library test 0.
+ *
+ * @details Checks sqrt() against fdlibm, and the rounding, sign and
+ *          comparison functions against their definitions, including
+ *          for signed zeros, ties, infinities and NaNs.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int math_test0(void)
+{
+	union { double d; uint64_t u; } a, b;
+	uint64_t seed = 88172645463325252ULL;
+
+	for (int i = 0; i < MATH_TEST_N; i++)
+	{
+		double x = math_value(i, &seed);
+		double y = math_value(i + 1, &seed);
+		double f, ip;
+
+		if (!math_same(sqrt(x), __ieee754_sqrt(x)))
+			return (-1);
+
+		a.d = x;
+		b.d = y;
+		a.u &= 0x7fffffffffffffffULL;
+		if (!math_same(fabs(x), a.d))
+			return (-1);
+		a.u |= b.u & 0x8000000000000000ULL;
+		if (!math_same(copysign(x, y), a.d))
+			return (-1);
+
+		f = modf(x, &ip);
+		if (!math_same(floor(x), (f < 0) ? ip - 1 : ip))
+			return (-1);
+		if (!math_same(ceil(x), (f > 0) ? ip + 1 : ip))
+			return (-1);
+		if (!math_same(rint(x), math_rint(x)))
+			return (-1);
+		if ((fabs(x) < 2147483647.0) && (lrint(x) != (long) math_rint(x)))
+			return (-1);
+
+		if (!math_same(fmin(x, y), isnan(x) ? y : isnan(y) ? x : (x < y) ? x : y))
+			return (-1);
+		if (!math_same(fmax(x, y), isnan(x) ? y : isnan(y) ? x : (x > y) ? x : y))
+			return (-1);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Math library test 1.
+ *
+ * @details Checks vexp(), vlog(), vsin() and vcos() against the scalar
+ *          fdlibm functions, to within one unit in the last place, over
+ *          usual ranges and random bit patterns, and measures vexp().
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int math_test1(void)
+{
+	long long t0, t1, t2;
+	static double x[256], y[256];
+	uint64_t seed = 88172645463325252ULL;
+	const int n = sizeof(x)/sizeof(double);
+
+	for (int i = 0; i < MATH_TEST_N/n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			x[j] = math_value(i*n + j, &seed);
+			if (i & 1)
+				x[j] = fmod(x[j], (i & 2) ? 710.0 : 10.0);
+		}
+
+		vexp(y, x, n);
+		for (int j = 0; j < n; j++)
+		{
+			if (math_ulps(y[j], __ieee754_exp(x[j])) > 1)
+				return (-1);
+		}
+
+		vlog(y, x, n);
+		for (int j = 0; j < n; j++)
+		{
+			if (math_ulps(y[j], __ieee754_log(x[j])) > 1)
+				return (-1);
+		}
+
+		vsin(y, x, n);
+		for (int j = 0; j < n; j++)
+		{
+			if (math_ulps(y[j], sin(x[j])) > 1)
+				return (-1);
+		}
+
+		/* In place. */
+		memcpy(y, x, sizeof(x));
+		vcos(y, y, n);
+		for (int j = 0; j < n; j++)
+		{
+			if (math_ulps(y[j], cos(x[j])) > 1)
+				return (-1);
+		}
+	}
+
+	/* Throughput. */
+	for (int j = 0; j < n; j++)
+		x[j] = j*0.0625 + 0.03125;
+	t0 = clock_monotonic();
+	for (int j = 0; j < n; j++)
+		y[j] = exp(x[j]);
+	t1 = clock_monotonic();
+	vexp(y, x, n);
+	t2 = clock_monotonic();
+
+	if (flags & VERBOSE)
+	{
+		printf("  exp: %d ns vexp: %d ns\n",
+			(int)((t1 - t0)/n), (int)((t2 - t1)/n));
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Prints program usage and exits.
+ * 
+ * @details Prints the program usage and exists gracefully.
+ */
+static void usage(void)
+{
+	printf("Usage: test [options]\n\n");
+	printf("Brief: Performs regression tests on Nanvix.\n\n");
+	printf("Options:\n");
+	printf("  fpu	  Floating Point Unit Test\n");
+	printf("  simd    Streaming SIMD Extensions Test\n");
+	printf("  io	  I/O Test\n");
+	printf("  ipc	  Interprocess Communication Test\n");
+	printf("  paging  Paging System Test\n");
+	printf("  stack	  Stack growth Test\n");
+	printf("  sched	  Scheduling Test\n");
+	printf("  sem	  Semaphore Tests\n");
+	printf("  mem	  Memory Violation Tests\n");
+	printf("  clock	  Clock Tests\n");
+	printf("  prof	  Profiler Tests\n");
+	printf("  spawn	  Spawn Tests\n");
+	printf("  rusage  Resource Usage Tests\n");
+	printf("  procfs  Process File System Tests\n");
+	printf("  tmpfs   Temporary File System Tests\n");
+	printf("  bmap    Block Map Tests\n");
+	printf("  dirplus Directory Read With Attributes Tests\n");
+	printf("  string  String Function Tests\n");
+	printf("  malloc  Memory Allocator Tests\n");
+	printf("  printf  Formatted Output Tests\n");
+	printf("  float   Floating-Point Conversion Tests\n");
+	printf("  math    Math Library Tests\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief System testing utility.
+ */
+int main(int argc, char **argv)
+{
+	/* Missing arguments? */
+	if (argc <= 1)
+		usage();
+
+	for (int i = 1; i < argc; i++)
+	{
+		/* I/O test. */
+		if (!strcmp(argv[i], "io"))
+		{
+			printf("I/O Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!io_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Paging system test. */
+		else if (!strcmp(argv[i], "paging"))
+		{
+			printf("Demand Zero Test\n");
+			printf("  Result:			  [%s]\n",
+				   (!demand_zero_test()) ? "PASSED" : "FAILED");
+		}
+
+		/* Stack growth test. */
+		else if (!strcmp(argv[i], "stack"))
+		{
+			printf("Stack Grow Test\n");
+			printf("  Result:			  [%s]\n",
+				   (!stack_grow_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Scheduling test. */
+		else if (!strcmp(argv[i], "sched"))
+		{
+			printf("Scheduling Tests\n");
+			printf("  waiting for child	 [%s]\n",
+				   (!sched_test0()) ? "PASSED" : "FAILED");
+			printf("  dynamic priorities [%s]\n",
+				   (!sched_test1()) ? "PASSED" : "FAILED");
+			printf("  scheduler stress	 [%s]\n",
+				   (!sched_test2() &&
+					!sched_test3() &&
+					!sched_test4()) ? "PASSED" : "FAILED");
+		}
+
+		/* FPU test. */
 		else if (!strcmp(argv[i], "fpu"))
 		{
 			printf("Float Point Unit Test\n");
@@ -920,6 +2861,10 @@ int main(int argc, char **argv)
 				   (!sem_test_open_close()) ? "PASSED" : "FAILED");
 			printf("  producer consumer [%s]\n",
 				   (!sem_producer_consumer_test()) ? "PASSED" : "FAILED");
+			printf("  fast path		[%s]\n",
+				   (!sem_fastpath_test()) ? "PASSED" : "FAILED");
+			printf("  unopened counters	[%s]\n",
+				   (!sem_fault_test()) ? "PASSED" : "FAILED");
 		}
 
 		/* Memory tests. */
@@ -930,6 +2875,132 @@ int main(int argc, char **argv)
 				   (!test_mem0()) ? "PASSED" : "FAILED");
 		}
 
+		/* Clock tests. */
+		else if (!strcmp(argv[i], "clock"))
+		{
+			printf("Clock Tests\n");
+			printf("  monotonic clock	[%s]\n",
+				   (!clock_test0()) ? "PASSED" : "FAILED");
+			printf("  short sleeps		[%s]\n",
+				   (!clock_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Profiler tests. */
+		else if (!strcmp(argv[i], "prof"))
+		{
+			printf("Profiler Tests\n");
+			printf("  user samples		[%s]\n",
+				   (!prof_test0()) ? "PASSED" : "FAILED");
+		}
+
+		/* Spawn tests. */
+		else if (!strcmp(argv[i], "spawn"))
+		{
+			printf("Spawn Tests\n");
+			printf("  redirect output	[%s]\n",
+				   (!spawn_test0()) ? "PASSED" : "FAILED");
+			printf("  missing program	[%s]\n",
+				   (!spawn_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Resource usage tests. */
+		else if (!strcmp(argv[i], "rusage"))
+		{
+			printf("Resource Usage Tests\n");
+			printf("  child accounting	[%s]\n",
+				   (!rusage_test0()) ? "PASSED" : "FAILED");
+			printf("  process snapshot	[%s]\n",
+				   (!rusage_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Process file system tests. */
+		else if (!strcmp(argv[i], "procfs"))
+		{
+			printf("Process File System Tests\n");
+			printf("  process status	[%s]\n",
+				   (!procfs_test0()) ? "PASSED" : "FAILED");
+			printf("  root directory	[%s]\n",
+				   (!procfs_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Temporary file system tests. */
+		else if (!strcmp(argv[i], "tmpfs"))
+		{
+			printf("Temporary File System Tests\n");
+			printf("  read and write	[%s]\n",
+				   (!tmpfs_test0()) ? "PASSED" : "FAILED");
+			printf("  directory		[%s]\n",
+				   (!tmpfs_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Block map test. */
+		else if (!strcmp(argv[i], "bmap"))
+		{
+			printf("Block Map Tests\n");
+			printf("  truncate and reuse	[%s]\n",
+				   (!bmap_test0()) ? "PASSED" : "FAILED");
+		}
+
+		/* Directory read with attributes tests. */
+		else if (!strcmp(argv[i], "dirplus"))
+		{
+			printf("Directory Read With Attributes Tests\n");
+			printf("  status of entries	[%s]\n",
+				   (!dirplus_test0()) ? "PASSED" : "FAILED");
+			printf("  mixed readdir		[%s]\n",
+				   (!dirplus_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* String function tests. */
+		else if (!strcmp(argv[i], "string"))
+		{
+			printf("String Function Tests\n");
+			printf("  memory functions	[%s]\n",
+				   (!string_test0()) ? "PASSED" : "FAILED");
+			printf("  string functions	[%s]\n",
+				   (!string_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Memory allocator tests. */
+		else if (!strcmp(argv[i], "malloc"))
+		{
+			printf("Memory Allocator Tests\n");
+			printf("  random objects	[%s]\n",
+				   (!malloc_test0()) ? "PASSED" : "FAILED");
+			printf("  churn and trim	[%s]\n",
+				   (!malloc_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Formatted output tests. */
+		else if (!strcmp(argv[i], "printf"))
+		{
+			printf("Formatted Output Tests\n");
+			printf("  string output		[%s]\n",
+				   (!printf_test0()) ? "PASSED" : "FAILED");
+			printf("  stream output		[%s]\n",
+				   (!printf_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Floating-point conversion tests. */
+		else if (!strcmp(argv[i], "float"))
+		{
+			printf("Floating-Point Conversion Tests\n");
+			printf("  double to string	[%s]\n",
+				   (!float_test0()) ? "PASSED" : "FAILED");
+			printf("  string to double	[%s]\n",
+				   (!float_test1()) ? "PASSED" : "FAILED");
+		}
+
+		/* Math library tests. */
+		else if (!strcmp(argv[i], "math"))
+		{
+			printf("Math Library Tests\n");
+			printf("  scalar functions	[%s]\n",
+				   (!math_test0()) ? "PASSED" : "FAILED");
+			printf("  vector functions	[%s]\n",
+				   (!math_test1()) ? "PASSED" : "FAILED");
+		}
+
 		/* Wrong usage. */
 		else
 			usage();
@@ -0,0 +1,175 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dev/klog.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stropts.h>
+#include <unistd.h>
+
+/* Software versioning. */
+#define VERSION_MAJOR 1 /* Major version. */
+#define VERSION_MINOR 0 /* Minor version. */
+
+/* Kernel log device. */
+#define KLOG_DEVICE "/dev/klog"
+
+/* Program arguments. */
+static int clear = 0;  /* Clear log after printing? */
+static int levels = 0; /* Print log levels?         */
+
+/*
+ * Kernel log snapshot. The ring never holds more than this.
+ */
+static char buffer[KLOG_RECORDS*KLOG_SLOT];
+
+/*
+ * Prints a kernel log record.
+ */
+static void print(const struct klog_record *r, int *newline)
+{
+	const char *text;
+
+	text = KLOG_TEXT(r);
+
+	/* Prefix only the first line of a message. */
+	if (!(r->flags & KLOG_CONT) && (*newline))
+	{
+		printf("[%8u] ", (unsigned)r->ticks);
+		if ((levels) && (r->level != KLOG_NOLEVEL))
+			printf("<%u> ", (unsigned)r->level);
+	}
+
+	fwrite(text, 1, r->length, stdout);
+
+	if (r->length > 0)
+		*newline = (text[r->length - 1] == '\n');
+}
+
+/*
+ * Prints program version and exits.
+ */
+static void version(void)
+{
+	printf("dmesg (Nanvix Coreutils) %d.%d\n\n", VERSION_MAJOR, VERSION_MINOR);
+	printf("Copyright(C) 2011-2016 Pedro H. Penna\n");
+	printf("This is free software under the ");
+	printf("GNU General Public License Version 3.\n");
+	printf("There is NO WARRANTY, to the extent permitted by law.\n\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: dmesg [options]\n\n");
+	printf("Brief: Prints the kernel log.\n\n");
+	printf("Options:\n");
+	printf("  -c        Clear the kernel log after printing it\n");
+	printf("  -l        Print log levels\n");
+	printf("  --help    Display this information and exit\n");
+	printf("  --version Display program version and exit\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Gets program arguments.
+ */
+static void getargs(int argc, char *const argv[])
+{
+	int i;     /* Loop index.       */
+	char *arg; /* Working argument. */
+
+	/* Get program arguments. */
+	for (i = 1; i < argc; i++)
+	{
+		arg = argv[i];
+
+		/* Display help information. */
+		if (!strcmp(arg, "--help"))
+			usage();
+
+		/* Display program version. */
+		else if (!strcmp(arg, "--version"))
+			version();
+
+		/* Clear kernel log. */
+		else if (!strcmp(arg, "-c"))
+			clear = 1;
+
+		/* Print log levels. */
+		else if (!strcmp(arg, "-l"))
+			levels = 1;
+
+		/* Bad argument. */
+		else
+		{
+			fprintf(stderr, "dmesg: bad argument %s\n", arg);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/*
+ * Prints the kernel log.
+ */
+int main(int argc, char *const argv[])
+{
+	int fd;                /* Kernel log device. */
+	ssize_t n;             /* Bytes read.        */
+	int newline;           /* At line start?     */
+	struct klog_record *r; /* Working record.    */
+
+	getargs(argc, argv);
+
+	if ((fd = open(KLOG_DEVICE, O_RDONLY)) < 0)
+	{
+		fprintf(stderr, "dmesg: cannot open %s\n", KLOG_DEVICE);
+		return (EXIT_FAILURE);
+	}
+
+	/* Whole records only, so a single read is enough. */
+	if ((n = read(fd, buffer, sizeof(buffer))) < 0)
+	{
+		fprintf(stderr, "dmesg: cannot read %s\n", KLOG_DEVICE);
+		close(fd);
+		return (EXIT_FAILURE);
+	}
+
+	newline = 1;
+	for (r = (struct klog_record *)buffer; (char *)r < buffer + n; r = KLOG_NEXT(r))
+		print(r, &newline);
+
+	if (!newline)
+		putchar('\n');
+
+	if ((clear) && (ioctl(fd, KLOG_CLEAR) < 0))
+		fprintf(stderr, "dmesg: cannot clear %s\n", KLOG_DEVICE);
+
+	close(fd);
+
+	return (EXIT_SUCCESS);
+}
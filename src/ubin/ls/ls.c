@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 /* Software versioning. */
 #define VERSION_MAJOR 1 /* Major version. */
@@ -31,11 +32,36 @@
 /* Program flags. */
 #define LS_ALL   001     /* Print entries starting with dot? */
 #define LS_INODE 002     /* Print inode numbers.             */
+#define LS_LONG  004     /* Use long listing format.         */
 static int ls_flags = 0; /* Flags.                           */
 
 /* Name of the directory to list. */
 static char *dirname = NULL;
 
+/*
+ * Converts a file mode to a string, as in "drwxr-xr-x".
+ */
+static void modestr(mode_t mode, char *str)
+{
+	static const char rwx[] = "rwxrwxrwx";
+	
+	if (S_ISDIR(mode))
+		str[0] = 'd';
+	else if (S_ISCHR(mode))
+		str[0] = 'c';
+	else if (S_ISBLK(mode))
+		str[0] = 'b';
+	else if (S_ISFIFO(mode))
+		str[0] = 'p';
+	else
+		str[0] = '-';
+	
+	for (int i = 0; i < 9; i++)
+		str[i + 1] = (mode & (0400 >> i)) ? rwx[i] : '-';
+	
+	str[10] = '\0';
+}
+
 /*
  * Lists contents of a directory.
  */
@@ -43,7 +69,9 @@ int ls(const char *pathname)
 {
 	DIR *dirp;                   /* Directory.               */
 	struct dirent *dp;           /* Working directory entry. */
+	struct dirplus *dpp;         /* Working entry status.    */
 	char filename[NAME_MAX + 1]; /* Working file name.       */
+	char mode[11];               /* Working file mode.       */
 	
 	/* Open directory. */
 	if ((dirp = opendir(pathname)) == NULL)
@@ -54,9 +82,16 @@ int ls(const char *pathname)
 	
 	errno = 0;
 	
-	/* Read directory entries. */
+	/*
+	 * Read directory entries. The long format reads
+	 * them along with their status, so that there is
+	 * no need to stat() each one of them.
+	 */
 	filename[NAME_MAX] = '\0';
-	while ((dp = readdir(dirp)) != NULL)
+	dpp = NULL;
+	while ((ls_flags & LS_LONG) ?
+		((dp = (struct dirent *)(dpp = readdirplus(dirp))) != NULL) :
+		((dp = readdir(dirp)) != NULL))
 	{
 		strncpy(filename, dp->d_name, NAME_MAX);
 		
@@ -68,6 +103,19 @@ int ls(const char *pathname)
 		if (ls_flags & LS_INODE)
 			printf("%d ", (int)dp->d_ino);
 		
+		/* Print file status. */
+		if (ls_flags & LS_LONG)
+		{
+			modestr(dpp->d_stat.st_mode, mode);
+			printf("%s %2d %3d %3d %8ld ",
+				mode,
+				(int)dpp->d_stat.st_nlink,
+				(int)dpp->d_stat.st_uid,
+				(int)dpp->d_stat.st_gid,
+				(long)dpp->d_stat.st_size
+			);
+		}
+		
 		printf("%s\n", filename);
 	}
 	closedir(dirp);
@@ -106,6 +154,7 @@ static void usage(void)
 	printf("Options:\n");
 	printf("  -a, --all     List all entries\n");
 	printf("  -i, --inode   Print the inode number of each file\n");
+	printf("  -l            Use a long listing format\n");
 	printf("      --help    Display this information and exit\n");
 	printf("      --version Display program version and exit\n");
 	
@@ -133,6 +182,10 @@ static void getargs(int argc, char *const argv[])
 		else if ((!strcmp(arg, "-i")) || (!strcmp(arg, "--inode")))
 			ls_flags |= LS_INODE;
 		
+		/* Use long listing format. */
+		else if (!strcmp(arg, "-l"))
+			ls_flags |= LS_LONG;
+		
 		/* Display help information. */
 		else if (!strcmp(arg, "--help"))
 			usage();
@@ -0,0 +1,772 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <dev/prof.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stropts.h>
+#include <unistd.h>
+
+/* Software versioning. */
+#define VERSION_MAJOR 1 /* Major version. */
+#define VERSION_MINOR 0 /* Minor version. */
+
+/* Default files. */
+#define PROF_DEVICE  "/dev/prof"    /* Profiler device. */
+#define KERNEL_IMAGE "/boot/kernel" /* Kernel image.    */
+
+/* Table sizes. */
+#define NR_IMAGES   16 /* Maximum number of symbolized images. */
+#define NR_FUNCS   512 /* Maximum number of distinct functions. */
+#define NR_EDGES  1024 /* Maximum number of call graph edges.  */
+
+/* Commands. */
+#define CMD_NONE   0 /* No command.       */
+#define CMD_START  1 /* Start sampling.   */
+#define CMD_STOP   2 /* Stop sampling.    */
+#define CMD_RESET  3 /* Discard samples.  */
+#define CMD_DUMP   4 /* Save raw samples. */
+#define CMD_REPORT 5 /* Print a report.   */
+
+/*
+ * Program arguments.
+ */
+static struct
+{
+	int cmd;            /* Command.                */
+	int callgraph;      /* Print call graph?       */
+	const char *kernel; /* Kernel image.           */
+	const char *input;  /* Where to read samples.  */
+	const char *output; /* Where to dump samples.  */
+} args = { CMD_NONE, 0, KERNEL_IMAGE, PROF_DEVICE, NULL };
+
+/*
+ * Symbol.
+ */
+struct symbol
+{
+	uint32_t addr; /* Start address. */
+	char *name;    /* Symbol name.   */
+};
+
+/*
+ * Symbolized image.
+ */
+struct image
+{
+	char name[PROF_NAME_MAX]; /* Image name.         */
+	struct symbol *syms;      /* Sorted symbols.     */
+	int nsyms;                /* Number of symbols.  */
+	char *strtab;             /* String table.       */
+};
+
+/*
+ * Profiled function.
+ */
+struct func
+{
+	struct image *img; /* Image.                     */
+	const char *name;  /* Function name.             */
+	unsigned self;     /* Samples in this function.  */
+	unsigned total;    /* Samples in its call chain. */
+};
+
+/*
+ * Call graph edge.
+ */
+struct edge
+{
+	int caller;     /* Caller function. */
+	int callee;     /* Callee function. */
+	unsigned count; /* Samples.         */
+};
+
+/* Symbolized images. */
+static struct image images[NR_IMAGES];
+static int nimages = 0;
+
+/* Profiled functions. */
+static struct func funcs[NR_FUNCS];
+static int nfuncs = 0;
+
+/* Call graph edges. */
+static struct edge edges[NR_EDGES];
+static int nedges = 0;
+
+/* Number of samples. */
+static unsigned nsamples = 0;
+
+/*
+ * Prints program version and exits.
+ */
+static void version(void)
+{
+	printf("prof (Nanvix Coreutils) %d.%d\n\n", VERSION_MAJOR, VERSION_MINOR);
+	printf("Copyright(C) 2011-2016 Pedro H. Penna\n");
+	printf("This is free software under the ");
+	printf("GNU General Public License Version 3.\n");
+	printf("There is NO WARRANTY, to the extent permitted by law.\n\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: prof [options] <command>\n\n");
+	printf("Brief: Controls the sampling profiler and reports samples.\n\n");
+	printf("Commands:\n");
+	printf("  start              Start sampling\n");
+	printf("  stop               Stop sampling\n");
+	printf("  reset              Discard collected samples\n");
+	printf("  dump               Save raw samples to a file\n");
+	printf("  report             Print a flat profile\n\n");
+	printf("Options:\n");
+	printf("  --callgraph        Also print a call graph\n");
+	printf("  --help             Display this information and exit\n");
+	printf("  --input <file>     Read samples from file\n");
+	printf("  --kernel <file>    Kernel image to symbolize against\n");
+	printf("  --output <file>    File where samples should be dumped\n");
+	printf("  --version          Display program version and exit\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Gets program arguments.
+ */
+static void getargs(int argc, char *const argv[])
+{
+	int i;     /* Loop index.       */
+	char *arg; /* Current argument. */
+	int state; /* Processing state. */
+
+	/* State values. */
+	#define READ_ARG   0 /* Read argument. */
+	#define SET_KERNEL 1 /* Set kernel.    */
+	#define SET_INPUT  2 /* Set input.     */
+	#define SET_OUTPUT 3 /* Set output.    */
+
+	state = READ_ARG;
+
+	/* Read command line arguments. */
+	for (i = 1; i < argc; i++)
+	{
+		arg = argv[i];
+
+		/* Set value. */
+		if (state != READ_ARG)
+		{
+			switch (state)
+			{
+				case SET_KERNEL:
+					args.kernel = arg;
+					break;
+
+				case SET_INPUT:
+					args.input = arg;
+					break;
+
+				case SET_OUTPUT:
+					args.output = arg;
+					break;
+
+				/* Bad usage.*/
+				default:
+					usage();
+			}
+
+			state = READ_ARG;
+			continue;
+		}
+
+		/* Parse command line argument. */
+		if (!strcmp(arg, "--help")) {
+			usage();
+		}
+		else if (!strcmp(arg, "--version")) {
+			version();
+		}
+		else if (!strcmp(arg, "--callgraph")) {
+			args.callgraph = 1;
+		}
+		else if (!strcmp(arg, "--kernel")) {
+			state = SET_KERNEL;
+		}
+		else if (!strcmp(arg, "--input")) {
+			state = SET_INPUT;
+		}
+		else if (!strcmp(arg, "--output")) {
+			state = SET_OUTPUT;
+		}
+		else if (!strcmp(arg, "start")) {
+			args.cmd = CMD_START;
+		}
+		else if (!strcmp(arg, "stop")) {
+			args.cmd = CMD_STOP;
+		}
+		else if (!strcmp(arg, "reset")) {
+			args.cmd = CMD_RESET;
+		}
+		else if (!strcmp(arg, "dump")) {
+			args.cmd = CMD_DUMP;
+		}
+		else if (!strcmp(arg, "report")) {
+			args.cmd = CMD_REPORT;
+		}
+		else {
+			usage();
+		}
+	}
+
+	/* Missing argument. */
+	if ((state != READ_ARG) || (args.cmd == CMD_NONE))
+		usage();
+
+	/* Missing output file. */
+	if ((args.cmd == CMD_DUMP) && (args.output == NULL))
+	{
+		fprintf(stderr, "prof: missing output file\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*============================================================================*
+ *                               Symbolization                                *
+ *============================================================================*/
+
+/*
+ * Compares two symbols by address.
+ */
+static int symcmp(const void *a, const void *b)
+{
+	uint32_t x = ((const struct symbol *)a)->addr;
+	uint32_t y = ((const struct symbol *)b)->addr;
+
+	return ((x < y) ? -1 : (x > y) ? 1 : 0);
+}
+
+/*
+ * Reads a chunk of a file.
+ */
+static void *readchunk(int fd, off_t off, size_t size)
+{
+	void *buf;
+
+	if ((buf = malloc(size)) == NULL)
+		return (NULL);
+
+	if ((lseek(fd, off, SEEK_SET) != off) ||
+		(read(fd, buf, size) != (ssize_t)size))
+	{
+		free(buf);
+		return (NULL);
+	}
+
+	return (buf);
+}
+
+/*
+ * Loads the function symbols of an ELF image.
+ */
+static void elfload(struct image *img, const char *path)
+{
+	int i, fd;
+	struct elf32_fhdr fhdr;
+	struct elf32_shdr *shdrs;
+	struct elf32_shdr *symtab;
+	struct elf32_sym *syms;
+	int n;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return;
+
+	if (read(fd, &fhdr, sizeof(fhdr)) != sizeof(fhdr))
+		goto out0;
+
+	/* Not an ELF file. */
+	if ((fhdr.e_ident[0] != ELFMAG0) || (fhdr.e_ident[1] != ELFMAG1) ||
+		(fhdr.e_ident[2] != ELFMAG2) || (fhdr.e_ident[3] != ELFMAG3) ||
+		(fhdr.e_shentsize != sizeof(struct elf32_shdr)))
+		goto out0;
+
+	shdrs = readchunk(fd, fhdr.e_shoff, fhdr.e_shnum*sizeof(struct elf32_shdr));
+	if (shdrs == NULL)
+		goto out0;
+
+	/* Find symbol table. */
+	symtab = NULL;
+	for (i = 0; i < fhdr.e_shnum; i++)
+	{
+		if (shdrs[i].sh_type == SHT_SYMTAB)
+		{
+			symtab = &shdrs[i];
+			break;
+		}
+	}
+
+	/* Stripped binary. */
+	if ((symtab == NULL) || (symtab->sh_link >= fhdr.e_shnum))
+		goto out1;
+
+	syms = readchunk(fd, symtab->sh_offset, symtab->sh_size);
+	if (syms == NULL)
+		goto out1;
+
+	img->strtab = readchunk(fd,
+		shdrs[symtab->sh_link].sh_offset, shdrs[symtab->sh_link].sh_size);
+	if (img->strtab == NULL)
+		goto out2;
+
+	n = symtab->sh_size/sizeof(struct elf32_sym);
+	if ((img->syms = malloc(n*sizeof(struct symbol))) == NULL)
+		goto out2;
+
+	/* Keep only code symbols. */
+	for (i = 0; i < n; i++)
+	{
+		int type = ELF32_ST_TYPE(syms[i].st_info);
+
+		if ((type != STT_FUNC) && (type != STT_NOTYPE))
+			continue;
+		if ((syms[i].st_shndx == SHN_UNDEF) || (syms[i].st_value == 0))
+			continue;
+		if (syms[i].st_name >= shdrs[symtab->sh_link].sh_size)
+			continue;
+
+		img->syms[img->nsyms].addr = syms[i].st_value;
+		img->syms[img->nsyms].name = &img->strtab[syms[i].st_name];
+		img->nsyms++;
+	}
+
+	qsort(img->syms, img->nsyms, sizeof(struct symbol), symcmp);
+
+out2:
+	free(syms);
+out1:
+	free(shdrs);
+out0:
+	close(fd);
+}
+
+/*
+ * Gets a symbolized image, loading it if needed.
+ */
+static struct image *getimage(const char *name, int kernel)
+{
+	int i;
+	char path[64];
+	struct image *img;
+
+	for (i = 0; i < nimages; i++)
+	{
+		if (!strcmp(images[i].name, name))
+			return (&images[i]);
+	}
+
+	/* Too many images. */
+	if (nimages == NR_IMAGES)
+		return (NULL);
+
+	img = &images[nimages++];
+	strncpy(img->name, name, PROF_NAME_MAX - 1);
+
+	if (kernel)
+		elfload(img, args.kernel);
+	else
+	{
+		snprintf(path, sizeof(path), "/bin/%s", name);
+		elfload(img, path);
+
+		if (img->nsyms == 0)
+		{
+			snprintf(path, sizeof(path), "/sbin/%s", name);
+			elfload(img, path);
+		}
+	}
+
+	return (img);
+}
+
+/*
+ * Looks up the symbol that contains an address.
+ */
+static const char *symbolize(const struct image *img, uint32_t addr)
+{
+	int lo, hi, mid;
+
+	if ((img == NULL) || (img->nsyms == 0) || (addr < img->syms[0].addr))
+		return ("??");
+
+	lo = 0;
+	hi = img->nsyms - 1;
+
+	while (lo < hi)
+	{
+		mid = (lo + hi + 1)/2;
+
+		if (img->syms[mid].addr <= addr)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return (img->syms[lo].name);
+}
+
+/*============================================================================*
+ *                                 Reports                                    *
+ *============================================================================*/
+
+/*
+ * Gets the profiled function that contains an address.
+ */
+static int getfunc(struct image *img, uint32_t addr)
+{
+	int i;
+	const char *name;
+
+	name = symbolize(img, addr);
+
+	for (i = 0; i < nfuncs; i++)
+	{
+		if ((funcs[i].img == img) && (!strcmp(funcs[i].name, name)))
+			return (i);
+	}
+
+	/* Too many functions. */
+	if (nfuncs == NR_FUNCS)
+		return (-1);
+
+	funcs[nfuncs].img = img;
+	funcs[nfuncs].name = name;
+	funcs[nfuncs].self = 0;
+	funcs[nfuncs].total = 0;
+
+	return (nfuncs++);
+}
+
+/*
+ * Accounts a call graph edge.
+ */
+static void addedge(int caller, int callee)
+{
+	int i;
+
+	for (i = 0; i < nedges; i++)
+	{
+		if ((edges[i].caller == caller) && (edges[i].callee == callee))
+		{
+			edges[i].count++;
+			return;
+		}
+	}
+
+	/* Too many edges. */
+	if (nedges == NR_EDGES)
+		return;
+
+	edges[nedges].caller = caller;
+	edges[nedges].callee = callee;
+	edges[nedges].count = 1;
+	nedges++;
+}
+
+/*
+ * Accounts a sample.
+ */
+static void account(const struct prof_sample *s)
+{
+	int i, j;
+	struct image *img;
+	int chain[PROF_DEPTH];
+	char name[PROF_NAME_MAX];
+
+	nsamples++;
+
+	strncpy(name, s->name, PROF_NAME_MAX);
+	name[PROF_NAME_MAX - 1] = '\0';
+	img = getimage((s->flags & PROF_KERNEL) ? "kernel" : name,
+		s->flags & PROF_KERNEL);
+
+	/*
+	 * Return addresses point past the call instruction,
+	 * so step back into the caller before symbolizing.
+	 */
+	for (i = 0; (i < s->depth) && (i < PROF_DEPTH); i++)
+		chain[i] = getfunc(img, (i == 0) ? s->pc[0] : s->pc[i] - 1);
+
+	if (chain[0] >= 0)
+		funcs[chain[0]].self++;
+
+	for (i = 0; (i < s->depth) && (i < PROF_DEPTH); i++)
+	{
+		if (chain[i] < 0)
+			continue;
+
+		/* Count recursive functions once. */
+		for (j = 0; j < i; j++)
+		{
+			if (chain[j] == chain[i])
+				break;
+		}
+		if (j == i)
+			funcs[chain[i]].total++;
+
+		if ((i > 0) && (chain[i - 1] >= 0))
+			addedge(chain[i], chain[i - 1]);
+	}
+}
+
+/*
+ * Compares two functions by self samples.
+ */
+static int selfcmp(const void *a, const void *b)
+{
+	const struct func *x = &funcs[*(const int *)a];
+	const struct func *y = &funcs[*(const int *)b];
+
+	if (x->self != y->self)
+		return ((x->self > y->self) ? -1 : 1);
+
+	return ((x->total > y->total) ? -1 : (x->total < y->total) ? 1 : 0);
+}
+
+/*
+ * Compares two functions by total samples.
+ */
+static int totalcmp(const void *a, const void *b)
+{
+	const struct func *x = &funcs[*(const int *)a];
+	const struct func *y = &funcs[*(const int *)b];
+
+	return ((x->total > y->total) ? -1 : (x->total < y->total) ? 1 : 0);
+}
+
+/*
+ * Prints a percentage with one decimal digit.
+ */
+static void percent(unsigned n)
+{
+	unsigned p = (nsamples) ? (n*1000)/nsamples : 0;
+
+	printf("%3u.%u%%", p/10, p%10);
+}
+
+/*
+ * Prints the flat profile.
+ */
+static void flat(int *order)
+{
+	int i;
+
+	qsort(order, nfuncs, sizeof(int), selfcmp);
+
+	printf("Flat profile (%u samples):\n\n", nsamples);
+	printf("  self%%     self    total  function\n");
+
+	for (i = 0; i < nfuncs; i++)
+	{
+		struct func *f = &funcs[order[i]];
+
+		if (f->self == 0)
+			continue;
+
+		printf("  ");
+		percent(f->self);
+		printf(" %8u %8u  %s [%s]\n", f->self, f->total, f->name, f->img->name);
+	}
+}
+
+/*
+ * Prints the call graph.
+ */
+static void callgraph(int *order)
+{
+	int i, j;
+
+	qsort(order, nfuncs, sizeof(int), totalcmp);
+
+	printf("\nCall graph (%u samples):\n\n", nsamples);
+	printf("  total%%    total     self  function\n");
+
+	for (i = 0; i < nfuncs; i++)
+	{
+		struct func *f = &funcs[order[i]];
+
+		for (j = 0; j < nedges; j++)
+		{
+			if (edges[j].callee == order[i])
+				printf("                   %8u      %s [caller]\n",
+					edges[j].count, funcs[edges[j].caller].name);
+		}
+
+		printf("  ");
+		percent(f->total);
+		printf(" %8u %8u  %s [%s]\n", f->total, f->self, f->name, f->img->name);
+
+		for (j = 0; j < nedges; j++)
+		{
+			if (edges[j].caller == order[i])
+				printf("                   %8u      %s [callee]\n",
+					edges[j].count, funcs[edges[j].callee].name);
+		}
+
+		printf("  -----------------------------------------\n");
+	}
+}
+
+/*
+ * Reads samples and prints a report.
+ */
+static int report(void)
+{
+	int i, fd;
+	int *order;
+	ssize_t n;
+	struct prof_sample samples[16];
+
+	if ((fd = open(args.input, O_RDONLY)) < 0)
+	{
+		fprintf(stderr, "prof: cannot open %s\n", args.input);
+		return (EXIT_FAILURE);
+	}
+
+	while ((n = read(fd, samples, sizeof(samples))) > 0)
+	{
+		for (i = 0; i < n/(ssize_t)sizeof(struct prof_sample); i++)
+			account(&samples[i]);
+	}
+
+	close(fd);
+
+	if ((order = malloc((nfuncs + 1)*sizeof(int))) == NULL)
+	{
+		fprintf(stderr, "prof: not enough memory\n");
+		return (EXIT_FAILURE);
+	}
+
+	for (i = 0; i < nfuncs; i++)
+		order[i] = i;
+
+	flat(order);
+
+	if (args.callgraph)
+		callgraph(order);
+
+	free(order);
+
+	return (EXIT_SUCCESS);
+}
+
+/*
+ * Saves raw samples to a file.
+ */
+static int dump(void)
+{
+	int in, out;
+	ssize_t n;
+	struct prof_sample samples[16];
+
+	if ((in = open(args.input, O_RDONLY)) < 0)
+	{
+		fprintf(stderr, "prof: cannot open %s\n", args.input);
+		return (EXIT_FAILURE);
+	}
+
+	if ((out = open(args.output, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+	{
+		fprintf(stderr, "prof: cannot create %s\n", args.output);
+		close(in);
+		return (EXIT_FAILURE);
+	}
+
+	while ((n = read(in, samples, sizeof(samples))) > 0)
+	{
+		if (write(out, samples, n) != n)
+		{
+			fprintf(stderr, "prof: write error\n");
+			break;
+		}
+	}
+
+	close(out);
+	close(in);
+
+	return (EXIT_SUCCESS);
+}
+
+/*
+ * Sends a control command to the profiler.
+ */
+static int control(unsigned cmd)
+{
+	int fd, ret;
+
+	if ((fd = open(PROF_DEVICE, O_RDONLY)) < 0)
+	{
+		fprintf(stderr, "prof: cannot open %s\n", PROF_DEVICE);
+		return (EXIT_FAILURE);
+	}
+
+	ret = ioctl(fd, cmd);
+
+	/* Report samples that did not fit in the kernel buffer. */
+	if ((ret >= 0) && (cmd == PROF_STOP) && ((ret = ioctl(fd, PROF_LOST)) > 0))
+		printf("prof: %d samples lost\n", ret);
+
+	close(fd);
+
+	return ((ret < 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*
+ * Controls the sampling profiler and reports samples.
+ */
+int main(int argc, char *const argv[])
+{
+	getargs(argc, argv);
+
+	switch (args.cmd)
+	{
+		case CMD_START:
+			return (control(PROF_START));
+
+		case CMD_STOP:
+			return (control(PROF_STOP));
+
+		case CMD_RESET:
+			return (control(PROF_RESET));
+
+		case CMD_DUMP:
+			return (dump());
+
+		default:
+			break;
+	}
+
+	return (report());
+}
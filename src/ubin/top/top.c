@@ -0,0 +1,277 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/pstat.h>
+#include <dev/tty.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stropts.h>
+#include <unistd.h>
+
+/* Software versioning. */
+#define VERSION_MAJOR 1 /* Major version. */
+#define VERSION_MINOR 0 /* Minor version. */
+
+/* Maximum number of processes in a snapshot. */
+#define NR_SNAPSHOT 64
+
+/* Nanoseconds per millisecond. */
+#define NSEC_PER_MSEC 1000000ULL
+
+/*
+ * Program arguments.
+ */
+static struct
+{
+	unsigned delay;  /* Seconds between updates.    */
+	int iterations;  /* Updates (negative: forever). */
+	int batch;       /* Do not clear the screen?    */
+} args = { 2, -1, 0 };
+
+/*
+ * Process table snapshots.
+ */
+static struct pstat snapshots[2][NR_SNAPSHOT];
+static int nsnapshots[2] = { 0, 0 };
+
+/*
+ * Process state letters.
+ */
+static const char states[] = "DZRRWST";
+
+/*
+ * Row of the report.
+ */
+struct row
+{
+	const struct pstat *curr; /* Current snapshot.                  */
+	unsigned cpu;             /* CPU usage (in tenths of a percent). */
+	struct pcounters delta;   /* Counters over the interval.        */
+};
+
+/* Rows of the report. */
+static struct row rows[NR_SNAPSHOT];
+
+/*
+ * Prints program version and exits.
+ */
+static void version(void)
+{
+	printf("top (Nanvix Coreutils) %d.%d\n\n", VERSION_MAJOR, VERSION_MINOR);
+	printf("Copyright(C) 2011-2016 Pedro H. Penna\n");
+	printf("This is free software under the ");
+	printf("GNU General Public License Version 3.\n");
+	printf("There is NO WARRANTY, to the extent permitted by law.\n\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: top [options]\n\n");
+	printf("Brief: Displays process activity.\n\n");
+	printf("Options:\n");
+	printf("  -b        Batch mode: do not clear the screen\n");
+	printf("  -d <secs> Delay between updates\n");
+	printf("  -n <num>  Number of updates\n");
+	printf("  --help    Display this information and exit\n");
+	printf("  --version Display program version and exit\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Gets program arguments.
+ */
+static void getargs(int argc, char *const argv[])
+{
+	int i;     /* Loop index.       */
+	char *arg; /* Current argument. */
+
+	for (i = 1; i < argc; i++)
+	{
+		arg = argv[i];
+
+		if (!strcmp(arg, "--help"))
+			usage();
+		else if (!strcmp(arg, "--version"))
+			version();
+		else if (!strcmp(arg, "-b"))
+			args.batch = 1;
+		else if ((!strcmp(arg, "-d")) && (i + 1 < argc))
+			args.delay = atoi(argv[++i]);
+		else if ((!strcmp(arg, "-n")) && (i + 1 < argc))
+			args.iterations = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "top: bad argument %s\n", arg);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (args.delay == 0)
+		args.delay = 1;
+}
+
+/*
+ * Finds a process in a snapshot.
+ */
+static const struct pstat *lookup(int s, pid_t pid)
+{
+	int i;
+
+	for (i = 0; i < nsnapshots[s]; i++)
+	{
+		if (snapshots[s][i].pid == pid)
+			return (&snapshots[s][i]);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Computes the counters of a process over the last interval.
+ */
+static void diff(struct row *r, const struct pstat *prev, uint64_t interval)
+{
+	uint64_t used;
+	const struct pcounters *c;
+	static const struct pstat none;
+
+	c = &r->curr->ru;
+
+	/* New process: everything happened in this interval. */
+	if (prev == NULL)
+		prev = &none;
+
+	used = (r->curr->utime + r->curr->ktime) - (prev->utime + prev->ktime);
+	r->cpu = (unsigned)((used*1000)/interval);
+
+	r->delta.minflt = c->minflt - prev->ru.minflt;
+	r->delta.majflt = c->majflt - prev->ru.majflt;
+	r->delta.cowflt = c->cowflt - prev->ru.cowflt;
+	r->delta.inblock = c->inblock - prev->ru.inblock;
+	r->delta.oublock = c->oublock - prev->ru.oublock;
+	r->delta.nvcsw = c->nvcsw - prev->ru.nvcsw;
+	r->delta.nivcsw = c->nivcsw - prev->ru.nivcsw;
+	r->delta.nsyscalls = c->nsyscalls - prev->ru.nsyscalls;
+}
+
+/*
+ * Compares rows by CPU usage, then by process ID.
+ */
+static int cmprow(const void *a, const void *b)
+{
+	const struct row *r1 = a;
+	const struct row *r2 = b;
+
+	if (r1->cpu != r2->cpu)
+		return ((r1->cpu < r2->cpu) ? 1 : -1);
+
+	return (r1->curr->pid - r2->curr->pid);
+}
+
+/*
+ * Prints activity over the last interval.
+ */
+static void report(int curr, uint64_t interval)
+{
+	int i;
+	unsigned ms;
+	const struct pstat *p;
+
+	for (i = 0; i < nsnapshots[curr]; i++)
+	{
+		rows[i].curr = &snapshots[curr][i];
+		diff(&rows[i], lookup(!curr, rows[i].curr->pid), interval);
+	}
+
+	qsort(rows, nsnapshots[curr], sizeof(struct row), cmprow);
+
+	if (!args.batch)
+		ioctl(fileno(stdout), TTY_CLEAR);
+
+	printf("%d processes, interval %u s\n\n", nsnapshots[curr], args.delay);
+	printf("  PID NAME         S  %%CPU     TIME MINFLT MAJFLT   COW  INBLK  OUBLK  VCSW IVCSW  SYSC\n");
+
+	for (i = 0; i < nsnapshots[curr]; i++)
+	{
+		p = rows[i].curr;
+		ms = (unsigned)((p->utime + p->ktime)/NSEC_PER_MSEC);
+
+		printf("%5d %-12.12s %c %3u.%u %5u.%02u %6u %6u %5u %6u %6u %5u %5u %5u\n",
+			(int)p->pid,
+			p->name,
+			((unsigned)p->state < sizeof(states) - 1) ? states[p->state] : '?',
+			rows[i].cpu/10, rows[i].cpu%10,
+			ms/1000, (ms%1000)/10,
+			(unsigned)rows[i].delta.minflt,
+			(unsigned)rows[i].delta.majflt,
+			(unsigned)rows[i].delta.cowflt,
+			(unsigned)rows[i].delta.inblock,
+			(unsigned)rows[i].delta.oublock,
+			(unsigned)rows[i].delta.nvcsw,
+			(unsigned)rows[i].delta.nivcsw,
+			(unsigned)rows[i].delta.nsyscalls
+		);
+	}
+
+	fflush(stdout);
+}
+
+/*
+ * Displays process activity.
+ */
+int main(int argc, char *const argv[])
+{
+	int curr;
+
+	getargs(argc, argv);
+
+	curr = 0;
+	if ((nsnapshots[curr] = pstat(snapshots[curr], NR_SNAPSHOT)) < 0)
+	{
+		fprintf(stderr, "top: cannot get process table\n");
+		return (EXIT_FAILURE);
+	}
+
+	while (args.iterations != 0)
+	{
+		sleep(args.delay);
+
+		curr = !curr;
+		if ((nsnapshots[curr] = pstat(snapshots[curr], NR_SNAPSHOT)) < 0)
+		{
+			fprintf(stderr, "top: cannot get process table\n");
+			return (EXIT_FAILURE);
+		}
+
+		report(curr, (uint64_t)args.delay*1000*NSEC_PER_MSEC);
+
+		if (args.iterations > 0)
+			args.iterations--;
+	}
+
+	return (EXIT_SUCCESS);
+}
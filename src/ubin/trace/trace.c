@@ -0,0 +1,249 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dev/trace.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stropts.h>
+#include <unistd.h>
+
+/* Software versioning. */
+#define VERSION_MAJOR 1 /* Major version. */
+#define VERSION_MINOR 0 /* Minor version. */
+
+/* Tracer device. */
+#define TRACE_DEVICE "/dev/trace"
+
+/*
+ * Marker of trace lines, so that they can be picked out of a serial log.
+ */
+#define TRACE_MARKER "@trace"
+
+/* Commands. */
+#define CMD_NONE  0 /* No command.                */
+#define CMD_START 1 /* Start tracing.             */
+#define CMD_STOP  2 /* Stop tracing.              */
+#define CMD_RESET 3 /* Discard events.            */
+#define CMD_DUMP  4 /* Print events.              */
+#define CMD_RUN   5 /* Trace a command.           */
+
+/*
+ * Program arguments.
+ */
+static struct
+{
+	int cmd;           /* Command.         */
+	char *const *argv; /* Command to trace. */
+} args = { CMD_NONE, NULL };
+
+/*
+ * Prints program version and exits.
+ */
+static void version(void)
+{
+	printf("trace (Nanvix Coreutils) %d.%d\n\n", VERSION_MAJOR, VERSION_MINOR);
+	printf("Copyright(C) 2011-2016 Pedro H. Penna\n");
+	printf("This is free software under the ");
+	printf("GNU General Public License Version 3.\n");
+	printf("There is NO WARRANTY, to the extent permitted by law.\n\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: trace [options] <command>\n\n");
+	printf("Brief: Controls the kernel event tracer.\n\n");
+	printf("Commands:\n");
+	printf("  start              Start tracing\n");
+	printf("  stop               Stop tracing\n");
+	printf("  reset              Discard recorded events\n");
+	printf("  dump               Print recorded events\n");
+	printf("  run <cmd> [args]   Trace a command and print its events\n\n");
+	printf("Options:\n");
+	printf("  --help             Display this information and exit\n");
+	printf("  --version          Display program version and exit\n");
+
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Gets program arguments.
+ */
+static void getargs(int argc, char *const argv[])
+{
+	int i;     /* Loop index.       */
+	char *arg; /* Current argument. */
+
+	/* Read command line arguments. */
+	for (i = 1; i < argc; i++)
+	{
+		arg = argv[i];
+
+		/* Parse command line argument. */
+		if (!strcmp(arg, "--help")) {
+			usage();
+		}
+		else if (!strcmp(arg, "--version")) {
+			version();
+		}
+		else if (!strcmp(arg, "start")) {
+			args.cmd = CMD_START;
+		}
+		else if (!strcmp(arg, "stop")) {
+			args.cmd = CMD_STOP;
+		}
+		else if (!strcmp(arg, "reset")) {
+			args.cmd = CMD_RESET;
+		}
+		else if (!strcmp(arg, "dump")) {
+			args.cmd = CMD_DUMP;
+		}
+		else if (!strcmp(arg, "run")) {
+			args.cmd = CMD_RUN;
+			args.argv = &argv[i + 1];
+			break;
+		}
+		else {
+			fprintf(stderr, "trace: bad argument %s\n", arg);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* Missing command. */
+	if ((args.cmd == CMD_NONE) || ((args.cmd == CMD_RUN) && (args.argv[0] == NULL)))
+		usage();
+}
+
+/*
+ * Prints recorded events, one per line.
+ *
+ * Lines are plain text, so that they survive the serial port and can be
+ * decoded on the host regardless of the target byte order.
+ */
+static int dump(int fd)
+{
+	int i;                          /* Loop index.   */
+	int lost;                       /* Lost events.  */
+	ssize_t n;                      /* Bytes read.   */
+	struct trace_event events[32];  /* Event buffer. */
+	struct trace_event *e;          /* Working event. */
+
+	while ((n = read(fd, events, sizeof(events))) > 0)
+	{
+		for (i = 0; i < (int)(n/sizeof(struct trace_event)); i++)
+		{
+			e = &events[i];
+			printf("%s %x %08x%08x %x %d %x %x %x\n",
+				TRACE_MARKER,
+				(unsigned)e->seq,
+				(unsigned)(e->ts >> 32),
+				(unsigned)(e->ts & 0xffffffff),
+				(unsigned)e->type,
+				(int)e->pid,
+				(unsigned)e->arg[0],
+				(unsigned)e->arg[1],
+				(unsigned)e->arg[2]
+			);
+		}
+	}
+
+	if ((lost = ioctl(fd, TRACE_LOST)) > 0)
+		printf("%s lost %d\n", TRACE_MARKER, lost);
+
+	return ((n < 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*
+ * Traces a command.
+ */
+static int run(int fd)
+{
+	pid_t pid;  /* Child process. */
+	int status; /* Exit status.   */
+
+	ioctl(fd, TRACE_RESET);
+	ioctl(fd, TRACE_START);
+
+	if (posix_spawnp(&pid, args.argv[0], NULL, NULL, args.argv, environ) != 0)
+	{
+		ioctl(fd, TRACE_STOP);
+		fprintf(stderr, "trace: cannot run %s\n", args.argv[0]);
+		return (EXIT_FAILURE);
+	}
+
+	while (wait(&status) != pid)
+		/* noop */ ;
+
+	ioctl(fd, TRACE_STOP);
+
+	return (dump(fd));
+}
+
+/*
+ * Controls the kernel event tracer.
+ */
+int main(int argc, char *const argv[])
+{
+	int fd, ret;
+
+	getargs(argc, argv);
+
+	if ((fd = open(TRACE_DEVICE, O_RDONLY)) < 0)
+	{
+		fprintf(stderr, "trace: cannot open %s\n", TRACE_DEVICE);
+		return (EXIT_FAILURE);
+	}
+
+	switch (args.cmd)
+	{
+		case CMD_START:
+			ret = (ioctl(fd, TRACE_START) < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+			break;
+
+		case CMD_STOP:
+			ret = (ioctl(fd, TRACE_STOP) < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+			break;
+
+		case CMD_RESET:
+			ret = (ioctl(fd, TRACE_RESET) < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+			break;
+
+		case CMD_DUMP:
+			ret = dump(fd);
+			break;
+
+		default:
+			ret = run(fd);
+			break;
+	}
+
+	close(fd);
+
+	return (ret);
+}
@@ -27,6 +27,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -162,10 +163,15 @@ static void closeredir(int *redir)
  */
 static void runcmd(const char **args, int argc, int *redir, int flags)
 {
-	int i;         /* Loop index.       */
-	int status;    /* Exit status.      */
-	pid_t pid;     /* Child process ID. */
-	builtin_t cmd; /* Built-in command. */
+	int i;                              /* Loop index.          */
+	int status;                         /* Exit status.         */
+	pid_t pid;                          /* Child process ID.    */
+	builtin_t cmd;                      /* Built-in command.    */
+	sigset_t sigdefault;                /* Signals to reset.    */
+	posix_spawnattr_t attr;             /* Spawn attributes.    */
+	posix_spawn_file_actions_t actions; /* Spawn file actions.  */
+	void (*oldint)(int);                /* Old SIGINT handler.  */
+	void (*oldquit)(int);               /* Old SIGQUIT handler. */
 
 	/* Checks built-in. */
 	if ((cmd = getbuiltin(args[0])) != NULL)
@@ -176,94 +182,101 @@ static void runcmd(const char **args, int argc, int *redir, int flags)
 		return;
 	}
 
-	pid = fork();
-
-	/* Failed to fork. */
-	if (pid < 0)
+	/* Build file actions. */
+	if ((errno = posix_spawn_file_actions_init(&actions)) != 0)
+		goto error0;
+	if (flags & CMD_ASYNC)
 	{
-		fprintf(stderr, "%s: failed to fork child\n", TSH_NAME);
-		shret = errno;
-		goto error;
+		if (redir[0] == -1)
+		{
+			errno = posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+			if (errno != 0)
+				goto error1;
+		}
 	}
-
-	/* Parent process. */
-	if (pid > 0)
+	for (i = 0; i < 2; i++)
 	{
-		closeredir(redir);
-
-		/* Piping... */
-		if (flags & CMD_PIPE)
-			return;
-
-		/* Asynchronous execution. */
-		if (flags & CMD_ASYNC)
+		if (redir[i] != -1)
 		{
-			printf("[%d]+\n", pid);
-			return;
+			if ((errno = posix_spawn_file_actions_adddup2(&actions, redir[i], i)) != 0)
+				goto error1;
+			if ((errno = posix_spawn_file_actions_addclose(&actions, redir[i])) != 0)
+				goto error1;
 		}
+	}
 
-		/* Wait child. */
-		while (wait(&status) != pid)
-			/* noop */;
+	/* Build attributes. */
+	if ((errno = posix_spawnattr_init(&attr)) != 0)
+		goto error1;
+	sigdefault = (1 << SIGTERM) | (1 << SIGTSTP);
+	if (!(flags & CMD_ASYNC))
+		sigdefault |= (1 << SIGINT) | (1 << SIGQUIT);
+	posix_spawnattr_setsigdefault(&attr, &sigdefault);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+	/* Asynchronous commands ignore interrupts. */
+	oldint = oldquit = SIG_DFL;
+	if (flags & CMD_ASYNC)
+	{
+		oldint = signal(SIGINT, SIG_IGN);
+		oldquit = signal(SIGQUIT, SIG_IGN);
+	}
 
-		/* Abnormal termination. */
-		if (status != EXIT_SUCCESS)
-		{
-			/* Signal. */
-			if (WIFSIGNALED(status))
-				sigmsg(shret = WTERMSIG(status));
+	errno = posix_spawnp(&pid, args[0], &actions, &attr, (char * const *)args, environ);
 
-			/* Voluntary. */
-			else if (WIFEXITED(status))
-				shret = WEXITSTATUS(status);
+	if (flags & CMD_ASYNC)
+	{
+		signal(SIGINT, oldint);
+		signal(SIGQUIT, oldquit);
+	}
 
-			/* Stopped. */
-			else if  (WIFSTOPPED(status))
-				printf("[%d]+\tStopped\n", pid);
-		}
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
 
-		return;
-	}
+	/* Failed to spawn. */
+	if (errno != 0)
+		goto error0;
 
-	/*
-	 * Child process.
-	 */
+	closeredir(redir);
+
+	/* Piping... */
+	if (flags & CMD_PIPE)
+		return;
 
-	/* Reset signals. */
-	signal(SIGINT, SIG_DFL);
-	signal(SIGQUIT, SIG_DFL);
-	signal(SIGTERM, SIG_DFL);
-	signal(SIGTSTP, SIG_DFL);
+	/* Asynchronous execution. */
 	if (flags & CMD_ASYNC)
 	{
-		signal(SIGINT, SIG_IGN);
-		signal(SIGQUIT, SIG_IGN);
-		if (redir[0] == -1)
-		{
-			close(0);
-			open("/dev/null", O_RDONLY);
-		}
+		printf("[%d]+\n", pid);
+		return;
 	}
 
-	/* Redirections. */
-	for (i = 0; i < 2; i++)
+	/* Wait child. */
+	while (wait(&status) != pid)
+		/* noop */;
+
+	/* Abnormal termination. */
+	if (status != EXIT_SUCCESS)
 	{
-		if (redir[i] != -1)
-		{
-			if (dup2(redir[i], i) == -1)
-			{
-				fprintf(stderr, "%s: failed to redirect\n", args[0]);
-				exit(EXIT_FAILURE);
-			}
-			close(redir[i]);
-		}
+		/* Signal. */
+		if (WIFSIGNALED(status))
+			sigmsg(shret = WTERMSIG(status));
+
+		/* Voluntary. */
+		else if (WIFEXITED(status))
+			shret = WEXITSTATUS(status);
+
+		/* Stopped. */
+		else if  (WIFSTOPPED(status))
+			printf("[%d]+\tStopped\n", pid);
 	}
 
-	execvp(args[0], (char * const *)args);
-	fprintf(stderr, "%s: failed to execute\n", args[0]);
-	exit(EXIT_FAILURE);
+	return;
 
-error:
+error1:
+	posix_spawn_file_actions_destroy(&actions);
+error0:
+	fprintf(stderr, "%s: failed to execute\n", args[0]);
+	shret = errno;
 	sherror();
 	closeredir(redir);
 }
@@ -498,6 +511,9 @@ static void ppipe(char *pipeblk, int flags)
 					shret = errno;
 					goto error0;
 				};
+				/* Children get pipe ends through redirections only. */
+				fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+				fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
 				redir[1] = pipefd[1];
 				pcmd(lastcmd, redir, flags | CMD_PIPE);
 				lastcmd = p + 1;
@@ -63,120 +63,40 @@ function eject {
 }
 
 # Generate passwords file
-#   $1 Disk image name.
+#   $1 Staging directory.
 #
 function passwords
 {
-	file="passwords"
+	file="$1/etc/passwords"
 	
 	$QEMU_VIRT bin/useradd $file root root $ROOTGID $ROOTUID
 	$QEMU_VIRT bin/useradd $file noob noob $NOOBUID $NOOBUID
-
-	chmod 600 $file
-	
-	$QEMU_VIRT bin/cp.minix $1 $file /etc/$file $ROOTUID $ROOTGID
-	
-	# House keeping.
-	rm -f $file
 }
 
 #
-# Formats a disk.
-#   $1 Disk image name.
-#   $2 Number of inodes.
-#   $3 File system size (in blocks).
-#
-function format {
-	$QEMU_VIRT bin/mkfs.minix $1 $2 $3 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /etc $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /sbin $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /bin $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/rep1 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/rep2 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /dev $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/mysem/ $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/null 666 c 0 0 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/tty 666 c 0 1 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/klog 666 c 0 2 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/ramdisk 666 b 0 0 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/ramdisk1 666 b 1 0 $ROOTUID $ROOTGID
-}
-
-#
-# Copy a given folder (and its files) to a root directory disk image.
-#   $1 Disk image name.
-#   $2 Target Folder
+# Stages the files of a disk image in a directory.
+#   $1 Staging directory.
 #
-function copy_folder
+function stage_files
 {
-	disk="$1"
-	folder="$2"
-
-	# Seems like mkdir.minix do not works well with leading '/'
-	# lets check and remove if any
-	if [ "${folder: -1}" = "/" ];
-	then
-		folder=${folder%?}
-	fi
-
-	complete_path=$(readlink -f "$folder")
-	basefolder=$(basename "$folder")
-	prefix=$(dirname "$complete_path")
-
-	# Make directories first
-	find "$complete_path" -type d -print0 | while read -d $'\0' cfolder
-	do
-		newpath=${cfolder#"$prefix"}
-		if [ "${newpath:0:1}" != "/" ];
-		then
-			newpath="/$newpath"
-		fi
-
-		echo "Creating $newpath folder..."
-		$QEMU_VIRT bin/mkdir.minix "$disk" "$newpath" "$ROOTUID" "$ROOTGID"
-	done
-	echo ""
-
-	# Copy files
-	find "$complete_path" -type f -print0 | while read -d $'\0' cfolder
-	do
-		newpath=${cfolder#"$prefix"}
-		if [ "${newpath:0:1}" != "/" ];
-		then
-			newpath="/$newpath"
-		fi
-
-		echo "Copying $cfolder file into $newpath..."
-		$QEMU_VIRT bin/cp.minix "$disk" "$cfolder" "$newpath" "$ROOTUID" "$ROOTGID"
-	done
-	echo ""
-}
-
-#
-# Copy files to a disk image.
-#   $1 Target disk image.
-#
-function copy_files
-{
-	chmod 666 tools/img/inittab
-	chmod 600 tools/img/inittab
+	mkdir -p $1/{etc,sbin,bin,boot}
 	
-	$QEMU_VIRT bin/cp.minix $1 tools/img/inittab /etc/inittab $ROOTUID $ROOTGID
+	cp tools/img/inittab $1/etc/inittab
 	
 	passwords $1
 	
+	# Kernel image, for symbolizing profiles.
+	cp bin/kernel $1/boot/kernel
+	
 	for file in bin/sbin/*; do
-		filename=`basename $file`
-		if [[ "$filename" != *.sym ]]; then
-			$QEMU_VIRT bin/cp.minix $1 $file /sbin/$filename $ROOTUID $ROOTGID
+		if [[ "$file" != *.sym ]]; then
+			cp $file $1/sbin/
 		fi;
 	done
 	
 	for file in bin/ubin/*; do
-		filename=`basename $file`
-		if [[ "$filename" != *.sym ]]; then
-			$QEMU_VIRT bin/cp.minix $1 $file /bin/$filename $ROOTUID $ROOTGID
+		if [[ "$file" != *.sym ]]; then
+			cp $file $1/bin/
 		fi;
 	done
 
@@ -192,14 +112,32 @@ function copy_files
 
 		echo "Copying $(basename $folder) port into initrd..."
 
-		# Iterate over each folder and copy them into the disk image
 		for targ_folder in $(ls -d $folder/binaries/*)
 		do
-			copy_folder initrd.img $targ_folder
+			cp -r "$targ_folder" $1/
 		done
 	done
 }
 
+#
+# Builds a disk image in a single pass.
+#   $1 Disk image name.
+#   $2 Number of inodes.
+#   $3 File system size (in blocks).
+#
+function build
+{
+	stage=$(mktemp -d)
+	
+	stage_files $stage
+	
+	$QEMU_VIRT bin/mkfs.minix $1 $2 $3 $ROOTUID $ROOTGID \
+		--from-dir $stage tools/img/manifest
+	
+	# House keeping.
+	rm -rf $stage
+}
+
 #
 # Strip a binary from it's debug symbols and
 # add a GNU debug link to the original binary
@@ -256,14 +194,14 @@ else
 	if [ "$BUILD_HD_IMAGE" -eq 1 ];
 	then
 		dd if=/dev/zero of=hdd.img bs=1024 count=65536
-		format hdd.img 1024 32768
-		copy_files hdd.img
+		build hdd.img 1024 32768
 	fi
 
 	# Build initrd image.
 	dd if=/dev/zero of=initrd.img bs=1024 count=65536
-	format initrd.img 1024 64535
-	copy_files initrd.img
+	build initrd.img 1024 64535
+	$QEMU_VIRT bin/mkinitrd initrd.img initrd.lz4
+	mv initrd.lz4 initrd.img
 	initrdsize=`stat -c %s initrd.img`
 	maxsize=`grep "INITRD_SIZE" include/nanvix/config.h | grep -Po "(0x[0-9]+|[0-9]+)"`
 	maxsize=`printf "%d\n" $maxsize`
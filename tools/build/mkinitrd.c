@@ -0,0 +1,264 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Packs a RAM disk image into the compressed initrd format (see
+ * <dev/ramdisk.h>). The image is cut into fixed-size chunks, and each one
+ * is compressed on its own as an LZ4 block, so the kernel can decompress
+ * only the chunks that are touched.
+ */
+
+#include <ramdisk.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* LZ4 parameters. */
+#define MINMATCH     4 /* Minimum match length.                     */
+#define LASTLITERALS 5 /* Trailing bytes that must be literals.     */
+#define MFLIMIT     12 /* A match must start this far from the end. */
+#define MAX_DISTANCE 65535
+
+/* Match finder hash table. */
+#define HASH_LOG  12
+#define HASH_SIZE (1 << HASH_LOG)
+
+/* Worst-case size of a compressed chunk. */
+#define BOUND (RAMDISK_CHUNK_SIZE + RAMDISK_CHUNK_SIZE/255 + 16)
+
+/*
+ * Reads 4 bytes.
+ */
+static uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return (v);
+}
+
+/*
+ * Hashes 4 bytes.
+ */
+static unsigned hash(uint32_t v)
+{
+	return ((v*2654435761u) >> (32 - HASH_LOG));
+}
+
+/*
+ * Writes an LZ4 length extension.
+ */
+static uint8_t *putlen(uint8_t *op, size_t len)
+{
+	for (/* noop */; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = (uint8_t)len;
+
+	return (op);
+}
+
+/*
+ * Writes an LZ4 sequence.
+ */
+static uint8_t *sequence
+(uint8_t *op, const uint8_t *lit, size_t nlit, size_t offset, size_t mlen)
+{
+	uint8_t *token;
+
+	token = op++;
+	*token = (uint8_t)(((nlit < 15) ? nlit : 15) << 4);
+	if (nlit >= 15)
+		op = putlen(op, nlit - 15);
+	memcpy(op, lit, nlit);
+	op += nlit;
+
+	/* Last sequence. */
+	if (mlen == 0)
+		return (op);
+
+	*op++ = (uint8_t)(offset & 0xff);
+	*op++ = (uint8_t)(offset >> 8);
+
+	mlen -= MINMATCH;
+	*token |= (uint8_t)((mlen < 15) ? mlen : 15);
+	if (mlen >= 15)
+		op = putlen(op, mlen - 15);
+
+	return (op);
+}
+
+/*
+ * Compresses a chunk as an LZ4 block with a greedy match finder.
+ */
+static size_t compress(const uint8_t *src, size_t n, uint8_t *dst)
+{
+	size_t ip;                  /* Read position.       */
+	size_t anchor;              /* First pending literal. */
+	uint8_t *op;                /* Write pointer.       */
+	uint32_t table[HASH_SIZE];  /* Last position + 1.   */
+
+	memset(table, 0, sizeof(table));
+
+	op = dst;
+	ip = anchor = 0;
+
+	while ((n > MFLIMIT) && (ip < n - MFLIMIT))
+	{
+		size_t ref;
+		size_t mlen;
+		unsigned h;
+
+		h = hash(read32(&src[ip]));
+		ref = table[h];
+		table[h] = (uint32_t)(ip + 1);
+
+		/* No match. */
+		if ((ref-- == 0) || (ip - ref > MAX_DISTANCE)
+			|| (read32(&src[ref]) != read32(&src[ip])))
+		{
+			ip++;
+			continue;
+		}
+
+		mlen = MINMATCH;
+		while ((ip + mlen < n - LASTLITERALS) && (src[ref + mlen] == src[ip + mlen]))
+			mlen++;
+
+		op = sequence(op, &src[anchor], ip - anchor, ip - ref, mlen);
+		ip += mlen;
+		anchor = ip;
+	}
+
+	op = sequence(op, &src[anchor], n - anchor, 0, 0);
+
+	return ((size_t)(op - dst));
+}
+
+/*
+ * Asserts if a chunk is all zeros.
+ */
+static int zeroed(const uint8_t *chunk)
+{
+	for (size_t i = 0; i < RAMDISK_CHUNK_SIZE; i++)
+	{
+		if (chunk[i] != 0)
+			return (0);
+	}
+
+	return (1);
+}
+
+/*
+ * Packs a RAM disk image.
+ */
+int main(int argc, char **argv)
+{
+	long size;                    /* Image size.             */
+	FILE *in, *out;               /* Input and output files. */
+	uint8_t *image;               /* Uncompressed image.     */
+	uint8_t *data;                /* Compressed chunks.      */
+	uint32_t *index;              /* Chunk index.            */
+	struct ramdisk_header header; /* Image header.           */
+	static uint8_t buf[BOUND];    /* Compressed chunk.       */
+
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: mkinitrd <image> <output>\n");
+		return (EXIT_FAILURE);
+	}
+
+	if ((in = fopen(argv[1], "rb")) == NULL)
+	{
+		perror(argv[1]);
+		return (EXIT_FAILURE);
+	}
+
+	fseek(in, 0, SEEK_END);
+	size = ftell(in);
+	rewind(in);
+
+	header.magic = RAMDISK_MAGIC;
+	header.chunk_size = RAMDISK_CHUNK_SIZE;
+	header.nchunks = (uint32_t)((size + RAMDISK_CHUNK_SIZE - 1)/RAMDISK_CHUNK_SIZE);
+	header.size = header.nchunks*RAMDISK_CHUNK_SIZE;
+
+	image = calloc(header.size, 1);
+	data = malloc(header.size);
+	index = malloc((header.nchunks + 1)*sizeof(uint32_t));
+	if ((image == NULL) || (data == NULL) || (index == NULL))
+	{
+		fprintf(stderr, "mkinitrd: out of memory\n");
+		return (EXIT_FAILURE);
+	}
+
+	if (fread(image, 1, size, in) != (size_t)size)
+	{
+		perror(argv[1]);
+		return (EXIT_FAILURE);
+	}
+	fclose(in);
+
+	/* Compress chunks. */
+	index[0] = 0;
+	for (uint32_t i = 0; i < header.nchunks; i++)
+	{
+		size_t len;
+		const uint8_t *chunk;
+
+		chunk = &image[i*RAMDISK_CHUNK_SIZE];
+
+		/* Zero chunk. */
+		if (zeroed(chunk))
+			len = 0;
+
+		/* Incompressible chunk. */
+		else if ((len = compress(chunk, RAMDISK_CHUNK_SIZE, buf)) >= RAMDISK_CHUNK_SIZE)
+		{
+			len = RAMDISK_CHUNK_SIZE;
+			memcpy(&data[index[i]], chunk, len);
+		}
+
+		else
+			memcpy(&data[index[i]], buf, len);
+
+		index[i + 1] = index[i] + (uint32_t)len;
+	}
+
+	if ((out = fopen(argv[2], "wb")) == NULL)
+	{
+		perror(argv[2]);
+		return (EXIT_FAILURE);
+	}
+
+	fwrite(&header, sizeof(header), 1, out);
+	fwrite(index, sizeof(uint32_t), header.nchunks + 1, out);
+	fwrite(data, 1, index[header.nchunks], out);
+	fclose(out);
+
+	printf("mkinitrd: %u bytes packed into %u bytes\n", (unsigned)header.size,
+		(unsigned)(sizeof(header) + (header.nchunks + 1)*sizeof(uint32_t) + index[header.nchunks]));
+
+	free(index);
+	free(data);
+	free(image);
+
+	return (EXIT_SUCCESS);
+}
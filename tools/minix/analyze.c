@@ -0,0 +1,538 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitmap.h"
+#include "minix.h"
+#include "stat.h"
+#include "util.h"
+
+/**
+ * @brief Maximum length of a path name.
+ */
+#define PATH_MAX_LEN 1024
+
+/**
+ * @brief Directory entries per block.
+ */
+#define DIRENTS_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_dirent))
+
+/**
+ * @brief Block access.
+ */
+struct access
+{
+	block_t blk;   /**< Physical block.         */
+	unsigned logic; /**< Logic block in the file. */
+	bool indirect; /**< Indirect block?         */
+};
+
+/**
+ * @brief Image-wide totals.
+ */
+static struct
+{
+	unsigned nfiles;     /**< Regular files.                 */
+	unsigned fragmented; /**< Files with more than one extent. */
+	unsigned extents;    /**< Extents.                       */
+	unsigned long seek;  /**< Seek distance (in blocks).      */
+	unsigned ndirs;      /**< Directories.                   */
+	unsigned indirect;   /**< Indirect blocks.               */
+} totals;
+
+/**
+ * @brief Cold-read simulation.
+ */
+static struct
+{
+	uint32_t *cached; /**< Blocks that were already read. */
+	block_t last;     /**< Last block read.               */
+	unsigned ios;     /**< Block reads.                   */
+	unsigned seeks;   /**< Non-sequential block reads.    */
+	unsigned long seek; /**< Seek distance (in blocks).   */
+} cold;
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("usage: analyze.minix <input file> [<file>...]\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Prints a JSON string.
+ *
+ * @param str String to print.
+ */
+static void json_string(const char *str)
+{
+	putchar('"');
+	for (const char *p = str; *p != '\0'; p++)
+	{
+		if ((*p == '"') || (*p == '\\'))
+			printf("\\%c", *p);
+		else if ((unsigned char)*p < 0x20)
+			printf("\\u%04x", (unsigned char)*p);
+		else
+			putchar(*p);
+	}
+	putchar('"');
+}
+
+/**
+ * @brief Distance between two blocks read in a row.
+ *
+ * @param prev Previous block.
+ * @param next Next block.
+ *
+ * @returns Zero if @p next follows @p prev on disk, and the number of blocks
+ *          the disk head has to travel otherwise.
+ */
+static unsigned long distance(block_t prev, block_t next)
+{
+	return ((next > prev) ? next - prev - 1 : prev - next + 1);
+}
+
+/**
+ * @brief Computes the blocks that a sequential read of a file touches.
+ *
+ * @param ip  File.
+ * @param seq Place to store the block accesses.
+ *
+ * @returns The number of block accesses, in the order they happen.
+ */
+static unsigned file_sequence(struct d_inode *ip, struct access **seq)
+{
+	unsigned n;                            /* Number of accesses.  */
+	unsigned nblocks;                      /* Data blocks.         */
+	block_t single;                        /* Single indirect blk. */
+	zone_t dbl[BLOCK_SIZE/sizeof(zone_t)]; /* Double indirect blk. */
+	
+	nblocks = (ip->i_size + BLOCK_SIZE - 1)/BLOCK_SIZE;
+	*seq = smalloc((nblocks + nblocks/NR_SINGLE + 3)*sizeof(struct access));
+	n = 0;
+	
+	for (unsigned i = 0; i < nblocks; i++)
+	{
+		block_t blk;
+		
+		/* First block of the single indirect zone. */
+		if ((i == NR_ZONES_DIRECT) && (ip->i_zones[ZONE_SINGLE] != BLOCK_NULL))
+		{
+			(*seq)[n].blk = ip->i_zones[ZONE_SINGLE];
+			(*seq)[n].logic = i;
+			(*seq)[n++].indirect = true;
+		}
+		
+		/* Double indirect zone. */
+		else if (i >= NR_ZONES_DIRECT + NR_SINGLE)
+		{
+			unsigned j = i - NR_ZONES_DIRECT - NR_SINGLE;
+			
+			if (ip->i_zones[ZONE_DOUBLE] == BLOCK_NULL)
+				continue;
+			
+			if (j == 0)
+			{
+				(*seq)[n].blk = ip->i_zones[ZONE_DOUBLE];
+				(*seq)[n].logic = i;
+				(*seq)[n++].indirect = true;
+				minix_block_read(ip->i_zones[ZONE_DOUBLE], dbl);
+			}
+			
+			if ((j%NR_SINGLE == 0) && ((single = dbl[j/NR_SINGLE]) != BLOCK_NULL))
+			{
+				(*seq)[n].blk = single;
+				(*seq)[n].logic = i;
+				(*seq)[n++].indirect = true;
+			}
+		}
+		
+		/* Holes are not read. */
+		if ((blk = minix_bmap(ip, i*BLOCK_SIZE)) == BLOCK_NULL)
+			continue;
+		
+		(*seq)[n].blk = blk;
+		(*seq)[n].logic = i;
+		(*seq)[n++].indirect = false;
+	}
+	
+	return (n);
+}
+
+/**
+ * @brief Reads a block in the cold-read simulation.
+ *
+ * @param blk Block number.
+ */
+static void cold_touch(block_t blk)
+{
+	if (cold.cached[IDX(blk)] & (1 << OFF(blk)))
+		return;
+	
+	cold.cached[IDX(blk)] |= 1 << OFF(blk);
+	cold.ios++;
+	if ((cold.ios > 1) && (blk != cold.last + 1))
+	{
+		cold.seeks++;
+		cold.seek += distance(cold.last, blk);
+	}
+	cold.last = blk;
+}
+
+/**
+ * @brief Reads an inode in the cold-read simulation.
+ *
+ * @param num Inode number.
+ */
+static void cold_inode(uint16_t num)
+{
+	const struct d_superblock *super;
+	unsigned inodes_per_block;
+	
+	super = minix_super();
+	inodes_per_block = BLOCK_SIZE/sizeof(struct d_inode);
+	cold_touch(2 + super->s_imap_nblocks + super->s_bmap_nblocks
+		+ (num - 1)/inodes_per_block);
+}
+
+/**
+ * @brief Simulates a cold read of a file, including its path lookup.
+ *
+ * @param pathname File to read.
+ *
+ * @returns The number of block reads that the file needed.
+ */
+static unsigned cold_read(const char *pathname)
+{
+	unsigned ios;                      /* Block reads so far.   */
+	uint16_t num;                      /* Working inode number. */
+	struct d_inode *ip;                /* Working inode.        */
+	struct access *seq;                /* Block accesses.       */
+	unsigned n;                        /* Number of accesses.   */
+	char filename[MINIX_NAME_MAX + 1]; /* Working file name.    */
+	struct d_dirent buf[DIRENTS_PER_BLOCK]; /* Directory block. */
+	
+	ios = cold.ios;
+	
+	num = INODE_ROOT;
+	cold_inode(num);
+	
+	while (*pathname != '\0')
+	{
+		uint16_t next = INODE_NULL;
+		unsigned nentries;
+		
+		/* Trailing slash. */
+		pathname = break_path(pathname, filename);
+		if (*filename == '\0')
+			break;
+		
+		ip = minix_inode_read(num);
+		if (!S_ISDIR(ip->i_mode))
+			error("not a directory");
+		nentries = ip->i_size/sizeof(struct d_dirent);
+		
+		/* Linear search, one directory block at a time. */
+		n = file_sequence(ip, &seq);
+		for (unsigned i = 0; (i < n) && (next == INODE_NULL); i++)
+		{
+			cold_touch(seq[i].blk);
+			if (seq[i].indirect)
+				continue;
+			
+			minix_block_read(seq[i].blk, buf);
+			for (unsigned j = 0; j < DIRENTS_PER_BLOCK; j++)
+			{
+				if (seq[i].logic*DIRENTS_PER_BLOCK + j >= nentries)
+					break;
+				if (buf[j].d_ino == INODE_NULL)
+					continue;
+				if (!strncmp(buf[j].d_name, filename, MINIX_NAME_MAX))
+				{
+					next = buf[j].d_ino;
+					break;
+				}
+			}
+		}
+		free(seq);
+		free(ip);
+		
+		if (next == INODE_NULL)
+			error("no such file");
+		
+		num = next;
+		cold_inode(num);
+	}
+	
+	/* File contents. */
+	ip = minix_inode_read(num);
+	n = file_sequence(ip, &seq);
+	for (unsigned i = 0; i < n; i++)
+		cold_touch(seq[i].blk);
+	free(seq);
+	free(ip);
+	
+	return (cold.ios - ios);
+}
+
+/**
+ * @brief Reports a regular file.
+ *
+ * @param path Path of the file.
+ * @param num  Inode number of the file.
+ * @param ip   File.
+ */
+static void report_file(const char *path, uint16_t num, struct d_inode *ip)
+{
+	struct access *seq;     /* Block accesses.      */
+	unsigned n;             /* Number of accesses.  */
+	unsigned extents;       /* Extents.             */
+	unsigned nindirect;     /* Indirect blocks.     */
+	unsigned long seek;     /* Seek distance.       */
+	unsigned hops;          /* Indirection levels.  */
+	
+	n = file_sequence(ip, &seq);
+	
+	extents = (n > 0) ? 1 : 0;
+	nindirect = 0;
+	seek = 0;
+	for (unsigned i = 0; i < n; i++)
+	{
+		if (seq[i].indirect)
+			nindirect++;
+		if ((i > 0) && (seq[i].blk != seq[i - 1].blk + 1))
+		{
+			extents++;
+			seek += distance(seq[i - 1].blk, seq[i].blk);
+		}
+	}
+	free(seq);
+	
+	hops = 0;
+	if (ip->i_zones[ZONE_DOUBLE] != BLOCK_NULL)
+		hops = 2;
+	else if (ip->i_zones[ZONE_SINGLE] != BLOCK_NULL)
+		hops = 1;
+	
+	totals.nfiles++;
+	totals.extents += extents;
+	totals.seek += seek;
+	totals.indirect += nindirect;
+	if (extents > 1)
+		totals.fragmented++;
+	
+	printf("%s\n    {\"path\": ", (totals.nfiles > 1) ? "," : "");
+	json_string(path);
+	printf(", \"inode\": %u, \"size\": %u, \"blocks\": %u, \"indirect\": %u, "
+		"\"hops\": %u, \"extents\": %u, \"seek\": %lu}",
+		num, ip->i_size, n - nindirect, nindirect, hops, extents, seek);
+}
+
+/**
+ * @brief Walks the file system tree, reporting regular files.
+ *
+ * @param path Path of the directory.
+ * @param num  Inode number of the directory.
+ * @param dirs Report directories instead of regular files?
+ */
+static void walk(char *path, uint16_t num, bool dirs)
+{
+	struct d_inode *ip;  /* Directory.          */
+	struct d_dirent *d;  /* Directory entries.  */
+	unsigned nentries;   /* Number of entries.  */
+	unsigned nused;      /* Entries in use.     */
+	unsigned long cost;  /* Total lookup cost.  */
+	unsigned maxcost;    /* Worst lookup cost.  */
+	size_t len;          /* Length of the path. */
+	
+	ip = minix_inode_read(num);
+	nentries = ip->i_size/sizeof(struct d_dirent);
+	d = smalloc(ip->i_size + 1);
+	minix_read(num, d, ip->i_size);
+	
+	/* Directory lookup cost, in blocks scanned by a linear search. */
+	nused = 0;
+	cost = 0;
+	maxcost = 0;
+	for (unsigned i = 0; i < nentries; i++)
+	{
+		if (d[i].d_ino == INODE_NULL)
+			continue;
+		
+		nused++;
+		cost += i/DIRENTS_PER_BLOCK + 1;
+		if (i/DIRENTS_PER_BLOCK + 1 > maxcost)
+			maxcost = i/DIRENTS_PER_BLOCK + 1;
+	}
+	
+	if (dirs)
+	{
+		totals.ndirs++;
+		printf("%s\n    {\"path\": ", (totals.ndirs > 1) ? "," : "");
+		json_string((*path == '\0') ? "/" : path);
+		printf(", \"inode\": %u, \"entries\": %u, \"size\": %u, \"blocks\": %u, "
+			"\"lookup_avg\": %.2f, \"lookup_max\": %u}",
+			num, nused, ip->i_size,
+			(unsigned)((ip->i_size + BLOCK_SIZE - 1)/BLOCK_SIZE),
+			(nused > 0) ? (double)cost/nused : 0.0, maxcost);
+	}
+	
+	len = strlen(path);
+	for (unsigned i = 0; i < nentries; i++)
+	{
+		struct d_inode *child;
+		char name[MINIX_NAME_MAX + 1];
+		
+		if (d[i].d_ino == INODE_NULL)
+			continue;
+		
+		strncpy(name, d[i].d_name, MINIX_NAME_MAX);
+		name[MINIX_NAME_MAX] = '\0';
+		if ((!strcmp(name, ".")) || (!strcmp(name, "..")))
+			continue;
+		
+		if (len + strlen(name) + 2 > PATH_MAX_LEN)
+			error("path too long");
+		sprintf(path + len, "/%s", name);
+		
+		child = minix_inode_read(d[i].d_ino);
+		if (S_ISDIR(child->i_mode))
+			walk(path, d[i].d_ino, dirs);
+		else if ((!dirs) && (S_ISREG(child->i_mode)))
+			report_file(path, d[i].d_ino, child);
+		free(child);
+		
+		path[len] = '\0';
+	}
+	
+	free(d);
+	free(ip);
+}
+
+/**
+ * @brief Reports bitmap occupancy.
+ */
+static void report_bitmaps(void)
+{
+	const struct d_superblock *super; /* Superblock.          */
+	unsigned ninodes, nblocks;        /* Allocated objects.   */
+	unsigned nzones;                  /* Allocatable blocks.  */
+	unsigned runs, largest, run;      /* Free block runs.     */
+	
+	super = minix_super();
+	minix_usage(&ninodes, &nblocks);
+	
+	nzones = super->s_bmap_nblocks*BLOCK_SIZE*8;
+	if (nzones > (unsigned)(super->s_nblocks - super->s_first_data_block))
+		nzones = super->s_nblocks - super->s_first_data_block;
+	
+	/* Free space fragmentation. */
+	runs = largest = run = 0;
+	for (unsigned i = 0; i < nzones; i++)
+	{
+		if (minix_block_used(super->s_first_data_block + i))
+		{
+			run = 0;
+			continue;
+		}
+		
+		if (run++ == 0)
+			runs++;
+		if (run > largest)
+			largest = run;
+	}
+	
+	printf("  \"superblock\": {\"ninodes\": %u, \"nblocks\": %u, "
+		"\"imap_blocks\": %u, \"bmap_blocks\": %u, \"first_data_block\": %u},\n",
+		super->s_ninodes, super->s_nblocks, super->s_imap_nblocks,
+		super->s_bmap_nblocks, super->s_first_data_block);
+	printf("  \"bitmaps\": {\n");
+	printf("    \"inodes\": {\"used\": %u, \"total\": %u, \"occupancy\": %.4f},\n",
+		ninodes, super->s_ninodes, (double)ninodes/super->s_ninodes);
+	printf("    \"blocks\": {\"used\": %u, \"total\": %u, \"occupancy\": %.4f, "
+		"\"free_runs\": %u, \"largest_free_run\": %u}\n",
+		nblocks, nzones, (double)nblocks/nzones, runs, largest);
+	printf("  },\n");
+}
+
+/**
+ * @brief Analyzes the layout of a Minix file system.
+ */
+int main(int argc, char **argv)
+{
+	char path[PATH_MAX_LEN]; /* Working path. */
+	
+	/* Wrong usage. */
+	if (argc < 2)
+		usage();
+	
+	minix_mount(argv[1]);
+	
+	printf("{\n  \"image\": ");
+	json_string(argv[1]);
+	printf(",\n");
+	
+	report_bitmaps();
+	
+	/* Regular files. */
+	printf("  \"files\": [");
+	path[0] = '\0';
+	walk(path, INODE_ROOT, false);
+	printf("\n  ],\n");
+	
+	/* Directories. */
+	printf("  \"directories\": [");
+	path[0] = '\0';
+	walk(path, INODE_ROOT, true);
+	printf("\n  ],\n");
+	
+	printf("  \"summary\": {\"files\": %u, \"directories\": %u, "
+		"\"fragmented\": %u, \"extents\": %u, \"indirect\": %u, \"seek\": %lu},\n",
+		totals.nfiles, totals.ndirs, totals.fragmented, totals.extents,
+		totals.indirect, totals.seek);
+	
+	/* Cold read of the requested files. */
+	cold.cached = scalloc((minix_super()->s_nblocks + 31)/32, sizeof(uint32_t));
+	printf("  \"cold_read\": {\n    \"files\": [");
+	for (int i = 2; i < argc; i++)
+	{
+		unsigned ios = cold_read(argv[i]);
+		
+		printf("%s\n      {\"path\": ", (i > 2) ? "," : "");
+		json_string(argv[i]);
+		printf(", \"ios\": %u}", ios);
+	}
+	printf("\n    ],\n");
+	printf("    \"ios\": %u, \"seeks\": %u, \"seek\": %lu\n  }\n}\n",
+		cold.ios, cold.seeks, cold.seek);
+	free(cold.cached);
+	
+	minix_umount();
+	
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,740 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Single-pass image builder.
+ *
+ * The whole host directory tree is first scanned into memory, then the
+ * image is mapped and populated breadth-first: each directory gets its
+ * children inode numbers in a row, its own blocks, and then the blocks of
+ * its regular files, so that a directory, its inodes and its file data
+ * end up close to each other on disk. Each file is written in a single
+ * run of consecutive blocks, with indirect blocks placed right before the
+ * data they map.
+ *
+ * The manifest is a text file with one entry per line:
+ *
+ *   <path> <type> <mode> <uid> <gid> [<major> <minor>]
+ *
+ * where type is 'f' (existing file), 'd' (directory, created if missing),
+ * 'c' or 'b' (character or block device, created). Mode is in octal. Empty
+ * lines and lines starting with '#' are ignored.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bitmap.h"
+#include "minix.h"
+#include "util.h"
+
+/**
+ * @brief Maximum length of a manifest line.
+ */
+#define LINE_MAX_LEN 1024
+
+/**
+ * @brief File tree node.
+ */
+struct node
+{
+	char name[MINIX_NAME_MAX + 1]; /**< File name.                     */
+	char *path;                    /**< Host path (NULL if none).      */
+	uint16_t mode;                 /**< Access mode.                   */
+	uint16_t uid;                  /**< User ID.                       */
+	uint16_t gid;                  /**< User group ID.                 */
+	uint16_t dev;                  /**< Device number (special files). */
+	uint32_t size;                 /**< File size (in bytes).          */
+	uint16_t num;                  /**< Inode number.                  */
+	unsigned nchildren;            /**< Number of children.            */
+	struct node *children;         /**< Children, sorted by name.      */
+	struct node *parent;           /**< Parent directory.              */
+	struct node *next;             /**< Next sibling.                  */
+	struct node *qnext;            /**< Next node in the build queue.  */
+};
+
+/**
+ * @brief Mapped image.
+ */
+static struct
+{
+	char *base;                  /**< Base address.                  */
+	size_t size;                 /**< Size (in bytes).               */
+	struct d_superblock *super;  /**< Superblock.                    */
+	uint32_t *imap;              /**< Inode map.                     */
+	uint32_t *zmap;              /**< Zone map.                      */
+	struct d_inode *inodes;      /**< Inode table.                   */
+	uint32_t nzones;             /**< Number of allocatable zones.   */
+	uint32_t inext;              /**< Next inode bit to try.         */
+	uint32_t znext;              /**< Next zone bit to try.          */
+} img;
+
+/**
+ * @brief Returns device number.
+ *
+ * @param type  Device type.
+ * @param major Major number.
+ * @param minor Minor number.
+ *
+ * @returns The device number.
+ */
+static inline uint16_t devnum(char type, unsigned major, unsigned minor)
+{
+	return (((major & 0xf) << 8)|((minor & 0xf) << 4) | (type == 'c' ? 0 : 1));
+}
+
+/*============================================================================*
+ *                                 File Tree                                  *
+ *============================================================================*/
+
+/**
+ * @brief Creates a file tree node.
+ *
+ * @param name Name of the node.
+ * @param mode Access mode.
+ * @param uid  User ID.
+ * @param gid  User group ID.
+ *
+ * @returns The new node.
+ */
+static struct node *node_create
+(const char *name, uint16_t mode, uint16_t uid, uint16_t gid)
+{
+	struct node *n;
+
+	if (strlen(name) > MINIX_NAME_MAX)
+		error("file name too long");
+
+	n = scalloc(1, sizeof(struct node));
+	strcpy(n->name, name);
+	n->mode = mode;
+	n->uid = uid;
+	n->gid = gid;
+
+	return (n);
+}
+
+/**
+ * @brief Searches for a child of a directory node.
+ *
+ * @param dir  Directory node.
+ * @param name Name of the child.
+ *
+ * @returns The child node, or NULL if there is no such child.
+ */
+static struct node *node_lookup(struct node *dir, const char *name)
+{
+	for (struct node *n = dir->children; n != NULL; n = n->next)
+	{
+		if (!strcmp(n->name, name))
+			return (n);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Inserts a child in a directory node, keeping children sorted.
+ *
+ * @param dir   Directory node.
+ * @param child Child node.
+ */
+static void node_insert(struct node *dir, struct node *child)
+{
+	struct node **pp;
+
+	for (pp = &dir->children; *pp != NULL; pp = &(*pp)->next)
+	{
+		int cmp = strcmp((*pp)->name, child->name);
+
+		if (cmp == 0)
+			error("duplicate entry");
+		if (cmp > 0)
+			break;
+	}
+
+	child->next = *pp;
+	*pp = child;
+	dir->nchildren++;
+}
+
+/**
+ * @brief Scans a host directory into the file tree.
+ *
+ * @param dir  Directory node.
+ * @param path Host path of the directory.
+ * @param uid  Default user ID.
+ * @param gid  Default user group ID.
+ */
+static void tree_scan(struct node *dir, const char *path, uint16_t uid, uint16_t gid)
+{
+	DIR *dp;           /* Host directory.   */
+	struct dirent *d;  /* Directory entry.  */
+	struct stat st;    /* File status.      */
+	struct node *n;    /* Working node.     */
+	char *p;           /* Working path.     */
+
+	if ((dp = opendir(path)) == NULL)
+		error("cannot opendir()");
+
+	while ((d = readdir(dp)) != NULL)
+	{
+		if ((!strcmp(d->d_name, ".")) || (!strcmp(d->d_name, "..")))
+			continue;
+
+		p = smalloc(strlen(path) + strlen(d->d_name) + 2);
+		sprintf(p, "%s/%s", path, d->d_name);
+
+		if (stat(p, &st) != 0)
+			error("cannot stat()");
+
+		/* Directory. */
+		if (S_ISDIR(st.st_mode))
+		{
+			n = node_create(d->d_name, S_IFDIR | (st.st_mode & 07777), uid, gid);
+			node_insert(dir, n);
+			tree_scan(n, p, uid, gid);
+			free(p);
+		}
+
+		/* Regular file. */
+		else if (S_ISREG(st.st_mode))
+		{
+			n = node_create(d->d_name, S_IFREG | (st.st_mode & 07777), uid, gid);
+			n->path = p;
+			n->size = st.st_size;
+			node_insert(dir, n);
+		}
+
+		/* Unsupported file type. */
+		else
+		{
+			fprintf(stderr, "warning: skipping %s\n", p);
+			free(p);
+		}
+	}
+
+	closedir(dp);
+}
+
+/**
+ * @brief Releases a file tree.
+ *
+ * @param n Root of the file tree.
+ */
+static void tree_destroy(struct node *n)
+{
+	struct node *child, *next;
+
+	for (child = n->children; child != NULL; child = next)
+	{
+		next = child->next;
+		tree_destroy(child);
+	}
+
+	free(n->path);
+	free(n);
+}
+
+/**
+ * @brief Walks a path in the file tree.
+ *
+ * @param root     Root node.
+ * @param pathname Path name.
+ * @param filename Place to save the last component of the path.
+ *
+ * @returns The parent directory of the last component of the path. Missing
+ *          intermediate directories are created.
+ */
+static struct node *tree_dname
+(struct node *root, const char *pathname, char *filename)
+{
+	struct node *dir, *n;
+
+	dir = root;
+	pathname = break_path(pathname, filename);
+
+	while (*pathname != '\0')
+	{
+		if ((n = node_lookup(dir, filename)) == NULL)
+		{
+			n = node_create(filename, dir->mode, dir->uid, dir->gid);
+			node_insert(dir, n);
+		}
+
+		if (!S_ISDIR(n->mode))
+			error("not a directory");
+
+		dir = n;
+		pathname = break_path(pathname, filename);
+	}
+
+	return (dir);
+}
+
+/**
+ * @brief Applies a manifest to the file tree.
+ *
+ * @param root     Root node.
+ * @param manifest Manifest file name.
+ */
+static void tree_manifest(struct node *root, const char *manifest)
+{
+	FILE *fp;                          /* Manifest file.     */
+	char line[LINE_MAX_LEN];           /* Working line.      */
+	char path[LINE_MAX_LEN];           /* Path of the entry. */
+	char filename[MINIX_NAME_MAX + 2]; /* Working file name. */
+	char type;                         /* Entry type.        */
+	unsigned mode, uid, gid;           /* Entry attributes.  */
+	unsigned major, minor;             /* Device numbers.    */
+	struct node *dir, *n;              /* Working nodes.     */
+	int nargs;                         /* Parsed fields.     */
+
+	if ((fp = fopen(manifest, "r")) == NULL)
+		error("cannot open manifest");
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		/* Skip comments and empty lines. */
+		if ((line[0] == '#') || (strspn(line, " \t\r\n") == strlen(line)))
+			continue;
+
+		nargs = sscanf(line, "%s %c %o %u %u %u %u",
+			path, &type, &mode, &uid, &gid, &major, &minor);
+		if (nargs < 5)
+			error("bad manifest entry");
+
+		/* Root directory. */
+		if (strspn(path, "/") == strlen(path))
+			n = root;
+
+		else
+		{
+			dir = tree_dname(root, path, filename);
+			n = node_lookup(dir, filename);
+
+			switch (type)
+			{
+				/* Existing file. */
+				case 'f':
+					if ((n == NULL) || (!S_ISREG(n->mode)))
+						error("no such file");
+					break;
+
+				/* Directory. */
+				case 'd':
+					if (n == NULL)
+					{
+						n = node_create(filename, S_IFDIR, uid, gid);
+						node_insert(dir, n);
+					}
+					break;
+
+				/* Device. */
+				case 'c':
+				case 'b':
+					if (nargs != 7)
+						error("missing device numbers");
+					if (n != NULL)
+						error("duplicate entry");
+					n = node_create(filename, (type == 'c') ? S_IFCHR : S_IFBLK, uid, gid);
+					n->dev = devnum(type, major, minor);
+					node_insert(dir, n);
+					break;
+
+				default:
+					error("bad manifest entry type");
+			}
+		}
+
+		if ((type == 'd') && (!S_ISDIR(n->mode)))
+			error("not a directory");
+
+		n->mode = (n->mode & S_IFMT) | (mode & 07777);
+		n->uid = uid;
+		n->gid = gid;
+	}
+
+	fclose(fp);
+}
+
+/*============================================================================*
+ *                                Mapped Image                                *
+ *============================================================================*/
+
+/**
+ * @brief Maps an image that was formatted by minix_mkfs().
+ *
+ * @param diskfile Image file name.
+ */
+static void image_map(const char *diskfile)
+{
+	int fd;
+	struct d_superblock super;
+	uint32_t ndata;
+
+	fd = sopen(diskfile, O_RDWR);
+
+	slseek(fd, 1*BLOCK_SIZE, SEEK_SET);
+	sread(fd, &super, sizeof(struct d_superblock));
+	if (super.s_magic != SUPER_MAGIC)
+		error("bad magic number");
+
+	/* Make sure the whole file system is backed by the file. */
+	img.size = (size_t)super.s_nblocks*BLOCK_SIZE;
+	if (lseek(fd, 0, SEEK_END) < (off_t)img.size)
+	{
+		if (ftruncate(fd, img.size) != 0)
+			error("cannot ftruncate()");
+	}
+
+	img.base = mmap(NULL, img.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (img.base == MAP_FAILED)
+		error("cannot mmap()");
+	sclose(fd);
+
+	img.super = (struct d_superblock *)(img.base + 1*BLOCK_SIZE);
+	img.imap = (uint32_t *)(img.base + 2*BLOCK_SIZE);
+	img.zmap = (uint32_t *)(img.base + (2 + super.s_imap_nblocks)*BLOCK_SIZE);
+	img.inodes = (struct d_inode *)(img.base +
+		(2 + super.s_imap_nblocks + super.s_bmap_nblocks)*BLOCK_SIZE);
+
+	/* Zones are limited both by the zone map and by the image size. */
+	ndata = super.s_nblocks - super.s_first_data_block;
+	img.nzones = super.s_bmap_nblocks*BLOCK_SIZE*8;
+	if (img.nzones > ndata)
+		img.nzones = ndata;
+	img.inext = 0;
+	img.znext = 0;
+}
+
+/**
+ * @brief Flushes and unmaps the image.
+ */
+static void image_unmap(void)
+{
+	if (msync(img.base, img.size, MS_SYNC) != 0)
+		error("cannot msync()");
+	munmap(img.base, img.size);
+}
+
+/**
+ * @brief Returns a pointer to a block of the image.
+ *
+ * @param blk Block number.
+ *
+ * @returns A pointer to the requested block.
+ */
+static inline void *image_block(block_t blk)
+{
+	return (img.base + (size_t)blk*BLOCK_SIZE);
+}
+
+/**
+ * @brief Returns a pointer to an inode of the image.
+ *
+ * @param num Inode number.
+ *
+ * @returns A pointer to the requested inode.
+ */
+static inline struct d_inode *image_inode(uint16_t num)
+{
+	return (&img.inodes[num - 1]);
+}
+
+/**
+ * @brief Allocates a zeroed block, next to the last allocated one.
+ *
+ * @returns The number of the allocated block.
+ */
+static block_t image_block_alloc(void)
+{
+	block_t blk;
+
+	while ((img.znext < img.nzones) &&
+	       (img.zmap[IDX(img.znext)] & (1 << OFF(img.znext))))
+		img.znext++;
+
+	if (img.znext >= img.nzones)
+		error("block map overflow");
+
+	bitmap_set(img.zmap, img.znext);
+	blk = img.super->s_first_data_block + img.znext++;
+	memset(image_block(blk), 0, BLOCK_SIZE);
+
+	return (blk);
+}
+
+/**
+ * @brief Allocates an inode, next to the last allocated one.
+ *
+ * @param n File tree node that describes the inode.
+ *
+ * @returns The number of the allocated inode.
+ */
+static uint16_t image_inode_alloc(const struct node *n)
+{
+	uint16_t num;
+	struct d_inode *ip;
+
+	while ((img.inext < img.super->s_ninodes) &&
+	       (img.imap[IDX(img.inext)] & (1 << OFF(img.inext))))
+		img.inext++;
+
+	if (img.inext >= img.super->s_ninodes)
+		error("inode map overflow");
+
+	bitmap_set(img.imap, img.inext);
+	num = img.inext++ + 1;
+
+	ip = image_inode(num);
+	memset(ip, 0, sizeof(struct d_inode));
+	ip->i_mode = n->mode;
+	ip->i_uid = n->uid;
+	ip->i_gid = n->gid;
+	ip->i_nlinks = 1;
+
+	return (num);
+}
+
+/**
+ * @brief Gets a zone in an indirect block, allocating it if needed.
+ *
+ * @param ind Indirect block.
+ * @param idx Index of the zone.
+ *
+ * @returns The requested zone.
+ */
+static block_t image_zone(zone_t *ind, unsigned idx)
+{
+	if (ind[idx] == BLOCK_NULL)
+		ind[idx] = image_block_alloc();
+
+	return (ind[idx]);
+}
+
+/**
+ * @brief Maps a logic block of a file, allocating blocks as needed.
+ *
+ * @param ip    File.
+ * @param logic Logic block number.
+ *
+ * @returns The physical block number.
+ *
+ * @note Since blocks are allocated on demand and in order, an indirect
+ *       block lands right before the first data block that it maps.
+ */
+static block_t image_block_map(struct d_inode *ip, unsigned logic)
+{
+	zone_t *ind;
+
+	/* Direct zone. */
+	if (logic < NR_ZONES_DIRECT)
+	{
+		if (ip->i_zones[logic] == BLOCK_NULL)
+			ip->i_zones[logic] = image_block_alloc();
+		return (ip->i_zones[logic]);
+	}
+
+	logic -= NR_ZONES_DIRECT;
+
+	/* Single indirect zone. */
+	if (logic < NR_SINGLE)
+	{
+		if (ip->i_zones[ZONE_SINGLE] == BLOCK_NULL)
+			ip->i_zones[ZONE_SINGLE] = image_block_alloc();
+		ind = image_block(ip->i_zones[ZONE_SINGLE]);
+		return (image_zone(ind, logic));
+	}
+
+	logic -= NR_SINGLE;
+
+	/* Double indirect zone. */
+	if (logic < NR_DOUBLE)
+	{
+		if (ip->i_zones[ZONE_DOUBLE] == BLOCK_NULL)
+			ip->i_zones[ZONE_DOUBLE] = image_block_alloc();
+		ind = image_block(ip->i_zones[ZONE_DOUBLE]);
+		ind = image_block(image_zone(ind, logic/NR_SINGLE));
+		return (image_zone(ind, logic%NR_SINGLE));
+	}
+
+	error("file too big");
+
+	return (BLOCK_NULL);
+}
+
+/**
+ * @brief Appends a directory entry to a directory.
+ *
+ * @param ip   Directory.
+ * @param name Name of the entry.
+ * @param num  Inode number of the entry.
+ */
+static void image_dirent_add(struct d_inode *ip, const char *name, uint16_t num)
+{
+	unsigned off;
+	struct d_dirent *d;
+
+	off = ip->i_size;
+	d = (struct d_dirent *)((char *)image_block(image_block_map(ip, off/BLOCK_SIZE))
+		+ off%BLOCK_SIZE);
+
+	d->d_ino = num;
+	strncpy(d->d_name, name, MINIX_NAME_MAX);
+
+	ip->i_size += sizeof(struct d_dirent);
+	ip->i_nlinks++;
+}
+
+/**
+ * @brief Copies a host file into the image.
+ *
+ * @param n File tree node.
+ */
+static void image_file_write(const struct node *n)
+{
+	int fd;             /* Host file.      */
+	struct d_inode *ip; /* Working inode.  */
+	uint32_t off;       /* Working offset. */
+	size_t chunk;       /* Bytes to copy.  */
+
+	if (n->size > img.super->s_max_size)
+		error("file too big");
+
+	ip = image_inode(n->num);
+	fd = sopen(n->path, O_RDONLY);
+
+	for (off = 0; off < n->size; off += chunk)
+	{
+		chunk = ((n->size - off) < BLOCK_SIZE) ? n->size - off : BLOCK_SIZE;
+		sread(fd, image_block(image_block_map(ip, off/BLOCK_SIZE)), chunk);
+	}
+
+	ip->i_size = n->size;
+	sclose(fd);
+}
+
+/**
+ * @brief Builds the file tree in the image, breadth-first.
+ *
+ * @param root Root node.
+ */
+static void image_build(struct node *root)
+{
+	struct d_inode *ip;        /* Working inode.      */
+	struct node *head, *tail;  /* Build queue.        */
+	struct node *dir;          /* Working directory.  */
+
+	/* Drop the root directory that minix_mkfs() created. */
+	ip = image_inode(INODE_ROOT);
+	bitmap_clear(img.zmap, ip->i_zones[0] - img.super->s_first_data_block);
+	memset(ip, 0, sizeof(struct d_inode));
+	ip->i_mode = root->mode;
+	ip->i_uid = root->uid;
+	ip->i_gid = root->gid;
+	ip->i_nlinks = 1;
+	root->num = INODE_ROOT;
+	root->parent = root;
+	root->qnext = NULL;
+
+	head = tail = root;
+	while (head != NULL)
+	{
+		dir = head;
+		head = dir->qnext;
+
+		/* Inodes of the children are allocated in a row. */
+		for (struct node *n = dir->children; n != NULL; n = n->next)
+		{
+			n->num = image_inode_alloc(n);
+			if (S_ISCHR(n->mode) || S_ISBLK(n->mode))
+				image_inode(n->num)->i_zones[0] = n->dev;
+		}
+
+		/* Directory blocks. */
+		ip = image_inode(dir->num);
+		image_dirent_add(ip, ".", dir->num);
+		image_dirent_add(ip, "..", dir->parent->num);
+		ip->i_nlinks--;
+		for (struct node *n = dir->children; n != NULL; n = n->next)
+			image_dirent_add(ip, n->name, n->num);
+
+		/* File data goes right after its directory. */
+		for (struct node *n = dir->children; n != NULL; n = n->next)
+		{
+			if (S_ISREG(n->mode))
+				image_file_write(n);
+		}
+
+		/* Enqueue subdirectories. */
+		for (struct node *n = dir->children; n != NULL; n = n->next)
+		{
+			if (!S_ISDIR(n->mode))
+				continue;
+
+			n->parent = dir;
+			n->qnext = NULL;
+			if (head == NULL)
+				head = n;
+			else
+				tail->qnext = n;
+			tail = n;
+		}
+	}
+}
+
+/**
+ * @brief Populates a freshly formatted Minix file system from a directory.
+ *
+ * @param diskfile File where the Minix file system resides.
+ * @param dirname  Host directory to copy into the file system.
+ * @param manifest Manifest file name (NULL if none).
+ * @param uid      Default user ID.
+ * @param gid      Default user group ID.
+ *
+ * @note @p diskfile must have been formatted by minix_mkfs().
+ */
+void minix_build
+(const char *diskfile, const char *dirname, const char *manifest, uint16_t uid, uint16_t gid)
+{
+	struct node *root;
+
+	/* Scan everything before touching the image. */
+	root = node_create("", S_IFDIR | S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH, uid, gid);
+	tree_scan(root, dirname, uid, gid);
+	if (manifest != NULL)
+		tree_manifest(root, manifest);
+
+	image_map(diskfile);
+	image_build(root);
+	image_unmap();
+
+	tree_destroy(root);
+}
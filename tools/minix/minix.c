@@ -127,6 +127,80 @@ void minix_umount(void)
 	sclose(fd);
 }
 
+/**
+ * @brief Gets the superblock of the currently mounted Minix file system.
+ * 
+ * @returns A pointer to the mounted superblock.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+const struct d_superblock *minix_super(void)
+{
+	return (&super);
+}
+
+/**
+ * @brief Counts allocated inodes and blocks.
+ * 
+ * @param ninodes Place to store the number of allocated inodes.
+ * @param nblocks Place to store the number of allocated data blocks.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+void minix_usage(unsigned *ninodes, unsigned *nblocks)
+{
+	*ninodes = 0;
+	for (unsigned i = 0; i < super.s_ninodes; i++)
+	{
+		if (imap.bitmap[IDX(i)] & (1 << OFF(i)))
+			(*ninodes)++;
+	}
+	
+	*nblocks = 0;
+	for (unsigned i = 0; i < zmap.size*8; i++)
+	{
+		if (zmap.bitmap[IDX(i)] & (1 << OFF(i)))
+			(*nblocks)++;
+	}
+}
+
+/**
+ * @brief Checks if a data block is allocated.
+ * 
+ * @param blk Block number.
+ * 
+ * @returns True if the block is allocated, and false otherwise.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+bool minix_block_used(block_t blk)
+{
+	unsigned bit;
+	
+	if (blk < super.s_first_data_block)
+		return (true);
+	
+	bit = blk - super.s_first_data_block;
+	if (bit >= zmap.size*8)
+		return (true);
+	
+	return (zmap.bitmap[IDX(bit)] & (1 << OFF(bit)));
+}
+
+/**
+ * @brief Reads a block from the currently mounted Minix file system.
+ * 
+ * @param blk Number of the block that shall be read.
+ * @param buf Buffer where the block shall be stored.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+void minix_block_read(block_t blk, void *buf)
+{
+	slseek(fd, blk*BLOCK_SIZE, SEEK_SET);
+	sread(fd, buf, BLOCK_SIZE);
+}
+
 /**
  * @brief Reads an inode from the currently mounted Minix file system.
  * 
@@ -272,7 +346,7 @@ static uint16_t minix_inode_alloc(uint16_t mode, uint16_t uid, uint16_t gid)
  *          returned.
  */
 static block_t create_indirect_block
-(block_t *dest, off_t offset, off_t off, int create)
+(zone_t *dest, off_t offset, off_t off, int create)
 {
 	block_t phys; /* Physical block number. */
 
@@ -333,7 +407,7 @@ static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
 {
 	block_t phys;                            /* Phys. blk. #.      */
 	size_t logic;                            /* Logic. blk. #.     */
-	block_t buf[BLOCK_SIZE/sizeof(block_t)]; /* Working buffer.    */
+	zone_t buf[BLOCK_SIZE/sizeof(zone_t)];   /* Working buffer.    */
 	unsigned tmp;                            /* Logic. blk. #. tmp */
 
 	logic = off/BLOCK_SIZE;
@@ -422,6 +496,62 @@ static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
 	return (BLOCK_NULL);
 }
 
+/**
+ * @brief Maps a file byte offset in a block number, without allocating.
+ * 
+ * @param ip  File to use.
+ * @param off File byte offset.
+ * 
+ * @returns The block number that is associated with the file byte offset,
+ *          or #BLOCK_NULL if there is none.
+ * 
+ * @note @p ip must point to a valid inode.
+ * @note The Minix file system must be mounted.
+ */
+block_t minix_bmap(struct d_inode *ip, off_t off)
+{
+	size_t logic;                            /* Logic. blk. #.   */
+	zone_t buf[BLOCK_SIZE/sizeof(zone_t)];   /* Working buffer.  */
+	
+	logic = off/BLOCK_SIZE;
+	
+	/* Direct block. */
+	if (logic < NR_ZONES_DIRECT)
+		return (ip->i_zones[logic]);
+	
+	logic -= NR_ZONES_DIRECT;
+	
+	/* Single indirect block. */
+	if (logic < NR_SINGLE)
+	{
+		if (ip->i_zones[ZONE_SINGLE] == BLOCK_NULL)
+			return (BLOCK_NULL);
+		
+		minix_block_read(ip->i_zones[ZONE_SINGLE], buf);
+		
+		return (buf[logic]);
+	}
+	
+	logic -= NR_SINGLE;
+	
+	/* Double indirect block. */
+	if (logic < NR_DOUBLE)
+	{
+		if (ip->i_zones[ZONE_DOUBLE] == BLOCK_NULL)
+			return (BLOCK_NULL);
+		
+		minix_block_read(ip->i_zones[ZONE_DOUBLE], buf);
+		if (buf[logic/NR_SINGLE] == BLOCK_NULL)
+			return (BLOCK_NULL);
+		
+		minix_block_read(buf[logic/NR_SINGLE], buf);
+		
+		return (buf[logic%NR_SINGLE]);
+	}
+	
+	return (BLOCK_NULL);
+}
+
 /**
  * @brief Searches for a directory entry.
  * 
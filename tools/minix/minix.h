@@ -21,6 +21,7 @@
 #define _MINIX_H_
  	
  	#include <sys/types.h>
+ 	#include <stdbool.h>
  	#include <minix.h>
 
 	/* Forward definitions. */
@@ -36,5 +37,12 @@
 	extern size_t minix_read(uint16_t, void *, size_t);
 	extern void minix_write(uint16_t, const void *, size_t);
 	extern void minix_mkfs(const char *, uint16_t, uint16_t, uint16_t, uint16_t);
+	extern const struct d_superblock *minix_super(void);
+	extern void minix_usage(unsigned *, unsigned *);
+	extern bool minix_block_used(block_t);
+	extern void minix_block_read(block_t, void *);
+	extern block_t minix_bmap(struct d_inode *, off_t);
+	extern void minix_build(const char *, const char *, const char *, uint16_t, uint16_t);
+	extern void minix3_mkfs(const char *, uint16_t, uint32_t, uint16_t, uint16_t);
 
 #endif /* _MINIX_H_ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bitmap.h"
+#include "minix.h"
+#include "stat.h"
+#include "util.h"
+
+/**
+ * @brief Maximum file size on a Minix V3 file system (in bytes).
+ */
+#define MINIX3_MAX_SIZE 0x7fffffff
+
+/**
+ * @brief Creates a Minix V3 bitmap.
+ * 
+ * @details Bit zero and the bits past the last object are marked as in use.
+ * 
+ * @param nblocks Number of blocks in the bitmap.
+ * @param nbits   Number of valid bits, including the reserved one.
+ * 
+ * @returns The bitmap.
+ */
+static void *minix3_bitmap(unsigned nblocks, unsigned nbits)
+{
+	uint32_t *bitmap;
+	
+	bitmap = scalloc(nblocks, MINIX3_BLOCK_SIZE);
+	
+	bitmap_set(bitmap, 0);
+	for (unsigned i = nbits; i < nblocks*(MINIX3_BLOCK_SIZE << 3); i++)
+		bitmap_set(bitmap, i);
+	
+	return (bitmap);
+}
+
+/**
+ * @brief Creates a Minix V3 file system.
+ * 
+ * @param diskfile File where the file system shall be created.
+ * @param ninodes  Number of inodes.
+ * @param nzones   Number of 4 KB zones.
+ * @param uid      User ID.
+ * @param gid      User group ID.
+ * 
+ * @note @p diskfile must refer to a valid file.
+ */
+void minix3_mkfs
+(const char *diskfile, uint16_t ninodes, uint32_t nzones, uint16_t uid, uint16_t gid)
+{
+	int fd;                         /* Disk file.                */
+	char buf[MINIX3_BLOCK_SIZE];    /* Writing buffer.           */
+	unsigned imap_nblocks;          /* Inode map blocks.         */
+	unsigned zmap_nblocks;          /* Zone map blocks.          */
+	unsigned inode_nblocks;         /* Inode blocks.             */
+	unsigned first;                 /* First data zone.          */
+	void *imap;                     /* Inode map.                */
+	void *zmap;                     /* Zone map.                 */
+	struct d_superblock3 super;     /* Superblock.               */
+	struct d_inode3 root;           /* Root directory.           */
+	struct d_dirent3 dirents[2];    /* Root directory entries.   */
+	
+	/* Compute dimensions of file system. */
+	#define NBLOCKS(x, y) (((x) + (y) - 1)/(y))
+	imap_nblocks = NBLOCKS(ninodes + 1, MINIX3_BLOCK_SIZE << 3);
+	zmap_nblocks = NBLOCKS(nzones, MINIX3_BLOCK_SIZE << 3);
+	inode_nblocks = NBLOCKS(ninodes, MINIX3_BLOCK_SIZE/sizeof(struct d_inode3));
+	first = 2 + imap_nblocks + zmap_nblocks + inode_nblocks;
+	
+	if ((ninodes == 0) || (first >= nzones))
+		error("bad file system dimensions");
+	
+	fd = sopen(diskfile, O_RDWR | O_CREAT);
+	
+	/* Fill file system with zeros. */
+	memset(buf, 0, MINIX3_BLOCK_SIZE);
+	for (unsigned i = 0; i < nzones; i++)
+		swrite(fd, buf, MINIX3_BLOCK_SIZE);
+	
+	/* Write superblock. */
+	memset(&super, 0, sizeof(super));
+	super.s_ninodes = ninodes;
+	super.s_imap_nblocks = imap_nblocks;
+	super.s_bmap_nblocks = zmap_nblocks;
+	super.s_first_data_block = first;
+	super.s_log_zone_size = 0;
+	super.s_max_size = MINIX3_MAX_SIZE;
+	super.s_nblocks = nzones;
+	super.s_magic = SUPER_MAGIC_V3;
+	super.s_block_size = MINIX3_BLOCK_SIZE;
+	slseek(fd, 1024, SEEK_SET);
+	swrite(fd, &super, sizeof(super));
+	
+	/* Write inode map, with the root directory allocated. */
+	imap = minix3_bitmap(imap_nblocks, ninodes + 1);
+	bitmap_set(imap, INODE_ROOT);
+	slseek(fd, 2*MINIX3_BLOCK_SIZE, SEEK_SET);
+	swrite(fd, imap, imap_nblocks*MINIX3_BLOCK_SIZE);
+	free(imap);
+	
+	/* Write zone map, with the root directory allocated. */
+	zmap = minix3_bitmap(zmap_nblocks, nzones - first + 1);
+	bitmap_set(zmap, 1);
+	swrite(fd, zmap, zmap_nblocks*MINIX3_BLOCK_SIZE);
+	free(zmap);
+	
+	/* Write root directory. */
+	memset(&root, 0, sizeof(root));
+	root.i_mode = S_IFDIR | S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+	root.i_nlinks = 2;
+	root.i_uid = uid;
+	root.i_gid = gid;
+	root.i_size = sizeof(dirents);
+	root.i_atime = root.i_mtime = root.i_ctime = time(NULL);
+	root.i_zones[0] = first;
+	swrite(fd, &root, sizeof(root));
+	
+	memset(dirents, 0, sizeof(dirents));
+	dirents[0].d_ino = INODE_ROOT;
+	strcpy(dirents[0].d_name, ".");
+	dirents[1].d_ino = INODE_ROOT;
+	strcpy(dirents[1].d_name, "..");
+	slseek(fd, (off_t)first*MINIX3_BLOCK_SIZE, SEEK_SET);
+	swrite(fd, dirents, sizeof(dirents));
+	
+	sclose(fd);
+}
@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "minix.h"
 
@@ -27,7 +28,9 @@
  */
 static void usage(void)
 {
-	printf("usage: mkfs.minix <input file> <ninodes> <nblocks> <uid> <gid>\n");
+	printf("usage: mkfs.minix <input file> <ninodes> <nblocks> <uid> <gid> ");
+	printf("[--v3 | --from-dir <directory> [<manifest>]]\n");
+	printf("  --v3  Minix V3 file system, <nblocks> in 4 KB blocks\n");
 	exit(EXIT_SUCCESS);
 }
 
@@ -39,11 +42,35 @@ int main(int argc, char **argv)
 	unsigned ninodes;     /* # inodes in the file system.      */
 	unsigned nblocks; 	  /* # data blocks in the file system. */
 	const char *diskfile; /* Disk file name.                   */
+	const char *dirname;  /* Directory to copy.                */
+	const char *manifest; /* Manifest file name.               */
 	
 	/* Missing arguments. */
 	if (argc < 6)
 		usage();
 	
+	/* Minix V3 file system. */
+	if ((argc == 7) && (!strcmp(argv[6], "--v3")))
+	{
+		sscanf(argv[2], "%u", &ninodes);
+		sscanf(argv[3], "%u", &nblocks);
+		minix3_mkfs(argv[1], ninodes, nblocks, atoi(argv[4]), atoi(argv[5]));
+		return (EXIT_SUCCESS);
+	}
+	
+	/* Populate from a directory? */
+	dirname = NULL;
+	manifest = NULL;
+	if (argc > 6)
+	{
+		if ((argc > 9) || (argc < 8) || (strcmp(argv[6], "--from-dir")))
+			usage();
+		
+		dirname = argv[7];
+		if (argc == 9)
+			manifest = argv[8];
+	}
+	
 	/* Extract arguments. */
 	diskfile = argv[1];
 	sscanf(argv[2], "%u", &ninodes);
@@ -51,5 +78,8 @@ int main(int argc, char **argv)
 	
 	minix_mkfs(diskfile, ninodes, nblocks, atoi(argv[4]), atoi(argv[5]));
 	
+	if (dirname != NULL)
+		minix_build(diskfile, dirname, manifest, atoi(argv[4]), atoi(argv[5]));
+	
 	return (EXIT_SUCCESS);
 }
@@ -37,6 +37,14 @@ if [ "$TARGET" = "i386" ]; then
 			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
 			-m 256M                                              \
 			-mem-prealloc -cpu host --enable-kvm
+	elif [ "$1" = "--bench" ]; then
+		# Log serial output, so that bench results can be compared across commits.
+		qemu-system-i386                                         \
+			-nographic                                           \
+			-display none                                        \
+			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
+			-m 256M                                              \
+			-mem-prealloc | tee "bench-$(git rev-parse --short HEAD 2>/dev/null || echo local).log"
 	elif [ "$1" = "--serial" ]; then
 		qemu-system-i386                                         \
 			-nographic                                           \
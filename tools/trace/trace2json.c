@@ -0,0 +1,276 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts kernel trace events captured from the serial port (see the trace
+ * utility) into Chrome trace event JSON, which can be loaded in
+ * chrome://tracing or Perfetto.
+ *
+ * Timeline layout:
+ *   - "processes": one row per process, with system calls as slices,
+ *     sleeps nested in them, and page faults and wakeups as instants.
+ *   - "cpu": which process was running, one slice per scheduling period.
+ *   - "disk": block I/O requests, from issue to completion.
+ */
+
+#include <trace.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Marker of trace lines. */
+#define TRACE_MARKER "@trace"
+
+/* Rows in the timeline. */
+#define ROW_PROCS 0 /* Processes. */
+#define ROW_CPU   1 /* Processor. */
+#define ROW_DISK  2 /* Disk.      */
+
+/* Number of distinct process IDs. */
+#define NR_PIDS 65536
+
+/* Slice that has not been closed yet. */
+struct open
+{
+	int valid;   /* Valid?      */
+	uint64_t ts; /* Start time. */
+};
+
+/* Pending sleeps, per process. */
+static struct open sleeping[NR_PIDS];
+
+/* Current scheduling period. */
+static struct open running;
+static int running_pid = -1;
+
+/* Number of events written. */
+static unsigned nevents = 0;
+
+/*
+ * Starts a JSON event.
+ */
+static void event(FILE *out, const char *name, const char *ph, int row, int tid, uint64_t ts)
+{
+	fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64 ".%03u",
+		(nevents++ > 0) ? "," : "", name, ph, row, tid, ts/1000, (unsigned)(ts%1000));
+}
+
+/*
+ * Emits a scheduling period that has ended at @p ts.
+ */
+static void endrun(FILE *out, uint64_t ts)
+{
+	uint64_t dur;
+	char name[32];
+
+	if ((!running.valid) || (ts < running.ts))
+		return;
+
+	dur = ts - running.ts;
+	sprintf(name, "pid %d", running_pid);
+	event(out, name, "X", ROW_CPU, 0, running.ts);
+	fprintf(out, ",\"dur\":%" PRIu64 ".%03u}", dur/1000, (unsigned)(dur%1000));
+}
+
+/*
+ * Converts a trace event.
+ */
+static void convert(FILE *out, const struct trace_event *e)
+{
+	char name[32];
+	uint16_t pid;
+
+	pid = (uint16_t)e->pid;
+
+	switch (e->type)
+	{
+		case TRACE_SYSENTER:
+			sprintf(name, "syscall %u", (unsigned)e->arg[0]);
+			event(out, name, "B", ROW_PROCS, e->pid, e->ts);
+			fprintf(out, ",\"args\":{\"nr\":%u}}", (unsigned)e->arg[0]);
+			break;
+
+		case TRACE_SYSEXIT:
+			event(out, "syscall", "E", ROW_PROCS, e->pid, e->ts);
+			fprintf(out, ",\"args\":{\"ret\":%d}}", (int)e->arg[0]);
+			break;
+
+		case TRACE_SLEEP:
+			sleeping[pid].valid = 1;
+			sleeping[pid].ts = e->ts;
+			event(out, "sleep", "B", ROW_PROCS, e->pid, e->ts);
+			fprintf(out, ",\"args\":{\"chain\":\"0x%x\",\"priority\":%d,\"exclusive\":%u}}",
+				(unsigned)e->arg[0], (int)e->arg[1], (unsigned)e->arg[2]);
+			break;
+
+		case TRACE_WAKEUP:
+			event(out, "wakeup", "i", ROW_PROCS, e->pid, e->ts);
+			fprintf(out, ",\"s\":\"t\",\"args\":{\"chain\":\"0x%x\",\"pid\":%u}}",
+				(unsigned)e->arg[0], (unsigned)e->arg[1]);
+			break;
+
+		case TRACE_BIO_ISSUE:
+			sprintf(name, "%u:%u", (unsigned)e->arg[0], (unsigned)e->arg[1]);
+			event(out, (TRACE_BIO_FLAGS(e) & 1) ? "write" : "read", "b", ROW_DISK, 0, e->ts);
+			fprintf(out, ",\"cat\":\"bio\",\"id\":\"%s\",\"args\":{\"dev\":%u,\"block\":%u,\"depth\":%u}}",
+				name, (unsigned)e->arg[0], (unsigned)e->arg[1], (unsigned)TRACE_BIO_DEPTH(e));
+			break;
+
+		case TRACE_BIO_DONE:
+			sprintf(name, "%u:%u", (unsigned)e->arg[0], (unsigned)e->arg[1]);
+			event(out, "bio", "e", ROW_DISK, 0, e->ts);
+			fprintf(out, ",\"cat\":\"bio\",\"id\":\"%s\",\"args\":{\"depth\":%u}}",
+				name, (unsigned)e->arg[2]);
+			break;
+
+		case TRACE_VFAULT:
+		case TRACE_PFAULT:
+			event(out, (e->type == TRACE_VFAULT) ? "vfault" : "pfault", "i", ROW_PROCS, e->pid, e->ts);
+			fprintf(out, ",\"s\":\"t\",\"args\":{\"addr\":\"0x%x\"}}", (unsigned)e->arg[0]);
+			break;
+
+		case TRACE_SWITCH:
+			endrun(out, e->ts);
+			running.valid = 1;
+			running.ts = e->ts;
+			running_pid = (int)e->arg[0];
+
+			/* Process that slept is running again. */
+			if (sleeping[(uint16_t)e->arg[0]].valid)
+			{
+				sleeping[(uint16_t)e->arg[0]].valid = 0;
+				event(out, "sleep", "E", ROW_PROCS, (int)e->arg[0], e->ts);
+				fprintf(out, "}");
+			}
+			break;
+
+		default:
+			fprintf(stderr, "trace2json: unknown event type %u\n", (unsigned)e->type);
+			break;
+	}
+}
+
+/*
+ * Parses a trace line.
+ *
+ * Returns 1 if an event was parsed, 0 otherwise.
+ */
+static int parse(const char *line, struct trace_event *e)
+{
+	const char *p;
+	char ts[17];
+	unsigned seq, type;
+	int pid, lost;
+	unsigned a0, a1, a2;
+
+	/* Not a trace line. Serial logs may prefix lines with garbage. */
+	if ((p = strstr(line, TRACE_MARKER)) == NULL)
+		return (0);
+
+	p += strlen(TRACE_MARKER);
+
+	if (sscanf(p, " lost %d", &lost) == 1)
+	{
+		fprintf(stderr, "trace2json: %d events lost\n", lost);
+		return (0);
+	}
+
+	if (sscanf(p, " %x %16s %x %d %x %x %x", &seq, ts, &type, &pid, &a0, &a1, &a2) != 7)
+	{
+		fprintf(stderr, "trace2json: malformed line: %s", line);
+		return (0);
+	}
+
+	e->seq = seq;
+	e->ts = strtoull(ts, NULL, 16);
+	e->type = type;
+	e->pid = pid;
+	e->arg[0] = a0;
+	e->arg[1] = a1;
+	e->arg[2] = a2;
+
+	return (1);
+}
+
+/*
+ * Names a row in the timeline.
+ */
+static void rowname(FILE *out, int row, const char *name)
+{
+	fprintf(out, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+		(nevents++ > 0) ? "," : "", row, name);
+}
+
+/*
+ * Converts a serial log to Chrome trace event JSON.
+ */
+int main(int argc, char **argv)
+{
+	FILE *in, *out;
+	char line[256];
+	uint64_t last;
+	struct trace_event e;
+
+	if ((argc < 2) || (argc > 3) || (!strcmp(argv[1], "--help")))
+	{
+		fprintf(stderr, "Usage: trace2json <serial log> [output]\n");
+		return (EXIT_FAILURE);
+	}
+
+	if ((in = fopen(argv[1], "r")) == NULL)
+	{
+		fprintf(stderr, "trace2json: cannot open %s\n", argv[1]);
+		return (EXIT_FAILURE);
+	}
+
+	out = stdout;
+	if ((argc == 3) && ((out = fopen(argv[2], "w")) == NULL))
+	{
+		fprintf(stderr, "trace2json: cannot create %s\n", argv[2]);
+		fclose(in);
+		return (EXIT_FAILURE);
+	}
+
+	fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	rowname(out, ROW_PROCS, "processes");
+	rowname(out, ROW_CPU, "cpu");
+	rowname(out, ROW_DISK, "disk");
+
+	last = 0;
+	while (fgets(line, sizeof(line), in) != NULL)
+	{
+		if (!parse(line, &e))
+			continue;
+
+		convert(out, &e);
+		last = e.ts;
+	}
+
+	endrun(out, last);
+
+	fprintf(out, "\n]}\n");
+
+	if (out != stdout)
+		fclose(out);
+	fclose(in);
+
+	return (EXIT_SUCCESS);
+}